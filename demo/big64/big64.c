@@ -0,0 +1,206 @@
+/* Allocate and stream more than 4GB */
+
+#include <core/coreall.h>
+#include <osbs/bfile.h>
+#include <sewer/bmem.h>
+
+typedef struct _rec_t Rec;
+
+struct _rec_t
+{
+    uint64_t id;
+    uint64_t value;
+};
+
+DeclSt(Rec);
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE byte_t i_byte(const uint64_t i)
+{
+    return (byte_t)((i * 2654435761u) >> 24);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_check(const byte_t *data, const uint64_t size)
+{
+    uint64_t i;
+    for (i = 0; i < size; i += 4093)
+    {
+        if (data[i] != i_byte(i))
+            return FALSE;
+    }
+
+    return (bool_t)(data[size - 1] == i_byte(size - 1));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_heap(const uint64_t size)
+{
+    byte_t *mem = heap_malloc64(size, "Big64");
+    uint64_t i;
+    bool_t ok;
+    for (i = 0; i < size; ++i)
+        mem[i] = i_byte(i);
+
+    /* Shrink below 4GB and grow again */
+    mem = heap_realloc64(mem, size, 0x10000000, "Big64");
+    mem = heap_realloc64(mem, 0x10000000, size, "Big64");
+    for (i = 0x10000000; i < size; ++i)
+        mem[i] = i_byte(i);
+
+    ok = i_check(mem, size);
+    heap_free64(&mem, size, "Big64");
+    return ok;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_stream(const char_t *pathname, const uint64_t size)
+{
+    Buffer *buffer = buffer_create64(size);
+    byte_t *data = buffer_data(buffer);
+    Stream *stm = NULL;
+    bool_t ok = FALSE;
+    uint64_t i;
+
+    for (i = 0; i < size; ++i)
+        data[i] = i_byte(i);
+
+    stm = stm_to_file(pathname, NULL);
+    if (stm != NULL)
+    {
+        stm_write64(stm, data, size);
+        ok = (bool_t)(stm_bytes_written(stm) == size);
+        stm_close(&stm);
+    }
+
+    buffer_destroy(&buffer);
+
+    /* Read the entire file in memory */
+    if (ok == TRUE)
+    {
+        buffer = hfile_buffer(pathname, NULL);
+        ok = (bool_t)(buffer != NULL && buffer_size64(buffer) == size);
+        if (ok == TRUE)
+            ok = i_check(buffer_const(buffer), size);
+        if (buffer != NULL)
+            buffer_destroy(&buffer);
+    }
+
+    /* Skip beyond 4GB in a file stream */
+    if (ok == TRUE)
+    {
+        stm = stm_from_file(pathname, NULL);
+        ok = (bool_t)(stm != NULL);
+        if (ok == TRUE)
+        {
+            byte_t last[16];
+            stm_skip64(stm, size - 16);
+            ok = (bool_t)(stm_read64(stm, last, 16) == 16);
+            for (i = 0; i < 16 && ok == TRUE; ++i)
+                ok = (bool_t)(last[i] == i_byte(size - 16 + i));
+            ok = (bool_t)(ok == TRUE && stm_read64(stm, last, 16) == 0);
+            stm_close(&stm);
+        }
+    }
+
+    bfile_delete(pathname, NULL);
+    return ok;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_array(const uint64_t size)
+{
+    ArrSt(Rec) *recs = arrst_create(Rec);
+    uint32_t n = (uint32_t)(size / sizeof(Rec)) + 1;
+    uint32_t i;
+    bool_t ok = TRUE;
+
+    for (i = 0; i < n; ++i)
+    {
+        Rec *rec = arrst_new(recs, Rec);
+        rec->id = i;
+        rec->value = (uint64_t)i * 3;
+    }
+
+    /* Delete and insert at the beginning, moving more than 4GB */
+    arrst_delete(recs, 0, NULL, Rec);
+    arrst_insert_n(recs, 0, 1, Rec)->id = 0;
+    ok = (bool_t)(arrst_size(recs, Rec) == n);
+
+    for (i = 1; i < n && ok == TRUE; i += 4093)
+    {
+        const Rec *rec = arrst_get_const(recs, i, Rec);
+        ok = (bool_t)(rec->id == i && rec->value == (uint64_t)i * 3);
+    }
+
+    ok = (bool_t)(ok == TRUE && arrst_last(recs, Rec)->id == n - 1);
+    arrst_destroy(&recs, NULL, Rec);
+    return ok;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint64_t size = (uint64_t)4400 << 20;
+    String *pathname = NULL;
+    bool_t ok = TRUE;
+
+    core_start();
+
+    if (argc == 2)
+    {
+        bool_t err;
+        uint32_t mb = str_to_u32(argv[1], 10, &err);
+        if (err == TRUE || mb == 0)
+        {
+            bstd_printf("Use: big64 [size in MB].\n");
+            core_finish();
+            return 0;
+        }
+
+        size = (uint64_t)mb << 20;
+    }
+
+    pathname = hfile_tmp_path("big64.bin");
+    bstd_printf("NAppGUI 64-bit sizes (%.2f GB).\n", (real64_t)size / (1024. * 1024. * 1024.));
+
+    if (i_heap(size) == TRUE)
+    {
+        bstd_printf("- heap_malloc64/heap_realloc64: OK\n");
+    }
+    else
+    {
+        bstd_printf("- heap_malloc64/heap_realloc64: FAIL\n");
+        ok = FALSE;
+    }
+
+    if (i_stream(tc(pathname), size) == TRUE)
+    {
+        bstd_printf("- stm_write64/hfile_buffer/stm_skip64: OK\n");
+    }
+    else
+    {
+        bstd_printf("- stm_write64/hfile_buffer/stm_skip64: FAIL\n");
+        ok = FALSE;
+    }
+
+    if (i_array(size) == TRUE)
+    {
+        bstd_printf("- ArrSt data > 4GB: OK\n");
+    }
+    else
+    {
+        bstd_printf("- ArrSt data > 4GB: FAIL\n");
+        ok = FALSE;
+    }
+
+    str_destroy(&pathname);
+    core_finish();
+    return ok == TRUE ? 0 : 1;
+}
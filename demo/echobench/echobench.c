@@ -0,0 +1,384 @@
+/* Event-driven socket benchmark */
+
+#include <core/coreall.h>
+#include <osbs/bpoll.h>
+#include <osbs/bsocket.h>
+#include <osbs/bthread.h>
+
+#define i_MSG_SIZE 64
+#define i_BUF_SIZE 4096
+
+typedef struct _server_t Server;
+typedef struct _conn_t Conn;
+typedef struct _blocking_t Blocking;
+typedef struct _load_t Load;
+typedef struct _client_t Client;
+
+struct _conn_t
+{
+    Server *server;
+    Socket *socket;
+    uint32_t start;
+    uint32_t end;
+    byte_t buffer[i_BUF_SIZE];
+};
+
+DeclPt(Conn);
+
+struct _server_t
+{
+    SocketPoll *poll;
+    Socket *listen;
+    ArrPt(Conn) *conns;
+};
+
+struct _blocking_t
+{
+    Socket *listen;
+    uint32_t nclients;
+};
+
+struct _client_t
+{
+    Load *load;
+    Socket *socket;
+    uint32_t received;
+};
+
+struct _load_t
+{
+    SocketPoll *poll;
+    uint64_t trips;
+    byte_t msg[i_MSG_SIZE];
+    byte_t buffer[i_BUF_SIZE];
+};
+
+/*---------------------------------------------------------------------------*/
+
+static void i_conn_close(Conn *conn)
+{
+    uint32_t pos = arrpt_find(conn->server->conns, conn, Conn);
+    bpoll_remove(conn->server->poll, conn->socket);
+    bsocket_close(&conn->socket);
+    arrpt_delete(conn->server->conns, pos, NULL, Conn);
+    heap_delete(&conn, Conn);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Edge-triggered: read until the socket would block */
+static void i_conn_event(Conn *conn, Socket *socket, const uint32_t events)
+{
+    cassert_no_null(conn);
+    cassert(conn->socket == socket);
+    unref(socket);
+
+    if (events & ekPOLL_ERROR)
+    {
+        i_conn_close(conn);
+        return;
+    }
+
+    for (;;)
+    {
+        uint32_t size = 0;
+        serror_t error = ekSOK;
+
+        /* Pending echo output */
+        while (conn->start < conn->end)
+        {
+            if (bsocket_send(conn->socket, conn->buffer + conn->start, conn->end - conn->start, &size, &error) == TRUE)
+            {
+                conn->start += size;
+            }
+            else if (error == ekSWOULDBLOCK)
+            {
+                bpoll_modify(conn->server->poll, conn->socket, ekPOLL_READ | ekPOLL_WRITE | ekPOLL_EDGE);
+                return;
+            }
+            else
+            {
+                i_conn_close(conn);
+                return;
+            }
+        }
+
+        conn->start = 0;
+        conn->end = 0;
+        bpoll_modify(conn->server->poll, conn->socket, ekPOLL_READ | ekPOLL_EDGE);
+
+        if (bsocket_recv(conn->socket, conn->buffer, i_BUF_SIZE, &size, &error) == TRUE)
+        {
+            /* Peer closed */
+            if (size == 0)
+            {
+                i_conn_close(conn);
+                return;
+            }
+
+            conn->end = size;
+        }
+        else if (error == ekSWOULDBLOCK)
+        {
+            return;
+        }
+        else
+        {
+            i_conn_close(conn);
+            return;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Level-triggered: one connection per event */
+static void i_listen_event(Server *server, Socket *socket, const uint32_t events)
+{
+    Socket *csocket = NULL;
+    cassert_no_null(server);
+    unref(events);
+    csocket = bsocket_accept(socket, 0, NULL);
+    if (csocket != NULL)
+    {
+        Conn *conn = heap_new(Conn);
+        conn->server = server;
+        conn->socket = csocket;
+        conn->start = 0;
+        conn->end = 0;
+        bsocket_nonblocking(csocket, TRUE);
+        arrpt_append(server->conns, conn, Conn);
+        bpoll_add(server->poll, csocket, ekPOLL_READ | ekPOLL_EDGE, i_conn_event, conn, Conn);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_server_main(Server *server)
+{
+    cassert_no_null(server);
+    bpoll_run(server->poll);
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_destroy_conn(Conn **conn)
+{
+    cassert_no_null(conn);
+    cassert_no_null(*conn);
+    bsocket_close(&(*conn)->socket);
+    heap_delete(conn, Conn);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_echo_main(Socket *socket)
+{
+    byte_t buffer[i_MSG_SIZE];
+    for (;;)
+    {
+        uint32_t size = 0;
+        if (bsocket_read(socket, buffer, i_MSG_SIZE, &size, NULL) == FALSE || size == 0)
+            break;
+
+        if (bsocket_write(socket, buffer, size, NULL, NULL) == FALSE)
+            break;
+    }
+
+    bsocket_close(&socket);
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* One thread per connection, blocking I/O */
+static uint32_t i_blocking_main(Blocking *blocking)
+{
+    Thread **threads = heap_new_n(blocking->nclients, Thread *);
+    uint32_t i, n = 0;
+    for (i = 0; i < blocking->nclients; ++i)
+    {
+        Socket *socket = bsocket_accept(blocking->listen, 0, NULL);
+        if (socket == NULL)
+            break;
+        threads[n++] = bthread_create(i_echo_main, socket, Socket);
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        bthread_wait(threads[i]);
+        bthread_close(&threads[i]);
+    }
+
+    heap_delete_n(&threads, blocking->nclients, Thread *);
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_send(Client *client)
+{
+    uint32_t size = 0;
+    bool_t ok = bsocket_send(client->socket, client->load->msg, i_MSG_SIZE, &size, NULL);
+    /* Empty socket buffer, a small message always fits */
+    cassert_unref(ok == TRUE && size == i_MSG_SIZE, ok);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_client_event(Client *client, Socket *socket, const uint32_t events)
+{
+    cassert_no_null(client);
+    unref(events);
+    for (;;)
+    {
+        uint32_t size = 0;
+        if (bsocket_recv(socket, client->load->buffer, i_BUF_SIZE, &size, NULL) == FALSE || size == 0)
+            break;
+
+        /* A round trip for each complete echo */
+        client->received += size;
+        while (client->received >= i_MSG_SIZE)
+        {
+            client->received -= i_MSG_SIZE;
+            client->load->trips += 1;
+            i_send(client);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_timer(Load *load, const uint32_t timer_id)
+{
+    cassert_no_null(load);
+    unref(timer_id);
+    bpoll_stop(load->poll);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static real64_t i_load(const uint16_t port, const uint32_t nclients, const uint32_t time_ms)
+{
+    Load load;
+    Client *clients = heap_new_n0(nclients, Client);
+    uint32_t ip = bsocket_str_ip("127.0.0.1");
+    Clock *clock = NULL;
+    real64_t t;
+    uint32_t i;
+
+    bmem_set1(load.msg, i_MSG_SIZE, 'x');
+    load.poll = bpoll_create();
+    load.trips = 0;
+
+    for (i = 0; i < nclients; ++i)
+    {
+        clients[i].load = &load;
+        clients[i].socket = bsocket_connect(ip, port, 0, NULL);
+        cassert_no_null(clients[i].socket);
+        bsocket_nonblocking(clients[i].socket, TRUE);
+        bpoll_add(load.poll, clients[i].socket, ekPOLL_READ | ekPOLL_EDGE, i_client_event, &clients[i], Client);
+    }
+
+    clock = clock_create(0.);
+    for (i = 0; i < nclients; ++i)
+        i_send(&clients[i]);
+
+    bpoll_timer(load.poll, time_ms, FALSE, i_timer, &load, Load);
+    bpoll_run(load.poll);
+    t = clock_elapsed(clock);
+    clock_destroy(&clock);
+
+    for (i = 0; i < nclients; ++i)
+    {
+        bpoll_remove(load.poll, clients[i].socket);
+        bsocket_close(&clients[i].socket);
+    }
+
+    bpoll_destroy(&load.poll);
+    heap_delete_n(&clients, nclients, Client);
+    return (real64_t)load.trips / t;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static Socket *i_listen(uint16_t *port)
+{
+    Socket *listen = bsocket_server(0, 1024, NULL);
+    uint32_t ip;
+    cassert_no_null(listen);
+    bsocket_local_ip(listen, &ip, port);
+    return listen;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint32_t time_ms = 1000;
+    uint32_t maxclients = 256;
+    Server server;
+    Thread *thread = NULL;
+    uint16_t port = 0;
+    uint32_t nclients;
+    bool_t err;
+
+    core_start();
+
+    if (argc >= 2)
+    {
+        time_ms = str_to_u32(argv[1], 10, &err);
+        if (argc >= 3 && err == FALSE)
+            maxclients = str_to_u32(argv[2], 10, &err);
+
+        if (err == TRUE || time_ms == 0 || maxclients == 0)
+        {
+            bstd_printf("Use: echobench [ms per round] [max clients].\n");
+            core_finish();
+            return 0;
+        }
+    }
+
+    /* Reactor server */
+    heap_start_mt();
+    server.poll = bpoll_create();
+    server.listen = i_listen(&port);
+    server.conns = arrpt_create(Conn);
+    bpoll_add(server.poll, server.listen, ekPOLL_READ, i_listen_event, &server, Server);
+    thread = bthread_create(i_server_main, &server, Server);
+
+    /* Each client and server connection uses a descriptor (see 'ulimit -n') */
+    bstd_printf("NAppGUI event-driven sockets.\n");
+    bstd_printf("- %u bytes echo over loopback, %u ms per round, %u cores\n", i_MSG_SIZE, time_ms, osbs_ncpus());
+
+    for (nclients = 1; nclients <= maxclients; nclients *= 4)
+    {
+        Blocking blocking;
+        Thread *bthread = NULL;
+        uint16_t bport = 0;
+        real64_t rpoll, rblock;
+
+        rpoll = i_load(port, nclients, time_ms);
+
+        blocking.listen = i_listen(&bport);
+        blocking.nclients = nclients;
+        bthread = bthread_create(i_blocking_main, &blocking, Blocking);
+        rblock = i_load(bport, nclients, time_ms);
+        bthread_wait(bthread);
+        bthread_close(&bthread);
+        bsocket_close(&blocking.listen);
+
+        bstd_printf("- %3u clients: poll %.0f trips/s, thread per connection %.0f trips/s\n", nclients, rpoll, rblock);
+    }
+
+    bpoll_stop(server.poll);
+    bthread_wait(thread);
+    bthread_close(&thread);
+    bpoll_destroy(&server.poll);
+    bsocket_close(&server.listen);
+    arrpt_destroy(&server.conns, i_destroy_conn, Conn);
+    heap_end_mt();
+    core_finish();
+    return 0;
+}
@@ -0,0 +1,131 @@
+/* Multi-threaded heap allocation benchmark */
+
+#include <core/coreall.h>
+#include <osbs/bthread.h>
+
+typedef struct _job_t Job;
+
+struct _job_t
+{
+    uint32_t seed;
+    uint32_t n;
+    byte_t *blocks[256];
+    uint32_t sizes[256];
+};
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_thread_main(Job *job)
+{
+    uint32_t i;
+    cassert_no_null(job);
+    for (i = 0; i < job->n; ++i)
+    {
+        uint32_t k = i_rand(&job->seed) % 256;
+        if (job->blocks[k] != NULL)
+        {
+            heap_free(&job->blocks[k], job->sizes[k], "HeapMtBlock");
+        }
+        else
+        {
+            job->sizes[k] = 8 + i_rand(&job->seed) % 248;
+            job->blocks[k] = heap_malloc(job->sizes[k], "HeapMtBlock");
+        }
+    }
+
+    for (i = 0; i < 256; ++i)
+    {
+        if (job->blocks[i] != NULL)
+            heap_free(&job->blocks[i], job->sizes[i], "HeapMtBlock");
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static real64_t i_bench(const uint32_t nthreads, const uint32_t n)
+{
+    Thread *threads[64];
+    Job *jobs = heap_new_n0(nthreads, Job);
+    Clock *clock = clock_create(0.);
+    real64_t t;
+    uint32_t i;
+
+    for (i = 0; i < nthreads; ++i)
+    {
+        jobs[i].seed = 526 + i;
+        jobs[i].n = n;
+        threads[i] = bthread_create(i_thread_main, &jobs[i], Job);
+    }
+
+    for (i = 0; i < nthreads; ++i)
+    {
+        bthread_wait(threads[i]);
+        bthread_close(&threads[i]);
+    }
+
+    t = clock_elapsed(clock);
+    clock_destroy(&clock);
+    heap_delete_n(&jobs, nthreads, Job);
+    return t;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint32_t n = 2000000;
+    uint32_t maxthreads = 2 * osbs_ncpus();
+    uint32_t nthreads;
+    real64_t ops1 = 0;
+    bool_t err;
+
+    core_start();
+
+    if (argc == 2)
+    {
+        n = str_to_u32(argv[1], 10, &err);
+        if (err == TRUE)
+        {
+            bstd_printf("Use: heapmt [allocs per thread].\n");
+            core_finish();
+            return 0;
+        }
+    }
+
+    if (maxthreads > 64)
+        maxthreads = 64;
+
+    heap_start_mt();
+    bstd_printf("NAppGUI multi-threaded heap.\n");
+    bstd_printf("- %u alloc/free per thread, %u cores\n", n, osbs_ncpus());
+
+    for (nthreads = 1; nthreads <= maxthreads; nthreads *= 2)
+    {
+        real64_t tl, tc, opsl, opsc;
+
+        /* Old behaviour: all threads share the global cache and its lock */
+        heap_thread_caches(FALSE);
+        tl = i_bench(nthreads, n);
+        heap_thread_caches(TRUE);
+        tc = i_bench(nthreads, n);
+        opsl = (real64_t)nthreads * (real64_t)n / tl;
+        opsc = (real64_t)nthreads * (real64_t)n / tc;
+        if (nthreads == 1)
+            ops1 = opsc;
+        bstd_printf("- %2u threads: global lock %.3fs (%.1f Mops/s) | thread caches %.3fs (%.1f Mops/s, x%.2f vs 1 thread, x%.2f vs global lock)\n", nthreads, tl, opsl / 1e6, tc, opsc / 1e6, opsc / ops1, opsc / opsl);
+    }
+
+    heap_end_mt();
+    core_finish();
+    return 0;
+}
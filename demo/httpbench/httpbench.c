@@ -0,0 +1,627 @@
+/* Concurrent HTTP requests benchmark */
+
+#include <core/coreall.h>
+#include <inet/httpcache.h>
+#include <inet/httppool.h>
+#include <inet/httpreq.h>
+#include <inet/inet.h>
+#include <osbs/bmutex.h>
+#include <osbs/bpoll.h>
+#include <osbs/bsocket.h>
+#include <osbs/bthread.h>
+
+#define i_IN_SIZE 4096
+
+typedef struct _server_t Server;
+typedef struct _conn_t Conn;
+typedef struct _bench_t Bench;
+typedef struct _chunks_t Chunks;
+
+/* Loopback HTTP/1.1 stand-in with keep-alive and a fixed response latency */
+struct _server_t
+{
+    SocketPoll *poll;
+    Thread *thread;
+    Socket *listen;
+    uint16_t port;
+    uint32_t delay_ms;
+    byte_t *response;
+    uint32_t response_size;
+    byte_t *notmod;
+    uint32_t notmod_size;
+    Mutex *mutex;
+    uint32_t connections;
+    uint32_t requests;
+    ArrPt(Conn) *conns;
+};
+
+struct _conn_t
+{
+    Server *server;
+    Socket *socket;
+    uint32_t timer;
+    const byte_t *out;
+    uint32_t out_size;
+    uint32_t sent;
+    bool_t sending;
+    uint32_t nin;
+    byte_t in[i_IN_SIZE];
+};
+
+struct _bench_t
+{
+    uint32_t ok;
+    uint32_t body_size;
+};
+
+struct _chunks_t
+{
+    Clock *clock;
+    real64_t first;
+    uint64_t received;
+};
+
+DeclPt(Conn);
+DeclPt(Http);
+
+/*---------------------------------------------------------------------------*/
+
+static void i_conn_close(Conn *conn)
+{
+    Server *server = conn->server;
+    uint32_t pos = arrpt_find(server->conns, conn, Conn);
+    if (conn->timer != 0)
+        bpoll_timer_cancel(server->poll, conn->timer);
+    bpoll_remove(server->poll, conn->socket);
+    bsocket_close(&conn->socket);
+    arrpt_delete(server->conns, pos, NULL, Conn);
+    heap_delete(&conn, Conn);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_conn_send(Conn *conn)
+{
+    Server *server = conn->server;
+    while (conn->sent < conn->out_size)
+    {
+        uint32_t size = 0;
+        serror_t error = ekSOK;
+        if (bsocket_send(conn->socket, conn->out + conn->sent, conn->out_size - conn->sent, &size, &error) == TRUE)
+        {
+            conn->sent += size;
+        }
+        else if (error == ekSWOULDBLOCK)
+        {
+            bpoll_modify(server->poll, conn->socket, ekPOLL_READ | ekPOLL_WRITE);
+            return TRUE;
+        }
+        else
+        {
+            return FALSE;
+        }
+    }
+
+    conn->sending = FALSE;
+    bpoll_modify(server->poll, conn->socket, ekPOLL_READ);
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_conn_timer(Conn *conn, const uint32_t timer_id)
+{
+    cassert_no_null(conn);
+    cassert_unref(conn->timer == timer_id, timer_id);
+    conn->timer = 0;
+    if (i_conn_send(conn) == FALSE)
+        i_conn_close(conn);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static const byte_t *i_header_end(const byte_t *data, const uint32_t size)
+{
+    uint32_t i;
+    for (i = 3; i < size; ++i)
+    {
+        if (data[i - 3] == '\r' && data[i - 2] == '\n' && data[i - 1] == '\r' && data[i] == '\n')
+            return data + i + 1;
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Revalidation of a cached response */
+static bool_t i_conditional(const byte_t *data, const uint32_t size)
+{
+    const char_t *header = "If-None-Match:";
+    uint32_t n = str_len_c(header), i;
+    for (i = 0; i + n <= size; ++i)
+    {
+        if (str_equ_cn(cast_const(data + i, char_t), header, n) == TRUE)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Bodyless requests. The client waits for each response (no pipelining) */
+static void i_conn_event(Conn *conn, Socket *socket, const uint32_t events)
+{
+    Server *server = NULL;
+    cassert_no_null(conn);
+    unref(socket);
+    server = conn->server;
+
+    if (events & ekPOLL_ERROR)
+    {
+        i_conn_close(conn);
+        return;
+    }
+
+    if ((events & ekPOLL_WRITE) && conn->sending == TRUE && conn->timer == 0)
+    {
+        if (i_conn_send(conn) == FALSE)
+        {
+            i_conn_close(conn);
+            return;
+        }
+    }
+
+    if (events & ekPOLL_READ)
+    {
+        uint32_t size = 0;
+        const byte_t *end = NULL;
+        if (conn->nin == i_IN_SIZE || bsocket_recv(conn->socket, conn->in + conn->nin, i_IN_SIZE - conn->nin, &size, NULL) == FALSE || size == 0)
+        {
+            i_conn_close(conn);
+            return;
+        }
+
+        conn->nin += size;
+        end = i_header_end(conn->in, conn->nin);
+        if (end != NULL && conn->sending == FALSE)
+        {
+            uint32_t used = (uint32_t)(end - conn->in);
+            if (server->notmod != NULL && i_conditional(conn->in, used) == TRUE)
+            {
+                conn->out = server->notmod;
+                conn->out_size = server->notmod_size;
+            }
+            else
+            {
+                conn->out = server->response;
+                conn->out_size = server->response_size;
+            }
+
+            if (used < conn->nin)
+                bmem_move(conn->in, end, conn->nin - used);
+            conn->nin -= used;
+            conn->sent = 0;
+            conn->sending = TRUE;
+
+            bmutex_lock(server->mutex);
+            server->requests += 1;
+            bmutex_unlock(server->mutex);
+
+            if (server->delay_ms > 0)
+            {
+                conn->timer = bpoll_timer(server->poll, server->delay_ms, FALSE, i_conn_timer, conn, Conn);
+            }
+            else if (i_conn_send(conn) == FALSE)
+            {
+                i_conn_close(conn);
+                return;
+            }
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_listen_event(Server *server, Socket *socket, const uint32_t events)
+{
+    Socket *csocket = NULL;
+    cassert_no_null(server);
+    unref(events);
+    csocket = bsocket_accept(socket, 0, NULL);
+    if (csocket != NULL)
+    {
+        Conn *conn = heap_new0(Conn);
+        conn->server = server;
+        conn->socket = csocket;
+        bsocket_nonblocking(csocket, TRUE);
+        arrpt_append(server->conns, conn, Conn);
+        bpoll_add(server->poll, csocket, ekPOLL_READ, i_conn_event, conn, Conn);
+        bmutex_lock(server->mutex);
+        server->connections += 1;
+        bmutex_unlock(server->mutex);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_server_main(Server *server)
+{
+    cassert_no_null(server);
+    bpoll_run(server->poll);
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* 'cache' are the Cache-Control and validator headers of cacheable responses */
+static void i_server_init(Server *server, const uint32_t body_size, const uint32_t delay_ms, const char_t *cache)
+{
+    String *header = str_printf("HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: %u\r\nConnection: keep-alive\r\n%s\r\n", body_size, cache != NULL ? cache : "");
+    uint32_t hsize = str_len(header);
+    uint32_t ip = 0;
+    bmem_zero(server, Server);
+    server->poll = bpoll_create();
+    server->listen = bsocket_server(0, 1024, NULL);
+    cassert_no_null(server->listen);
+    bsocket_local_ip(server->listen, &ip, &server->port);
+    server->delay_ms = delay_ms;
+    server->response_size = hsize + body_size;
+    server->response = heap_new_n(server->response_size, byte_t);
+    bmem_copy(server->response, cast_const(tc(header), byte_t), hsize);
+    bmem_set1(server->response + hsize, body_size, 'x');
+    if (cache != NULL)
+    {
+        String *notmod = str_printf("HTTP/1.1 304 Not Modified\r\nConnection: keep-alive\r\n%s\r\n", cache);
+        server->notmod_size = str_len(notmod);
+        server->notmod = heap_new_n(server->notmod_size, byte_t);
+        bmem_copy(server->notmod, cast_const(tc(notmod), byte_t), server->notmod_size);
+        str_destroy(&notmod);
+    }
+
+    server->mutex = bmutex_create();
+    server->conns = arrpt_create(Conn);
+    bpoll_add(server->poll, server->listen, ekPOLL_READ, i_listen_event, server, Server);
+    server->thread = bthread_create(i_server_main, server, Server);
+    str_destroy(&header);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_destroy_conn(Conn **conn)
+{
+    cassert_no_null(conn);
+    cassert_no_null(*conn);
+    bsocket_close(&(*conn)->socket);
+    heap_delete(conn, Conn);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_server_remove(Server *server)
+{
+    bpoll_stop(server->poll);
+    bthread_wait(server->thread);
+    bthread_close(&server->thread);
+    bpoll_destroy(&server->poll);
+    bsocket_close(&server->listen);
+    arrpt_destroy(&server->conns, i_destroy_conn, Conn);
+    heap_delete_n(&server->response, server->response_size, byte_t);
+    if (server->notmod != NULL)
+        heap_delete_n(&server->notmod, server->notmod_size, byte_t);
+    bmutex_close(&server->mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_connections(Server *server)
+{
+    uint32_t n;
+    bmutex_lock(server->mutex);
+    n = server->connections;
+    bmutex_unlock(server->mutex);
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_requests(Server *server)
+{
+    uint32_t n;
+    bmutex_lock(server->mutex);
+    n = server->requests;
+    bmutex_unlock(server->mutex);
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_check(Bench *bench, Http *http)
+{
+    if (http_response_status(http) == 200)
+    {
+        Stream *body = stm_memory(bench->body_size + 16);
+        if (http_response_body(http, body, NULL) == TRUE && stm_buffer_size(body) == bench->body_size)
+            bench->ok += 1;
+        stm_close(&body);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_OnDone(Bench *bench, Http *http, const ierror_t error)
+{
+    cassert_no_null(bench);
+    if (error == ekIOK)
+        i_check(bench, http);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_print(const char_t *name, Server *server, const uint32_t connections, const Bench *bench, const uint32_t n, const real64_t t)
+{
+    bstd_printf("- %-28s %4u/%u ok, %7.3f s, %7.1f req/s, %u connections\n", name, bench->ok, n, t, (real64_t)n / t, i_connections(server) - connections);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_bench_dget(const char_t *name, Server *server, const uint32_t n, const uint32_t body_size)
+{
+    Bench bench;
+    uint32_t connections = i_connections(server);
+    Clock *clock = clock_create(0.);
+    uint32_t i;
+    bench.ok = 0;
+    bench.body_size = body_size;
+    for (i = 0; i < n; ++i)
+    {
+        char_t url[128];
+        uint32_t status = 0;
+        Stream *stm = NULL;
+        bstd_sprintf(url, sizeof32(url), "http://127.0.0.1:%u/res/%u", server->port, i);
+        stm = http_dget(url, &status, NULL);
+        if (stm != NULL)
+        {
+            if (status == 200 && stm_buffer_size(stm) == body_size)
+                bench.ok += 1;
+            stm_close(&stm);
+        }
+    }
+
+    i_print(name, server, connections, &bench, n, clock_elapsed(clock));
+    clock_destroy(&clock);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_bench_http(Server *server, const uint32_t n, const uint32_t body_size)
+{
+    Bench bench;
+    uint32_t connections = i_connections(server);
+    Clock *clock = clock_create(0.);
+    Http *http = http_create("127.0.0.1", server->port);
+    uint32_t i;
+    bench.ok = 0;
+    bench.body_size = body_size;
+    http_cookies_policy(http, ekCOOKIES_OFF);
+    for (i = 0; i < n; ++i)
+    {
+        char_t path[64];
+        bstd_sprintf(path, sizeof32(path), "/res/%u", i);
+        if (http_get(http, path, NULL, 0, NULL) == TRUE)
+            i_check(&bench, http);
+    }
+
+    i_print("http_get (same Http)", server, connections, &bench, n, clock_elapsed(clock));
+    http_destroy(&http);
+    clock_destroy(&clock);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_bench_pool(Server *server, const uint32_t n, const uint32_t body_size, const uint32_t max_host)
+{
+    Bench bench;
+    uint32_t connections = i_connections(server);
+    Clock *clock = clock_create(0.);
+    HttpPool *pool = httppool_create(64, max_host);
+    ArrPt(Http) *https = arrpt_create(Http);
+    char_t name[64];
+    uint32_t i;
+    bench.ok = 0;
+    bench.body_size = body_size;
+    httppool_callback(pool, i_OnDone, &bench, Bench);
+
+    /* All requests are submitted at once */
+    for (i = 0; i < n; ++i)
+    {
+        char_t path[64];
+        Http *http = http_create("127.0.0.1", server->port);
+        http_cookies_policy(http, ekCOOKIES_OFF);
+        bstd_sprintf(path, sizeof32(path), "/res/%u", i);
+        httppool_get(pool, http, path, NULL, 0);
+        arrpt_append(https, http, Http);
+    }
+
+    while (httppool_wait(pool, UINT32_MAX) > 0)
+    {
+    }
+
+    bstd_sprintf(name, sizeof32(name), "HttpPool (%u per host)", max_host);
+    i_print(name, server, connections, &bench, n, clock_elapsed(clock));
+    httppool_destroy(&pool);
+    arrpt_destroy(&https, http_destroy, Http);
+    clock_destroy(&clock);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Sequential requests without server latency: connection setup and request overhead */
+static void i_bench_latency(const char_t *name, Server *server, const uint32_t n, const bool_t exists)
+{
+    uint32_t connections = i_connections(server);
+    uint32_t requests = i_requests(server);
+    Clock *clock = clock_create(0.);
+    real64_t total = 0, max = 0;
+    uint32_t i, ok = 0;
+    for (i = 0; i < n; ++i)
+    {
+        char_t url[128];
+        real64_t t;
+        bstd_sprintf(url, sizeof32(url), "http://127.0.0.1:%u/res/%u", server->port, i);
+        clock_reset(clock);
+        if (exists == TRUE)
+        {
+            if (http_exists(url) == TRUE)
+                ok += 1;
+        }
+        else
+        {
+            Stream *stm = http_dget(url, NULL, NULL);
+            if (stm != NULL)
+            {
+                ok += 1;
+                stm_close(&stm);
+            }
+        }
+
+        t = clock_elapsed(clock);
+        total += t;
+        if (t > max)
+            max = t;
+    }
+
+    bstd_printf("- %-28s %4u/%u ok, mean %7.1f us, max %7.1f us, %u connections, %u requests\n", name, ok, n, 1e6 * total / (real64_t)n, 1e6 * max, i_connections(server) - connections, i_requests(server) - requests);
+    clock_destroy(&clock);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_OnChunk(Chunks *chunks, const byte_t *chunk, const uint32_t size)
+{
+    cassert_no_null(chunks);
+    unref(chunk);
+    if (chunks->received == 0)
+        chunks->first = clock_elapsed(chunks->clock);
+    chunks->received += size;
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_print_large(const char_t *name, const uint64_t size, const real64_t first, const real64_t t)
+{
+    bstd_printf("- %-28s %.1f MB, first byte %7.3f s, total %7.3f s, %7.1f MB/s\n", name, (real64_t)size / (1024. * 1024.), first, t, (real64_t)size / (1024. * 1024. * t));
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* The buffered body is available when the request ends */
+static void i_bench_large(const uint16_t port)
+{
+    Http *http = http_create("127.0.0.1", port);
+    Clock *clock = clock_create(0.);
+    Stream *body = stm_memory(1024);
+    Chunks chunks;
+    real64_t t;
+
+    http_cookies_policy(http, ekCOOKIES_OFF);
+    if (http_get(http, "/large", NULL, 0, NULL) == TRUE)
+        http_response_body(http, body, NULL);
+    t = clock_elapsed(clock);
+    i_print_large("buffered body", stm_buffer_size(body), t, t);
+    stm_close(&body);
+
+    chunks.clock = clock;
+    chunks.first = 0;
+    chunks.received = 0;
+    clock_reset(clock);
+    http_response_callback(http, i_OnChunk, &chunks, Chunks);
+    http_get(http, "/large", NULL, 0, NULL);
+    t = clock_elapsed(clock);
+    i_print_large("streamed body", chunks.received, chunks.first, t);
+
+    http_destroy(&http);
+    clock_destroy(&clock);
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint32_t n = 200;
+    uint32_t delay_ms = 10;
+    uint32_t body_size = 16 * 1024;
+    Server server;
+    bool_t err = FALSE;
+
+    inet_start();
+
+    if (argc >= 2)
+    {
+        n = str_to_u32(argv[1], 10, &err);
+        if (argc >= 3 && err == FALSE)
+            delay_ms = str_to_u32(argv[2], 10, &err);
+
+        if (err == TRUE || n == 0)
+        {
+            bstd_printf("Use: httpbench [requests] [server latency ms].\n");
+            inet_finish();
+            return 0;
+        }
+    }
+
+    heap_start_mt();
+    i_server_init(&server, body_size, delay_ms, NULL);
+
+    bstd_printf("NAppGUI concurrent HTTP requests.\n");
+    bstd_printf("- %u GET requests of %u bytes to a loopback server with %u ms latency\n", n, body_size, delay_ms);
+    http_keepalive(0, 0);
+    i_bench_dget("http_dget (no keep-alive)", &server, n, body_size);
+    http_keepalive(4, 30000);
+    i_bench_dget("http_dget", &server, n, body_size);
+    i_bench_http(&server, n, body_size);
+    i_bench_pool(&server, n, body_size, 1);
+    i_bench_pool(&server, n, body_size, 4);
+    i_bench_pool(&server, n, body_size, 16);
+    i_server_remove(&server);
+
+    /* Small body without latency */
+    i_server_init(&server, 1024, 0, NULL);
+    bstd_printf("- Request latency. %u GET requests of 1024 bytes without server latency\n", n);
+    http_keepalive(0, 0);
+    i_bench_latency("http_dget (no keep-alive)", &server, n, FALSE);
+    i_bench_latency("http_exists (no keep-alive)", &server, n, TRUE);
+    http_keepalive(4, 30000);
+    i_bench_latency("http_dget", &server, n, FALSE);
+    i_bench_latency("http_exists", &server, n, TRUE);
+    i_server_remove(&server);
+
+    /* Large body without latency */
+    i_server_init(&server, 64 * 1024 * 1024, 0, NULL);
+    i_bench_large(server.port);
+    i_server_remove(&server);
+
+    /* Repeated requests with the on-disk cache */
+    bstd_printf("- HTTP cache. %u GET requests of %u bytes, twice, %u ms latency\n", n, body_size, delay_ms);
+    if (httpcache_enable("httpbench", 64 * 1024 * 1024) == TRUE)
+    {
+        httpcache_clear();
+        i_server_init(&server, body_size, delay_ms, "Cache-Control: max-age=3600\r\nETag: \"v1\"\r\n");
+        i_bench_latency("http_dget (empty cache)", &server, n, FALSE);
+        i_bench_latency("http_dget (fresh)", &server, n, FALSE);
+        i_server_remove(&server);
+
+        i_server_init(&server, body_size, delay_ms, "Cache-Control: no-cache\r\nETag: \"v1\"\r\n");
+        i_bench_latency("http_dget (empty cache)", &server, n, FALSE);
+        i_bench_latency("http_dget (revalidated)", &server, n, FALSE);
+        i_server_remove(&server);
+        httpcache_clear();
+        httpcache_disable();
+    }
+
+    heap_end_mt();
+    inet_finish();
+    return 0;
+}
@@ -0,0 +1,251 @@
+/* Json parsing benchmark over large record arrays */
+
+#include <encode/encode.h>
+#include <encode/json.h>
+#include <core/coreall.h>
+
+typedef struct _record_t Record;
+typedef struct _records_t Records;
+typedef struct _header_t Header;
+
+struct _record_t
+{
+    uint32_t id;
+    String *name;
+    String *email;
+    bool_t active;
+    int32_t balance;
+    real64_t latitude;
+    real64_t longitude;
+    uint16_t age;
+    String *city;
+    String *country;
+    real32_t score;
+    uint32_t visits;
+};
+
+struct _records_t
+{
+    uint32_t size;
+    ArrSt(Record) *data;
+};
+
+/* Only the 'size' member. Records array is scanned but not parsed */
+struct _header_t
+{
+    uint32_t size;
+};
+
+DeclSt(Record);
+
+/*---------------------------------------------------------------------------*/
+
+static void i_dbind(void)
+{
+    dbind(Record, uint32_t, id);
+    dbind(Record, String *, name);
+    dbind(Record, String *, email);
+    dbind(Record, bool_t, active);
+    dbind(Record, int32_t, balance);
+    dbind(Record, real64_t, latitude);
+    dbind(Record, real64_t, longitude);
+    dbind(Record, uint16_t, age);
+    dbind(Record, String *, city);
+    dbind(Record, String *, country);
+    dbind(Record, real32_t, score);
+    dbind(Record, uint32_t, visits);
+    dbind(Records, uint32_t, size);
+    dbind(Records, ArrSt(Record) *, data);
+    dbind(Header, uint32_t, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_member(Stream *stm, const uint32_t i, const uint32_t field)
+{
+    switch (field)
+    {
+    case 0:
+        stm_printf(stm, "\"id\":%u", i);
+        break;
+    case 1:
+        stm_printf(stm, "\"name\":\"User %u\"", i);
+        break;
+    case 2:
+        stm_printf(stm, "\"email\":\"user%u@example.com\"", i);
+        break;
+    case 3:
+        stm_printf(stm, "\"active\":%s", (i % 3) == 0 ? "false" : "true");
+        break;
+    case 4:
+        stm_printf(stm, "\"balance\":%d", (int32_t)(i % 20000) - 10000);
+        break;
+    case 5:
+        stm_printf(stm, "\"latitude\":%.6f", (real64_t)(i % 180) - 90.25);
+        break;
+    case 6:
+        stm_printf(stm, "\"longitude\":%.6f", (real64_t)(i % 360) - 180.75);
+        break;
+    case 7:
+        stm_printf(stm, "\"age\":%u", 18 + i % 70);
+        break;
+    case 8:
+        stm_printf(stm, "\"city\":\"City %u\"", i % 500);
+        break;
+    case 9:
+        stm_printf(stm, "\"country\":\"Country %u\"", i % 50);
+        break;
+    case 10:
+        stm_printf(stm, "\"score\":%.2f", (real64_t)(i % 1000) / 10.);
+        break;
+    case 11:
+        stm_printf(stm, "\"visits\":%u", i * 7 % 1000);
+        break;
+    default:
+        cassert_default(field);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static Stream *i_json(const uint32_t n, const bool_t in_order)
+{
+    Stream *stm = stm_memory(n * 256);
+    uint32_t i;
+    stm_printf(stm, "{\"size\":%u,\"data\":[", n);
+    for (i = 0; i < n; ++i)
+    {
+        uint32_t j;
+        stm_printf(stm, i == 0 ? "{" : ",{");
+        for (j = 0; j < 12; ++j)
+        {
+            /* Out of order: members in reverse declaration order */
+            uint32_t field = in_order == TRUE ? j : 11 - j;
+            if (j > 0)
+                stm_printf(stm, ",");
+            i_member(stm, i, field);
+        }
+        stm_printf(stm, "}");
+    }
+    stm_printf(stm, "]}");
+    return stm;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static real64_t i_bench(const uint32_t n, const bool_t in_order)
+{
+    Stream *json = i_json(n, in_order);
+    Stream *stm = stm_from_block(stm_buffer(json), stm_buffer_size(json));
+    Clock *clock = clock_create(0.);
+    Records *records = json_read(stm, NULL, Records);
+    real64_t t = clock_elapsed(clock);
+    real64_t mb = (real64_t)stm_buffer_size(json) / (1024. * 1024.);
+    cassert_no_null(records);
+    cassert(arrst_size(records->data, Record) == n);
+    bstd_printf("- %s: %.3fs (%.1f MB, %.1f MB/s, %.2f Mrecords/s)\n", in_order == TRUE ? "Declaration order" : "Reverse order    ", t, mb, mb / t, (real64_t)n / t / 1e6);
+    json_destroy(&records, Records);
+    clock_destroy(&clock);
+    stm_close(&stm);
+    stm_close(&json);
+    return mb / t;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_bench_scan(const uint32_t n)
+{
+    Stream *json = i_json(n, TRUE);
+    Stream *stm = stm_from_block(stm_buffer(json), stm_buffer_size(json));
+    Clock *clock = clock_create(0.);
+    Header *header = json_read(stm, NULL, Header);
+    real64_t t = clock_elapsed(clock);
+    real64_t mb = (real64_t)stm_buffer_size(json) / (1024. * 1024.);
+    cassert_no_null(header);
+    cassert(header->size == n);
+    bstd_printf("- Scan only        : %.3fs (%.1f MB, %.1f MB/s)\n", t, mb, mb / t);
+    json_destroy(&header, Header);
+    clock_destroy(&clock);
+    stm_close(&stm);
+    stm_close(&json);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_bench_stream(const uint32_t n)
+{
+    Stream *json = i_json(n, TRUE);
+    Stream *stm = stm_from_block(stm_buffer(json), stm_buffer_size(json));
+    Clock *clock = clock_create(0.);
+    JsonReader *reader = json_reader_create(stm, NULL);
+    jsonev_t event = json_reader_next(reader);
+    uint32_t count = 0;
+    real64_t t, mb;
+
+    /* Records are parsed and released one by one */
+    cassert_unref(event == ekJSON_BEGIN_OBJECT, event);
+    while (json_reader_next(reader) == ekJSON_KEY)
+    {
+        if (str_equ_c(json_reader_text(reader), "data") == TRUE)
+        {
+            Record *record = NULL;
+            event = json_reader_next(reader);
+            cassert_unref(event == ekJSON_BEGIN_ARRAY, event);
+            while ((record = json_reader_value(reader, Record)) != NULL)
+            {
+                count += 1;
+                dbind_destroy(&record, Record);
+            }
+        }
+        else
+        {
+            json_reader_skip(reader);
+        }
+    }
+
+    json_reader_destroy(&reader);
+    t = clock_elapsed(clock);
+    mb = (real64_t)stm_buffer_size(json) / (1024. * 1024.);
+    cassert_unref(count == n, count);
+    bstd_printf("- Streaming        : %.3fs (%.1f MB, %.1f MB/s, %.2f Mrecords/s)\n", t, mb, mb / t, (real64_t)n / t / 1e6);
+    clock_destroy(&clock);
+    stm_close(&stm);
+    stm_close(&json);
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint32_t n = 1000000;
+    real64_t mbs = 0;
+    bool_t err;
+
+    encode_start();
+
+    if (argc == 2)
+    {
+        n = str_to_u32(argv[1], 10, &err);
+        if (err == TRUE)
+        {
+            bstd_printf("Use: jsonbench [records].\n");
+            encode_finish();
+            return 0;
+        }
+    }
+
+    i_dbind();
+    bstd_printf("NAppGUI Json parsing.\n");
+    bstd_printf("- %u records, 12 members each\n", n);
+    /* End to end: Json text to binded objects (scanner + dbind) */
+    bstd_printf("json_read (end to end)\n");
+    mbs = i_bench(n, TRUE);
+    i_bench(n, FALSE);
+    i_bench_stream(n);
+    /* Scanner alone, records are not binded. Not representative of 'json_read' */
+    bstd_printf("Scanner (no binding)\n");
+    i_bench_scan(n);
+    bstd_printf("json_read end to end: %.1f MB/s\n", mbs);
+    encode_finish();
+    return 0;
+}
@@ -0,0 +1,118 @@
+/* Multi-threaded log benchmark */
+
+#include <core/coreall.h>
+#include <osbs/bfile.h>
+#include <osbs/bthread.h>
+#include <osbs/log.h>
+
+typedef struct _job_t Job;
+
+struct _job_t
+{
+    uint32_t id;
+    uint32_t n;
+};
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_thread_main(Job *job)
+{
+    uint32_t i;
+    cassert_no_null(job);
+    for (i = 0; i < job->n; ++i)
+        log_printf("Producer %u: message %u with some payload %.3f", job->id, i, (real64_t)i * .5);
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static real64_t i_bench(const uint32_t nthreads, const uint32_t n)
+{
+    Thread *threads[64];
+    Job *jobs = heap_new_n0(nthreads, Job);
+    Clock *clock = clock_create(0.);
+    real64_t t;
+    uint32_t i;
+
+    for (i = 0; i < nthreads; ++i)
+    {
+        jobs[i].id = i;
+        jobs[i].n = n;
+        threads[i] = bthread_create(i_thread_main, &jobs[i], Job);
+    }
+
+    for (i = 0; i < nthreads; ++i)
+    {
+        bthread_wait(threads[i]);
+        bthread_close(&threads[i]);
+    }
+
+    /* Lines are in disk */
+    log_flush();
+    t = clock_elapsed(clock);
+    clock_destroy(&clock);
+    heap_delete_n(&jobs, nthreads, Job);
+    return t;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    uint32_t n = 100000;
+    uint32_t maxthreads = 2 * osbs_ncpus();
+    uint32_t nthreads;
+    char_t path[512];
+    bool_t err;
+
+    core_start();
+
+    if (argc == 2)
+    {
+        n = str_to_u32(argv[1], 10, &err);
+        if (err == TRUE)
+        {
+            bstd_printf("Use: logbench [messages per thread].\n");
+            core_finish();
+            return 0;
+        }
+    }
+
+    if (maxthreads > 64)
+        maxthreads = 64;
+
+    bfile_dir_tmp(path, sizeof32(path));
+    str_cat_c(path, sizeof32(path), "/logbench.txt");
+    bstd_printf("NAppGUI multi-threaded log.\n");
+    bstd_printf("- %u messages per thread, %u cores, '%s'\n", n, osbs_ncpus(), path);
+    log_output(FALSE, FALSE);
+
+    for (nthreads = 1; nthreads <= maxthreads; nthreads *= 2)
+    {
+        real64_t msgs = (real64_t)nthreads * (real64_t)n;
+        real64_t ts, tw, td;
+        uint32_t dropped;
+
+        log_file(path);
+        ts = i_bench(nthreads, n);
+
+        log_file(path);
+        log_async(1024 * 1024, ekLOG_WAIT);
+        tw = i_bench(nthreads, n);
+
+        log_file(path);
+        log_async(1024 * 1024, ekLOG_DROP);
+        dropped = log_dropped();
+        td = i_bench(nthreads, n);
+        dropped = log_dropped() - dropped;
+        log_async(0, ekLOG_DROP);
+
+        bstd_printf("- %2u threads: sync %.0f msg/s, async wait %.0f msg/s, async drop %.0f msg/s (%u dropped)\n", nthreads, msgs / ts, msgs / tw, msgs / td, dropped);
+    }
+
+    log_file(NULL);
+    bfile_delete(path, NULL);
+    log_output(TRUE, FALSE);
+    core_finish();
+    return 0;
+}
@@ -0,0 +1,240 @@
+/* NAppGUI parallel algorithms VS STL */
+
+#include <core/coreall.h>
+#include <core/arrst.hpp>
+#include <sewer/nowarn.hxx>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#if defined(PARBENCH_EXECUTION)
+#include <execution>
+#endif
+#include <sewer/warn.hxx>
+
+using namespace std;
+
+struct Sample
+{
+    uint32_t id;
+    real32_t value;
+    real64_t weight;
+};
+
+DeclSt(Sample);
+
+/*---------------------------------------------------------------------------*/
+
+static int i_compare(const Sample *s1, const Sample *s2)
+{
+    return s1->id < s2->id ? -1 : (s1->id > s2->id ? 1 : 0);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int i_compare_ex(const Sample *s1, const Sample *s2, void *data)
+{
+    unref(data);
+    return i_compare(s1, s2);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_key(const Sample *sample, uint32_t *key)
+{
+    *key = sample->id;
+}
+
+/*---------------------------------------------------------------------------*/
+
+struct i_stl_compare
+{
+    inline bool operator()(const Sample &lhs, const Sample &rhs) const
+    {
+        return lhs.id < rhs.id;
+    }
+};
+
+/*---------------------------------------------------------------------------*/
+
+static void i_scale(Sample *samples, const uint32_t n, const uint32_t first, real64_t *factor)
+{
+    unref(first);
+    for (uint32_t i = 0; i < n; ++i)
+        samples[i].weight = bmath_sqrtd((real64_t)samples[i].value) * *factor;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_sum(const Sample *samples, const uint32_t n, real64_t *partial, void *data)
+{
+    unref(data);
+    for (uint32_t i = 0; i < n; ++i)
+        *partial += samples[i].weight;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_join(real64_t *result, const real64_t *partial, void *data)
+{
+    unref(data);
+    *result += *partial;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_sorted(const Sample *samples, const uint32_t n)
+{
+    for (uint32_t i = 1; i < n; ++i)
+    {
+        if (samples[i - 1].id > samples[i].id)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_core_finish(void)
+{
+    core_finish();
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    bool_t err;
+    uint32_t n;
+    Sample *samples;
+    ArrSt(Sample) *arrst;
+    vector< Sample > stl_arrst;
+    real64_t factor = 1.5;
+    real64_t sum1 = 0, sum2 = 0;
+    Clock *clock;
+    real64_t t;
+
+    core_start();
+    atexit(i_core_finish);
+
+    if (argc == 2)
+    {
+        n = str_to_u32(argv[1], 10, &err);
+        if (err == TRUE)
+        {
+            log_printf("Use: parbench [size].");
+            return 0;
+        }
+    }
+    else
+    {
+        n = 4000000;
+    }
+
+    bstd_printf("NAppGUI parallel algorithms vs STL.\n");
+
+    // Create the elements. This time is out of the test
+    samples = heap_new_n(n, Sample);
+    bmath_rand_seed(526);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        samples[i].id = bmath_randi(0, 0x7FFFFFFF);
+        samples[i].value = (real32_t)i;
+        samples[i].weight = 0;
+    }
+
+    arrst = arrst_create(Sample);
+    for (uint32_t i = 0; i < n; ++i)
+        arrst_append(arrst, samples[i], Sample);
+
+    clock = clock_create(0.);
+    bstd_printf("- Created %u elements of %u bytes, %u workers\n", n, sizeof32(Sample), tpool_nworkers(tpool_global()));
+    bstd_printf("- Starting...\n");
+
+    // Element-wise transform
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        samples[i].weight = bmath_sqrtd((real64_t)samples[i].value) * factor;
+    t = clock_elapsed(clock);
+    bstd_printf("- Serial for: %.6f\n", t);
+
+    clock_reset(clock);
+    arrst_parallel_for(arrst, 0, i_scale, &factor, Sample, real64_t);
+    t = clock_elapsed(clock);
+    bstd_printf("- arrst_parallel_for: %.6f\n", t);
+
+    // Sum reduction
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        sum1 += samples[i].weight;
+    t = clock_elapsed(clock);
+    bstd_printf("- Serial reduce: %.6f\n", t);
+
+    clock_reset(clock);
+    arrst_parallel_reduce(arrst, 0, i_sum, i_join, &sum2, NULL, Sample, real64_t, void);
+    t = clock_elapsed(clock);
+    bstd_printf("- arrst_parallel_reduce: %.6f (diff %g)\n", t, bmath_absd(sum1 - sum2) / sum1);
+
+    // Sort
+    clock_reset(clock);
+    arrst_sort(arrst, i_compare, Sample);
+    t = clock_elapsed(clock);
+    bstd_printf("- arrst_sort: %.6f\n", t);
+
+    arrst_clear(arrst, NULL, Sample);
+    for (uint32_t i = 0; i < n; ++i)
+        arrst_append(arrst, samples[i], Sample);
+
+    clock_reset(clock);
+    arrst_sort_ex(arrst, i_compare_ex, NULL, Sample, void);
+    t = clock_elapsed(clock);
+    bstd_printf("- arrst_sort_ex: %.6f (%s)\n", t, i_sorted(arrst_all_const(arrst, Sample), n) ? "ok" : "FAIL");
+
+    arrst_clear(arrst, NULL, Sample);
+    for (uint32_t i = 0; i < n; ++i)
+        arrst_append(arrst, samples[i], Sample);
+
+    clock_reset(clock);
+    arrst_sort_stable(arrst, i_compare, Sample);
+    t = clock_elapsed(clock);
+    bstd_printf("- arrst_sort_stable: %.6f (%s)\n", t, i_sorted(arrst_all_const(arrst, Sample), n) ? "ok" : "FAIL");
+
+    arrst_clear(arrst, NULL, Sample);
+    for (uint32_t i = 0; i < n; ++i)
+        arrst_append(arrst, samples[i], Sample);
+
+    clock_reset(clock);
+    arrst_sort_key(arrst, i_key, ekSKEY_U32, Sample, uint32_t);
+    t = clock_elapsed(clock);
+    bstd_printf("- arrst_sort_key: %.6f (%s)\n", t, i_sorted(arrst_all_const(arrst, Sample), n) ? "ok" : "FAIL");
+
+    arrst_clear(arrst, NULL, Sample);
+    for (uint32_t i = 0; i < n; ++i)
+        arrst_append(arrst, samples[i], Sample);
+
+    clock_reset(clock);
+    arrst_parallel_sort(arrst, i_compare, Sample);
+    t = clock_elapsed(clock);
+    bstd_printf("- arrst_parallel_sort: %.6f (%s)\n", t, i_sorted(arrst_all_const(arrst, Sample), n) ? "ok" : "FAIL");
+
+    stl_arrst.assign(samples, samples + n);
+    clock_reset(clock);
+    sort(stl_arrst.begin(), stl_arrst.end(), i_stl_compare());
+    t = clock_elapsed(clock);
+    bstd_printf("- std::sort: %.6f\n", t);
+
+#if defined(PARBENCH_EXECUTION)
+    stl_arrst.assign(samples, samples + n);
+    clock_reset(clock);
+    sort(execution::par, stl_arrst.begin(), stl_arrst.end(), i_stl_compare());
+    t = clock_elapsed(clock);
+    bstd_printf("- std::sort(par): %.6f\n", t);
+#else
+    bstd_printf("- std::sort(par): not available\n");
+#endif
+
+    clock_destroy(&clock);
+    arrst_destroy(&arrst, NULL, Sample);
+    heap_delete_n(&samples, n, Sample);
+    return 0;
+}
@@ -0,0 +1,257 @@
+/* Regular expression matching benchmark */
+
+#include <core/coreall.h>
+#include <core/regexh.h>
+
+typedef bool_t (*FPtr_match)(const RegEx *regex, const char_t *str);
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_rand(uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ArrPt(String) *i_filenames(const uint32_t n)
+{
+    static const char_t *i_EXT[] = {"png", "jpg", "txt", "json", "c", "log"};
+    ArrPt(String) *names = arrpt_create(String);
+    uint32_t seed = 526;
+    uint32_t i;
+    for (i = 0; i < n; ++i)
+    {
+        uint32_t r = i_rand(&seed);
+        uint32_t e = i_rand(&seed) % 6;
+        String *name = NULL;
+        if (r % 3 == 0)
+            name = str_printf("%03u_OCR_OK_%02u_%03u.%s", r % 4, (r / 3) % 3, i % 1000, i_EXT[e]);
+        else if (r % 3 == 1)
+            name = str_printf("server_%u_%u-2026.%s", r % 97, i, i_EXT[e]);
+        else
+            name = str_printf("[%u] %s /api/v%u/items/%u took %u ms", i, e == 0 ? "error" : "request", r % 3, r % 5000, r % 250);
+        arrpt_append(names, name, String);
+    }
+
+    return names;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static real64_t i_bench(const RegEx *regex, const ArrPt(String) *names, FPtr_match func_match, uint32_t *hits)
+{
+    Clock *clock = clock_create(0.);
+    real64_t t;
+    *hits = 0;
+    arrpt_foreach_const(name, names, String)
+        if (func_match(regex, tc(name)) == TRUE)
+            *hits += 1;
+    arrpt_end()
+    t = clock_elapsed(clock);
+    clock_destroy(&clock);
+    return t;
+}
+
+/*---------------------------------------------------------------------------*/
+
+typedef struct _rcase_t RCase;
+struct _rcase_t
+{
+    const char_t *pattern;
+    const char_t *str;
+    bool_t match;
+};
+
+/*
+ * Expected results, same as the previous engine except where noted.
+ * Capture groups '(..)' must not change what a pattern matches.
+ */
+static const RCase i_CASES[] = {
+    {"[ca*]", "", TRUE},
+    {"[ca*]", "c", TRUE},
+    {"[ca*]", "ca", FALSE},
+    {"[ca*]", "aa", TRUE}, /* Previously FALSE: '*' was lost in the union */
+    {"[c(a*)]", "", TRUE},
+    {"[c(a*)]", "c", TRUE},
+    {"[c(a*)]", "ca", FALSE},
+    {"[c(a*)]", "aa", TRUE},   /* Previously FALSE */
+    {"x[ca*]y", "xcy", TRUE},
+    {"x[ca*]y", "xcay", FALSE},
+    {"x[ca*]y", "xaay", TRUE}, /* Previously FALSE: '*' was lost in the union */
+    {"x[c(a*)]y", "xcy", TRUE},
+    {"x[c(a*)]y", "xcay", FALSE},
+    {"x[c(a*)]y", "xaay", TRUE}, /* Previously FALSE */
+    {"a*b", "aab", TRUE},
+    {"(a*)b", "aab", TRUE},
+    {"(a*)b", "b", TRUE},
+    {"(a*)b", "aba", FALSE},
+    {"(ab)*c", "c", TRUE},
+    {"(ab)*c", "ababc", TRUE},
+    {"(ab)*c", "abac", FALSE},
+    {"(a)(b)(c)", "abc", TRUE},
+    {"(a)(b)(c)", "ab", FALSE},
+    {"x(.*)y", "xhelloy", TRUE},
+    {"x(.*)y", "xhello", FALSE},
+    {"[a*b]*", "aabba", TRUE},  /* Previously crashed: nullable item in a closure */
+    {"[a*b]*", "abc", FALSE},   /* Previously crashed */
+    {"c(.*)*c", "cabc", TRUE},  /* Previously crashed */
+    {"(a*)*", "", TRUE},         /* Previously crashed: nullable group in a closure */
+    {"(a*)*", "aaa", TRUE},      /* Previously crashed */
+    {"(x*)*y", "xxy", TRUE},     /* Previously crashed */
+    {"(x*)*y", "xx", FALSE},     /* Previously crashed */
+    {".*_OCR_OK_.*\\.[(png)(jpg)]", "000_OCR_OK_01_001.jpg", TRUE},
+    {".*_OCR_OK_.*\\.[(png)(jpg)]", "000_OCR_OK_01_001.txt", FALSE}};
+
+/*---------------------------------------------------------------------------*/
+
+/* Checks the DFA and NFA results of the pattern set */
+static bool_t i_check(void)
+{
+    uint32_t i, n = sizeof32(i_CASES) / sizeof32(RCase), fails = 0;
+    for (i = 0; i < n; ++i)
+    {
+        RegEx *regex = regex_create(i_CASES[i].pattern);
+        bool_t mdfa, mnfa;
+        cassert_no_null(regex);
+        mdfa = regex_match(regex, i_CASES[i].str);
+        mnfa = regex_match_nfa(regex, i_CASES[i].str);
+        if (mdfa != i_CASES[i].match || mnfa != i_CASES[i].match)
+        {
+            bstd_printf("- FAIL '%s' with '%s': DFA %d, NFA %d, expected %d\n", i_CASES[i].pattern, i_CASES[i].str, mdfa, mnfa, i_CASES[i].match);
+            fails += 1;
+        }
+
+        regex_destroy(&regex);
+    }
+
+    bstd_printf("- Check: %u cases, %u failed\n", n, fails);
+    return (bool_t)(fails == 0);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* All patterns against all strings: one pass per pattern versus one pass with a set */
+static void i_bench_set(const char_t **patterns, const uint32_t npatterns, const ArrPt(String) *names)
+{
+    RegEx *regex[16];
+    RegExSet *set = regex_set_create();
+    ArrSt(uint32_t) *matches = arrst_create(uint32_t);
+    Clock *clock = NULL;
+    uint32_t i, hloop = 0, hset = 0;
+    real64_t tloop, tset;
+
+    cassert(npatterns <= 16);
+    for (i = 0; i < npatterns; ++i)
+    {
+        bool_t ok = regex_set_add(set, patterns[i]);
+        cassert_unref(ok == TRUE, ok);
+        regex[i] = regex_create(patterns[i]);
+    }
+
+    clock = clock_create(0.);
+    arrpt_foreach_const(name, names, String)
+        for (i = 0; i < npatterns; ++i)
+        {
+            if (regex_match(regex[i], tc(name)) == TRUE)
+                hloop += 1;
+        }
+    arrpt_end()
+    tloop = clock_elapsed(clock);
+
+    clock_reset(clock);
+    arrpt_foreach_const(name, names, String)
+        hset += regex_set_match(set, tc(name), matches);
+    arrpt_end()
+    tset = clock_elapsed(clock);
+
+    cassert_unref(hloop == hset, hloop);
+    bstd_printf("- All patterns: %u matches, %u x regex_match %.3fs, RegExSet %.3fs, x%.1f\n", hset, npatterns, tloop, tset, tloop / tset);
+
+    for (i = 0; i < npatterns; ++i)
+        regex_destroy(&regex[i]);
+    clock_destroy(&clock);
+    arrst_destroy(&matches, NULL, uint32_t);
+    regex_set_destroy(&set);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_bench_search(const ArrPt(String) *names)
+{
+    RegEx *regex = regex_create("/api/v[0-9]*/items/[0-9]*");
+    Clock *clock = clock_create(0.);
+    uint32_t hits = 0, bytes = 0;
+    real64_t t;
+    arrpt_foreach_const(name, names, String)
+        uint32_t start, end;
+        if (regex_search(regex, tc(name), &start, &end) == TRUE)
+        {
+            hits += 1;
+            bytes += end - start;
+        }
+    arrpt_end()
+    t = clock_elapsed(clock);
+    bstd_printf("- Search '/api/v[0-9]*/items/[0-9]*': %u matches (%u bytes), %.3fs (%.1f Mstr/s)\n", hits, bytes, t, (real64_t)arrpt_size(names, String) / t / 1e6);
+    clock_destroy(&clock);
+    regex_destroy(&regex);
+}
+
+/*---------------------------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    static const char_t *i_PATTERNS[] = {
+        "000_OCR_OK_01_.*\\.png",
+        ".*_OCR_OK_.*\\.[(png)(jpg)]",
+        "server_[0-9]*_.*\\.log",
+        ".*request /api/v[12]/items/.* took [0-9]* ms",
+        ".*[(error)(warning)].*"};
+    uint32_t n = 1000000;
+    uint32_t i;
+    ArrPt(String) *names = NULL;
+    bool_t err;
+
+    core_start();
+
+    if (argc == 2)
+    {
+        n = str_to_u32(argv[1], 10, &err);
+        if (err == TRUE)
+        {
+            bstd_printf("Use: regexbench [number of strings].\n");
+            core_finish();
+            return 0;
+        }
+    }
+
+    bstd_printf("NAppGUI regular expressions.\n");
+    if (i_check() == FALSE)
+    {
+        core_finish();
+        return 1;
+    }
+
+    names = i_filenames(n);
+    bstd_printf("- %u strings (filenames and log lines)\n", n);
+
+    for (i = 0; i < sizeof(i_PATTERNS) / sizeof(i_PATTERNS[0]); ++i)
+    {
+        RegEx *regex = regex_create(i_PATTERNS[i]);
+        uint32_t hnfa, hdfa;
+        real64_t tnfa, tdfa;
+        cassert_no_null(regex);
+        tnfa = i_bench(regex, names, regex_match_nfa, &hnfa);
+        tdfa = i_bench(regex, names, regex_match, &hdfa);
+        cassert_unref(hnfa == hdfa, hnfa);
+        bstd_printf("- '%s': %u matches, NFA %.3fs (%.1f Mstr/s), DFA %.3fs (%.1f Mstr/s), x%.1f\n", i_PATTERNS[i], hdfa, tnfa, (real64_t)n / tnfa / 1e6, tdfa, (real64_t)n / tdfa / 1e6, tnfa / tdfa);
+        regex_destroy(&regex);
+    }
+
+    i_bench_set(i_PATTERNS, sizeof32(i_PATTERNS) / sizeof32(i_PATTERNS[0]), names);
+    i_bench_search(names);
+    arrpt_destroy(&names, str_destroy, String);
+    core_finish();
+    return 0;
+}
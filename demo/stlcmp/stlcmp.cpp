@@ -5,9 +5,12 @@
 #include <core/arrpt.hpp>
 #include <core/setst.hpp>
 #include <core/setpt.hpp>
+#include <core/hashst.hpp>
+#include <core/hashpt.hpp>
 #include <sewer/nowarn.hxx>
 #include <vector>
 #include <set>
+#include <unordered_map>
 #include <algorithm>
 #include <stdlib.h>
 #include <sewer/warn.hxx>
@@ -96,10 +99,15 @@ int main(int argc, char *argv[])
     ArrPt(Product) *arrpt;
     SetSt(Product) *setst;
     SetPt(Product) *setpt;
+    HashSt(Product) *hashst;
+    HashPt(Product) *hashpt;
     vector< Product > stl_arrst;
     vector< Product * > stl_arrpt;
     set< Product, i_stl_compare > stl_setst;
     set< Product *, i_stl_compare > stl_setpt;
+    unordered_map< uint32_t, Product > stl_hashst;
+    unordered_map< uint32_t, Product * > stl_hashpt;
+    uint32_t found;
     Clock *clock;
     real64_t t;
 
@@ -142,6 +150,8 @@ int main(int argc, char *argv[])
     arrpt = arrpt_create(Product);
     setst = setst_create(i_compare_key, Product, uint32_t);
     setpt = setpt_create(i_compare_key, Product, uint32_t);
+    hashst = hashst_create(NULL, i_compare_key, Product, uint32_t);
+    hashpt = hashpt_create(NULL, i_compare_key, Product, uint32_t);
 
     clock = clock_create(0.);
     bstd_printf("- Created %u elements of %u bytes\n", n, sizeof32(Product));
@@ -213,6 +223,87 @@ int main(int argc, char *argv[])
     t = clock_elapsed(clock);
     bstd_printf("- Add to set<Product*>: %.6f\n", t);
 
+    // NAppGUI struct hash table
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        Product *product = hashst_insert(hashst, &products[i].id, Product, uint32_t);
+        *product = products[i];
+    }
+    t = clock_elapsed(clock);
+    bstd_printf("- Add to HashSt(Product): %.6f\n", t);
+
+    // STL struct hash table
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        stl_hashst.insert(make_pair(products[i].id, products[i]));
+    t = clock_elapsed(clock);
+    bstd_printf("- Add to unordered_map<uint32_t, Product>: %.6f\n", t);
+
+    // NAppGUI pointer hash table
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        hashpt_insert(hashpt, &pproducts[i]->id, pproducts[i], Product, uint32_t);
+    t = clock_elapsed(clock);
+    bstd_printf("- Add to HashPt(Product): %.6f\n", t);
+
+    // STL pointer hash table
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        stl_hashpt.insert(make_pair(pproducts[i]->id, pproducts[i]));
+    t = clock_elapsed(clock);
+    bstd_printf("- Add to unordered_map<uint32_t, Product*>: %.6f\n", t);
+
+    // Key lookups (in random order)
+    found = 0;
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        found += setst_get(setst, &ids[i], Product, uint32_t) != NULL ? 1 : 0;
+    t = clock_elapsed(clock);
+    bstd_printf("- Find in SetSt(Product): %.6f (%u)\n", t, found);
+
+    found = 0;
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        found += stl_setst.find(products[i]) != stl_setst.end() ? 1 : 0;
+    t = clock_elapsed(clock);
+    bstd_printf("- Find in set<Product>: %.6f (%u)\n", t, found);
+
+    found = 0;
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        found += hashst_get(hashst, &ids[i], Product, uint32_t) != NULL ? 1 : 0;
+    t = clock_elapsed(clock);
+    bstd_printf("- Find in HashSt(Product): %.6f (%u)\n", t, found);
+
+    found = 0;
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        found += stl_hashst.find(ids[i]) != stl_hashst.end() ? 1 : 0;
+    t = clock_elapsed(clock);
+    bstd_printf("- Find in unordered_map<uint32_t, Product>: %.6f (%u)\n", t, found);
+
+    found = 0;
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        found += setpt_get(setpt, &ids[i], Product, uint32_t) != NULL ? 1 : 0;
+    t = clock_elapsed(clock);
+    bstd_printf("- Find in SetPt(Product): %.6f (%u)\n", t, found);
+
+    found = 0;
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        found += hashpt_get(hashpt, &ids[i], Product, uint32_t) != NULL ? 1 : 0;
+    t = clock_elapsed(clock);
+    bstd_printf("- Find in HashPt(Product): %.6f (%u)\n", t, found);
+
+    found = 0;
+    clock_reset(clock);
+    for (uint32_t i = 0; i < n; ++i)
+        found += stl_hashpt.find(ids[i]) != stl_hashpt.end() ? 1 : 0;
+    t = clock_elapsed(clock);
+    bstd_printf("- Find in unordered_map<uint32_t, Product*>: %.6f (%u)\n", t, found);
+
     // Verify the sorting correctness
     clock_reset(clock);
     arrst_foreach(product, arrst, Product)
@@ -284,11 +375,45 @@ int main(int argc, char *argv[])
     t = clock_elapsed(clock);
     bstd_printf("- Loop set<Product*>: %.6f\n", t);
 
+    // NAppGUI bulk-build from sorted arrays
+    clock_reset(clock);
+    SetSt(Product) *sorted_setst = setst_from_sorted(i_compare_key, arrst_all_const(arrst, Product), arrst_size(arrst, Product), Product, uint32_t);
+    t = clock_elapsed(clock);
+    bstd_printf("- Build SetSt(Product) from sorted: %.6f\n", t);
+
+    clock_reset(clock);
+    SetPt(Product) *sorted_setpt = setpt_from_sorted(i_compare_key, arrpt_all(arrpt, Product), arrpt_size(arrpt, Product), Product, uint32_t);
+    t = clock_elapsed(clock);
+    bstd_printf("- Build SetPt(Product) from sorted: %.6f\n", t);
+
+    // Destroy the sets
+    clock_reset(clock);
+    setst_destroy(&setst, NULL, Product);
+    setst_destroy(&sorted_setst, NULL, Product);
+    t = clock_elapsed(clock);
+    bstd_printf("- Destroy 2 x SetSt(Product): %.6f\n", t);
+
+    clock_reset(clock);
+    stl_setst.clear();
+    t = clock_elapsed(clock);
+    bstd_printf("- Destroy set<Product>: %.6f\n", t);
+
+    clock_reset(clock);
+    setpt_destroy(&setpt, NULL, Product);
+    setpt_destroy(&sorted_setpt, NULL, Product);
+    t = clock_elapsed(clock);
+    bstd_printf("- Destroy 2 x SetPt(Product): %.6f\n", t);
+
+    clock_reset(clock);
+    stl_setpt.clear();
+    t = clock_elapsed(clock);
+    bstd_printf("- Destroy set<Product*>: %.6f\n", t);
+
     clock_destroy(&clock);
     arrst_destroy(&arrst, NULL, Product);
     arrpt_destroy(&arrpt, NULL, Product);
-    setst_destroy(&setst, NULL, Product);
-    setpt_destroy(&setpt, NULL, Product);
+    hashst_destroy(&hashst, NULL, Product);
+    hashpt_destroy(&hashpt, NULL, Product);
 
     for (uint32_t i = 0; i < n; ++i)
         heap_delete(&pproducts[i], Product);
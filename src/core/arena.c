@@ -0,0 +1,353 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: arena.c
+ *
+ */
+
+/* Arena allocator for bulk-lifetime objects */
+
+#include "arena.h"
+#include "arena.inl"
+#include "heap.h"
+#include "heap.inl"
+#include "strings.h"
+#include <sewer/bmem.h>
+#include <sewer/cassert.h>
+
+typedef struct i_block_t i_Block;
+typedef struct i_object_t i_Object;
+
+struct i_block_t
+{
+    i_Block *next;
+    uint32_t size;
+    uint32_t offset;
+};
+
+/* Live objects of a type, allocated inside an arena scope */
+struct i_object_t
+{
+    char_t name[64];
+    uint32_t num;
+    uint64_t bytes;
+};
+
+struct _arena_t
+{
+    uint32_t block_size;
+    uint32_t used;
+    i_Block *first;
+    i_Block *current;
+    i_Block *large;
+    Arena **scopes;
+    uint32_t scope;
+    uint32_t scopes_alloc;
+    uint32_t num_objects;
+    uint64_t obj_bytes;
+#if defined(__MEMORY_AUDITOR__)
+    i_Object *objects;
+    uint32_t objects_size;
+    uint32_t objects_alloc;
+#endif
+};
+
+#define i_DEFAULT_BLOCK_SIZE 65536
+#define i_SCOPES_GROW_SIZE 8
+#define i_OBJECTS_GROW_SIZE 16
+
+/*---------------------------------------------------------------------------*/
+
+static i_Block *i_new_block(const uint32_t size)
+{
+    /* Blocks are never allocated inside the arena scope */
+    Arena *scope = _heap_arena(NULL);
+    i_Block *block = cast(heap_malloc(size, "ArenaBlock"), i_Block);
+    _heap_arena(scope);
+    block->next = NULL;
+    block->size = size;
+    block->offset = sizeof32(i_Block);
+    return block;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_free_blocks(i_Block **block)
+{
+    cassert_no_null(block);
+    while (*block != NULL)
+    {
+        i_Block *next = (*block)->next;
+        uint32_t size = (*block)->size;
+        heap_free(dcast(block, byte_t), size, "ArenaBlock");
+        *block = next;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Objects allocated in a scope (and not freed) are accounted in the heap
+ * statistics until the arena memory is released.
+ */
+static void i_release_objects(Arena *arena)
+{
+    cassert_no_null(arena);
+#if defined(__MEMORY_AUDITOR__)
+    {
+        uint32_t i;
+        for (i = 0; i < arena->objects_size; ++i)
+        {
+            if (arena->objects[i].num > 0)
+                _heap_arena_free(arena->objects[i].name, arena->objects[i].num, arena->objects[i].bytes);
+        }
+        arena->objects_size = 0;
+    }
+#else
+    if (arena->num_objects > 0)
+        _heap_arena_free(NULL, arena->num_objects, arena->obj_bytes);
+#endif
+    arena->num_objects = 0;
+    arena->obj_bytes = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+Arena *arena_create(const uint32_t block_size)
+{
+    Arena *scope = _heap_arena(NULL);
+    Arena *arena = heap_new0(Arena);
+    _heap_arena(scope);
+    arena->block_size = block_size > 0 ? block_size : i_DEFAULT_BLOCK_SIZE;
+    if (arena->block_size < 1024)
+        arena->block_size = 1024;
+    arena->first = i_new_block(arena->block_size);
+    arena->current = arena->first;
+    return arena;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void arena_destroy(Arena **arena)
+{
+    cassert_no_null(arena);
+    cassert_no_null(*arena);
+    cassert_msg((*arena)->scope == 0, "Destroying an arena with an open scope.");
+    i_release_objects(*arena);
+    i_free_blocks(&(*arena)->first);
+    i_free_blocks(&(*arena)->large);
+    if ((*arena)->scopes != NULL)
+        heap_delete_n(&(*arena)->scopes, (*arena)->scopes_alloc, Arena *);
+#if defined(__MEMORY_AUDITOR__)
+    if ((*arena)->objects != NULL)
+        bmem_free(cast((*arena)->objects, byte_t));
+#endif
+    heap_delete(arena, Arena);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void arena_reset(Arena *arena)
+{
+    cassert_no_null(arena);
+    i_release_objects(arena);
+    i_free_blocks(&arena->large);
+    /* The rest of blocks will be rewinded when reached */
+    arena->current = arena->first;
+    arena->current->offset = sizeof32(i_Block);
+    arena->used = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Aligns the real address, not the offset (blocks are only pointer-aligned) */
+static ___INLINE uint32_t i_align(const i_Block *block, const uint32_t offset, const uint32_t align)
+{
+    uint32_t mod = (uint32_t)(((uintptr_t)block + offset) % align);
+    return mod > 0 ? offset + align - mod : offset;
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *arena_alloc(Arena *arena, const uint32_t size, const uint32_t align)
+{
+    i_Block *block = NULL;
+    uint32_t offset = 0;
+    cassert_no_null(arena);
+    cassert(size > 0);
+    cassert(align > 0 && (align & (align - 1)) == 0);
+
+    /* Big objects in their own block (freed in arena_reset) */
+    if (size + align + sizeof32(i_Block) > arena->block_size / 2)
+    {
+        block = i_new_block(size + align + sizeof32(i_Block));
+        block->next = arena->large;
+        arena->large = block;
+    }
+    else
+    {
+        block = arena->current;
+        offset = i_align(block, block->offset, align);
+        if (offset + size > block->size)
+        {
+            /* Reuse the next block (after a reset) or chain a new one */
+            if (block->next == NULL)
+                block->next = i_new_block(arena->block_size);
+
+            block = block->next;
+            block->offset = sizeof32(i_Block);
+            arena->current = block;
+        }
+    }
+
+    offset = i_align(block, block->offset, align);
+    cassert(offset + size <= block->size);
+    block->offset = offset + size;
+    arena->used += size;
+    return cast(block, byte_t) + offset;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t arena_mem(const Arena *arena)
+{
+    cassert_no_null(arena);
+    return arena->used;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void arena_scope_begin(Arena *arena)
+{
+    Arena *scope = NULL;
+    cassert_no_null(arena);
+    /* Stack of previous scopes, to allow nested begin/end over any arena */
+    if (arena->scope == arena->scopes_alloc)
+    {
+        scope = _heap_arena(NULL);
+        if (arena->scopes == NULL)
+            arena->scopes = heap_new_n(i_SCOPES_GROW_SIZE, Arena *);
+        else
+            arena->scopes = heap_realloc_n(arena->scopes, arena->scopes_alloc, arena->scopes_alloc + i_SCOPES_GROW_SIZE, Arena *);
+        arena->scopes_alloc += i_SCOPES_GROW_SIZE;
+        _heap_arena(scope);
+    }
+
+    arena->scopes[arena->scope] = _heap_arena(arena);
+    arena->scope += 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void arena_scope_end(Arena *arena)
+{
+    Arena *current = NULL;
+    cassert_no_null(arena);
+    cassert(arena->scope > 0);
+    arena->scope -= 1;
+    current = _heap_arena(arena->scopes[arena->scope]);
+    cassert_unref(current == arena, current);
+    arena->scopes[arena->scope] = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+#if defined(__MEMORY_AUDITOR__)
+
+static i_Object *i_object(Arena *arena, const char_t *name)
+{
+    uint32_t i;
+    cassert_no_null(arena);
+    for (i = 0; i < arena->objects_size; ++i)
+    {
+        if (str_cmp_cn(arena->objects[i].name, name, sizeof(arena->objects[i].name)) == 0)
+            return arena->objects + i;
+    }
+
+    if (arena->objects == NULL)
+    {
+        arena->objects = cast(bmem_malloc(i_OBJECTS_GROW_SIZE * sizeof32(i_Object)), i_Object);
+        arena->objects_alloc = i_OBJECTS_GROW_SIZE;
+    }
+    else if (arena->objects_size == arena->objects_alloc)
+    {
+        arena->objects = cast(bmem_realloc(cast(arena->objects, byte_t), arena->objects_alloc * sizeof32(i_Object), (arena->objects_alloc + i_OBJECTS_GROW_SIZE) * sizeof32(i_Object)), i_Object);
+        arena->objects_alloc += i_OBJECTS_GROW_SIZE;
+    }
+
+    bmem_zero(arena->objects + arena->objects_size, i_Object);
+    str_copy_c(arena->objects[arena->objects_size].name, sizeof32(arena->objects[arena->objects_size].name), name);
+    arena->objects_size += 1;
+    return arena->objects + arena->objects_size - 1;
+}
+
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+void _arena_obj_alloc(Arena *arena, const char_t *name, const uint32_t size)
+{
+    cassert_no_null(arena);
+#if defined(__MEMORY_AUDITOR__)
+    {
+        i_Object *object = i_object(arena, name);
+        object->num += 1;
+        object->bytes += size;
+    }
+#else
+    unref(name);
+#endif
+    arena->num_objects += 1;
+    arena->obj_bytes += size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _arena_obj_free(Arena *arena, const char_t *name, const uint32_t size)
+{
+    cassert_no_null(arena);
+#if defined(__MEMORY_AUDITOR__)
+    {
+        i_Object *object = i_object(arena, name);
+        cassert(object->num > 0 && object->bytes >= size);
+        object->num -= 1;
+        object->bytes -= size;
+    }
+#else
+    unref(name);
+#endif
+    cassert(arena->num_objects > 0 && arena->obj_bytes >= size);
+    arena->num_objects -= 1;
+    arena->obj_bytes -= size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *_arena_realloc(Arena *arena, byte_t *mem, const uint32_t size, const uint32_t new_size, const uint32_t align)
+{
+    i_Block *block = NULL;
+    cassert_no_null(arena);
+    cassert_no_null(mem);
+    block = arena->current;
+
+    /* Last object of the current block: grow or shrink in place */
+    if (mem + size == cast(block, byte_t) + block->offset && mem + new_size <= cast(block, byte_t) + block->size)
+    {
+        block->offset = (uint32_t)(mem - cast(block, byte_t)) + new_size;
+        arena->used = arena->used - size + new_size;
+        return mem;
+    }
+    else if (new_size <= size)
+    {
+        return mem;
+    }
+    else
+    {
+        byte_t *new_mem = arena_alloc(arena, new_size, align);
+        bmem_copy(new_mem, mem, size);
+        return new_mem;
+    }
+}
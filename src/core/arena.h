@@ -0,0 +1,38 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: arena.h
+ * https://nappgui.com/en/core/arena.html
+ *
+ */
+
+/* Arena allocator for bulk-lifetime objects */
+
+#include "core.hxx"
+
+__EXTERN_C
+
+_core_api Arena *arena_create(const uint32_t block_size);
+
+_core_api void arena_destroy(Arena **arena);
+
+_core_api void arena_reset(Arena *arena);
+
+_core_api byte_t *arena_alloc(Arena *arena, const uint32_t size, const uint32_t align);
+
+_core_api uint32_t arena_mem(const Arena *arena);
+
+_core_api void arena_scope_begin(Arena *arena);
+
+_core_api void arena_scope_end(Arena *arena);
+
+__END_C
+
+#define arena_new(arena, type) \
+    cast(arena_alloc(arena, (uint32_t)sizeof(type), sizeof32(void *)), type)
+
+#define arena_new_n(arena, n, type) \
+    cast(arena_alloc(arena, ((uint32_t)sizeof(type) * (uint32_t)(n)), sizeof32(void *)), type)
@@ -0,0 +1,23 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: arena.inl
+ *
+ */
+
+/* Arena allocator for bulk-lifetime objects */
+
+#include "core.hxx"
+
+__EXTERN_C
+
+byte_t *_arena_realloc(Arena *arena, byte_t *mem, const uint32_t size, const uint32_t new_size, const uint32_t align);
+
+void _arena_obj_alloc(Arena *arena, const char_t *name, const uint32_t size);
+
+void _arena_obj_free(Arena *arena, const char_t *name, const uint32_t size);
+
+__END_C
@@ -10,9 +10,12 @@
 
 /* Array data structure */
 
+#include "arena.h"
 #include "heap.h"
 #include "stream.h"
 #include "strings.h"
+#include "tpool.h"
+#include <osbs/bmutex.h>
 #include <sewer/blib.h>
 #include <sewer/bmem.h>
 #include <sewer/cassert.h>
@@ -30,6 +33,9 @@ struct _array_t
 
 #define i_MINIMUN_ARRAY_SIZE 8
 
+/* Arrays data can exceed 4GB, even if the number of elements is 32-bit */
+#define i_BYTES(n, esize) ((uint64_t)(n) * (uint64_t)(esize))
+
 /*---------------------------------------------------------------------------*/
 
 static Array *i_create_array(
@@ -53,7 +59,7 @@ static void i_destroy(Array **array, const char_t *type)
 {
     cassert_no_null(array);
     cassert_no_null(*array);
-    heap_free(&(*array)->data, (*array)->nallocs * (*array)->esize, "ArrayData");
+    heap_free64(&(*array)->data, i_BYTES((*array)->nallocs, (*array)->esize), "ArrayData");
     heap_free(dcast(array, byte_t), sizeof(Array), type);
 }
 
@@ -62,6 +68,9 @@ static void i_destroy(Array **array, const char_t *type)
 static uint32_t i_next_pow2(const uint32_t value)
 {
     uint32_t v = value;
+    /* Next power of 2 doesn't fit in 32 bits */
+    if (v > 0x80000000)
+        return UINT32_MAX;
     v--;
     v |= v >> 1;
     v |= v >> 2;
@@ -84,7 +93,7 @@ static Array *i_create_init_array(const uint32_t elems, const uint16_t esize, co
     if (nallocs < i_MINIMUN_ARRAY_SIZE)
         nallocs = i_MINIMUN_ARRAY_SIZE;
 
-    data = heap_malloc(nallocs * esize, "ArrayData");
+    data = heap_malloc64(i_BYTES(nallocs, esize), "ArrayData");
     return i_create_array(nallocs, elems, esize, &data, type);
 }
 
@@ -97,12 +106,24 @@ Array *array_create(const uint16_t esize, const char_t *type)
 
 /*---------------------------------------------------------------------------*/
 
+Array *array_arena(Arena *arena, const uint16_t esize, const char_t *type)
+{
+    /* Later reallocs of 'data' will remain in the arena */
+    Array *array = NULL;
+    arena_scope_begin(arena);
+    array = i_create_init_array(0, esize, type);
+    arena_scope_end(arena);
+    return array;
+}
+
+/*---------------------------------------------------------------------------*/
+
 Array *array_copy(const Array *array, FPtr_scopy func_copy, const char_t *type)
 {
     byte_t *data = NULL;
 
     cassert_no_null(array);
-    data = heap_malloc(array->nallocs * array->esize, "ArrayData");
+    data = heap_malloc64(i_BYTES(array->nallocs, array->esize), "ArrayData");
 
     if (func_copy != NULL)
     {
@@ -114,7 +135,7 @@ Array *array_copy(const Array *array, FPtr_scopy func_copy, const char_t *type)
     }
     else
     {
-        bmem_copy(data, array->data, array->elems * array->esize);
+        bmem_copy(data, array->data, i_BYTES(array->elems, array->esize));
     }
 
     return i_create_array(array->nallocs, array->elems, array->esize, &data, type);
@@ -128,19 +149,19 @@ Array *array_copy_ptr(const Array *array, FPtr_copy func_copy, const char_t *typ
     cassert_no_null(array);
     cassert_no_nullf(func_copy);
     cassert(array->esize == sizeofptr);
-    data = heap_malloc(array->nallocs * array->esize, "ArrayData");
+    data = heap_malloc64(i_BYTES(array->nallocs, array->esize), "ArrayData");
     if (func_copy != NULL)
     {
         uint32_t i;
         for (i = 0; i < array->elems; ++i)
         {
-            void *elem = func_copy(*dcast(array->data + i * array->esize, void));
-            *dcast(data + i * array->esize, void) = elem;
+            void *elem = func_copy(*dcast(array->data + i_BYTES(i, array->esize), void));
+            *dcast(data + i_BYTES(i, array->esize), void) = elem;
         }
     }
     else
     {
-        bmem_copy(data, array->data, array->elems * array->esize);
+        bmem_copy(data, array->data, i_BYTES(array->elems, array->esize));
     }
 
     return i_create_array(array->nallocs, array->elems, array->esize, &data, type);
@@ -164,7 +185,7 @@ static Array *i_read_array(Stream *stream, const uint16_t esize, FPtr_read func_
             void *elem = NULL;
             if (nonull == TRUE)
                 elem = func_read(stream);
-            *dcast(array->data + i * esize, void) = elem;
+            *dcast(array->data + i_BYTES(i, esize), void) = elem;
         }
     }
     else
@@ -172,7 +193,7 @@ static Array *i_read_array(Stream *stream, const uint16_t esize, FPtr_read func_
         uint32_t i;
         cassert_no_nullf(func_read_init);
         for (i = 0; i < elems; ++i)
-            func_read_init(stream, cast(array->data + i * esize, void));
+            func_read_init(stream, cast(array->data + i_BYTES(i, esize), void));
     }
 
     return array;
@@ -196,7 +217,7 @@ static Array *i_read_array_ex(Stream *stream, const uint16_t esize, FPtr_read_ex
             void *elem = NULL;
             if (nonull == TRUE)
                 elem = func_read(stream, data);
-            *dcast(array->data + i * esize, void) = elem;
+            *dcast(array->data + i_BYTES(i, esize), void) = elem;
         }
     }
     else
@@ -204,7 +225,7 @@ static Array *i_read_array_ex(Stream *stream, const uint16_t esize, FPtr_read_ex
         uint32_t i;
         cassert_no_nullf(func_read_init);
         for (i = 0; i < elems; ++i)
-            func_read_init(stream, cast(array->data + i * esize, void), data);
+            func_read_init(stream, cast(array->data + i_BYTES(i, esize), void), data);
     }
 
     return array;
@@ -314,9 +335,9 @@ static void i_clear(Array *array)
     cassert_no_null(array);
     if (array->nallocs != i_MINIMUN_ARRAY_SIZE)
     {
-        uint32_t n_free_bytes = array->nallocs * array->esize;
-        uint32_t n_alloc_bytes = i_MINIMUN_ARRAY_SIZE * array->esize;
-        array->data = heap_realloc(array->data, n_free_bytes, n_alloc_bytes, "ArrayData");
+        uint64_t n_free_bytes = i_BYTES(array->nallocs, array->esize);
+        uint64_t n_alloc_bytes = i_BYTES(i_MINIMUN_ARRAY_SIZE, array->esize);
+        array->data = heap_realloc64(array->data, n_free_bytes, n_alloc_bytes, "ArrayData");
         array->nallocs = i_MINIMUN_ARRAY_SIZE;
     }
 
@@ -459,6 +480,7 @@ static void i_grow_array(
     cassert_no_null(elems);
     cassert_no_null(data);
     cassert(*nallocs >= *elems);
+    cassert(*elems <= UINT32_MAX - elems_grown);
     *elems += elems_grown;
     num_new_allocs = i_next_pow2(*elems);
     if (num_new_allocs < i_MINIMUN_ARRAY_SIZE)
@@ -466,10 +488,10 @@ static void i_grow_array(
 
     if (num_new_allocs > *nallocs)
     {
-        uint32_t n_free_bytes = *nallocs * esize;
-        uint32_t n_alloc_bytes = num_new_allocs * esize;
+        uint64_t n_free_bytes = i_BYTES(*nallocs, esize);
+        uint64_t n_alloc_bytes = i_BYTES(num_new_allocs, esize);
         cassert(n_free_bytes < n_alloc_bytes);
-        *data = heap_realloc(*data, n_free_bytes, n_alloc_bytes, "ArrayData");
+        *data = heap_realloc64(*data, n_free_bytes, n_alloc_bytes, "ArrayData");
         *nallocs = num_new_allocs;
     }
 }
@@ -496,10 +518,10 @@ static void i_shrink_array(
 
     if (num_new_allocs < *nallocs)
     {
-        uint32_t n_free_bytes = *nallocs * esize;
-        uint32_t n_alloc_bytes = num_new_allocs * esize;
+        uint64_t n_free_bytes = i_BYTES(*nallocs, esize);
+        uint64_t n_alloc_bytes = i_BYTES(num_new_allocs, esize);
         cassert(n_free_bytes > n_alloc_bytes);
-        *data = heap_realloc(*data, n_free_bytes, n_alloc_bytes, "ArrayData");
+        *data = heap_realloc64(*data, n_free_bytes, n_alloc_bytes, "ArrayData");
         *nallocs = num_new_allocs;
     }
 }
@@ -510,7 +532,7 @@ byte_t *array_get(const Array *array, const uint32_t pos)
 {
     cassert_no_null(array);
     cassert_msg(pos < array->elems, "Array invalid index");
-    return array->data + pos * array->esize;
+    return array->data + i_BYTES(pos, array->esize);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -519,7 +541,7 @@ byte_t *array_get_last(const Array *array)
 {
     cassert_no_null(array);
     cassert(array->elems > 0);
-    return array->data + (array->elems - 1) * array->esize;
+    return array->data + i_BYTES(array->elems - 1, array->esize);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -544,9 +566,9 @@ byte_t *array_insert(Array *array, const uint32_t pos, const uint32_t n)
     i_grow_array(&array->nallocs, &array->elems, &array->data, array->esize, n);
 
     if (cpos < celem)
-        bmem_move(array->data + (cpos + n) * array->esize, array->data + cpos * array->esize, (celem - cpos) * array->esize);
+        bmem_move(array->data + i_BYTES(cpos + n, array->esize), array->data + i_BYTES(cpos, array->esize), i_BYTES(celem - cpos, array->esize));
 
-    return array->data + cpos * array->esize;
+    return array->data + i_BYTES(cpos, array->esize);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -554,7 +576,7 @@ byte_t *array_insert(Array *array, const uint32_t pos, const uint32_t n)
 byte_t *array_insert0(Array *array, const uint32_t pos, const uint32_t n)
 {
     byte_t *data = array_insert(array, pos, n);
-    bmem_set_zero(data, n * array->esize);
+    bmem_set_zero(data, i_BYTES(n, array->esize));
     return data;
 }
 
@@ -574,7 +596,7 @@ void array_join(Array *dest, const Array *src, FPtr_scopy func_copy)
 
         i_grow_array(&dest->nallocs, &dest->elems, &dest->data, dest->esize, src->elems);
         cassert(dest->elems == celem + src->elems);
-        bdest = dest->data + (celem * dest->esize);
+        bdest = dest->data + i_BYTES(celem, dest->esize);
 
         if (func_copy != NULL)
         {
@@ -584,7 +606,7 @@ void array_join(Array *dest, const Array *src, FPtr_scopy func_copy)
         }
         else
         {
-            bmem_copy(bdest, bsrc, src->elems * src->esize);
+            bmem_copy(bdest, bsrc, i_BYTES(src->elems, src->esize));
         }
     }
 }
@@ -605,7 +627,7 @@ void array_join_ptr(Array *dest, const Array *src, FPtr_copy func_copy)
 
         i_grow_array(&dest->nallocs, &dest->elems, &dest->data, dest->esize, src->elems);
         cassert(dest->elems == celem + src->elems);
-        bdest = dest->data + (celem * dest->esize);
+        bdest = dest->data + i_BYTES(celem, dest->esize);
 
         if (func_copy != NULL)
         {
@@ -618,7 +640,7 @@ void array_join_ptr(Array *dest, const Array *src, FPtr_copy func_copy)
         }
         else
         {
-            bmem_copy(bdest, bsrc, src->elems * src->esize);
+            bmem_copy(bdest, bsrc, i_BYTES(src->elems, src->esize));
         }
     }
 }
@@ -635,7 +657,7 @@ static void i_delete_elems(uint32_t *nallocs, uint32_t *elems, byte_t **data, co
     if (pos + num_deletes < *elems)
     {
         uint32_t elems_moved = *elems - (pos + num_deletes);
-        bmem_move(PARAM(dest, *data + pos * esize), PARAM(src, *data + (pos + num_deletes) * esize), PARAM(num_bytes, elems_moved * esize));
+        bmem_move(PARAM(dest, *data + i_BYTES(pos, esize)), PARAM(src, *data + i_BYTES(pos + num_deletes, esize)), PARAM(num_bytes, i_BYTES(elems_moved, esize)));
     }
 
     i_shrink_array(nallocs, elems, data, esize, num_deletes);
@@ -650,7 +672,7 @@ void array_delete(Array *array, const uint32_t pos, const uint32_t n, FPtr_remov
     cassert(pos + n <= array->elems);
     if (func_remove != NULL)
     {
-        byte_t *data = array->data + pos * array->esize;
+        byte_t *data = array->data + i_BYTES(pos, array->esize);
         uint32_t i;
         for (i = 0; i < n; ++i)
         {
@@ -672,7 +694,7 @@ void array_delete_ptr(Array *array, const uint32_t pos, const uint32_t n, FPtr_d
     cassert(array->esize == sizeofptr);
     if (func_destroy != NULL)
     {
-        byte_t *data = array->data + pos * array->esize;
+        byte_t *data = array->data + i_BYTES(pos, array->esize);
         uint32_t i;
         for (i = 0; i < n; ++i)
         {
@@ -695,7 +717,7 @@ void array_pop(Array *array, FPtr_remove func_remove)
     cassert(array->elems > 0);
     if (func_remove != NULL)
     {
-        byte_t *data = array->data + (array->elems - 1) * array->esize;
+        byte_t *data = array->data + i_BYTES(array->elems - 1, array->esize);
         func_remove(data);
     }
 
@@ -711,7 +733,7 @@ void array_pop_ptr(Array *array, FPtr_destroy func_destroy)
     cassert(array->esize == sizeofptr);
     if (func_destroy != NULL)
     {
-        byte_t *data = array->data + (array->elems - 1) * array->esize;
+        byte_t *data = array->data + i_BYTES(array->elems - 1, array->esize);
         void **ldata = dcast(data, void);
         cassert_no_null(ldata);
         if (*ldata != NULL)
@@ -739,48 +761,759 @@ void array_sort_ex(Array *array, FPtr_compare_ex func_compare, void *data)
 
 /*---------------------------------------------------------------------------*/
 
-typedef struct i_compare_dptr
+void array_sort_ptr(Array *array, FPtr_compare func_compare)
+{
+    cassert_no_null(array);
+    cassert(array->esize == sizeofptr);
+    blib_qsort_ptr(dcast_const(array->data, void), array->elems, func_compare);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_sort_ptr_ex(Array *array, FPtr_compare_ex func_compare, void *data)
+{
+    cassert_no_null(array);
+    cassert(array->esize == sizeofptr);
+    blib_qsort_ptr_ex(dcast_const(array->data, void), array->elems, func_compare, cast_const(data, byte_t));
+}
+
+/*---------------------------------------------------------------------------*/
+
+typedef struct i_compare_t
 {
     FPtr_compare func_compare;
     FPtr_compare_ex func_compare_ex;
-    void *data;
-} i_CompareDPtr;
+    const byte_t *data;
+    bool_t deref;
+} i_Compare;
+
+/* Stable sort: insertion sort runs of this size, then merge passes */
+#define i_STABLE_RUN 32
 
 /*---------------------------------------------------------------------------*/
 
-static int i_compare_ptr(const void **elem1, const void **elem2, i_CompareDPtr *cmp)
+static ___INLINE int i_compare(const i_Compare *cmp, const byte_t *elem1, const byte_t *elem2)
 {
-    cassert_no_null(elem1);
-    cassert_no_null(elem2);
-    cassert_no_null(cmp);
+    if (cmp->deref == TRUE)
+    {
+        elem1 = *dcast_const(elem1, byte_t);
+        elem2 = *dcast_const(elem2, byte_t);
+    }
+
     if (cmp->func_compare != NULL)
-        return cmp->func_compare(*elem1, *elem2);
+        return cmp->func_compare(elem1, elem2);
     else
-        return cmp->func_compare_ex(*elem1, *elem2, cmp->data);
+        return cmp->func_compare_ex(elem1, elem2, cmp->data);
 }
 
 /*---------------------------------------------------------------------------*/
 
-void array_sort_ptr(Array *array, FPtr_compare func_compare)
+/* Most elements are whole 32-bit words, avoiding a memcpy call per element */
+static ___INLINE void i_copy_elem(byte_t *dest, const byte_t *src, const uint32_t esize)
+{
+    if ((esize & 3) == 0)
+    {
+        uint32_t *d = cast(dest, uint32_t);
+        const uint32_t *s = cast_const(src, uint32_t);
+        uint32_t i, n = esize / 4;
+        for (i = 0; i < n; ++i)
+            d[i] = s[i];
+    }
+    else
+    {
+        bmem_copy(dest, src, esize);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Merge two sorted sequences into 'dest'. Ties are taken from 'a' */
+static void i_merge(const i_Compare *cmp, const byte_t *a, const uint32_t m, const byte_t *b, const uint32_t l, byte_t *dest, const uint16_t esize)
+{
+    const byte_t *a_end = a + i_BYTES(m, esize);
+    const byte_t *b_end = b + i_BYTES(l, esize);
+
+    while (a < a_end && b < b_end)
+    {
+        if (i_compare(cmp, a, b) <= 0)
+        {
+            i_copy_elem(dest, a, esize);
+            a += esize;
+        }
+        else
+        {
+            i_copy_elem(dest, b, esize);
+            b += esize;
+        }
+
+        dest += esize;
+    }
+
+    if (a < a_end)
+        bmem_copy(dest, a, (uint64_t)(a_end - a));
+    else if (b < b_end)
+        bmem_copy(dest, b, (uint64_t)(b_end - b));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_insertion_stable(const i_Compare *cmp, byte_t *data, const uint32_t n, const uint16_t esize, byte_t *elem)
+{
+    uint32_t i;
+    for (i = 1; i < n; ++i)
+    {
+        byte_t *elem_i = data + i_BYTES(i, esize);
+        byte_t *pos = elem_i;
+        while (pos > data && i_compare(cmp, elem_i, pos - esize) < 0)
+            pos -= esize;
+
+        if (pos != elem_i)
+        {
+            bmem_copy(elem, elem_i, esize);
+            bmem_move(pos + esize, pos, (uint64_t)(elem_i - pos));
+            bmem_copy(pos, elem, esize);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_sort_stable(Array *array, const i_Compare *cmp)
+{
+    uint32_t n = array->elems;
+    uint16_t esize = array->esize;
+    byte_t *temp = NULL;
+    byte_t *src, *dest;
+    uint32_t i, width;
+
+    if (n < 2)
+        return;
+
+    /* One extra element for insertion */
+    temp = heap_malloc64(i_BYTES(n + 1, esize), "ArraySortStable");
+    for (i = 0; i < n; i += i_STABLE_RUN)
+        i_insertion_stable(cmp, array->data + i_BYTES(i, esize), n - i < i_STABLE_RUN ? n - i : i_STABLE_RUN, esize, temp + i_BYTES(n, esize));
+
+    src = array->data;
+    dest = temp;
+    for (width = i_STABLE_RUN; width < n; width = width > n / 2 ? n : 2 * width)
+    {
+        for (i = 0; i < n; i += 2 * width)
+        {
+            uint32_t m = n - i < width ? n - i : width;
+            uint32_t l = n - i - m < width ? n - i - m : width;
+            const byte_t *a = src + i_BYTES(i, esize);
+            const byte_t *b = a + i_BYTES(m, esize);
+
+            /* Runs already in order */
+            if (l == 0 || i_compare(cmp, b - esize, b) <= 0)
+                bmem_copy(dest + i_BYTES(i, esize), a, i_BYTES(m + l, esize));
+            else
+                i_merge(cmp, a, m, b, l, dest + i_BYTES(i, esize), esize);
+        }
+
+        bmem_swap_type(&src, &dest, byte_t *);
+    }
+
+    if (src != array->data)
+        bmem_copy(array->data, src, i_BYTES(n, esize));
+
+    heap_free64(&temp, i_BYTES(n + 1, esize), "ArraySortStable");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_sort_stable(Array *array, FPtr_compare func_compare)
 {
-    i_CompareDPtr cmp;
+    i_Compare cmp;
     cassert_no_null(array);
+    cassert_no_nullf(func_compare);
+    bmem_zero(&cmp, i_Compare);
     cmp.func_compare = func_compare;
-    cmp.func_compare_ex = NULL;
-    cmp.data = NULL;
-    blib_qsort_ex(array->data, array->elems, array->esize, (FPtr_compare_ex)i_compare_ptr, cast_const(&cmp, byte_t));
+    i_sort_stable(array, &cmp);
 }
 
 /*---------------------------------------------------------------------------*/
 
-void array_sort_ptr_ex(Array *array, FPtr_compare_ex func_compare, void *data)
+void array_sort_stable_ex(Array *array, FPtr_compare_ex func_compare, void *data)
 {
-    i_CompareDPtr cmp;
+    i_Compare cmp;
     cassert_no_null(array);
-    cmp.func_compare = NULL;
+    cassert_no_nullf(func_compare);
+    bmem_zero(&cmp, i_Compare);
     cmp.func_compare_ex = func_compare;
-    cmp.data = data;
-    blib_qsort_ex(array->data, array->elems, array->esize, (FPtr_compare_ex)i_compare_ptr, cast_const(&cmp, byte_t));
+    cmp.data = cast_const(data, byte_t);
+    i_sort_stable(array, &cmp);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_sort_stable_ptr(Array *array, FPtr_compare func_compare)
+{
+    i_Compare cmp;
+    cassert_no_null(array);
+    cassert_no_nullf(func_compare);
+    cassert(array->esize == sizeofptr);
+    bmem_zero(&cmp, i_Compare);
+    cmp.func_compare = func_compare;
+    cmp.deref = TRUE;
+    i_sort_stable(array, &cmp);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_sort_stable_ptr_ex(Array *array, FPtr_compare_ex func_compare, void *data)
+{
+    i_Compare cmp;
+    cassert_no_null(array);
+    cassert_no_nullf(func_compare);
+    cassert(array->esize == sizeofptr);
+    bmem_zero(&cmp, i_Compare);
+    cmp.func_compare_ex = func_compare;
+    cmp.data = cast_const(data, byte_t);
+    cmp.deref = TRUE;
+    i_sort_stable(array, &cmp);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_key32(uint32_t key, byte_t *rec)
+{
+    rec[0] = (byte_t)(key >> 24);
+    rec[1] = (byte_t)(key >> 16);
+    rec[2] = (byte_t)(key >> 8);
+    rec[3] = (byte_t)key;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_key64(uint64_t key, byte_t *rec)
+{
+    i_key32((uint32_t)(key >> 32), rec);
+    i_key32((uint32_t)key, rec + 4);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Writes the key in 'rec' as unsigned big-endian bytes, so byte order
+ * is key order: signed integers flip the sign bit, negative floats
+ * flip all the bits and positive ones the sign bit.
+ */
+static void i_sort_key_bytes(FPtr_sort_key func_key, const byte_t *elem, const sortkey_t ktype, byte_t *rec)
+{
+    switch (ktype)
+    {
+    case ekSKEY_U32:
+    {
+        uint32_t key;
+        func_key(elem, &key);
+        i_key32(key, rec);
+        break;
+    }
+
+    case ekSKEY_I32:
+    {
+        int32_t key;
+        func_key(elem, &key);
+        i_key32((uint32_t)key ^ 0x80000000, rec);
+        break;
+    }
+
+    case ekSKEY_R32:
+    {
+        union {
+            real32_t r;
+            uint32_t u;
+        } key;
+        func_key(elem, &key.r);
+        i_key32((key.u & 0x80000000) != 0 ? ~key.u : key.u | 0x80000000, rec);
+        break;
+    }
+
+    case ekSKEY_U64:
+    {
+        uint64_t key;
+        func_key(elem, &key);
+        i_key64(key, rec);
+        break;
+    }
+
+    case ekSKEY_I64:
+    {
+        int64_t key;
+        func_key(elem, &key);
+        i_key64((uint64_t)key ^ 0x8000000000000000, rec);
+        break;
+    }
+
+    case ekSKEY_R64:
+    {
+        union {
+            real64_t r;
+            uint64_t u;
+        } key;
+        func_key(elem, &key.r);
+        i_key64((key.u & 0x8000000000000000) != 0 ? ~key.u : key.u | 0x8000000000000000, rec);
+        break;
+    }
+
+    case ekSKEY_BYTES:
+        func_key(elem, rec);
+        break;
+
+    default:
+        cassert_default(ktype);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * LSD radix sort. Keys are extracted once into records (key bytes +
+ * element index), sorted byte by byte from the least significant and
+ * the elements are permuted at the end. Stable.
+ */
+static void i_sort_key(Array *array, FPtr_sort_key func_key, const sortkey_t ktype, const uint16_t ksize, const bool_t deref)
+{
+    uint32_t n = array->elems;
+    uint16_t esize = array->esize;
+    uint32_t rsize = (((uint32_t)ksize + 3) & ~3u) + 4;
+    byte_t *recs = NULL;
+    byte_t *src, *dest;
+    uint32_t *counts = NULL;
+    uint32_t i, d;
+
+    cassert(ksize > 0);
+    cassert((ksize == 4 && (ktype == ekSKEY_U32 || ktype == ekSKEY_I32 || ktype == ekSKEY_R32)) || (ksize == 8 && (ktype == ekSKEY_U64 || ktype == ekSKEY_I64 || ktype == ekSKEY_R64)) || ktype == ekSKEY_BYTES);
+
+    if (n < 2)
+        return;
+
+    recs = heap_malloc64(2 * (uint64_t)n * rsize, "ArraySortKey");
+    counts = heap_new_n0(256 * (uint32_t)ksize, uint32_t);
+
+    /* Keys and histograms of all digits in one pass */
+    for (i = 0; i < n; ++i)
+    {
+        const byte_t *elem = array->data + i_BYTES(i, esize);
+        byte_t *rec = recs + (uint64_t)i * rsize;
+        uint32_t k;
+        if (deref == TRUE)
+            elem = *dcast_const(elem, byte_t);
+        i_sort_key_bytes(func_key, elem, ktype, rec);
+        *cast(rec + rsize - 4, uint32_t) = i;
+        for (k = 0; k < ksize; ++k)
+            counts[k * 256 + rec[k]] += 1;
+    }
+
+    src = recs;
+    dest = recs + (uint64_t)n * rsize;
+    for (d = ksize; d > 0; --d)
+    {
+        uint32_t *count = counts + (d - 1) * 256;
+        uint32_t b, sum = 0;
+
+        /* All the elements share this digit */
+        if (count[src[d - 1]] == n)
+            continue;
+
+        for (b = 0; b < 256; ++b)
+        {
+            uint32_t c = count[b];
+            count[b] = sum;
+            sum += c;
+        }
+
+        for (i = 0; i < n; ++i)
+        {
+            const byte_t *rec = src + (uint64_t)i * rsize;
+            byte_t *to = dest + (uint64_t)(count[rec[d - 1]]++) * rsize;
+            i_copy_elem(to, rec, rsize);
+        }
+
+        bmem_swap_type(&src, &dest, byte_t *);
+    }
+
+    /* Gather the elements in key order */
+    {
+        uint64_t bytes = i_BYTES(n, esize);
+        byte_t *elems = heap_malloc64(bytes, "ArraySortKey");
+        for (i = 0; i < n; ++i)
+        {
+            uint32_t index = *cast_const(src + (uint64_t)i * rsize + rsize - 4, uint32_t);
+            bmem_copy(elems + i_BYTES(i, esize), array->data + i_BYTES(index, esize), esize);
+        }
+
+        bmem_copy(array->data, elems, bytes);
+        heap_free64(&elems, bytes, "ArraySortKey");
+    }
+
+    heap_delete_n(&counts, 256 * (uint32_t)ksize, uint32_t);
+    heap_free64(&recs, 2 * (uint64_t)n * rsize, "ArraySortKey");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_sort_key(Array *array, FPtr_sort_key func_key, const sortkey_t ktype, const uint16_t ksize)
+{
+    cassert_no_null(array);
+    cassert_no_nullf(func_key);
+    i_sort_key(array, func_key, ktype, ksize, FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_sort_key_ptr(Array *array, FPtr_sort_key func_key, const sortkey_t ktype, const uint16_t ksize)
+{
+    cassert_no_null(array);
+    cassert_no_nullf(func_key);
+    cassert(array->esize == sizeofptr);
+    i_sort_key(array, func_key, ktype, ksize, TRUE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Parallel algorithms. The work is split in chunks that the caller and the
+ * workers of the global pool grab in order until there are no more left.
+ * With one core, the caller runs all chunks with no extra threads.
+ */
+typedef void (*i_FPtr_chunk)(void *data, const uint32_t chunk);
+
+typedef struct i_parallel_t
+{
+    Mutex *mutex;
+    uint32_t next;
+    uint32_t nchunks;
+    i_FPtr_chunk func_chunk;
+    void *data;
+} i_Parallel;
+
+typedef struct i_range_t
+{
+    byte_t *data;
+    uint16_t esize;
+    uint32_t elems;
+    uint32_t grain;
+    FPtr_range func_range;
+    FPtr_reduce func_reduce;
+    byte_t *partials;
+    uint16_t rsize;
+    void *udata;
+} i_Range;
+
+typedef struct i_psort_t
+{
+    uint16_t esize;
+    i_Compare cmp;
+    byte_t *src;
+    byte_t *dest;
+    uint32_t *runs;
+    uint32_t nruns;
+    struct i_merge_t *merges;
+} i_PSort;
+
+typedef struct i_merge_t
+{
+    uint32_t a, m;
+    uint32_t b, l;
+    uint32_t k0, k1;
+} i_Merge;
+
+#define i_MIN_PARALLEL_SORT 16384
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_parallel_task(i_Parallel *par)
+{
+    for (;;)
+    {
+        uint32_t chunk;
+        bmutex_lock(par->mutex);
+        chunk = par->next;
+        par->next += 1;
+        bmutex_unlock(par->mutex);
+        if (chunk >= par->nchunks)
+            return 0;
+
+        par->func_chunk(par->data, chunk);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_parallel(const uint32_t nchunks, i_FPtr_chunk func_chunk, void *data)
+{
+    ThreadPool *pool = nchunks > 1 ? tpool_global() : NULL;
+    uint32_t ntasks = pool != NULL ? tpool_nworkers(pool) : 1;
+
+    if (ntasks > nchunks)
+        ntasks = nchunks;
+
+    /* The caller is also a runner */
+    if (ntasks > 1)
+    {
+        i_Parallel par;
+        Future **futures = heap_new_n(ntasks - 1, Future *);
+        uint32_t i;
+        par.mutex = bmutex_create();
+        par.next = 0;
+        par.nchunks = nchunks;
+        par.func_chunk = func_chunk;
+        par.data = data;
+        for (i = 0; i < ntasks - 1; ++i)
+            futures[i] = tpool_submit(pool, &par, i_parallel_task, i_Parallel);
+
+        i_parallel_task(&par);
+        for (i = 0; i < ntasks - 1; ++i)
+            future_destroy(&futures[i]);
+
+        bmutex_close(&par.mutex);
+        heap_delete_n(&futures, ntasks - 1, Future *);
+    }
+    else
+    {
+        uint32_t i;
+        for (i = 0; i < nchunks; ++i)
+            func_chunk(data, i);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_grain(const uint32_t elems, const uint32_t grain)
+{
+    if (grain == 0)
+    {
+        /* A few chunks per worker balance the load */
+        uint32_t nworkers = elems > 1 ? tpool_nworkers(tpool_global()) : 1;
+        uint32_t agrain = elems / (4 * nworkers);
+        return agrain > 0 ? agrain : 1;
+    }
+
+    return grain;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_range_chunk(i_Range *range, const uint32_t chunk)
+{
+    uint32_t first = chunk * range->grain;
+    uint32_t n = range->elems - first < range->grain ? range->elems - first : range->grain;
+    byte_t *elems = range->data + i_BYTES(first, range->esize);
+    if (range->func_range != NULL)
+        range->func_range(cast(elems, void), n, first, range->udata);
+    else
+        range->func_reduce(cast(elems, void), n, cast(range->partials + chunk * range->rsize, void), range->udata);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_parallel_for(Array *array, const uint32_t grain, FPtr_range func_range, void *data)
+{
+    i_Range range;
+    cassert_no_null(array);
+    cassert_no_nullf(func_range);
+    bmem_zero(&range, i_Range);
+    range.data = array->data;
+    range.esize = array->esize;
+    range.elems = array->elems;
+    range.grain = i_grain(array->elems, grain);
+    range.func_range = func_range;
+    range.udata = data;
+    i_parallel((array->elems + range.grain - 1) / range.grain, (i_FPtr_chunk)i_range_chunk, &range);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_parallel_reduce(const Array *array, const uint32_t grain, FPtr_reduce func_reduce, FPtr_join func_join, void *result, const uint16_t rsize, void *data)
+{
+    i_Range range;
+    uint32_t i, nchunks;
+    cassert_no_null(array);
+    cassert_no_nullf(func_reduce);
+    cassert_no_nullf(func_join);
+    cassert_no_null(result);
+    cassert(rsize > 0);
+    bmem_zero(&range, i_Range);
+    range.data = array->data;
+    range.esize = array->esize;
+    range.elems = array->elems;
+    range.grain = i_grain(array->elems, grain);
+    range.func_reduce = func_reduce;
+    range.rsize = rsize;
+    range.udata = data;
+    nchunks = (array->elems + range.grain - 1) / range.grain;
+    if (nchunks == 0)
+        return;
+
+    /* Each chunk starts from the identity value in 'result' */
+    range.partials = heap_malloc(nchunks * rsize, "ArrayPartials");
+    for (i = 0; i < nchunks; ++i)
+        bmem_copy(range.partials + i * rsize, cast_const(result, byte_t), rsize);
+
+    i_parallel(nchunks, (i_FPtr_chunk)i_range_chunk, &range);
+
+    /* Partial results are joined in array order */
+    for (i = 0; i < nchunks; ++i)
+        func_join(result, cast(range.partials + i * rsize, void), data);
+
+    heap_free(&range.partials, nchunks * rsize, "ArrayPartials");
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_psort_run(i_PSort *sort, const uint32_t run)
+{
+    uint32_t first = sort->runs[run];
+    uint32_t n = sort->runs[run + 1] - first;
+    byte_t *elems = sort->src + i_BYTES(first, sort->esize);
+    if (sort->cmp.func_compare != NULL)
+        blib_qsort(elems, n, sort->esize, sort->cmp.func_compare);
+    else
+        blib_qsort_ex(elems, n, sort->esize, sort->cmp.func_compare_ex, sort->cmp.data);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Merge path: number of elements of 'a' (m sorted elements) in the first 'k'
+ * elements of the merge with 'b' (l sorted elements). Ties come from 'a'.
+ */
+static uint32_t i_corank(const i_PSort *sort, const byte_t *a, const uint32_t m, const byte_t *b, const uint32_t l, const uint32_t k)
+{
+    uint32_t lo = k > l ? k - l : 0;
+    uint32_t hi = k < m ? k : m;
+    while (lo < hi)
+    {
+        uint32_t i = lo + (hi - lo) / 2;
+        uint32_t j = k - i;
+        if (i_compare(&sort->cmp, a + i_BYTES(i, sort->esize), b + i_BYTES(j - 1, sort->esize)) <= 0)
+            lo = i + 1;
+        else
+            hi = i;
+    }
+
+    return lo;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_psort_merge(i_PSort *sort, const uint32_t index)
+{
+    const i_Merge *merge = &sort->merges[index];
+    uint16_t esize = sort->esize;
+    const byte_t *a = sort->src + i_BYTES(merge->a, esize);
+    const byte_t *b = sort->src + i_BYTES(merge->b, esize);
+    byte_t *dest = sort->dest + i_BYTES(merge->a + merge->k0, esize);
+    uint32_t i = i_corank(sort, a, merge->m, b, merge->l, merge->k0);
+    uint32_t j = merge->k0 - i;
+    uint32_t i1 = i_corank(sort, a, merge->m, b, merge->l, merge->k1);
+    uint32_t j1 = merge->k1 - i1;
+    i_merge(&sort->cmp, a + i_BYTES(i, esize), i1 - i, b + i_BYTES(j, esize), j1 - j, dest, esize);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_parallel_sort(Array *array, FPtr_compare func_compare, FPtr_compare_ex func_compare_ex, void *data)
+{
+    uint32_t nworkers = array->elems >= i_MIN_PARALLEL_SORT ? tpool_nworkers(tpool_global()) : 1;
+    i_PSort sort;
+    byte_t *temp = NULL;
+    uint32_t i;
+
+    if (nworkers == 1)
+    {
+        if (func_compare != NULL)
+            blib_qsort(array->data, array->elems, array->esize, func_compare);
+        else
+            blib_qsort_ex(array->data, array->elems, array->esize, func_compare_ex, cast_const(data, byte_t));
+        return;
+    }
+
+    sort.esize = array->esize;
+    bmem_zero(&sort.cmp, i_Compare);
+    sort.cmp.func_compare = func_compare;
+    sort.cmp.func_compare_ex = func_compare_ex;
+    sort.cmp.data = cast_const(data, byte_t);
+    sort.src = array->data;
+    temp = heap_malloc64(i_BYTES(array->elems, array->esize), "ArrayParallelSort");
+    sort.dest = temp;
+
+    /* 1) Sort two runs per worker */
+    sort.nruns = 2 * nworkers;
+    sort.runs = heap_new_n(sort.nruns + 1, uint32_t);
+    for (i = 0; i <= sort.nruns; ++i)
+        sort.runs[i] = (uint32_t)(((uint64_t)array->elems * i) / sort.nruns);
+
+    i_parallel(sort.nruns, (i_FPtr_chunk)i_psort_run, &sort);
+
+    /* 2) Merge pairs of runs until one is left. Each merge is split in segments of output */
+    {
+        uint32_t nruns = sort.nruns;
+        uint32_t segment = array->elems / (4 * nworkers) > 0 ? array->elems / (4 * nworkers) : 1;
+        uint32_t nmerges = array->elems / segment + sort.nruns;
+        sort.merges = heap_new_n(nmerges, i_Merge);
+        while (nruns > 1)
+        {
+            uint32_t r, n = 0, nm = 0;
+            for (r = 0; r < nruns; r += 2)
+            {
+                uint32_t a = sort.runs[r];
+                uint32_t b = sort.runs[r + 1];
+                uint32_t e = r + 2 <= nruns ? sort.runs[r + 2] : b;
+                uint32_t k = 0;
+
+                /* Odd run: copied with an empty 'b' */
+                do
+                {
+                    i_Merge *merge = &sort.merges[nm++];
+                    cassert(nm <= nmerges);
+                    merge->a = a;
+                    merge->m = b - a;
+                    merge->b = b;
+                    merge->l = e - b;
+                    merge->k0 = k;
+                    k = e - a - k > segment ? k + segment : e - a;
+                    merge->k1 = k;
+                } while (k < e - a);
+
+                sort.runs[n++] = a;
+            }
+
+            sort.runs[n] = array->elems;
+            i_parallel(nm, (i_FPtr_chunk)i_psort_merge, &sort);
+            bmem_swap_type(&sort.src, &sort.dest, byte_t *);
+            nruns = n;
+        }
+
+        heap_delete_n(&sort.merges, nmerges, i_Merge);
+    }
+
+    if (sort.src != array->data)
+        bmem_copy(array->data, sort.src, i_BYTES(array->elems, array->esize));
+
+    heap_delete_n(&sort.runs, 2 * nworkers + 1, uint32_t);
+    heap_free64(&temp, i_BYTES(array->elems, array->esize), "ArrayParallelSort");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_parallel_sort(Array *array, FPtr_compare func_compare)
+{
+    cassert_no_null(array);
+    cassert_no_nullf(func_compare);
+    i_parallel_sort(array, func_compare, NULL, NULL);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void array_parallel_sort_ex(Array *array, FPtr_compare_ex func_compare, void *data)
+{
+    cassert_no_null(array);
+    cassert_no_nullf(func_compare);
+    i_parallel_sort(array, NULL, func_compare, data);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -818,7 +1551,7 @@ byte_t *array_search(const Array *array, FPtr_compare func_compare, const void *
         if (func_compare(cast_const(data, void), key) == 0)
         {
             ptr_assign(pos, i);
-            return array->data + i * array->esize;
+            return array->data + i_BYTES(i, array->esize);
         }
     }
 
@@ -857,7 +1590,7 @@ byte_t *array_bsearch(const Array *array, FPtr_compare func_compare, const void
     if (blib_bsearch(array->data, cast_const(key, byte_t), array->elems, array->esize, func_compare, &i) == TRUE)
     {
         ptr_assign(pos, i);
-        return array->data + i * array->esize;
+        return array->data + i_BYTES(i, array->esize);
     }
     else
     {
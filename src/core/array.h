@@ -16,6 +16,8 @@ __EXTERN_C
 
 _core_api Array *array_create(const uint16_t esize, const char_t *type);
 
+_core_api Array *array_arena(Arena *arena, const uint16_t esize, const char_t *type);
+
 _core_api Array *array_copy(const Array *array, FPtr_scopy func_copy, const char_t *type);
 
 _core_api Array *array_copy_ptr(const Array *array, FPtr_copy func_copy, const char_t *type);
@@ -84,6 +86,26 @@ _core_api void array_sort_ptr(Array *array, FPtr_compare func_compare);
 
 _core_api void array_sort_ptr_ex(Array *array, FPtr_compare_ex func_compare, void *data);
 
+_core_api void array_sort_stable(Array *array, FPtr_compare func_compare);
+
+_core_api void array_sort_stable_ex(Array *array, FPtr_compare_ex func_compare, void *data);
+
+_core_api void array_sort_stable_ptr(Array *array, FPtr_compare func_compare);
+
+_core_api void array_sort_stable_ptr_ex(Array *array, FPtr_compare_ex func_compare, void *data);
+
+_core_api void array_sort_key(Array *array, FPtr_sort_key func_key, const sortkey_t ktype, const uint16_t ksize);
+
+_core_api void array_sort_key_ptr(Array *array, FPtr_sort_key func_key, const sortkey_t ktype, const uint16_t ksize);
+
+_core_api void array_parallel_for(Array *array, const uint32_t grain, FPtr_range func_range, void *data);
+
+_core_api void array_parallel_reduce(const Array *array, const uint32_t grain, FPtr_reduce func_reduce, FPtr_join func_join, void *result, const uint16_t rsize, void *data);
+
+_core_api void array_parallel_sort(Array *array, FPtr_compare func_compare);
+
+_core_api void array_parallel_sort_ex(Array *array, FPtr_compare_ex func_compare, void *data);
+
 _core_api uint32_t array_find_ptr(const Array *array, const void *elem);
 
 _core_api byte_t *array_search(const Array *array, FPtr_compare func_compare, const void *key, uint32_t *pos);
@@ -14,6 +14,9 @@
 #define arrpt_create(type) \
     arrpt_##type##_create((uint16_t)sizeof(type *))
 
+#define arrpt_arena(arena, type) \
+    arrpt_##type##_arena(arena, (uint16_t)sizeof(type *))
+
 #define arrpt_copy(array, func_copy, type) \
     arrpt_##type##_copy(array, func_copy)
 
@@ -98,6 +101,22 @@
      FUNC_CHECK_COMPARE_EX(func_compare, type, dtype), \
      arrpt_##type##_sort_ex(array, (FPtr_compare_ex)func_compare, cast(data, void)))
 
+#define arrpt_sort_stable(array, func_compare, type) \
+    ((void)((array) == cast(array, ArrPt(type))), \
+     FUNC_CHECK_COMPARE(func_compare, type), \
+     array_sort_stable_ptr(cast(array, Array), (FPtr_compare)func_compare))
+
+#define arrpt_sort_stable_ex(array, func_compare, data, type, dtype) \
+    ((void)((array) == cast(array, ArrPt(type))), \
+     (void)((data) == cast(data, dtype)), \
+     FUNC_CHECK_COMPARE_EX(func_compare, type, dtype), \
+     array_sort_stable_ptr_ex(cast(array, Array), (FPtr_compare_ex)func_compare, cast(data, void)))
+
+#define arrpt_sort_key(array, func_key, skey, type, ktype) \
+    ((void)((array) == cast(array, ArrPt(type))), \
+     FUNC_CHECK_SORT_KEY(func_key, type, ktype), \
+     array_sort_key_ptr(cast(array, Array), (FPtr_sort_key)func_key, skey, (uint16_t)sizeof(ktype)))
+
 #define arrpt_find(array, elem, type) \
     arrpt_##type##_find(array, elem)
 
@@ -24,6 +24,8 @@ struct ArrPt
 {
     static ArrPt< type > *create(void);
 
+    static ArrPt< type > *arena(Arena *arena);
+
     static ArrPt< type > *copy(const ArrPt< type > *array, type *(*func_copy)(const type *));
 
     static ArrPt< type > *read(Stream *stm, type *(*func_read)(Stream *));
@@ -117,6 +119,16 @@ ArrPt< type > *ArrPt< type >::create(void)
 
 /*---------------------------------------------------------------------------*/
 
+template < typename type >
+ArrPt< type > *ArrPt< type >::arena(Arena *arena)
+{
+    char_t dtype[64];
+    bstd_sprintf(dtype, sizeof(dtype), "ArrPt<%s>", typeid(type).name());
+    return cast(array_arena(arena, sizeof(type *), dtype), ArrPt< type >);
+}
+
+/*---------------------------------------------------------------------------*/
+
 template < typename type >
 ArrPt< type > *ArrPt< type >::copy(const ArrPt< type > *array, type *(*func_copy)(const type *))
 {
@@ -33,6 +33,12 @@
     { \
         return cast(array_create(esize, cast_const(ARRPT #type, char_t)), ArrPt(type)); \
     } \
+\
+    static __TYPECHECK ArrPt(type) *arrpt_##type##_arena(Arena *arena, const uint16_t esize); \
+    static ArrPt(type) *arrpt_##type##_arena(Arena *arena, const uint16_t esize) \
+    { \
+        return cast(array_arena(arena, esize, cast_const(ARRPT #type, char_t)), ArrPt(type)); \
+    } \
 \
     static __TYPECHECK ArrPt(type) *arrpt_##type##_copy(const struct Arr##Pt##type *array, type *(func_copy)(const type *)); \
     static ArrPt(type) *arrpt_##type##_copy(const struct Arr##Pt##type *array, type *(func_copy)(const type *)) \
@@ -14,6 +14,9 @@
 #define arrst_create(type) \
     arrst_##type##_create((uint16_t)sizeof(type))
 
+#define arrst_arena(arena, type) \
+    arrst_##type##_arena(arena, (uint16_t)sizeof(type))
+
 #define arrst_copy(array, func_copy, type) \
     arrst_##type##_copy(array, func_copy)
 
@@ -116,6 +119,47 @@
      FUNC_CHECK_COMPARE_EX(func_compare, type, dtype), \
      arrst_##type##_sort_ex(array, (FPtr_compare_ex)func_compare, cast(data, void)))
 
+#define arrst_sort_stable(array, func_compare, type) \
+    ((void)((array) == cast(array, ArrSt(type))), \
+     FUNC_CHECK_COMPARE(func_compare, type), \
+     array_sort_stable(cast(array, Array), (FPtr_compare)func_compare))
+
+#define arrst_sort_stable_ex(array, func_compare, data, type, dtype) \
+    ((void)((array) == cast(array, ArrSt(type))), \
+     (void)((data) == cast(data, dtype)), \
+     FUNC_CHECK_COMPARE_EX(func_compare, type, dtype), \
+     array_sort_stable_ex(cast(array, Array), (FPtr_compare_ex)func_compare, cast(data, void)))
+
+#define arrst_sort_key(array, func_key, skey, type, ktype) \
+    ((void)((array) == cast(array, ArrSt(type))), \
+     FUNC_CHECK_SORT_KEY(func_key, type, ktype), \
+     array_sort_key(cast(array, Array), (FPtr_sort_key)func_key, skey, (uint16_t)sizeof(ktype)))
+
+#define arrst_parallel_for(array, grain, func_range, data, type, dtype) \
+    ((void)((array) == cast(array, ArrSt(type))), \
+     (void)((data) == cast(data, dtype)), \
+     FUNC_CHECK_RANGE(func_range, type, dtype), \
+     array_parallel_for(cast(array, Array), grain, (FPtr_range)func_range, cast(data, void)))
+
+#define arrst_parallel_reduce(array, grain, func_reduce, func_join, result, data, type, rtype, dtype) \
+    ((void)((array) == cast_const(array, ArrSt(type))), \
+     (void)((result) == cast(result, rtype)), \
+     (void)((data) == cast(data, dtype)), \
+     FUNC_CHECK_REDUCE(func_reduce, type, rtype, dtype), \
+     FUNC_CHECK_JOIN(func_join, rtype, dtype), \
+     array_parallel_reduce(cast_const(array, Array), grain, (FPtr_reduce)func_reduce, (FPtr_join)func_join, cast(result, void), (uint16_t)sizeof(rtype), cast(data, void)))
+
+#define arrst_parallel_sort(array, func_compare, type) \
+    ((void)((array) == cast(array, ArrSt(type))), \
+     FUNC_CHECK_COMPARE(func_compare, type), \
+     array_parallel_sort(cast(array, Array), (FPtr_compare)func_compare))
+
+#define arrst_parallel_sort_ex(array, func_compare, data, type, dtype) \
+    ((void)((array) == cast(array, ArrSt(type))), \
+     (void)((data) == cast(data, dtype)), \
+     FUNC_CHECK_COMPARE_EX(func_compare, type, dtype), \
+     array_parallel_sort_ex(cast(array, Array), (FPtr_compare_ex)func_compare, cast(data, void)))
+
 #define arrst_search(array, func_compare, key, pos, type, ktype) \
     ((void)((key) == cast_const(key, ktype)), \
      FUNC_CHECK_COMPARE_KEY(func_compare, type, ktype), \
@@ -24,6 +24,8 @@ struct ArrSt
 {
     static ArrSt< type > *create(void);
 
+    static ArrSt< type > *arena(Arena *arena);
+
     static ArrSt< type > *copy(const ArrSt< type > *array, void (*func_copy)(type *, const type));
 
     static ArrSt< type > *read(Stream *stm, void (*func_read)(Stream *, type *));
@@ -127,6 +129,16 @@ ArrSt< type > *ArrSt< type >::create(void)
 
 /*---------------------------------------------------------------------------*/
 
+template < typename type >
+ArrSt< type > *ArrSt< type >::arena(Arena *arena)
+{
+    char_t dtype[64];
+    bstd_sprintf(dtype, sizeof(dtype), "ArrSt<%s>", typeid(type).name());
+    return cast(array_arena(arena, sizeof(type), dtype), ArrSt< type >);
+}
+
+/*---------------------------------------------------------------------------*/
+
 template < typename type >
 ArrSt< type > *ArrSt< type >::copy(const ArrSt< type > *array, void (*func_copy)(type *, const type))
 {
@@ -33,6 +33,12 @@
     { \
         return cast(array_create(esize, cast_const(ARRST #type, char_t)), ArrSt(type)); \
     } \
+\
+    static __TYPECHECK ArrSt(type) *arrst_##type##_arena(Arena *arena, const uint16_t esize); \
+    static ArrSt(type) *arrst_##type##_arena(Arena *arena, const uint16_t esize) \
+    { \
+        return cast(array_arena(arena, esize, cast_const(ARRST #type, char_t)), ArrSt(type)); \
+    } \
 \
     static __TYPECHECK ArrSt(type) *arrst_##type##_copy(const struct Arr##St##type *array, void(func_copy)(type *, const type *)); \
     static ArrSt(type) *arrst_##type##_copy(const struct Arr##St##type *array, void(func_copy)(type *, const type *)) \
@@ -11,30 +11,57 @@
 /* Fixed size memory buffers */
 
 #include "buffer.h"
+#include "buffer.inl"
 #include "heap.h"
+#include "heap.inl"
 #include "stream.h"
 #include <sewer/bmem.h>
 #include <sewer/cassert.h>
 
 /*---------------------------------------------------------------------------*/
 
-#define i_SIZE(buffer) *cast(buffer, uint32_t)
-#define i_DATA(buffer) cast(buffer, byte_t) + sizeof(uint32_t)
+/* 64-bit size header. Also keeps the data 8-byte aligned */
+#define i_SIZE(buffer) *cast(buffer, uint64_t)
+#define i_DATA(buffer) cast(buffer, byte_t) + sizeof(uint64_t)
 
 /*---------------------------------------------------------------------------*/
 
 Buffer *buffer_create(const uint32_t size)
 {
-    Buffer *buffer = cast(heap_malloc(size + sizeof32(uint32_t), "Buffer"), Buffer);
+    return buffer_create64(size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+Buffer *buffer_create64(const uint64_t size)
+{
+    Buffer *buffer = cast(heap_malloc64(size + sizeof(uint64_t), "Buffer"), Buffer);
     i_SIZE(buffer) = size;
     return buffer;
 }
 
 /*---------------------------------------------------------------------------*/
 
+Buffer *_buffer_try_create64(const uint64_t size)
+{
+    Buffer *buffer = cast(_heap_try_malloc64(size + sizeof(uint64_t), "Buffer"), Buffer);
+    if (buffer != NULL)
+        i_SIZE(buffer) = size;
+    return buffer;
+}
+
+/*---------------------------------------------------------------------------*/
+
 Buffer *buffer_with_data(const byte_t *data, const uint32_t size)
 {
-    Buffer *buffer = buffer_create(size);
+    return buffer_with_data64(data, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+Buffer *buffer_with_data64(const byte_t *data, const uint64_t size)
+{
+    Buffer *buffer = buffer_create64(size);
     bmem_copy(i_DATA(buffer), data, size);
     return buffer;
 }
@@ -55,12 +82,21 @@ void buffer_destroy(Buffer **buffer)
 {
     cassert_no_null(buffer);
     cassert_no_null(*buffer);
-    heap_free(dcast(buffer, byte_t), i_SIZE(*buffer) + sizeof32(uint32_t), "Buffer");
+    heap_free64(dcast(buffer, byte_t), i_SIZE(*buffer) + sizeof(uint64_t), "Buffer");
 }
 
 /*---------------------------------------------------------------------------*/
 
 uint32_t buffer_size(const Buffer *buffer)
+{
+    cassert_no_null(buffer);
+    cassert_msg(i_SIZE(buffer) <= UINT32_MAX, "Use 'buffer_size64' in buffers bigger than 4GB.");
+    return (uint32_t)i_SIZE(buffer);
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint64_t buffer_size64(const Buffer *buffer)
 {
     cassert_no_null(buffer);
     return i_SIZE(buffer);
@@ -87,6 +123,6 @@ const byte_t *buffer_const(const Buffer *buffer)
 void buffer_write(Stream *stream, const Buffer *buffer)
 {
     cassert_no_null(buffer);
-    stm_write_u32(stream, i_SIZE(buffer));
-    stm_write(stream, i_DATA(buffer), i_SIZE(buffer));
+    stm_write_u32(stream, buffer_size(buffer));
+    stm_write(stream, i_DATA(buffer), buffer_size(buffer));
 }
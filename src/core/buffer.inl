@@ -0,0 +1,19 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: buffer.inl
+ *
+ */
+
+/* Fixed size memory buffers */
+
+#include "core.hxx"
+
+__EXTERN_C
+
+Buffer *_buffer_try_create64(const uint64_t size);
+
+__END_C
@@ -15,6 +15,7 @@
 #include "dbindh.h"
 #include "heap.inl"
 #include "stream.inl"
+#include "tpool.inl"
 #include "strings.h"
 #include <osbs/osbs.h>
 #include <osbs/bproc.h>
@@ -177,6 +178,7 @@ void core_start(void)
     {
         osbs_start();
         _heap_start();
+        _tpool_start();
         _stm_start();
         _dbind_start();
         cassert_set_func(NULL, i_assert_to_log);
@@ -218,6 +220,7 @@ void core_finish(void)
     if (i_NUM_USERS == 1)
     {
         i_NUM_USERS = 0;
+        _tpool_finish();
         _dbind_finish();
         _stm_finish();
         _heap_finish();
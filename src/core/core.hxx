@@ -227,18 +227,35 @@ typedef enum _dbindst_t
     ekDBIND_ALIAS_SIZE
 } dbindst_t;
 
+typedef enum _sortkey_t
+{
+    ekSKEY_U32,
+    ekSKEY_U64,
+    ekSKEY_I32,
+    ekSKEY_I64,
+    ekSKEY_R32,
+    ekSKEY_R64,
+    ekSKEY_BYTES
+} sortkey_t;
+
 typedef struct _buffer_t Buffer;
 typedef struct _string_t String;
 typedef struct _stream_t Stream;
 typedef struct _array_t Array;
 typedef struct _rbtree_t RBTree;
+typedef struct _hash_t Hash;
 typedef struct _regex RegEx;
+typedef struct _regexset_t RegExSet;
 typedef struct _event_t Event;
 typedef struct _keybuf_t KeyBuf;
 typedef struct _listener_t Listener;
 typedef struct _direntry_t DirEntry;
 typedef struct _evfiledir_t EvFileDir;
 typedef struct _respack ResPack;
+typedef struct _arena_t Arena;
+typedef struct _tpool_t ThreadPool;
+typedef struct _future_t Future;
+typedef struct _dbindtype_t DBindType;
 typedef const char_t *ResId;
 typedef struct _clock_t Clock;
 typedef struct _object_t Object;
@@ -248,10 +265,14 @@ typedef struct _object_t Object;
 #define ARRPT "ArrPt::"
 #define SETST "SetSt::"
 #define SETPT "SetPt::"
+#define HASHST "HashSt::"
+#define HASHPT "HashPt::"
 #define ArrPt(type) struct Arr##Pt##type
 #define ArrSt(type) struct Arr##St##type
 #define SetPt(type) struct Set##Pt##type
 #define SetSt(type) struct Set##St##type
+#define HashPt(type) struct Hash##Pt##type
+#define HashSt(type) struct Hash##St##type
 
 typedef void (*FPtr_remove)(void *obj);
 #define FUNC_CHECK_REMOVE(func, type) \
@@ -289,6 +310,30 @@ typedef uint32_t (*FPtr_size)(const void *);
 #define FUNC_CHECK_SIZE(func, type) \
     (void)((uint32_t(*)(const type *))func == func)
 
+typedef uint32_t (*FPtr_hash)(const void *key);
+#define FUNC_CHECK_HASH(func, ktype) \
+    (void)((uint32_t(*)(const ktype *))func == func)
+
+typedef uint32_t (*FPtr_task)(void *data);
+#define FUNC_CHECK_TASK(func, type) \
+    (void)((uint32_t(*)(type *))func == func)
+
+typedef void (*FPtr_range)(void *elems, const uint32_t n, const uint32_t first, void *data);
+#define FUNC_CHECK_RANGE(func, type, dtype) \
+    (void)((void (*)(type *, const uint32_t, const uint32_t, dtype *))func == func)
+
+typedef void (*FPtr_reduce)(const void *elems, const uint32_t n, void *partial, void *data);
+#define FUNC_CHECK_REDUCE(func, type, rtype, dtype) \
+    (void)((void (*)(const type *, const uint32_t, rtype *, dtype *))func == func)
+
+typedef void (*FPtr_join)(void *result, const void *partial, void *data);
+#define FUNC_CHECK_JOIN(func, rtype, dtype) \
+    (void)((void (*)(rtype *, const rtype *, dtype *))func == func)
+
+typedef void (*FPtr_sort_key)(const void *elem, void *key);
+#define FUNC_CHECK_SORT_KEY(func, type, ktype) \
+    (void)((void (*)(const type *, ktype *))func == func)
+
 /* Do not use! only for debugger inspection */
 struct _buffer_t
 {
@@ -324,22 +369,29 @@ struct _evfiledir_t
 
 #include "array.h"
 #include "rbtree.h"
+#include "hash.h"
 #include "arrst.hxx"
 #include "arrpt.hxx"
 #include "setst.hxx"
 #include "setpt.hxx"
+#include "hashst.hxx"
+#include "hashpt.hxx"
 
 #define DeclSt(type) \
     ArrStDebug(type); \
     SetStDebug(type); \
+    HashStDebug(type); \
     ArrStFuncs(type); \
-    SetStFuncs(type)
+    SetStFuncs(type); \
+    HashStFuncs(type)
 
 #define DeclPt(type) \
     ArrPtDebug(type); \
     SetPtDebug(type); \
+    HashPtDebug(type); \
     ArrPtFuncs(type); \
-    SetPtFuncs(type)
+    SetPtFuncs(type); \
+    HashPtFuncs(type)
 
 DeclSt(bool_t);
 DeclSt(int8_t);
@@ -16,8 +16,11 @@
 #include "core.hxx"
 
 typedef struct _nfa_t NFA;
+typedef struct _dfa_t DFA;
 typedef struct _evassert_t EvAssert;
 typedef struct _lexscn_t LexScn;
+typedef struct _deflater_t Deflater;
+typedef struct _inflater_t Inflater;
 
 typedef void *(*FPtr_retain)(const void *item);
 #define FUNC_CHECK_RETAIN(func, type) \
@@ -11,6 +11,7 @@
 /* Core library all-in-one headers include */
 
 #include "core.h"
+#include "arena.h"
 #include "arrpt.h"
 #include "arrst.h"
 #include "bhash.h"
@@ -19,6 +20,8 @@
 #include "date.h"
 #include "dbind.h"
 #include "event.h"
+#include "hashpt.h"
+#include "hashst.h"
 #include "heap.h"
 #include "hfile.h"
 #include "keybuf.h"
@@ -29,4 +32,5 @@
 #include "stream.h"
 #include "strings.h"
 #include "tfilter.h"
+#include "tpool.h"
 #include <osbs/osbsall.h>
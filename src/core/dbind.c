@@ -16,10 +16,14 @@
 #include "tfilter.inl"
 #include "arrpt.h"
 #include "arrst.h"
+#include "bhash.h"
 #include "buffer.h"
+#include "hashpt.h"
 #include "heap.h"
+#include "heap.inl"
 #include "stream.h"
 #include "strings.h"
+#include <osbs/bmutex.h>
 #include <osbs/log.h>
 #include <sewer/bmath.h>
 #include <sewer/bmem.h>
@@ -109,6 +113,7 @@ struct _structmember_t
 {
     DBind *bind;
     String *name;
+    uint32_t hash;
     uint16_t offset;
     MemberAttr attr;
 };
@@ -145,10 +150,13 @@ struct _stringprops_t
     void *def;
 };
 
+/* 'index' is an open addressing table of 'member_id + 1' by name hash (0 = empty) */
 struct _structprops_t
 {
     bool_t is_union;
     ArrSt(StructMember) *members;
+    uint32_t *index;
+    uint32_t index_size;
 };
 
 struct _containerprops_t
@@ -200,19 +208,51 @@ struct _alias_t
     DBind *bind;
 };
 
+/*
+ * Resolved type name. Valid while 'gen' matches the registry generation.
+ * Entries are immutable: a new resolution replaces (and retires) the entry,
+ * so the fields can be read without locking.
+ */
+struct _dbindtype_t
+{
+    String *name;
+    DBind *bind;
+    DBind *ebind;
+    bool_t is_pointer;
+    uint32_t alias_id;
+    uint32_t gen;
+};
+
 struct _databind_t
 {
     ArrPt(DBind) *binds;
     ArrSt(Alias) *alias;
+    HashPt(DBindType) *types;
+    ArrPt(DBindType) *retired;
+    Mutex *lock;
+    uint32_t gen;
+};
+
+/* Per-thread cache of looked up names. Hits don't lock the registry */
+typedef struct _typeslot_t TypeSlot;
+struct _typeslot_t
+{
+    const char_t *name;
+    const DBindType *htype;
+    uint32_t gen;
 };
 
+#define i_TYPE_SLOTS 64
+
 /*---------------------------------------------------------------------------*/
 
 DeclSt(EnumMember);
 DeclSt(StructMember);
 DeclSt(Alias);
 DeclPt(DBind);
-static DataBind i_DATABIND = {0, 0};
+DeclPt(DBindType);
+static DataBind i_DATABIND = {NULL, NULL, NULL, NULL, NULL, 0};
+static __THREAD_LOCAL TypeSlot i_TYPE_SLOTS_CACHE[i_TYPE_SLOTS];
 static real64_t i_EPSILON = 0.00001;
 
 /*---------------------------------------------------------------------------*/
@@ -228,6 +268,7 @@ static byte_t *i_read_container(Stream *stm, const DBind *bind, const DBind *ebi
 static void i_write_struct_data(Stream *stm, const byte_t *data, const StructProps *props);
 static void i_write_container(Stream *stm, const byte_t *data, const DBind *bind, const DBind *ebind);
 static void i_destroy_data(byte_t **data, const DBind *bind, const DBind *ebind);
+static DBind *i_inner_elem_bind(const DBind *bind, const char_t *type);
 
 /*---------------------------------------------------------------------------*/
 
@@ -523,6 +564,48 @@ static void i_remove_struct_props(StructProps *props)
 {
     cassert_no_null(props);
     arrst_destroy(&props->members, i_remove_struct_member, StructMember);
+    if (props->index != NULL)
+        heap_delete_n(&props->index, props->index_size, uint32_t);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint32_t i_member_hash(const char_t *mname)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    cassert_no_null(mname);
+    while (*mname != 0)
+    {
+        hash ^= (uint32_t)(unsigned char)*mname;
+        hash *= 16777619u;
+        mname += 1;
+    }
+    return hash;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_update_member_index(StructProps *props)
+{
+    uint32_t n = 0, size = 8;
+    cassert_no_null(props);
+    n = arrst_size(props->members, StructMember);
+    /* Load factor <= 1/2 */
+    while (size < 2 * n)
+        size <<= 1;
+
+    if (props->index != NULL)
+        heap_delete_n(&props->index, props->index_size, uint32_t);
+
+    props->index = heap_new_n0(size, uint32_t);
+    props->index_size = size;
+    arrst_foreach_const(member, props->members, StructMember)
+        uint32_t i = member->hash & (size - 1);
+        while (props->index[i] != 0)
+            i = (i + 1) & (size - 1);
+        props->index[i] = member_i + 1;
+    arrst_end()
 }
 
 /*---------------------------------------------------------------------------*/
@@ -575,12 +658,50 @@ static void i_remove_alias(Alias *alias)
 
 /*---------------------------------------------------------------------------*/
 
+static uint32_t i_type_hash(const char_t *name)
+{
+    return bhash_from_block(cast_const(name, byte_t), str_len_c(name));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int i_type_cmp(const DBindType *htype, const char_t *name)
+{
+    cassert_no_null(htype);
+    return str_cmp(htype->name, name);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_destroy_type(DBindType **htype)
+{
+    cassert_no_null(htype);
+    cassert_no_null(*htype);
+    str_destroy(&(*htype)->name);
+    heap_delete(htype, DBindType);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_registry_changed(void)
+{
+    /* Invalidates all resolved type names and handles */
+    i_DATABIND.gen += 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
 void _dbind_start(void)
 {
     if (i_DATABIND.binds == NULL)
     {
         i_DATABIND.binds = arrpt_create(DBind);
         i_DATABIND.alias = arrst_create(Alias);
+        i_DATABIND.types = hashpt_create(i_type_hash, i_type_cmp, DBindType, char_t);
+        i_DATABIND.retired = arrpt_create(DBindType);
+        i_DATABIND.lock = bmutex_create();
+        /* Never reset: cached slots of a previous session must not match */
+        i_registry_changed();
     }
 }
 
@@ -601,6 +722,10 @@ void _dbind_finish(void)
 
         arrpt_destroy(&i_DATABIND.binds, NULL, DBind);
         arrst_destroy(&i_DATABIND.alias, i_remove_alias, Alias);
+        hashpt_destroy(&i_DATABIND.types, i_destroy_type, DBindType);
+        arrpt_destroy(&i_DATABIND.retired, i_destroy_type, DBindType);
+        bmutex_close(&i_DATABIND.lock);
+        i_registry_changed();
     }
 }
 
@@ -806,7 +931,7 @@ static uint32_t i_clean_spaces(char_t *dest, const uint32_t size, const char_t *
 
 /*---------------------------------------------------------------------------*/
 
-static DBind *i_dbind_from_typename(const char_t *name, bool_t *is_pointer, uint32_t *alias_id)
+static DBind *i_dbind_resolve(const char_t *name, bool_t *is_pointer, uint32_t *alias_id)
 {
     char_t mtype[256];
     uint32_t len = 0;
@@ -870,6 +995,68 @@ static DBind *i_dbind_from_typename(const char_t *name, bool_t *is_pointer, uint
 
 /*---------------------------------------------------------------------------*/
 
+static const DBindType *i_dbind_lookup(const char_t *name)
+{
+    /* Registry entries live until '_dbind_finish', never in an active arena scope */
+    Arena *arena = _heap_arena(NULL);
+    DBindType *htype = NULL;
+    cassert_no_null(name);
+    bmutex_lock(i_DATABIND.lock);
+    htype = hashpt_get(i_DATABIND.types, name, DBindType, char_t);
+    if (htype == NULL || htype->gen != i_DATABIND.gen)
+    {
+        /* Threads can still be reading the old entry. Retire it until '_dbind_finish' */
+        if (htype != NULL)
+        {
+            hashpt_delete(i_DATABIND.types, name, NULL, DBindType, char_t);
+            arrpt_append(i_DATABIND.retired, htype, DBindType);
+        }
+
+        htype = heap_new0(DBindType);
+        htype->name = str_c(name);
+        htype->bind = i_dbind_resolve(name, &htype->is_pointer, &htype->alias_id);
+        htype->ebind = htype->bind != NULL ? i_inner_elem_bind(htype->bind, name) : NULL;
+        htype->gen = i_DATABIND.gen;
+        hashpt_insert(i_DATABIND.types, tc(htype->name), htype, DBindType, char_t);
+    }
+
+    bmutex_unlock(i_DATABIND.lock);
+    _heap_arena(arena);
+    return htype;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Registration is not thread-safe (done at startup), so 'gen' doesn't change
+ * while lookups are running. A slot of the current generation points to a live entry.
+ */
+static const DBindType *i_dbind_type(const char_t *name)
+{
+    TypeSlot *slot = i_TYPE_SLOTS_CACHE + ((uint32_t)((uintptr_t)name >> 3) & (i_TYPE_SLOTS - 1));
+    cassert_no_null(name);
+    if (__TRUE_EXPECTED(slot->name == name && slot->gen == i_DATABIND.gen && str_equ(slot->htype->name, name) == TRUE))
+        return slot->htype;
+
+    slot->htype = i_dbind_lookup(name);
+    slot->name = name;
+    slot->gen = slot->htype->gen;
+    return slot->htype;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static DBind *i_dbind_from_typename(const char_t *name, bool_t *is_pointer, uint32_t *alias_id)
+{
+    const DBindType *htype = i_dbind_type(name);
+    cassert_no_null(is_pointer);
+    *is_pointer = htype->is_pointer;
+    ptr_assign(alias_id, htype->alias_id);
+    return htype->bind;
+}
+
+/*---------------------------------------------------------------------------*/
+
 dbindst_t dbind_bool_imp(const char_t *type, const uint16_t size)
 {
     dbindst_t st = ekDBIND_OK;
@@ -882,6 +1069,7 @@ dbindst_t dbind_bool_imp(const char_t *type, const uint16_t size)
     {
         bind = heap_new0(DBind);
         arrpt_append(i_DATABIND.binds, bind, DBind);
+        i_registry_changed();
         bind->name = str_c(type);
         bind->type = ekDTYPE_BOOL;
         bind->size = size;
@@ -910,6 +1098,7 @@ dbindst_t dbind_int_imp(const char_t *type, const uint16_t size, const bool_t is
     {
         bind = heap_new0(DBind);
         arrpt_append(i_DATABIND.binds, bind, DBind);
+        i_registry_changed();
         bind->name = str_c(type);
         bind->type = ekDTYPE_INT;
         bind->size = size;
@@ -939,6 +1128,7 @@ dbindst_t dbind_real_imp(const char_t *type, const uint16_t size)
     {
         bind = heap_new0(DBind);
         arrpt_append(i_DATABIND.binds, bind, DBind);
+        i_registry_changed();
         bind->name = str_c(type);
         bind->type = ekDTYPE_REAL;
         bind->size = size;
@@ -973,6 +1163,7 @@ dbindst_t dbind_string_imp(const char_t *type, FPtr_str_create func_create, FPtr
     {
         bind = heap_new0(DBind);
         arrpt_append(i_DATABIND.binds, bind, DBind);
+        i_registry_changed();
         bind->name = str_c(type);
         bind->type = ekDTYPE_STRING;
         bind->size = sizeofptr;
@@ -1014,6 +1205,7 @@ dbindst_t dbind_container_imp(const char_t *type, const bool_t store_pointers, F
     {
         bind = heap_new0(DBind);
         arrpt_append(i_DATABIND.binds, bind, DBind);
+        i_registry_changed();
         bind->name = str_c(type);
         bind->type = ekDTYPE_CONTAINER;
         bind->size = sizeofptr;
@@ -1080,6 +1272,7 @@ dbindst_t dbind_enum_imp(const char_t *type, const char_t *name, const enum_t va
     {
         bind = heap_new0(DBind);
         arrpt_append(i_DATABIND.binds, bind, DBind);
+        i_registry_changed();
         bind->name = str_c(type);
         bind->type = ekDTYPE_ENUM;
         bind->size = sizeof(enum_t);
@@ -1417,7 +1610,7 @@ static void i_copy_struct_data(byte_t *dest, const byte_t *src, const StructProp
 
 /*---------------------------------------------------------------------------*/
 
-static void i_init_struct_data(byte_t *data, const StructProps *props)
+static void i_init_struct_members(byte_t *data, const StructProps *props, const bool_t strings)
 {
     cassert_no_null(props);
     arrst_foreach(member, props->members, StructMember)
@@ -1455,7 +1648,7 @@ static void i_init_struct_data(byte_t *data, const StructProps *props)
             if (member->attr.stringt.def != NULL)
                 value = member->bind->props.stringp.func_get(member->attr.stringt.def);
 
-            if (value != NULL)
+            if (value != NULL && strings == TRUE)
                 *nstr = member->bind->props.stringp.func_create(value);
             break;
         }
@@ -1474,7 +1667,7 @@ static void i_init_struct_data(byte_t *data, const StructProps *props)
                 else if (member->attr.structt.def_null == FALSE)
                 {
                     *ndata = i_dbind_calloc(member->bind);
-                    i_init_struct_data(*ndata, &member->bind->props.structp);
+                    i_init_struct_members(*ndata, &member->bind->props.structp, TRUE);
                 }
             }
             else
@@ -1482,7 +1675,7 @@ static void i_init_struct_data(byte_t *data, const StructProps *props)
                 if (member->attr.structt.def != NULL)
                     i_copy_struct_data(data + member->offset, member->attr.structt.def, &member->bind->props.structp);
                 else
-                    i_init_struct_data(data + member->offset, &member->bind->props.structp);
+                    i_init_struct_members(data + member->offset, &member->bind->props.structp, TRUE);
             }
             break;
 
@@ -1513,6 +1706,13 @@ static void i_init_struct_data(byte_t *data, const StructProps *props)
 
 /*---------------------------------------------------------------------------*/
 
+static void i_init_struct_data(byte_t *data, const StructProps *props)
+{
+    i_init_struct_members(data, props, TRUE);
+}
+
+/*---------------------------------------------------------------------------*/
+
 static DBind *i_inner_elem_bind(const DBind *bind, const char_t *type)
 {
     String *etype = i_inner_elem_type(type, bind);
@@ -1520,7 +1720,7 @@ static DBind *i_inner_elem_bind(const DBind *bind, const char_t *type)
     if (etype != NULL)
     {
         bool_t is_pointer = FALSE;
-        DBind *ebind = i_dbind_from_typename(tc(etype), &is_pointer, NULL);
+        DBind *ebind = i_dbind_resolve(tc(etype), &is_pointer, NULL);
         cassert_unref(is_pointer == FALSE, is_pointer);
         str_destroy(&etype);
         return ebind;
@@ -1547,6 +1747,7 @@ static dbindst_t i_add_member(DBind *bind, const char_t *mname, const char_t *mt
             member = arrst_insert_n(bind->props.structp.members, index, 1, StructMember);
             member->bind = mbind;
             member->name = str_c(mname);
+            member->hash = i_member_hash(mname);
             member->offset = moffset;
             cassert_unref((!is_pointer && mbind->size == msize) || (msize == sizeofptr), msize);
 
@@ -1650,6 +1851,9 @@ static dbindst_t i_add_member(DBind *bind, const char_t *mname, const char_t *mt
         st = ekDBIND_MEMBER_EXISTS;
     }
 
+    if (st == ekDBIND_OK)
+        i_update_member_index(&bind->props.structp);
+
     return st;
 }
 
@@ -1670,6 +1874,7 @@ dbindst_t dbind_imp(
     {
         bind = heap_new0(DBind);
         arrpt_append(i_DATABIND.binds, bind, DBind);
+        i_registry_changed();
         bind->name = str_c(type);
         bind->type = ekDTYPE_STRUCT;
         bind->size = size;
@@ -1704,6 +1909,7 @@ dbindst_t dbind_binary_imp(
     {
         bind = heap_new0(DBind);
         arrpt_append(i_DATABIND.binds, bind, DBind);
+        i_registry_changed();
         bind->name = str_c(type);
         bind->type = ekDTYPE_BINARY;
         bind->size = sizeofptr;
@@ -1739,6 +1945,7 @@ dbindst_t dbind_alias_imp(const char_t *type, const char_t *alias, const uint16_
             {
                 char_t mtype[256];
                 Alias *nalias = arrst_new(i_DATABIND.alias, Alias);
+                i_registry_changed();
                 i_clean_spaces(mtype, sizeof(mtype), alias);
                 nalias->name = str_c(mtype);
                 nalias->bind = bind;
@@ -1898,6 +2105,7 @@ static dbindst_t i_try_unreg(const DBind *bind, const uint32_t alias_id)
                     }
                 arrpt_end();
                 arrst_delete(stbind->props.structp.members, member_id, i_remove_struct_member, StructMember);
+                i_update_member_index(&cast(stbind, DBind)->props.structp);
             }
         }
 
@@ -1936,12 +2144,14 @@ static dbindst_t i_try_unreg(const DBind *bind, const uint32_t alias_id)
             uint32_t pos = arrpt_find(i_DATABIND.binds, bind, DBind);
             i_defaults_destroy(bind);
             arrpt_delete(i_DATABIND.binds, pos, i_destroy_dbind_full, DBind);
+            i_registry_changed();
             return ekDBIND_OK;
         }
     }
     else
     {
         arrst_delete(i_DATABIND.alias, alias_id, i_remove_alias, Alias);
+        i_registry_changed();
         return ekDBIND_OK;
     }
 }
@@ -2054,29 +2264,62 @@ static byte_t *i_create(const DBind *bind, const DBind *ebind)
 
 /*---------------------------------------------------------------------------*/
 
-byte_t *dbind_create_imp(const char_t *type)
+static const DBindType *i_handle(const DBindType *htype, const char_t *type)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    cassert_unref(is_pointer == FALSE, is_pointer);
-    if (bind != NULL)
-    {
-        DBind *ebind = i_inner_elem_bind(bind, type);
-        return i_create(bind, ebind);
-    }
+    cassert_no_null(htype);
+    cassert_unref(str_equ(htype->name, type) == TRUE, type);
+    cassert(htype->is_pointer == FALSE);
+    if (__TRUE_EXPECTED(htype->gen == i_DATABIND.gen))
+        return htype;
+    /* The registry has changed since the handle was resolved */
+    return i_dbind_type(tc(htype->name));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE const DBindType *i_htype(const char_t *type)
+{
+    const DBindType *htype = i_dbind_type(type);
+    cassert(htype->is_pointer == FALSE);
+    return htype;
+}
+
+/*---------------------------------------------------------------------------*/
+
+const DBindType *dbind_handle_imp(const char_t *type)
+{
+    return i_dbind_type(type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static byte_t *i_create_htype(const DBindType *htype)
+{
+    if (htype->bind != NULL)
+        return i_create(htype->bind, htype->ebind);
     else
-    {
         return NULL;
-    }
 }
 
 /*---------------------------------------------------------------------------*/
 
-byte_t *dbind_copy_imp(const byte_t *obj, const char_t *type)
+byte_t *dbind_create_imp(const char_t *type)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    cassert_unref(is_pointer == FALSE, is_pointer);
+    return i_create_htype(i_htype(type));
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *dbind_hcreate_imp(const DBindType *htype, const char_t *type)
+{
+    return i_create_htype(i_handle(htype, type));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static byte_t *i_copy_htype(const byte_t *obj, const DBindType *htype)
+{
+    DBind *bind = htype->bind;
     cassert_no_null(obj);
     if (bind != NULL)
     {
@@ -2108,11 +2351,8 @@ byte_t *dbind_copy_imp(const byte_t *obj, const char_t *type)
             break;
 
         case ekDTYPE_CONTAINER:
-        {
-            DBind *ebind = i_inner_elem_bind(bind, type);
-            nobj = i_copy_container(obj, bind, ebind);
+            nobj = i_copy_container(obj, bind, htype->ebind);
             break;
-        }
 
         case ekDTYPE_UNKNOWN:
         default:
@@ -2129,41 +2369,77 @@ byte_t *dbind_copy_imp(const byte_t *obj, const char_t *type)
 
 /*---------------------------------------------------------------------------*/
 
-void dbind_init_imp(byte_t *obj, const char_t *type)
+byte_t *dbind_copy_imp(const byte_t *obj, const char_t *type)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    cassert_unref(is_pointer == FALSE, is_pointer);
-    if (bind != NULL)
+    return i_copy_htype(obj, i_htype(type));
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *dbind_hcopy_imp(const byte_t *obj, const DBindType *htype, const char_t *type)
+{
+    return i_copy_htype(obj, i_handle(htype, type));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_init_htype(byte_t *obj, const DBindType *htype)
+{
+    if (htype->bind != NULL)
     {
-        bmem_set_zero(obj, bind->size);
-        i_init_bind(obj, bind);
+        bmem_set_zero(obj, htype->bind->size);
+        i_init_bind(obj, htype->bind);
     }
 }
 
 /*---------------------------------------------------------------------------*/
 
+void dbind_init_imp(byte_t *obj, const char_t *type)
+{
+    i_init_htype(obj, i_htype(type));
+}
+
+/*---------------------------------------------------------------------------*/
+
+void dbind_hinit_imp(byte_t *obj, const DBindType *htype, const char_t *type)
+{
+    i_init_htype(obj, i_handle(htype, type));
+}
+
+/*---------------------------------------------------------------------------*/
+
 void dbind_remove_imp(byte_t *obj, const char_t *type)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    cassert_unref(is_pointer == FALSE, is_pointer);
-    if (bind != NULL)
-        i_remove_data(obj, bind);
+    const DBindType *htype = i_htype(type);
+    if (htype->bind != NULL)
+        i_remove_data(obj, htype->bind);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void dbind_hremove_imp(byte_t *obj, const DBindType *htype, const char_t *type)
+{
+    const DBindType *rtype = i_handle(htype, type);
+    if (rtype->bind != NULL)
+        i_remove_data(obj, rtype->bind);
 }
 
 /*---------------------------------------------------------------------------*/
 
 void dbind_destroy_imp(byte_t **obj, const char_t *type)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    cassert_unref(is_pointer == FALSE, is_pointer);
-    if (bind != NULL)
-    {
-        DBind *ebind = i_inner_elem_bind(bind, type);
-        i_destroy_data(obj, bind, ebind);
-    }
+    const DBindType *htype = i_htype(type);
+    if (htype->bind != NULL)
+        i_destroy_data(obj, htype->bind, htype->ebind);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void dbind_hdestroy_imp(byte_t **obj, const DBindType *htype, const char_t *type)
+{
+    const DBindType *rtype = i_handle(htype, type);
+    if (rtype->bind != NULL)
+        i_destroy_data(obj, rtype->bind, rtype->ebind);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -2384,13 +2660,20 @@ static int i_cmp_struct_data(const byte_t *data1, const byte_t *data2, const Str
 
 int dbind_cmp_imp(const byte_t *obj1, const byte_t *obj2, const char_t *type)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    DBind *ebind = i_inner_elem_bind(bind, type);
-    cassert_unref(is_pointer == FALSE, is_pointer);
+    const DBindType *htype = i_htype(type);
     cassert_no_null(obj1);
     cassert_no_null(obj2);
-    return i_compare_type(bind, ebind, obj1, obj2);
+    return i_compare_type(htype->bind, htype->ebind, obj1, obj2);
+}
+
+/*---------------------------------------------------------------------------*/
+
+int dbind_hcmp_imp(const byte_t *obj1, const byte_t *obj2, const DBindType *htype, const char_t *type)
+{
+    const DBindType *rtype = i_handle(htype, type);
+    cassert_no_null(obj1);
+    cassert_no_null(obj2);
+    return i_compare_type(rtype->bind, rtype->ebind, obj1, obj2);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -2562,9 +2845,8 @@ static uint32_t i_struct_mem(const byte_t *data, const DBind *bind)
 
 uint32_t dbind_sizeof_imp(const byte_t *obj, const char_t *type)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    cassert_unref(is_pointer == FALSE, is_pointer);
+    const DBindType *htype = i_htype(type);
+    const DBind *bind = htype->bind;
     cassert_no_null(obj);
     if (bind != NULL)
     {
@@ -2586,10 +2868,7 @@ uint32_t dbind_sizeof_imp(const byte_t *obj, const char_t *type)
             return bind->props.binaryp.func_mem(cast_const(obj, void));
 
         case ekDTYPE_CONTAINER:
-        {
-            DBind *ebind = i_inner_elem_bind(bind, type);
-            return i_container_mem(obj, bind, ebind);
-        }
+            return i_container_mem(obj, bind, htype->ebind);
 
         case ekDTYPE_UNKNOWN:
         default:
@@ -2888,11 +3167,9 @@ static void i_read_struct_data(Stream *stm, byte_t *data, const StructProps *pro
 
 /*---------------------------------------------------------------------------*/
 
-byte_t *dbind_read_imp(Stream *stm, const char_t *type)
+static byte_t *i_read_htype(Stream *stm, const DBindType *htype)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    cassert_unref(is_pointer == FALSE, is_pointer);
+    const DBind *bind = htype->bind;
     if (bind != NULL)
     {
         byte_t *data = NULL;
@@ -2913,11 +3190,8 @@ byte_t *dbind_read_imp(Stream *stm, const char_t *type)
             break;
 
         case ekDTYPE_CONTAINER:
-        {
-            DBind *ebind = i_inner_elem_bind(bind, type);
-            i_read_bind(stm, cast(&data, byte_t), bind, ebind);
+            i_read_bind(stm, cast(&data, byte_t), bind, htype->ebind);
             break;
-        }
 
         case ekDTYPE_UNKNOWN:
         default:
@@ -2934,6 +3208,20 @@ byte_t *dbind_read_imp(Stream *stm, const char_t *type)
 
 /*---------------------------------------------------------------------------*/
 
+byte_t *dbind_read_imp(Stream *stm, const char_t *type)
+{
+    return i_read_htype(stm, i_htype(type));
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *dbind_hread_imp(Stream *stm, const DBindType *htype, const char_t *type)
+{
+    return i_read_htype(stm, i_handle(htype, type));
+}
+
+/*---------------------------------------------------------------------------*/
+
 static void i_write_bool(Stream *stm, const byte_t *data, const DBind *bind)
 {
     cassert_no_null(bind);
@@ -3260,11 +3548,9 @@ static void i_write_struct_data(Stream *stm, const byte_t *data, const StructPro
 
 /*---------------------------------------------------------------------------*/
 
-void dbind_write_imp(Stream *stm, const void *obj, const char_t *type)
+static void i_write_htype(Stream *stm, const void *obj, const DBindType *htype)
 {
-    bool_t is_pointer = FALSE;
-    DBind *bind = i_dbind_from_typename(type, &is_pointer, NULL);
-    cassert_unref(is_pointer == FALSE, is_pointer);
+    const DBind *bind = htype->bind;
     if (bind != NULL)
     {
         switch (bind->type)
@@ -3283,11 +3569,8 @@ void dbind_write_imp(Stream *stm, const void *obj, const char_t *type)
             break;
 
         case ekDTYPE_CONTAINER:
-        {
-            DBind *ebind = i_inner_elem_bind(bind, type);
-            i_write_bind(stm, cast_const(&obj, byte_t), bind, ebind);
+            i_write_bind(stm, cast_const(&obj, byte_t), bind, htype->ebind);
             break;
-        }
 
         case ekDTYPE_UNKNOWN:
         default:
@@ -3298,6 +3581,20 @@ void dbind_write_imp(Stream *stm, const void *obj, const char_t *type)
 
 /*---------------------------------------------------------------------------*/
 
+void dbind_write_imp(Stream *stm, const void *obj, const char_t *type)
+{
+    i_write_htype(stm, obj, i_htype(type));
+}
+
+/*---------------------------------------------------------------------------*/
+
+void dbind_hwrite_imp(Stream *stm, const void *obj, const DBindType *htype, const char_t *type)
+{
+    i_write_htype(stm, obj, i_handle(htype, type));
+}
+
+/*---------------------------------------------------------------------------*/
+
 void dbind_default_imp(const char_t *type, const char_t *mname, const byte_t *value)
 {
     bool_t is_pointer = FALSE;
@@ -3575,6 +3872,15 @@ const DBind *dbind_from_typename(const char_t *type, bool_t *is_ptr)
 
 /*---------------------------------------------------------------------------*/
 
+const DBind *dbind_handle_bind(const DBindType *htype, const char_t *type, const DBind **ebind)
+{
+    const DBindType *rtype = i_handle(htype, type);
+    ptr_assign(ebind, rtype->ebind);
+    return rtype->bind;
+}
+
+/*---------------------------------------------------------------------------*/
+
 dtype_t dbind_type(const DBind *bind)
 {
     cassert_no_null(bind);
@@ -3591,6 +3897,37 @@ uint16_t dbind_size(const DBind *bind)
 
 /*---------------------------------------------------------------------------*/
 
+void dbind_int_range(const DBind *bind, int64_t *min, int64_t *max)
+{
+    bool_t is_signed = FALSE;
+    cassert_no_null(bind);
+    cassert(bind->type == ekDTYPE_INT);
+    is_signed = bind->props.intp.is_signed;
+    switch (bind->size)
+    {
+    case 1:
+        ptr_assign(min, is_signed ? (int64_t)INT8_MIN : 0);
+        ptr_assign(max, is_signed ? (int64_t)INT8_MAX : (int64_t)UINT8_MAX);
+        break;
+    case 2:
+        ptr_assign(min, is_signed ? (int64_t)INT16_MIN : 0);
+        ptr_assign(max, is_signed ? (int64_t)INT16_MAX : (int64_t)UINT16_MAX);
+        break;
+    case 4:
+        ptr_assign(min, is_signed ? (int64_t)INT32_MIN : 0);
+        ptr_assign(max, is_signed ? (int64_t)INT32_MAX : (int64_t)UINT32_MAX);
+        break;
+    case 8:
+        ptr_assign(min, is_signed ? INT64_MIN : 0);
+        ptr_assign(max, INT64_MAX);
+        break;
+    default:
+        cassert_default(bind->size);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
 const char_t *dbind_typename(const DBind *bind)
 {
     cassert_no_null(bind);
@@ -3718,6 +4055,22 @@ const DBind *dbind_st_member(const DBind *stbind, const uint32_t member_id)
 
 /*---------------------------------------------------------------------------*/
 
+const DBind *dbind_st_member_info(const DBind *stbind, const uint32_t member_id, const DBind **ebind, bool_t *is_str_dptr, uint16_t *offset)
+{
+    StructMember *member = i_member(stbind, member_id);
+    cassert_no_null(member);
+    cassert_no_null(member->bind);
+    cassert_no_null(ebind);
+    cassert_no_null(is_str_dptr);
+    cassert_no_null(offset);
+    *ebind = member->bind->type == ekDTYPE_CONTAINER ? member->attr.containert.bind : NULL;
+    *is_str_dptr = member->bind->type == ekDTYPE_STRUCT ? member->attr.structt.is_pointer : FALSE;
+    *offset = member->offset;
+    return member->bind;
+}
+
+/*---------------------------------------------------------------------------*/
+
 const DBind *dbind_st_ebind(const DBind *stbind, const uint32_t member_id)
 {
     StructMember *member = i_member(stbind, member_id);
@@ -3741,17 +4094,45 @@ uint32_t dbind_st_count(const DBind *stbind)
 
 uint32_t dbind_st_member_id(const DBind *stbind, const char_t *mname)
 {
+    const StructProps *props = NULL;
+    uint32_t hash, mask, i;
     cassert_no_null(stbind);
     cassert(stbind->type == ekDTYPE_STRUCT);
-    arrst_foreach_const(member, stbind->props.structp.members, StructMember)
-        if (str_equ(member->name, mname) == TRUE)
-            return member_i;
-    arrst_end()
+    props = &stbind->props.structp;
+    if (props->index == NULL)
+        return UINT32_MAX;
+    hash = i_member_hash(mname);
+    mask = props->index_size - 1;
+    i = hash & mask;
+    while (props->index[i] != 0)
+    {
+        const StructMember *member = arrst_get_const(props->members, props->index[i] - 1, StructMember);
+        if (member->hash == hash && str_equ(member->name, mname) == TRUE)
+            return props->index[i] - 1;
+        i = (i + 1) & mask;
+    }
+
     return UINT32_MAX;
 }
 
 /*---------------------------------------------------------------------------*/
 
+uint32_t dbind_st_member_id_hint(const DBind *stbind, const char_t *mname, const uint32_t hint)
+{
+    cassert_no_null(stbind);
+    cassert(stbind->type == ekDTYPE_STRUCT);
+    if (hint < arrst_size(stbind->props.structp.members, StructMember))
+    {
+        const StructMember *member = arrst_get_const(stbind->props.structp.members, hint, StructMember);
+        if (str_equ(member->name, mname) == TRUE)
+            return hint;
+    }
+
+    return dbind_st_member_id(stbind, mname);
+}
+
+/*---------------------------------------------------------------------------*/
+
 uint16_t dbind_st_offset(const DBind *stbind, const uint32_t member_id)
 {
     StructMember *member = i_member(stbind, member_id);
@@ -3875,6 +4256,40 @@ void dbind_init_data(const DBind *bind, byte_t *data)
 
 /*---------------------------------------------------------------------------*/
 
+void dbind_init_data_lazy(const DBind *bind, byte_t *data)
+{
+    cassert_no_null(bind);
+    cassert_no_null(data);
+    bmem_set_zero(data, bind->size);
+    if (bind->type == ekDTYPE_STRUCT)
+        i_init_struct_members(data, &bind->props.structp, FALSE);
+    else
+        i_init_bind(data, bind);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void dbind_st_init_lazy(const DBind *stbind, byte_t *obj, const uint64_t parsed)
+{
+    cassert_no_null(stbind);
+    cassert_no_null(obj);
+    cassert(stbind->type == ekDTYPE_STRUCT);
+    cassert(arrst_size(stbind->props.structp.members, StructMember) <= 64);
+    arrst_foreach_const(member, stbind->props.structp.members, StructMember)
+        cassert_no_null(member->bind);
+        if (member->bind->type == ekDTYPE_STRING && member->attr.stringt.def != NULL && (parsed & ((uint64_t)1 << member_i)) == 0)
+        {
+            byte_t **nstr = dcast(obj + member->offset, byte_t);
+            const char_t *value = member->bind->props.stringp.func_get(member->attr.stringt.def);
+            cassert(*nstr == NULL);
+            if (value != NULL)
+                *nstr = member->bind->props.stringp.func_create(value);
+        }
+    arrst_end()
+}
+
+/*---------------------------------------------------------------------------*/
+
 void dbind_remove_data(byte_t *data, const DBind *bind)
 {
     i_remove_data(data, bind);
@@ -57,6 +57,24 @@ _core_api void dbind_increment_imp(const char_t *type, const char_t *mname, cons
 
 _core_api void dbind_suffix_imp(const char_t *type, const char_t *mname, const char_t *suffix);
 
+_core_api const DBindType *dbind_handle_imp(const char_t *type);
+
+_core_api byte_t *dbind_hcreate_imp(const DBindType *htype, const char_t *type);
+
+_core_api byte_t *dbind_hcopy_imp(const byte_t *obj, const DBindType *htype, const char_t *type);
+
+_core_api void dbind_hinit_imp(byte_t *obj, const DBindType *htype, const char_t *type);
+
+_core_api void dbind_hremove_imp(byte_t *obj, const DBindType *htype, const char_t *type);
+
+_core_api void dbind_hdestroy_imp(byte_t **obj, const DBindType *htype, const char_t *type);
+
+_core_api int dbind_hcmp_imp(const byte_t *obj1, const byte_t *obj2, const DBindType *htype, const char_t *type);
+
+_core_api byte_t *dbind_hread_imp(Stream *stm, const DBindType *htype, const char_t *type);
+
+_core_api void dbind_hwrite_imp(Stream *stm, const void *obj, const DBindType *htype, const char_t *type);
+
 __END_C
 
 #define dbind(type, mtype, mname) \
@@ -200,3 +218,40 @@ __END_C
             cast_const(#type, char_t), \
             cast_const(#mname, char_t), \
             suffix))
+
+#define dbind_handle(type) \
+    dbind_handle_imp(cast_const(#type, char_t))
+
+#define dbind_hcreate(htype, type) \
+    cast(dbind_hcreate_imp(htype, cast_const(#type, char_t)), type)
+
+#define dbind_hcopy(htype, obj, type) \
+    ((void)(obj == cast(obj, type)), \
+     cast(dbind_hcopy_imp(cast_const(obj, byte_t), htype, cast_const(#type, char_t)), type))
+
+#define dbind_hinit(htype, obj, type) \
+    ((void)(obj == cast(obj, type)), \
+     dbind_hinit_imp(cast(obj, byte_t), htype, cast_const(#type, char_t)))
+
+#define dbind_hremove(htype, obj, type) \
+    ((void)(obj == cast(obj, type)), \
+     dbind_hremove_imp(cast(obj, byte_t), htype, cast_const(#type, char_t)))
+
+#define dbind_hdestroy(htype, obj, type) \
+    ((void)(obj == dcast(obj, type)), \
+     dbind_hdestroy_imp(dcast(obj, byte_t), htype, cast_const(#type, char_t)))
+
+#define dbind_hcmp(htype, obj1, obj2, type) \
+    ((void)(cast_const(obj1, type) == obj1), \
+     (void)(cast_const(obj2, type) == obj2), \
+     dbind_hcmp_imp(cast_const(obj1, byte_t), cast_const(obj2, byte_t), htype, cast_const(#type, char_t)))
+
+#define dbind_hequ(htype, obj1, obj2, type) \
+    (dbind_hcmp(htype, obj1, obj2, type) == 0)
+
+#define dbind_hread(stm, htype, type) \
+    cast(dbind_hread_imp(stm, htype, cast_const(#type, char_t)), type)
+
+#define dbind_hwrite(stm, htype, obj, type) \
+    ((void)(cast_const(obj, type) == obj), \
+     dbind_hwrite_imp(stm, cast_const(obj, void), htype, cast_const(#type, char_t)))
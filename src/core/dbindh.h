@@ -35,10 +35,14 @@ _core_api dbindst_t dbind_container_imp(const char_t *type, const bool_t store_p
 
 _core_api const DBind *dbind_from_typename(const char_t *type, bool_t *is_ptr);
 
+_core_api const DBind *dbind_handle_bind(const DBindType *htype, const char_t *type, const DBind **ebind);
+
 _core_api dtype_t dbind_type(const DBind *bind);
 
 _core_api uint16_t dbind_size(const DBind *bind);
 
+_core_api void dbind_int_range(const DBind *bind, int64_t *min, int64_t *max);
+
 _core_api const char_t *dbind_typename(const DBind *bind);
 
 _core_api uint32_t dbind_enum_count(const DBind *bind);
@@ -61,12 +65,16 @@ _core_api bool_t dbind_is_number_type(const dtype_t type);
 
 _core_api const DBind *dbind_st_member(const DBind *stbind, const uint32_t member_id);
 
+_core_api const DBind *dbind_st_member_info(const DBind *stbind, const uint32_t member_id, const DBind **ebind, bool_t *is_str_dptr, uint16_t *offset);
+
 _core_api const DBind *dbind_st_ebind(const DBind *stbind, const uint32_t member_id);
 
 _core_api uint32_t dbind_st_count(const DBind *stbind);
 
 _core_api uint32_t dbind_st_member_id(const DBind *stbind, const char_t *mname);
 
+_core_api uint32_t dbind_st_member_id_hint(const DBind *stbind, const char_t *mname, const uint32_t hint);
+
 _core_api uint16_t dbind_st_offset(const DBind *stbind, const uint32_t member_id);
 
 _core_api const char_t *dbind_st_mname(const DBind *stbind, const uint32_t member_id);
@@ -89,6 +97,10 @@ _core_api byte_t *dbind_create_data(const DBind *bind, const DBind *ebind);
 
 _core_api void dbind_init_data(const DBind *bind, byte_t *data);
 
+_core_api void dbind_init_data_lazy(const DBind *bind, byte_t *data);
+
+_core_api void dbind_st_init_lazy(const DBind *stbind, byte_t *obj, const uint64_t parsed);
+
 _core_api void dbind_remove_data(byte_t *data, const DBind *bind);
 
 _core_api void dbind_destroy_data(byte_t **data, const DBind *bind, const DBind *ebind);
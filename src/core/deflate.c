@@ -0,0 +1,1341 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: deflate.c
+ *
+ */
+
+/* Deflate compression */
+
+#include "deflate.inl"
+#include "heap.h"
+#include "stream.h"
+#include "streamh.h"
+#include <sewer/bmem.h>
+#include <sewer/cassert.h>
+
+/*
+ * zlib format (RFC 1950) over deflate blocks (RFC 1951).
+ * Compression uses LZ77 with hash chains and lazy matching (similar to zlib level 6).
+ * Each block is encoded with fixed or dynamic Huffman codes, the smaller one.
+ */
+
+#define WSIZE 32768
+#define WMASK (WSIZE - 1)
+#define HASH_BITS 15
+#define HASH_SIZE (1 << HASH_BITS)
+#define HASH_MASK (HASH_SIZE - 1)
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define MIN_LOOKAHEAD (MAX_MATCH + MIN_MATCH + 1)
+#define MAX_DIST (WSIZE - MIN_LOOKAHEAD)
+#define TOO_FAR 4096
+#define GOOD_LENGTH 8
+#define MAX_LAZY 16
+#define NICE_LENGTH 128
+#define MAX_CHAIN 128
+#define SYM_SIZE 16384
+#define OUT_SIZE 16384
+#define LCODES 286
+#define FIXED_LCODES 288
+#define DCODES 30
+#define CLCODES 19
+#define END_BLOCK 256
+#define MAX_BITS 15
+#define MAX_CL_BITS 7
+#define LOOKUP_BITS 10
+#define LOOKUP_MASK ((1 << LOOKUP_BITS) - 1)
+#define ADLER_BASE 65521
+#define ADLER_NMAX 5552
+
+typedef struct i_huffman_t i_Huffman;
+
+typedef enum i_istate_t
+{
+    i_ekHEADER,
+    i_ekBLOCK,
+    i_ekSTORED,
+    i_ekCODES,
+    i_ekTRAILER,
+    i_ekEND,
+    i_ekERROR
+} istate_t;
+
+struct _deflater_t
+{
+    Stream *stm;
+    byte_t *window;
+    uint16_t *head;
+    uint16_t *prev;
+    uint16_t *syms;
+    uint16_t *dists;
+    uint32_t nsyms;
+    uint32_t pos;
+    uint32_t end;
+    uint32_t match_length;
+    uint32_t match_start;
+    bool_t match_available;
+    uint32_t adler1;
+    uint32_t adler2;
+    uint32_t bitbuf;
+    uint32_t bitcount;
+    uint32_t nout;
+    byte_t out[OUT_SIZE];
+};
+
+struct i_huffman_t
+{
+    uint16_t count[MAX_BITS + 1];
+    uint16_t symbol[FIXED_LCODES];
+    uint16_t lookup[1 << LOOKUP_BITS];
+};
+
+struct _inflater_t
+{
+    Stream *stm;
+    const byte_t *in;
+    uint32_t insize;
+    uint32_t inpos;
+    uint32_t bitbuf;
+    uint32_t bitcount;
+    istate_t state;
+    bool_t last;
+    uint32_t stored;
+    uint32_t copy;
+    uint32_t dist;
+    uint32_t wpos;
+    uint64_t total;
+    uint32_t adler1;
+    uint32_t adler2;
+    i_Huffman lencode;
+    i_Huffman distcode;
+    byte_t window[WSIZE];
+};
+
+static const uint16_t i_LBASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const byte_t i_LEXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t i_DBASE[DCODES] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const byte_t i_DEXTRA[DCODES] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const byte_t i_CLORDER[CLCODES] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+static const byte_t i_CLEXTRA[CLCODES] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 3, 7};
+
+/*---------------------------------------------------------------------------*/
+
+static void i_adler(uint32_t *adler1, uint32_t *adler2, const byte_t *data, const uint32_t size)
+{
+    uint32_t a = *adler1;
+    uint32_t b = *adler2;
+    uint32_t remain = size;
+    while (remain > 0)
+    {
+        uint32_t n = remain < ADLER_NMAX ? remain : ADLER_NMAX;
+        remain -= n;
+        while (n > 0)
+        {
+            a += *data++;
+            b += a;
+            n -= 1;
+        }
+
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+    }
+
+    *adler1 = a;
+    *adler2 = b;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_log2(const uint32_t value)
+{
+    uint32_t v = value, n = 0;
+    while (v > 1)
+    {
+        v >>= 1;
+        n += 1;
+    }
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_reverse(const uint32_t code, const uint32_t len)
+{
+    uint32_t i, r = 0;
+    for (i = 0; i < len; ++i)
+        r |= ((code >> i) & 1) << (len - 1 - i);
+    return r;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Length 3..258 to symbol 257..285 */
+static uint32_t i_len_code(const uint32_t len)
+{
+    uint32_t l = len - MIN_MATCH;
+    uint32_t n;
+    cassert(len >= MIN_MATCH && len <= MAX_MATCH);
+    if (len == MAX_MATCH)
+        return 285;
+    if (l < 8)
+        return 257 + l;
+    n = i_log2(l);
+    return 257 + 4 * (n - 1) + ((l >> (n - 2)) & 3);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Distance 1..32768 to symbol 0..29 */
+static uint32_t i_dist_code(const uint32_t dist)
+{
+    uint32_t d = dist - 1;
+    uint32_t n;
+    cassert(dist >= 1 && dist <= WSIZE);
+    if (d < 4)
+        return d;
+    n = i_log2(d);
+    return 2 * n + ((d >> (n - 1)) & 1);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Length-limited Huffman code lengths. Frequencies are flattened until the deepest leaf fits */
+static void i_huffman(const uint32_t *freq, const uint32_t n, const uint32_t maxbits, byte_t *lens)
+{
+    uint32_t f[FIXED_LCODES];
+    uint16_t leaves[FIXED_LCODES];
+    uint32_t weight[2 * FIXED_LCODES];
+    uint16_t parent[2 * FIXED_LCODES];
+    byte_t depth[2 * FIXED_LCODES];
+    uint32_t i, nleaves = 0;
+    cassert(n <= FIXED_LCODES);
+    bmem_set_zero(lens, n);
+
+    for (i = 0; i < n; ++i)
+    {
+        f[i] = freq[i];
+        if (freq[i] > 0)
+            leaves[nleaves++] = (uint16_t)i;
+    }
+
+    /* A complete code needs at least two symbols */
+    if (nleaves < 2)
+    {
+        uint32_t sym = nleaves == 1 ? leaves[0] : 0;
+        lens[sym] = 1;
+        lens[sym == 0 ? 1 : 0] = 1;
+        return;
+    }
+
+    for (;;)
+    {
+        uint32_t nnodes = nleaves, ileaf = 0, inode = nleaves, maxdepth = 0;
+
+        /* Stable insertion sort by frequency */
+        for (i = 1; i < nleaves; ++i)
+        {
+            uint16_t sym = leaves[i];
+            uint32_t j = i;
+            while (j > 0 && f[leaves[j - 1]] > f[sym])
+            {
+                leaves[j] = leaves[j - 1];
+                j -= 1;
+            }
+            leaves[j] = sym;
+        }
+
+        for (i = 0; i < nleaves; ++i)
+            weight[i] = f[leaves[i]];
+
+        /* Two-queue construction. Internal nodes are created in non-decreasing weight order */
+        while (nnodes < 2 * nleaves - 1)
+        {
+            uint32_t k, child[2];
+            for (k = 0; k < 2; ++k)
+            {
+                if (ileaf < nleaves && (inode >= nnodes || weight[ileaf] <= weight[inode]))
+                    child[k] = ileaf++;
+                else
+                    child[k] = inode++;
+            }
+
+            weight[nnodes] = weight[child[0]] + weight[child[1]];
+            parent[child[0]] = (uint16_t)nnodes;
+            parent[child[1]] = (uint16_t)nnodes;
+            nnodes += 1;
+        }
+
+        depth[nnodes - 1] = 0;
+        for (i = nnodes - 1; i > 0; --i)
+        {
+            depth[i - 1] = (byte_t)(depth[parent[i - 1]] + 1);
+            if (i - 1 < nleaves && depth[i - 1] > maxdepth)
+                maxdepth = depth[i - 1];
+        }
+
+        if (maxdepth <= maxbits)
+        {
+            for (i = 0; i < nleaves; ++i)
+                lens[leaves[i]] = depth[i];
+            return;
+        }
+
+        for (i = 0; i < nleaves; ++i)
+            f[leaves[i]] = (f[leaves[i]] + 1) / 2;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Canonical codes, bit-reversed for LSB-first output */
+static void i_codes(const byte_t *lens, const uint32_t n, uint16_t *codes)
+{
+    uint32_t count[MAX_BITS + 1];
+    uint32_t next[MAX_BITS + 1];
+    uint32_t i, code = 0;
+    bmem_zero_n(count, (MAX_BITS + 1), uint32_t);
+    for (i = 0; i < n; ++i)
+        count[lens[i]] += 1;
+
+    count[0] = 0;
+    next[0] = 0;
+    for (i = 1; i <= MAX_BITS; ++i)
+    {
+        code = (code + count[i - 1]) << 1;
+        next[i] = code;
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        if (lens[i] > 0)
+            codes[i] = (uint16_t)i_reverse(next[lens[i]]++, lens[i]);
+        else
+            codes[i] = 0;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_fixed_lens(byte_t *llens, byte_t *dlens)
+{
+    uint32_t i;
+    for (i = 0; i < 144; ++i)
+        llens[i] = 8;
+    for (; i < 256; ++i)
+        llens[i] = 9;
+    for (; i < 280; ++i)
+        llens[i] = 7;
+    for (; i < FIXED_LCODES; ++i)
+        llens[i] = 8;
+    for (i = 0; i < DCODES; ++i)
+        dlens[i] = 5;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Run-length encoding of code lengths with symbols 16, 17 and 18 */
+static uint32_t i_rle(const byte_t *lens, const uint32_t n, byte_t *rsyms, byte_t *rextra, uint32_t *freq)
+{
+    uint32_t i = 0, k = 0;
+    while (i < n)
+    {
+        byte_t len = lens[i];
+        uint32_t run = 1;
+        while (i + run < n && lens[i + run] == len)
+            run += 1;
+
+        if (len == 0 && run >= 3)
+        {
+            uint32_t r = run > 138 ? 138 : run;
+            rsyms[k] = (byte_t)(r >= 11 ? 18 : 17);
+            rextra[k] = (byte_t)(r >= 11 ? r - 11 : r - 3);
+            i += r;
+        }
+        else if (len != 0 && i > 0 && lens[i - 1] == len && run >= 3)
+        {
+            uint32_t r = run > 6 ? 6 : run;
+            rsyms[k] = 16;
+            rextra[k] = (byte_t)(r - 3);
+            i += r;
+        }
+        else
+        {
+            rsyms[k] = len;
+            rextra[k] = 0;
+            i += 1;
+        }
+
+        freq[rsyms[k]] += 1;
+        k += 1;
+    }
+
+    return k;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_flush_out(Deflater *def)
+{
+    cassert_no_null(def);
+    if (def->nout > 0)
+    {
+        stm_write(def->stm, def->out, def->nout);
+        def->nout = 0;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_put_bits(Deflater *def, const uint32_t value, const uint32_t nbits)
+{
+    def->bitbuf |= value << def->bitcount;
+    def->bitcount += nbits;
+    while (def->bitcount >= 8)
+    {
+        if (def->nout == OUT_SIZE)
+            i_flush_out(def);
+        def->out[def->nout++] = (byte_t)(def->bitbuf & 0xFF);
+        def->bitbuf >>= 8;
+        def->bitcount -= 8;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_data_bits(const uint32_t *lfreq, const uint32_t *dfreq, const byte_t *llens, const byte_t *dlens)
+{
+    uint32_t i, bits = 0;
+    for (i = 0; i < LCODES; ++i)
+    {
+        bits += lfreq[i] * llens[i];
+        if (i > END_BLOCK)
+            bits += lfreq[i] * i_LEXTRA[i - 257];
+    }
+
+    for (i = 0; i < DCODES; ++i)
+        bits += dfreq[i] * (dlens[i] + i_DEXTRA[i]);
+
+    return bits;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_block(Deflater *def, const bool_t last)
+{
+    uint32_t lfreq[LCODES];
+    uint32_t dfreq[DCODES];
+    uint32_t clfreq[CLCODES];
+    byte_t llens[FIXED_LCODES];
+    byte_t dlens[DCODES];
+    byte_t cllens[CLCODES];
+    byte_t fllens[FIXED_LCODES];
+    byte_t fdlens[DCODES];
+    byte_t lens[LCODES + DCODES];
+    byte_t rsyms[LCODES + DCODES];
+    byte_t rextra[LCODES + DCODES];
+    uint16_t lcodes[FIXED_LCODES];
+    uint16_t dcodes[DCODES];
+    uint16_t clcodes[CLCODES];
+    uint32_t i, nlit = LCODES, ndist = DCODES, nclen = CLCODES, nrle;
+    uint32_t dyn_bits, fixed_bits;
+    cassert_no_null(def);
+
+    bmem_zero_n(lfreq, LCODES, uint32_t);
+    bmem_zero_n(dfreq, DCODES, uint32_t);
+    bmem_zero_n(clfreq, CLCODES, uint32_t);
+    for (i = 0; i < def->nsyms; ++i)
+    {
+        if (def->dists[i] == 0)
+        {
+            lfreq[def->syms[i]] += 1;
+        }
+        else
+        {
+            lfreq[i_len_code(def->syms[i])] += 1;
+            dfreq[i_dist_code(def->dists[i])] += 1;
+        }
+    }
+
+    lfreq[END_BLOCK] = 1;
+    i_huffman(lfreq, LCODES, MAX_BITS, llens);
+    i_huffman(dfreq, DCODES, MAX_BITS, dlens);
+
+    while (nlit > 257 && llens[nlit - 1] == 0)
+        nlit -= 1;
+    while (ndist > 1 && dlens[ndist - 1] == 0)
+        ndist -= 1;
+
+    bmem_copy(lens, llens, nlit);
+    bmem_copy(lens + nlit, dlens, ndist);
+    nrle = i_rle(lens, nlit + ndist, rsyms, rextra, clfreq);
+    i_huffman(clfreq, CLCODES, MAX_CL_BITS, cllens);
+    while (nclen > 4 && cllens[i_CLORDER[nclen - 1]] == 0)
+        nclen -= 1;
+
+    dyn_bits = 5 + 5 + 4 + 3 * nclen + i_data_bits(lfreq, dfreq, llens, dlens);
+    for (i = 0; i < CLCODES; ++i)
+        dyn_bits += clfreq[i] * (cllens[i] + i_CLEXTRA[i]);
+
+    i_fixed_lens(fllens, fdlens);
+    fixed_bits = i_data_bits(lfreq, dfreq, fllens, fdlens);
+
+    i_put_bits(def, last == TRUE ? 1 : 0, 1);
+    if (fixed_bits <= dyn_bits)
+    {
+        i_put_bits(def, 1, 2);
+        bmem_copy(llens, fllens, FIXED_LCODES);
+        bmem_copy(dlens, fdlens, DCODES);
+        i_codes(llens, FIXED_LCODES, lcodes);
+        i_codes(dlens, DCODES, dcodes);
+    }
+    else
+    {
+        i_put_bits(def, 2, 2);
+        i_put_bits(def, nlit - 257, 5);
+        i_put_bits(def, ndist - 1, 5);
+        i_put_bits(def, nclen - 4, 4);
+        for (i = 0; i < nclen; ++i)
+            i_put_bits(def, cllens[i_CLORDER[i]], 3);
+
+        i_codes(cllens, CLCODES, clcodes);
+        for (i = 0; i < nrle; ++i)
+        {
+            byte_t sym = rsyms[i];
+            i_put_bits(def, clcodes[sym], cllens[sym]);
+            if (i_CLEXTRA[sym] > 0)
+                i_put_bits(def, rextra[i], i_CLEXTRA[sym]);
+        }
+
+        i_codes(llens, LCODES, lcodes);
+        i_codes(dlens, DCODES, dcodes);
+    }
+
+    for (i = 0; i < def->nsyms; ++i)
+    {
+        uint32_t sym = def->syms[i];
+        uint32_t dist = def->dists[i];
+        if (dist == 0)
+        {
+            i_put_bits(def, lcodes[sym], llens[sym]);
+        }
+        else
+        {
+            uint32_t lc = i_len_code(sym);
+            uint32_t dc = i_dist_code(dist);
+            i_put_bits(def, lcodes[lc], llens[lc]);
+            if (i_LEXTRA[lc - 257] > 0)
+                i_put_bits(def, sym - i_LBASE[lc - 257], i_LEXTRA[lc - 257]);
+            i_put_bits(def, dcodes[dc], dlens[dc]);
+            if (i_DEXTRA[dc] > 0)
+                i_put_bits(def, dist - i_DBASE[dc], i_DEXTRA[dc]);
+        }
+    }
+
+    i_put_bits(def, lcodes[END_BLOCK], llens[END_BLOCK]);
+    def->nsyms = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_literal(Deflater *def, const byte_t value)
+{
+    def->syms[def->nsyms] = value;
+    def->dists[def->nsyms] = 0;
+    def->nsyms += 1;
+    if (def->nsyms == SYM_SIZE)
+        i_block(def, FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_match(Deflater *def, const uint32_t len, const uint32_t dist)
+{
+    cassert(len >= MIN_MATCH && len <= MAX_MATCH);
+    cassert(dist >= 1 && dist <= MAX_DIST);
+    def->syms[def->nsyms] = (uint16_t)len;
+    def->dists[def->nsyms] = (uint16_t)dist;
+    def->nsyms += 1;
+    if (def->nsyms == SYM_SIZE)
+        i_block(def, FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Returns the previous head of the chain. Position 0 is used as null link */
+static ___INLINE uint32_t i_insert(Deflater *def, const uint32_t pos)
+{
+    const byte_t *p = def->window + pos;
+    uint32_t h = (((uint32_t)p[0] << 10) ^ ((uint32_t)p[1] << 5) ^ (uint32_t)p[2]) & HASH_MASK;
+    uint32_t head = def->head[h];
+    def->prev[pos & WMASK] = (uint16_t)head;
+    def->head[h] = (uint16_t)pos;
+    return head;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_longest_match(Deflater *def, const uint32_t match, const uint32_t prev_length)
+{
+    const byte_t *scan = def->window + def->pos;
+    uint32_t limit = def->pos > MAX_DIST ? def->pos - MAX_DIST : 0;
+    uint32_t maxlen = def->end - def->pos;
+    uint32_t best = prev_length;
+    uint32_t nice = NICE_LENGTH;
+    uint32_t chain = MAX_CHAIN;
+    uint32_t cur = match;
+
+    if (maxlen > MAX_MATCH)
+        maxlen = MAX_MATCH;
+    if (nice > maxlen)
+        nice = maxlen;
+    if (prev_length >= GOOD_LENGTH)
+        chain >>= 2;
+    if (best >= maxlen)
+        return best;
+
+    do
+    {
+        const byte_t *m = def->window + cur;
+        if (m[best] == scan[best] && m[0] == scan[0] && m[1] == scan[1])
+        {
+            uint32_t len = 2;
+            while (len < maxlen && m[len] == scan[len])
+                len += 1;
+
+            if (len > best)
+            {
+                def->match_start = cur;
+                best = len;
+                if (len >= nice)
+                    break;
+            }
+        }
+
+        cur = def->prev[cur & WMASK];
+    } while (cur > limit && --chain != 0);
+
+    return best;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Lazy evaluation: a match is emitted only if the next position doesn't find a longer one */
+static void i_compress(Deflater *def, const bool_t flush)
+{
+    uint32_t limit = def->end;
+    cassert_no_null(def);
+    if (flush == FALSE)
+    {
+        if (limit < MIN_LOOKAHEAD)
+            return;
+        limit -= MIN_LOOKAHEAD;
+    }
+
+    while (def->pos < limit)
+    {
+        uint32_t hash_head = 0;
+        uint32_t prev_length = def->match_length;
+        uint32_t prev_match = def->match_start;
+
+        if (def->end - def->pos >= MIN_MATCH)
+            hash_head = i_insert(def, def->pos);
+
+        def->match_length = MIN_MATCH - 1;
+        if (hash_head != 0 && prev_length < MAX_LAZY && def->pos - hash_head <= MAX_DIST)
+        {
+            def->match_length = i_longest_match(def, hash_head, prev_length);
+            if (def->match_length == MIN_MATCH && def->pos - def->match_start > TOO_FAR)
+                def->match_length = MIN_MATCH - 1;
+        }
+
+        if (prev_length >= MIN_MATCH && def->match_length <= prev_length)
+        {
+            uint32_t last = def->pos - 1 + prev_length;
+            uint32_t max_insert = def->end - MIN_MATCH;
+            i_match(def, prev_length, def->pos - 1 - prev_match);
+            def->pos += 1;
+            while (def->pos < last)
+            {
+                if (def->pos <= max_insert)
+                    i_insert(def, def->pos);
+                def->pos += 1;
+            }
+
+            def->match_available = FALSE;
+            def->match_length = MIN_MATCH - 1;
+        }
+        else if (def->match_available == TRUE)
+        {
+            i_literal(def, def->window[def->pos - 1]);
+            def->pos += 1;
+        }
+        else
+        {
+            def->match_available = TRUE;
+            def->pos += 1;
+        }
+    }
+
+    if (flush == TRUE && def->match_available == TRUE)
+    {
+        i_literal(def, def->window[def->pos - 1]);
+        def->match_available = FALSE;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint16_t i_slide_pos(const uint16_t pos)
+{
+    return (uint16_t)(pos >= WSIZE ? pos - WSIZE : 0);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_slide(Deflater *def)
+{
+    uint32_t i;
+    cassert_no_null(def);
+    cassert(def->end == 2 * WSIZE);
+    cassert(def->pos >= WSIZE);
+    bmem_copy(def->window, def->window + WSIZE, WSIZE);
+    def->pos -= WSIZE;
+    def->end -= WSIZE;
+    def->match_start = def->match_start >= WSIZE ? def->match_start - WSIZE : 0;
+    for (i = 0; i < HASH_SIZE; ++i)
+        def->head[i] = i_slide_pos(def->head[i]);
+    for (i = 0; i < WSIZE; ++i)
+        def->prev[i] = i_slide_pos(def->prev[i]);
+}
+
+/*---------------------------------------------------------------------------*/
+
+Deflater *_deflater_create(Stream *stm)
+{
+    Deflater *def = heap_new0(Deflater);
+    cassert_no_null(stm);
+    def->stm = stm;
+    def->window = heap_new_n(2 * WSIZE, byte_t);
+    def->head = heap_new_n0(HASH_SIZE, uint16_t);
+    def->prev = heap_new_n0(WSIZE, uint16_t);
+    def->syms = heap_new_n(SYM_SIZE, uint16_t);
+    def->dists = heap_new_n(SYM_SIZE, uint16_t);
+    def->match_length = MIN_MATCH - 1;
+    def->match_available = FALSE;
+    def->adler1 = 1;
+    def->adler2 = 0;
+
+    /* CMF: deflate with 32K window. FLG: default level, no dictionary */
+    def->out[0] = 0x78;
+    def->out[1] = 0x9C;
+    def->nout = 2;
+    return def;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _deflater_destroy(Deflater **def)
+{
+    cassert_no_null(def);
+    cassert_no_null(*def);
+    heap_delete_n(&(*def)->window, 2 * WSIZE, byte_t);
+    heap_delete_n(&(*def)->head, HASH_SIZE, uint16_t);
+    heap_delete_n(&(*def)->prev, WSIZE, uint16_t);
+    heap_delete_n(&(*def)->syms, SYM_SIZE, uint16_t);
+    heap_delete_n(&(*def)->dists, SYM_SIZE, uint16_t);
+    heap_delete(def, Deflater);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _deflater_write(Deflater *def, const byte_t *data, const uint32_t size)
+{
+    uint32_t i = 0;
+    cassert_no_null(def);
+    i_adler(&def->adler1, &def->adler2, data, size);
+    while (i < size)
+    {
+        uint32_t n = 2 * WSIZE - def->end;
+        if (n > size - i)
+            n = size - i;
+
+        bmem_copy(def->window + def->end, data + i, n);
+        def->end += n;
+        i += n;
+        i_compress(def, FALSE);
+        if (def->end == 2 * WSIZE)
+            i_slide(def);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _deflater_finish(Deflater *def)
+{
+    uint32_t adler;
+    cassert_no_null(def);
+    i_compress(def, TRUE);
+    i_block(def, TRUE);
+    if (def->bitcount > 0)
+        i_put_bits(def, 0, 8 - def->bitcount);
+
+    adler = (def->adler2 << 16) | def->adler1;
+    i_put_bits(def, (adler >> 24) & 0xFF, 8);
+    i_put_bits(def, (adler >> 16) & 0xFF, 8);
+    i_put_bits(def, (adler >> 8) & 0xFF, 8);
+    i_put_bits(def, adler & 0xFF, 8);
+    i_flush_out(def);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Input is consumed from the inner stream cache, so no byte after the compressed data is readed */
+static bool_t i_next_byte(Inflater *inf, uint32_t *value)
+{
+    if (inf->inpos == inf->insize)
+    {
+        if (inf->insize > 0)
+            stm_skip(inf->stm, inf->insize);
+
+        inf->inpos = 0;
+        inf->in = stm_peek(inf->stm, &inf->insize);
+        if (inf->in == NULL)
+        {
+            inf->insize = 0;
+            return FALSE;
+        }
+    }
+
+    *value = inf->in[inf->inpos++];
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE bool_t i_need(Inflater *inf, const uint32_t nbits)
+{
+    while (inf->bitcount < nbits)
+    {
+        uint32_t value;
+        if (i_next_byte(inf, &value) == FALSE)
+            return FALSE;
+        inf->bitbuf |= value << inf->bitcount;
+        inf->bitcount += 8;
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint32_t i_bits(Inflater *inf, const uint32_t nbits)
+{
+    uint32_t value = inf->bitbuf & ((1u << nbits) - 1);
+    cassert(nbits <= inf->bitcount);
+    inf->bitbuf >>= nbits;
+    inf->bitcount -= nbits;
+    return value;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_build(i_Huffman *huff, const byte_t *lens, const uint32_t n)
+{
+    uint16_t offs[MAX_BITS + 1];
+    uint32_t next[MAX_BITS + 1];
+    int32_t left = 1;
+    uint32_t i, code = 0;
+    cassert_no_null(huff);
+    cassert(n <= FIXED_LCODES);
+    bmem_zero_n(huff->count, (MAX_BITS + 1), uint16_t);
+    bmem_zero_n(huff->lookup, (1 << LOOKUP_BITS), uint16_t);
+    for (i = 0; i < n; ++i)
+        huff->count[lens[i]] += 1;
+
+    if (huff->count[0] == n)
+        return TRUE;
+
+    /* Over-subscribed codes are invalid. Incomplete ones fail when a missing code appears */
+    for (i = 1; i <= MAX_BITS; ++i)
+    {
+        left <<= 1;
+        left -= huff->count[i];
+        if (left < 0)
+            return FALSE;
+    }
+
+    offs[1] = 0;
+    for (i = 1; i < MAX_BITS; ++i)
+        offs[i + 1] = (uint16_t)(offs[i] + huff->count[i]);
+
+    for (i = 0; i < n; ++i)
+    {
+        if (lens[i] > 0)
+            huff->symbol[offs[lens[i]]++] = (uint16_t)i;
+    }
+
+    huff->count[0] = 0;
+    next[0] = 0;
+    for (i = 1; i <= MAX_BITS; ++i)
+    {
+        code = (code + huff->count[i - 1]) << 1;
+        next[i] = code;
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        uint32_t len = lens[i];
+        if (len > 0)
+        {
+            if (len <= LOOKUP_BITS)
+            {
+                uint32_t r = i_reverse(next[len], len);
+                for (; r < (1 << LOOKUP_BITS); r += 1u << len)
+                    huff->lookup[r] = (uint16_t)((i << 4) | len);
+            }
+
+            next[len] += 1;
+        }
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int32_t i_decode(Inflater *inf, const i_Huffman *huff)
+{
+    uint32_t entry;
+    i_need(inf, MAX_BITS);
+    entry = huff->lookup[inf->bitbuf & LOOKUP_MASK];
+    if (entry != 0)
+    {
+        uint32_t len = entry & 15;
+        if (len > inf->bitcount)
+            return -1;
+        i_bits(inf, len);
+        return (int32_t)(entry >> 4);
+    }
+    else
+    {
+        /* Codes longer than the lookup table, canonical decoding bit by bit */
+        int32_t code = 0, first = 0, index = 0;
+        uint32_t len;
+        for (len = 1; len <= MAX_BITS && len <= inf->bitcount; ++len)
+        {
+            int32_t count = huff->count[len];
+            code |= (int32_t)((inf->bitbuf >> (len - 1)) & 1);
+            if (code - count < first)
+            {
+                i_bits(inf, len);
+                return huff->symbol[index + (code - first)];
+            }
+
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+
+        return -1;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_dynamic(Inflater *inf)
+{
+    byte_t lens[LCODES + DCODES];
+    byte_t cllens[CLCODES];
+    uint32_t i, nlit, ndist, nclen;
+    if (i_need(inf, 14) == FALSE)
+        return FALSE;
+
+    nlit = i_bits(inf, 5) + 257;
+    ndist = i_bits(inf, 5) + 1;
+    nclen = i_bits(inf, 4) + 4;
+    if (nlit > LCODES || ndist > DCODES)
+        return FALSE;
+
+    bmem_set_zero(cllens, CLCODES);
+    for (i = 0; i < nclen; ++i)
+    {
+        if (i_need(inf, 3) == FALSE)
+            return FALSE;
+        cllens[i_CLORDER[i]] = (byte_t)i_bits(inf, 3);
+    }
+
+    if (i_build(&inf->lencode, cllens, CLCODES) == FALSE)
+        return FALSE;
+
+    i = 0;
+    while (i < nlit + ndist)
+    {
+        int32_t sym = i_decode(inf, &inf->lencode);
+        uint32_t rep = 0;
+        byte_t len = 0;
+        if (sym < 0)
+            return FALSE;
+
+        if (sym < 16)
+        {
+            lens[i++] = (byte_t)sym;
+            continue;
+        }
+
+        if (i_need(inf, i_CLEXTRA[sym]) == FALSE)
+            return FALSE;
+
+        if (sym == 16)
+        {
+            if (i == 0)
+                return FALSE;
+            len = lens[i - 1];
+            rep = 3 + i_bits(inf, 2);
+        }
+        else if (sym == 17)
+        {
+            rep = 3 + i_bits(inf, 3);
+        }
+        else
+        {
+            rep = 11 + i_bits(inf, 7);
+        }
+
+        if (i + rep > nlit + ndist)
+            return FALSE;
+
+        while (rep > 0)
+        {
+            lens[i++] = len;
+            rep -= 1;
+        }
+    }
+
+    /* End of block code is mandatory */
+    if (lens[END_BLOCK] == 0)
+        return FALSE;
+
+    if (i_build(&inf->lencode, lens, nlit) == FALSE)
+        return FALSE;
+
+    return i_build(&inf->distcode, lens + nlit, ndist);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_inflate_header(Inflater *inf)
+{
+    uint32_t cmf, flg;
+    inf->state = i_ekERROR;
+    if (i_need(inf, 16) == FALSE)
+        return;
+
+    cmf = i_bits(inf, 8);
+    flg = i_bits(inf, 8);
+    if ((cmf & 15) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20) != 0)
+        return;
+
+    inf->state = i_ekBLOCK;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_inflate_block(Inflater *inf)
+{
+    if (inf->last == TRUE)
+    {
+        inf->state = i_ekTRAILER;
+        return;
+    }
+
+    inf->state = i_ekERROR;
+    if (i_need(inf, 3) == FALSE)
+        return;
+
+    inf->last = (bool_t)i_bits(inf, 1);
+    switch (i_bits(inf, 2))
+    {
+    case 0:
+    {
+        uint32_t len, nlen;
+        i_bits(inf, inf->bitcount & 7);
+        if (i_need(inf, 16) == FALSE)
+            return;
+        len = i_bits(inf, 16);
+        if (i_need(inf, 16) == FALSE)
+            return;
+        nlen = i_bits(inf, 16);
+        if (len != (~nlen & 0xFFFF))
+            return;
+        inf->stored = len;
+        inf->state = i_ekSTORED;
+        break;
+    }
+
+    case 1:
+    {
+        byte_t llens[FIXED_LCODES];
+        byte_t dlens[DCODES];
+        i_fixed_lens(llens, dlens);
+        i_build(&inf->lencode, llens, FIXED_LCODES);
+        i_build(&inf->distcode, dlens, DCODES);
+        inf->state = i_ekCODES;
+        break;
+    }
+
+    case 2:
+        if (i_dynamic(inf) == TRUE)
+            inf->state = i_ekCODES;
+        break;
+
+    default:
+        break;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_history(Inflater *inf, const byte_t *data, const uint32_t size)
+{
+    uint32_t i = size > WSIZE ? size - WSIZE : 0;
+    for (; i < size; ++i)
+    {
+        inf->window[inf->wpos & WMASK] = data[i];
+        inf->wpos += 1;
+    }
+
+    inf->total += size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_inflate_stored(Inflater *inf, byte_t *data, const uint32_t size)
+{
+    uint32_t n = 0;
+    while (n < size && inf->stored > 0)
+    {
+        if (inf->bitcount >= 8)
+        {
+            data[n++] = (byte_t)i_bits(inf, 8);
+            inf->stored -= 1;
+        }
+        else if (inf->inpos < inf->insize)
+        {
+            uint32_t c = inf->insize - inf->inpos;
+            if (c > size - n)
+                c = size - n;
+            if (c > inf->stored)
+                c = inf->stored;
+            bmem_copy(data + n, inf->in + inf->inpos, c);
+            inf->inpos += c;
+            inf->stored -= c;
+            n += c;
+        }
+        else if (i_need(inf, 8) == FALSE)
+        {
+            inf->state = i_ekERROR;
+            break;
+        }
+    }
+
+    i_history(inf, data, n);
+    if (inf->stored == 0 && inf->state == i_ekSTORED)
+        inf->state = i_ekBLOCK;
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_output(Inflater *inf, byte_t *data, const byte_t value)
+{
+    *data = value;
+    inf->window[inf->wpos & WMASK] = value;
+    inf->wpos += 1;
+    inf->total += 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_inflate_codes(Inflater *inf, byte_t *data, const uint32_t size)
+{
+    uint32_t n = 0;
+    while (n < size)
+    {
+        if (inf->copy > 0)
+        {
+            while (inf->copy > 0 && n < size)
+            {
+                i_output(inf, data + n, inf->window[(inf->wpos - inf->dist) & WMASK]);
+                inf->copy -= 1;
+                n += 1;
+            }
+        }
+        else
+        {
+            int32_t sym = i_decode(inf, &inf->lencode);
+            if (sym < 0)
+            {
+                inf->state = i_ekERROR;
+                break;
+            }
+            else if (sym < END_BLOCK)
+            {
+                i_output(inf, data + n, (byte_t)sym);
+                n += 1;
+            }
+            else if (sym == END_BLOCK)
+            {
+                inf->state = i_ekBLOCK;
+                break;
+            }
+            else
+            {
+                uint32_t lc = (uint32_t)sym - 257;
+                uint32_t len, dc;
+                int32_t dsym;
+                if (lc >= 29 || i_need(inf, i_LEXTRA[lc]) == FALSE)
+                {
+                    inf->state = i_ekERROR;
+                    break;
+                }
+
+                len = i_LBASE[lc] + i_bits(inf, i_LEXTRA[lc]);
+                dsym = i_decode(inf, &inf->distcode);
+                if (dsym < 0 || dsym >= DCODES)
+                {
+                    inf->state = i_ekERROR;
+                    break;
+                }
+
+                dc = (uint32_t)dsym;
+                if (i_need(inf, i_DEXTRA[dc]) == FALSE)
+                {
+                    inf->state = i_ekERROR;
+                    break;
+                }
+
+                inf->dist = i_DBASE[dc] + i_bits(inf, i_DEXTRA[dc]);
+                if (inf->dist > inf->total)
+                {
+                    inf->state = i_ekERROR;
+                    break;
+                }
+
+                inf->copy = len;
+            }
+        }
+    }
+
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_inflate_trailer(Inflater *inf)
+{
+    uint32_t i, adler = 0;
+    inf->state = i_ekERROR;
+    i_bits(inf, inf->bitcount & 7);
+    for (i = 0; i < 4; ++i)
+    {
+        if (i_need(inf, 8) == FALSE)
+            return;
+        adler = (adler << 8) | i_bits(inf, 8);
+    }
+
+    if (adler != ((inf->adler2 << 16) | inf->adler1))
+        return;
+
+    /* Compressed data ends here. The inner stream is left just after it */
+    if (inf->inpos > 0)
+        stm_skip(inf->stm, inf->inpos);
+
+    inf->in = NULL;
+    inf->insize = 0;
+    inf->inpos = 0;
+    inf->state = i_ekEND;
+}
+
+/*---------------------------------------------------------------------------*/
+
+Inflater *_inflater_create(Stream *stm)
+{
+    Inflater *inf = heap_new0(Inflater);
+    cassert_no_null(stm);
+    inf->stm = stm;
+    inf->state = i_ekHEADER;
+    inf->last = FALSE;
+    inf->adler1 = 1;
+    inf->adler2 = 0;
+    return inf;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _inflater_destroy(Inflater **inf)
+{
+    cassert_no_null(inf);
+    cassert_no_null(*inf);
+    if ((*inf)->inpos > 0)
+        stm_skip((*inf)->stm, (*inf)->inpos);
+    heap_delete(inf, Inflater);
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t _inflater_read(Inflater *inf, byte_t *data, const uint32_t size)
+{
+    uint32_t n = 0, checked = 0;
+    cassert_no_null(inf);
+    cassert_no_null(data);
+    while (n < size && inf->state != i_ekEND && inf->state != i_ekERROR)
+    {
+        switch (inf->state)
+        {
+        case i_ekHEADER:
+            i_inflate_header(inf);
+            break;
+
+        case i_ekBLOCK:
+            i_inflate_block(inf);
+            break;
+
+        case i_ekSTORED:
+            n += i_inflate_stored(inf, data + n, size - n);
+            break;
+
+        case i_ekCODES:
+            n += i_inflate_codes(inf, data + n, size - n);
+            break;
+
+        case i_ekTRAILER:
+            i_adler(&inf->adler1, &inf->adler2, data + checked, n - checked);
+            checked = n;
+            i_inflate_trailer(inf);
+            break;
+
+        case i_ekEND:
+        case i_ekERROR:
+            break;
+
+        default:
+            cassert_default(inf->state);
+        }
+    }
+
+    i_adler(&inf->adler1, &inf->adler2, data + checked, n - checked);
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _inflater_error(const Inflater *inf)
+{
+    cassert_no_null(inf);
+    return (bool_t)(inf->state == i_ekERROR);
+}
@@ -0,0 +1,33 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: deflate.inl
+ *
+ */
+
+/* Deflate compression */
+
+#include "core.ixx"
+
+__EXTERN_C
+
+Deflater *_deflater_create(Stream *stm);
+
+void _deflater_destroy(Deflater **def);
+
+void _deflater_write(Deflater *def, const byte_t *data, const uint32_t size);
+
+void _deflater_finish(Deflater *def);
+
+Inflater *_inflater_create(Stream *stm);
+
+void _inflater_destroy(Inflater **inf);
+
+uint32_t _inflater_read(Inflater *inf, byte_t *data, const uint32_t size);
+
+bool_t _inflater_error(const Inflater *inf);
+
+__END_C
@@ -0,0 +1,498 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: dfa.c
+ *
+ */
+
+/* Deterministic finite automata */
+
+#include "dfa.inl"
+#include "nfa.inl"
+#include "arrst.h"
+#include "bhash.h"
+#include "heap.h"
+#include <sewer/bmem.h>
+#include <sewer/cassert.h>
+#include <sewer/unicode.h>
+
+/*
+ * DFA states are built on demand (lazy subset construction) from the NFA
+ * state sets reached while matching, and cached in a transition table.
+ * Code points are grouped in classes with the same behavior in all NFA
+ * transitions, so the table has one column per class, not per code point.
+ * If the cache exceeds its limits, the DFA is disabled and the caller
+ * simulates the NFA.
+ * Several NFAs can share one DFA (regex sets): their states are numbered
+ * consecutively ('bases') and each DFA state knows which NFAs accept.
+ * In search mode, the NFA start states are added after every step, so the
+ * DFA finds matches beginning at any position of the input.
+ */
+
+#define UNKNOWN UINT32_MAX
+#define DEAD (UINT32_MAX - 1)
+#define MAX_STATES 4096
+#define MAX_CELLS (1 << 20)
+
+typedef struct _dstate_t DState;
+
+struct _dstate_t
+{
+    uint32_t offset;
+    uint32_t size;
+    uint32_t hash;
+    uint32_t aoffset;
+    uint32_t naccepts;
+};
+
+struct _dfa_t
+{
+    NFA **nfas;
+    uint32_t nnfas;
+    uint32_t *bases;
+    bool_t search;
+    uint32_t nclasses;
+    uint32_t ascii[128];
+    ArrSt(uint32_t) *bounds;
+    ArrSt(DState) *states;
+    ArrSt(uint32_t) *sets;
+    ArrSt(uint32_t) *accepts;
+    ArrSt(uint32_t) *start;
+    ArrSt(uint32_t) *temp;
+    ArrSt(uint32_t) *local;
+    ArrSt(uint32_t) *next;
+    uint32_t *table;
+    uint32_t ncells;
+    uint32_t *slots;
+    uint32_t nslots;
+    bool_t overflow;
+};
+
+DeclSt(DState);
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_class(const DFA *dfa, const uint32_t codepoint)
+{
+    const uint32_t *bounds = arrst_all_const(dfa->bounds, uint32_t);
+    uint32_t lo = 0, hi = dfa->nclasses;
+    while (hi - lo > 1)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if (bounds[mid] <= codepoint)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_rehash(DFA *dfa, const uint32_t nslots)
+{
+    uint32_t i, n = arrst_size(dfa->states, DState);
+    const DState *states = arrst_all_const(dfa->states, DState);
+    if (dfa->slots != NULL)
+        heap_delete_n(&dfa->slots, dfa->nslots, uint32_t);
+
+    dfa->nslots = nslots;
+    dfa->slots = heap_new_n(nslots, uint32_t);
+    for (i = 0; i < nslots; ++i)
+        dfa->slots[i] = UNKNOWN;
+
+    for (i = 0; i < n; ++i)
+    {
+        uint32_t slot = states[i].hash & (nslots - 1);
+        while (dfa->slots[slot] != UNKNOWN)
+            slot = (slot + 1) & (nslots - 1);
+        dfa->slots[slot] = i;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* DFA state of a NFA state set. UNKNOWN if the cache is full */
+static uint32_t i_state(DFA *dfa, const ArrSt(uint32_t) *set)
+{
+    const uint32_t *nstates = arrst_all_const(set, uint32_t);
+    uint32_t size = arrst_size(set, uint32_t);
+    uint32_t hash = bhash_from_block(cast_const(nstates, byte_t), size * sizeof32(uint32_t));
+    uint32_t slot = hash & (dfa->nslots - 1);
+    uint32_t id = arrst_size(dfa->states, DState);
+    DState *state = NULL;
+
+    while (dfa->slots[slot] != UNKNOWN)
+    {
+        const DState *cstate = arrst_get_const(dfa->states, dfa->slots[slot], DState);
+        if (cstate->hash == hash && cstate->size == size)
+        {
+            const uint32_t *cset = arrst_all_const(dfa->sets, uint32_t) + cstate->offset;
+            if (bmem_cmp(cast_const(cset, byte_t), cast_const(nstates, byte_t), size * sizeof32(uint32_t)) == 0)
+                return dfa->slots[slot];
+        }
+
+        slot = (slot + 1) & (dfa->nslots - 1);
+    }
+
+    if (id == MAX_STATES || (id + 1) * dfa->nclasses > MAX_CELLS)
+        return UNKNOWN;
+
+    state = arrst_new(dfa->states, DState);
+    state->offset = arrst_size(dfa->sets, uint32_t);
+    state->size = size;
+    state->hash = hash;
+    state->aoffset = arrst_size(dfa->accepts, uint32_t);
+    state->naccepts = 0;
+
+    /* The accept state of each NFA is the last one of its range */
+    {
+        uint32_t i, k = 0;
+        for (i = 0; i < size; ++i)
+        {
+            while (nstates[i] >= dfa->bases[k + 1])
+                k += 1;
+
+            if (nstates[i] == dfa->bases[k + 1] - 1)
+            {
+                arrst_append(dfa->accepts, k, uint32_t);
+                state->naccepts += 1;
+            }
+        }
+    }
+
+    if (size > 0)
+    {
+        uint32_t *cset = arrst_new_n(dfa->sets, size, uint32_t);
+        bmem_copy_n(cset, nstates, size, uint32_t);
+    }
+
+    /* New row of unknown transitions */
+    if ((id + 1) * dfa->nclasses > dfa->ncells)
+    {
+        uint32_t ncells = dfa->ncells * 2;
+        dfa->table = heap_realloc_n(dfa->table, dfa->ncells, ncells, uint32_t);
+        dfa->ncells = ncells;
+    }
+
+    {
+        uint32_t i, *row = dfa->table + id * dfa->nclasses;
+        for (i = 0; i < dfa->nclasses; ++i)
+            row[i] = UNKNOWN;
+    }
+
+    dfa->slots[slot] = id;
+    if (2 * (id + 1) > dfa->nslots)
+        i_rehash(dfa, dfa->nslots * 2);
+
+    return id;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Sorted union of 'set' and the NFA start states (search mode) */
+static void i_add_start(DFA *dfa, ArrSt(uint32_t) *set)
+{
+    const uint32_t *s1 = arrst_all_const(set, uint32_t);
+    const uint32_t *s2 = arrst_all_const(dfa->start, uint32_t);
+    uint32_t n1 = arrst_size(set, uint32_t);
+    uint32_t n2 = arrst_size(dfa->start, uint32_t);
+    uint32_t i = 0, j = 0;
+    arrst_clear(dfa->next, NULL, uint32_t);
+    while (i < n1 || j < n2)
+    {
+        uint32_t v;
+        if (j == n2 || (i < n1 && s1[i] < s2[j]))
+        {
+            v = s1[i++];
+        }
+        else
+        {
+            if (i < n1 && s1[i] == s2[j])
+                i += 1;
+            v = s2[j++];
+        }
+
+        arrst_append(dfa->next, v, uint32_t);
+    }
+
+    arrst_clear(set, NULL, uint32_t);
+    arrst_foreach_const(v, dfa->next, uint32_t)
+        arrst_append(set, *v, uint32_t);
+    arrst_end()
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Global NFA states reached from 'set' with 'codepoint' */
+static void i_move(DFA *dfa, const uint32_t *set, const uint32_t size, const uint32_t codepoint, ArrSt(uint32_t) *out)
+{
+    uint32_t i = 0, k;
+    arrst_clear(out, NULL, uint32_t);
+    for (k = 0; k < dfa->nnfas && i < size; ++k)
+    {
+        uint32_t j = i, base = dfa->bases[k];
+        while (j < size && set[j] < dfa->bases[k + 1])
+            j += 1;
+
+        if (j > i)
+        {
+            uint32_t *local = NULL, l;
+            arrst_clear(dfa->local, NULL, uint32_t);
+            arrst_clear(dfa->next, NULL, uint32_t);
+            local = arrst_new_n(dfa->local, j - i, uint32_t);
+            for (l = 0; l < j - i; ++l)
+                local[l] = set[i + l] - base;
+
+            _nfa_move(dfa->nfas[k], local, j - i, codepoint, dfa->next);
+            arrst_foreach_const(v, dfa->next, uint32_t)
+                arrst_append(out, *v + base, uint32_t);
+            arrst_end()
+        }
+
+        i = j;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_transition(DFA *dfa, const uint32_t state, const uint32_t cls)
+{
+    const DState *dstate = arrst_get_const(dfa->states, state, DState);
+    const uint32_t *set = arrst_all_const(dfa->sets, uint32_t) + dstate->offset;
+    uint32_t next = DEAD;
+
+    /* All code points in a class behave the same. The first one represents the class */
+    i_move(dfa, set, dstate->size, *arrst_get_const(dfa->bounds, cls, uint32_t), dfa->temp);
+    if (dfa->search == TRUE)
+        i_add_start(dfa, dfa->temp);
+
+    if (arrst_size(dfa->temp, uint32_t) > 0)
+    {
+        next = i_state(dfa, dfa->temp);
+        if (next == UNKNOWN)
+        {
+            dfa->overflow = TRUE;
+            return UNKNOWN;
+        }
+    }
+
+    dfa->table[state * dfa->nclasses + cls] = next;
+    return next;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Next state from the code point at '*str'. UNKNOWN if the cache is full */
+static ___INLINE uint32_t i_step(DFA *dfa, const uint32_t state, const char_t **str)
+{
+    const char_t *s = *str;
+    byte_t c = (byte_t)*s;
+    uint32_t cls, next;
+    if (c < 128)
+    {
+        cls = dfa->ascii[c];
+        s += 1;
+    }
+    else
+    {
+        cls = i_class(dfa, unicode_to_u32(s, ekUTF8));
+        s = unicode_next(s, ekUTF8);
+    }
+
+    *str = s;
+    next = dfa->table[state * dfa->nclasses + cls];
+    if (next == UNKNOWN)
+        next = i_transition(dfa, state, cls);
+    return next;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE bool_t i_accept(const DFA *dfa, const uint32_t state)
+{
+    return (bool_t)(arrst_get_const(dfa->states, state, DState)->naccepts > 0);
+}
+
+/*---------------------------------------------------------------------------*/
+
+DFA *_dfa_create(NFA **nfas, const uint32_t n, const bool_t search)
+{
+    DFA *dfa = heap_new0(DFA);
+    uint32_t i, start;
+    cassert_no_null(nfas);
+    cassert(n > 0);
+    dfa->nfas = nfas;
+    dfa->nnfas = n;
+    dfa->bases = heap_new_n(n + 1, uint32_t);
+    dfa->search = search;
+    dfa->bounds = arrst_create(uint32_t);
+    dfa->states = arrst_create(DState);
+    dfa->sets = arrst_create(uint32_t);
+    dfa->accepts = arrst_create(uint32_t);
+    dfa->start = arrst_create(uint32_t);
+    dfa->temp = arrst_create(uint32_t);
+    dfa->local = arrst_create(uint32_t);
+    dfa->next = arrst_create(uint32_t);
+    dfa->bases[0] = 0;
+    for (i = 0; i < n; ++i)
+    {
+        dfa->bases[i + 1] = dfa->bases[i] + _nfa_accept_state(nfas[i]) + 1;
+        _nfa_bounds(nfas[i], dfa->bounds);
+
+        /* Start states (sorted, as the NFA ranges don't overlap) */
+        arrst_clear(dfa->next, NULL, uint32_t);
+        _nfa_closure(nfas[i], 0, dfa->next);
+        arrst_foreach_const(v, dfa->next, uint32_t)
+            arrst_append(dfa->start, *v + dfa->bases[i], uint32_t);
+        arrst_end()
+    }
+
+    dfa->nclasses = arrst_size(dfa->bounds, uint32_t);
+    for (i = 0; i < 128; ++i)
+        dfa->ascii[i] = i_class(dfa, i);
+
+    dfa->ncells = dfa->nclasses * 16;
+    dfa->table = heap_new_n(dfa->ncells, uint32_t);
+    dfa->overflow = FALSE;
+    i_rehash(dfa, 32);
+
+    /* Too many classes for the cache */
+    start = i_state(dfa, dfa->start);
+    if (start == UNKNOWN)
+        dfa->overflow = TRUE;
+    cassert(start == 0 || start == UNKNOWN);
+    return dfa;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _dfa_destroy(DFA **dfa)
+{
+    cassert_no_null(dfa);
+    cassert_no_null(*dfa);
+    heap_delete_n(&(*dfa)->bases, (*dfa)->nnfas + 1, uint32_t);
+    arrst_destroy(&(*dfa)->bounds, NULL, uint32_t);
+    arrst_destroy(&(*dfa)->states, NULL, DState);
+    arrst_destroy(&(*dfa)->sets, NULL, uint32_t);
+    arrst_destroy(&(*dfa)->accepts, NULL, uint32_t);
+    arrst_destroy(&(*dfa)->start, NULL, uint32_t);
+    arrst_destroy(&(*dfa)->temp, NULL, uint32_t);
+    arrst_destroy(&(*dfa)->local, NULL, uint32_t);
+    arrst_destroy(&(*dfa)->next, NULL, uint32_t);
+    heap_delete_n(&(*dfa)->table, (*dfa)->ncells, uint32_t);
+    heap_delete_n(&(*dfa)->slots, (*dfa)->nslots, uint32_t);
+    heap_delete(dfa, DFA);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _dfa_match(DFA *dfa, const char_t *str, const uint32_t **accepts, uint32_t *naccepts)
+{
+    const char_t *s = str;
+    uint32_t state = 0;
+    const DState *dstate = NULL;
+    cassert_no_null(dfa);
+    cassert_no_null(str);
+    cassert_no_null(accepts);
+    cassert_no_null(naccepts);
+    cassert(dfa->search == FALSE);
+    if (dfa->overflow == TRUE)
+        return FALSE;
+
+    while (*s != '\0')
+    {
+        uint32_t next = i_step(dfa, state, &s);
+        if (next == UNKNOWN)
+            return FALSE;
+
+        if (next == DEAD)
+        {
+            *accepts = NULL;
+            *naccepts = 0;
+            return TRUE;
+        }
+
+        state = next;
+    }
+
+    dstate = arrst_get_const(dfa->states, state, DState);
+    *accepts = arrst_all_const(dfa->accepts, uint32_t) + dstate->aoffset;
+    *naccepts = dstate->naccepts;
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _dfa_longest(DFA *dfa, const char_t *str, uint32_t *size, uint32_t *read)
+{
+    const char_t *s = str;
+    uint32_t state = 0;
+    cassert_no_null(dfa);
+    cassert_no_null(str);
+    cassert_no_null(size);
+    cassert_no_null(read);
+    cassert(dfa->search == FALSE);
+    if (dfa->overflow == TRUE)
+        return FALSE;
+
+    *size = i_accept(dfa, 0) == TRUE ? 0 : UINT32_MAX;
+    while (*s != '\0')
+    {
+        uint32_t next = i_step(dfa, state, &s);
+        if (next == UNKNOWN)
+            return FALSE;
+
+        if (next == DEAD)
+            break;
+
+        state = next;
+        if (i_accept(dfa, state) == TRUE)
+            *size = (uint32_t)(s - str);
+    }
+
+    *read = (uint32_t)(s - str);
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _dfa_first_end(DFA *dfa, const char_t *str, uint32_t *end)
+{
+    const char_t *s = str;
+    uint32_t state = 0;
+    cassert_no_null(dfa);
+    cassert_no_null(str);
+    cassert_no_null(end);
+    cassert(dfa->search == TRUE);
+    if (dfa->overflow == TRUE)
+        return FALSE;
+
+    if (i_accept(dfa, 0) == TRUE)
+    {
+        *end = 0;
+        return TRUE;
+    }
+
+    while (*s != '\0')
+    {
+        uint32_t next = i_step(dfa, state, &s);
+        if (next == UNKNOWN)
+            return FALSE;
+
+        /* Start states are always alive in search mode */
+        cassert(next != DEAD);
+        state = next;
+        if (i_accept(dfa, state) == TRUE)
+        {
+            *end = (uint32_t)(s - str);
+            return TRUE;
+        }
+    }
+
+    *end = UINT32_MAX;
+    return TRUE;
+}
@@ -0,0 +1,27 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: dfa.inl
+ *
+ */
+
+/* Deterministic finite automata */
+
+#include "core.ixx"
+
+__EXTERN_C
+
+DFA *_dfa_create(NFA **nfas, const uint32_t n, const bool_t search);
+
+void _dfa_destroy(DFA **dfa);
+
+bool_t _dfa_match(DFA *dfa, const char_t *str, const uint32_t **accepts, uint32_t *naccepts);
+
+bool_t _dfa_longest(DFA *dfa, const char_t *str, uint32_t *size, uint32_t *read);
+
+bool_t _dfa_first_end(DFA *dfa, const char_t *str, uint32_t *end);
+
+__END_C
@@ -0,0 +1,380 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: hash.c
+ *
+ */
+
+/* Open addressing hash tables */
+
+#include "bhash.h"
+#include "heap.h"
+#include "strings.h"
+#include <sewer/bmem.h>
+#include <sewer/cassert.h>
+
+/*
+ * Linear probing over two flat arrays: 'hashes' (0 = empty slot) and 'data'
+ * (elements stored in place). The full hash of each element is kept, so
+ * probing compares elements only on hash match and rehashing never calls
+ * 'func_hash'. Deletion shifts back the following elements (no tombstones).
+ * Insertions and deletions can move the elements in memory.
+ */
+struct _hash_t
+{
+    uint32_t elems;
+    uint32_t capacity;
+    uint16_t esize;
+    uint16_t ksize;
+    uint32_t it;
+    uint32_t *hashes;
+    byte_t *data;
+    FPtr_hash func_hash;
+    FPtr_compare func_compare;
+    String *ktype;
+};
+
+#define i_MINIMUN_CAPACITY 16
+
+/*---------------------------------------------------------------------------*/
+
+Hash *hash_create(FPtr_hash func_hash, FPtr_compare func_compare, const uint16_t esize, const uint16_t ksize, const char_t *type, const char_t *ktype)
+{
+    Hash *hash = cast(heap_malloc(sizeof(Hash), type), Hash);
+    cassert_no_nullf(func_compare);
+    cassert(func_hash != NULL || ksize > 0);
+    hash->elems = 0;
+    hash->capacity = 0;
+    hash->esize = esize;
+    hash->ksize = ksize;
+    hash->it = 0;
+    hash->hashes = NULL;
+    hash->data = NULL;
+    hash->func_hash = func_hash;
+    hash->func_compare = func_compare;
+    hash->ktype = str_c(ktype);
+    return hash;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_destroy(Hash **hash, FPtr_remove func_remove, FPtr_destroy func_destroy, const char_t *type)
+{
+    cassert_no_null(hash);
+    cassert_no_null(*hash);
+    if ((*hash)->capacity > 0)
+    {
+        if (func_remove != NULL || func_destroy != NULL)
+        {
+            uint32_t i;
+            for (i = 0; i < (*hash)->capacity; ++i)
+            {
+                if ((*hash)->hashes[i] != 0)
+                {
+                    byte_t *elem = (*hash)->data + i * (*hash)->esize;
+                    if (func_remove != NULL)
+                        func_remove(cast(elem, void));
+                    else
+                        func_destroy(dcast(elem, void));
+                }
+            }
+        }
+
+        heap_delete_n(&(*hash)->hashes, (*hash)->capacity, uint32_t);
+        heap_free(&(*hash)->data, (*hash)->capacity * (*hash)->esize, "HashData");
+    }
+
+    str_destroy(&(*hash)->ktype);
+    heap_free(dcast(hash, byte_t), sizeof(Hash), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void hash_destroy(Hash **hash, FPtr_remove func_remove, const char_t *type)
+{
+    i_destroy(hash, func_remove, NULL, type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void hash_destroy_ptr(Hash **hash, FPtr_destroy func_destroy, const char_t *type)
+{
+    cassert_no_null(hash);
+    cassert_no_null(*hash);
+    cassert((*hash)->esize == sizeofptr);
+    i_destroy(hash, NULL, func_destroy, type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t hash_size(const Hash *hash)
+{
+    cassert_no_null(hash);
+    return hash->elems;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint32_t i_hash(const Hash *hash, const void *key)
+{
+    uint32_t h = 0;
+    if (hash->func_hash != NULL)
+        h = hash->func_hash(key);
+    else
+        h = bhash_from_block(cast_const(key, byte_t), hash->ksize);
+
+    /* Final mix. User hash functions may be weak in the low bits */
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+
+    /* Zero is reserved for empty slots */
+    return h != 0 ? h : 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_find(const Hash *hash, const void *key, const uint32_t h, const bool_t isptr)
+{
+    cassert_no_null(hash);
+    if (hash->capacity > 0)
+    {
+        uint32_t mask = hash->capacity - 1;
+        uint32_t i = h & mask;
+        while (hash->hashes[i] != 0)
+        {
+            if (hash->hashes[i] == h)
+            {
+                byte_t *elem = hash->data + i * hash->esize;
+                if (hash->func_compare(isptr == TRUE ? *dcast(elem, byte_t) : elem, key) == 0)
+                    return i;
+            }
+
+            i = (i + 1) & mask;
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *hash_get(const Hash *hash, const void *key, const bool_t isptr, const char_t *ktype)
+{
+    uint32_t i;
+    cassert_no_null(hash);
+    cassert_unref(str_equ(hash->ktype, ktype) == TRUE, ktype);
+    i = i_find(hash, key, i_hash(hash, key), isptr);
+    if (i != UINT32_MAX)
+    {
+        byte_t *elem = hash->data + i * hash->esize;
+        return isptr ? *dcast(elem, byte_t) : elem;
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_rehash(Hash *hash, const uint32_t capacity)
+{
+    uint32_t *hashes = heap_new_n0(capacity, uint32_t);
+    byte_t *data = heap_malloc(capacity * hash->esize, "HashData");
+    uint32_t mask = capacity - 1;
+    uint32_t i;
+
+    for (i = 0; i < hash->capacity; ++i)
+    {
+        uint32_t h = hash->hashes[i];
+        if (h != 0)
+        {
+            uint32_t j = h & mask;
+            while (hashes[j] != 0)
+                j = (j + 1) & mask;
+            hashes[j] = h;
+            bmem_copy(data + j * hash->esize, hash->data + i * hash->esize, hash->esize);
+        }
+    }
+
+    if (hash->capacity > 0)
+    {
+        heap_delete_n(&hash->hashes, hash->capacity, uint32_t);
+        heap_free(&hash->data, hash->capacity * hash->esize, "HashData");
+    }
+
+    hash->hashes = hashes;
+    hash->data = data;
+    hash->capacity = capacity;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static byte_t *i_insert(Hash *hash, const void *key, const bool_t isptr)
+{
+    uint32_t h, i, mask;
+    cassert_no_null(hash);
+    h = i_hash(hash, key);
+    if (i_find(hash, key, h, isptr) != UINT32_MAX)
+        return NULL;
+
+    /* Max load factor 3/4 */
+    if ((hash->elems + 1) * 4 > hash->capacity * 3)
+        i_rehash(hash, hash->capacity > 0 ? hash->capacity * 2 : i_MINIMUN_CAPACITY);
+
+    mask = hash->capacity - 1;
+    i = h & mask;
+    while (hash->hashes[i] != 0)
+        i = (i + 1) & mask;
+
+    hash->hashes[i] = h;
+    hash->elems += 1;
+    return hash->data + i * hash->esize;
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *hash_insert(Hash *hash, const void *key, const char_t *ktype)
+{
+    cassert_no_null(hash);
+    cassert_unref(str_equ(hash->ktype, ktype) == TRUE, ktype);
+    return i_insert(hash, key, FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t hash_insert_ptr(Hash *hash, const void *key, void *ptr, const char_t *ktype)
+{
+    byte_t *elem = NULL;
+    cassert_no_null(hash);
+    cassert_unref(str_equ(hash->ktype, ktype) == TRUE, ktype);
+    cassert(hash->esize == sizeofptr);
+    elem = i_insert(hash, key, TRUE);
+    if (elem != NULL)
+    {
+        *dcast(elem, void) = ptr;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_remove_slot(Hash *hash, const uint32_t slot)
+{
+    uint32_t mask = hash->capacity - 1;
+    uint32_t i = slot;
+    uint32_t j = (slot + 1) & mask;
+
+    /* Backward shift of the elements displaced by 'slot' */
+    while (hash->hashes[j] != 0)
+    {
+        uint32_t k = hash->hashes[j] & mask;
+        if (((j - k) & mask) >= ((j - i) & mask))
+        {
+            hash->hashes[i] = hash->hashes[j];
+            bmem_copy(hash->data + i * hash->esize, hash->data + j * hash->esize, hash->esize);
+            i = j;
+        }
+
+        j = (j + 1) & mask;
+    }
+
+    hash->hashes[i] = 0;
+    hash->elems -= 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t hash_delete(Hash *hash, const void *key, FPtr_remove func_remove, const char_t *ktype)
+{
+    uint32_t i;
+    cassert_no_null(hash);
+    cassert_unref(str_equ(hash->ktype, ktype) == TRUE, ktype);
+    i = i_find(hash, key, i_hash(hash, key), FALSE);
+    if (i != UINT32_MAX)
+    {
+        if (func_remove != NULL)
+            func_remove(hash->data + i * hash->esize);
+        i_remove_slot(hash, i);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t hash_delete_ptr(Hash *hash, const void *key, FPtr_destroy func_destroy, const char_t *ktype)
+{
+    uint32_t i;
+    cassert_no_null(hash);
+    cassert_unref(str_equ(hash->ktype, ktype) == TRUE, ktype);
+    cassert(hash->esize == sizeofptr);
+    i = i_find(hash, key, i_hash(hash, key), TRUE);
+    if (i != UINT32_MAX)
+    {
+        if (func_destroy != NULL)
+            func_destroy(dcast(hash->data + i * hash->esize, void));
+        i_remove_slot(hash, i);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static byte_t *i_next(Hash *hash, const uint32_t from)
+{
+    uint32_t i;
+    cassert_no_null(hash);
+    for (i = from; i < hash->capacity; ++i)
+    {
+        if (hash->hashes[i] != 0)
+        {
+            hash->it = i;
+            return hash->data + i * hash->esize;
+        }
+    }
+
+    hash->it = hash->capacity;
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *hash_first(Hash *hash)
+{
+    return i_next(hash, 0);
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *hash_next(Hash *hash)
+{
+    cassert_no_null(hash);
+    cassert(hash->it < hash->capacity);
+    return i_next(hash, hash->it + 1);
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *hash_first_ptr(Hash *hash)
+{
+    byte_t *elem = hash_first(hash);
+    return elem != NULL ? *dcast(elem, byte_t) : NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *hash_next_ptr(Hash *hash)
+{
+    byte_t *elem = hash_next(hash);
+    return elem != NULL ? *dcast(elem, byte_t) : NULL;
+}
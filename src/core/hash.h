@@ -0,0 +1,43 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: hash.h
+ *
+ */
+
+/* Open addressing hash tables */
+
+#include "core.hxx"
+
+__EXTERN_C
+
+_core_api Hash *hash_create(FPtr_hash func_hash, FPtr_compare func_compare, const uint16_t esize, const uint16_t ksize, const char_t *type, const char_t *ktype);
+
+_core_api void hash_destroy(Hash **hash, FPtr_remove func_remove, const char_t *type);
+
+_core_api void hash_destroy_ptr(Hash **hash, FPtr_destroy func_destroy, const char_t *type);
+
+_core_api uint32_t hash_size(const Hash *hash);
+
+_core_api byte_t *hash_get(const Hash *hash, const void *key, const bool_t isptr, const char_t *ktype);
+
+_core_api byte_t *hash_insert(Hash *hash, const void *key, const char_t *ktype);
+
+_core_api bool_t hash_insert_ptr(Hash *hash, const void *key, void *ptr, const char_t *ktype);
+
+_core_api bool_t hash_delete(Hash *hash, const void *key, FPtr_remove func_remove, const char_t *ktype);
+
+_core_api bool_t hash_delete_ptr(Hash *hash, const void *key, FPtr_destroy func_destroy, const char_t *ktype);
+
+_core_api byte_t *hash_first(Hash *hash);
+
+_core_api byte_t *hash_next(Hash *hash);
+
+_core_api byte_t *hash_first_ptr(Hash *hash);
+
+_core_api byte_t *hash_next_ptr(Hash *hash);
+
+__END_C
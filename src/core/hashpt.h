@@ -0,0 +1,79 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: hashpt.h
+ *
+ */
+
+/* Pointer hash tables */
+
+#define hashpt_create(func_hash, func_compare, type, ktype) \
+    (FUNC_CHECK_HASH(func_hash, ktype), \
+     FUNC_CHECK_COMPARE_KEY(func_compare, type, ktype), \
+     hashpt_##type##_create((FPtr_hash)func_hash, (FPtr_compare)func_compare, (uint16_t)sizeof(type *), (uint16_t)sizeof(ktype), cast_const(#ktype, char_t)))
+
+#define hashpt_destroy(hash, func_destroy, type) \
+    hashpt_##type##_destroy(hash, func_destroy)
+
+#define hashpt_size(hash, type) \
+    hashpt_##type##_size(hash)
+
+#define hashpt_get(hash, key, type, ktype) \
+    ((void)((key) == cast_const(key, ktype)), \
+     hashpt_##type##_get(hash, cast_const(key, void), cast_const(#ktype, char_t)))
+
+#define hashpt_get_const(hash, key, type, ktype) \
+    ((void)((key) == cast_const(key, ktype)), \
+     hashpt_##type##_get_const(hash, cast_const(key, void), cast_const(#ktype, char_t)))
+
+#define hashpt_insert(hash, key, ptr, type, ktype) \
+    ((void)((key) == cast_const(key, ktype)), \
+     hashpt_##type##_insert(hash, cast_const(key, void), ptr, cast_const(#ktype, char_t)))
+
+#define hashpt_delete(hash, key, func_destroy, type, ktype) \
+    ((void)((key) == cast_const(key, ktype)), \
+     FUNC_CHECK_DESTROY(func_destroy, type), \
+     hashpt_##type##_delete(hash, cast_const(key, void), (FPtr_destroy)func_destroy, cast_const(#ktype, char_t)))
+
+#define hashpt_first(hash, type) \
+    hashpt_##type##_first(hash)
+
+#define hashpt_first_const(hash, type) \
+    hashpt_##type##_first_const(hash)
+
+#define hashpt_next(hash, type) \
+    hashpt_##type##_next(hash)
+
+#define hashpt_next_const(hash, type) \
+    hashpt_##type##_next_const(hash)
+
+#define hashpt_foreach(elem, hash, type) \
+    { \
+        type *elem = hashpt_first(hash, type); \
+        uint32_t elem##_i = 0, elem##_total = hashpt_size(hash, type); \
+        while (elem != NULL) \
+        {
+
+#define hashpt_foreach_const(elem, hash, type) \
+    { \
+        const type *elem = hashpt_first_const(hash, type); \
+        uint32_t elem##_i = 0, elem##_total = hashpt_size(hash, type); \
+        while (elem != NULL) \
+        {
+
+#define hashpt_fornext(elem, hash, type) \
+    elem = hashpt_next(hash, type); \
+    elem##_i += 1; \
+    unref(elem##_total); \
+    } \
+    }
+
+#define hashpt_fornext_const(elem, hash, type) \
+    elem = hashpt_next_const(hash, type); \
+    elem##_i += 1; \
+    unref(elem##_total); \
+    } \
+    }
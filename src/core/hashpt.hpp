@@ -0,0 +1,156 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: hashpt.hpp
+ *
+ */
+
+/* Pointer hash tables */
+
+#ifndef __HASHPT_HPP__
+#define __HASHPT_HPP__
+
+#include <sewer/bstd.h>
+#include <sewer/nowarn.hxx>
+#include <typeinfo>
+#include <sewer/warn.hxx>
+
+template < class type >
+struct HashPt
+{
+    static void destroy(HashPt< type > **hash, void (*func_destroy)(type **));
+
+    static uint32_t size(const HashPt< type > *hash);
+
+    static type *first(HashPt< type > *hash);
+
+    static const type *first(const HashPt< type > *hash);
+
+    static type *next(HashPt< type > *hash);
+
+    static const type *next(const HashPt< type > *hash);
+
+#if defined __ASSERTS__
+    // Only for debugger inspector (non used)
+    uint32_t elems;
+    uint32_t capacity;
+    uint16_t esize;
+    uint16_t ksize;
+    uint32_t it;
+    uint32_t *hashes;
+    type **data;
+    FPtr_hash func_hash;
+    FPtr_compare func_compare;
+#endif
+};
+
+template < typename type, typename dtype >
+struct HashP2
+{
+    static HashPt< type > *create(uint32_t(func_hash)(const dtype *), int(func_compare)(const type *, const dtype *));
+
+    static type *get(HashPt< type > *hash, const dtype *key);
+
+    static const type *get(const HashPt< type > *hash, const dtype *key);
+
+    static bool_t insert(HashPt< type > *hash, const dtype *key, type *ptr);
+
+    static bool_t ddelete(HashPt< type > *hash, const dtype *key, void (*func_destroy)(type **));
+};
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+HashPt< type > *HashP2< type, dtype >::create(uint32_t(func_hash)(const dtype *), int(func_compare)(const type *, const dtype *))
+{
+    char_t ltype[64];
+    bstd_sprintf(ltype, sizeof(ltype), "HashPt<%s>", typeid(type).name());
+    return cast(hash_create((FPtr_hash)func_hash, (FPtr_compare)func_compare, (uint16_t)sizeof(type *), (uint16_t)sizeof(dtype), ltype, typeid(dtype).name()), HashPt< type >);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+void HashPt< type >::destroy(HashPt< type > **hash, void (*func_destroy)(type **))
+{
+    char_t ltype[64];
+    bstd_sprintf(ltype, sizeof(ltype), "HashPt<%s>", typeid(type).name());
+    hash_destroy_ptr(dcast(hash, Hash), (FPtr_destroy)func_destroy, ltype);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+uint32_t HashPt< type >::size(const HashPt< type > *hash)
+{
+    return hash_size(cast_const(hash, Hash));
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+type *HashP2< type, dtype >::get(HashPt< type > *hash, const dtype *key)
+{
+    return cast(hash_get(cast_const(hash, Hash), cast_const(key, void), TRUE, typeid(dtype).name()), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+const type *HashP2< type, dtype >::get(const HashPt< type > *hash, const dtype *key)
+{
+    return cast_const(hash_get(cast_const(hash, Hash), cast_const(key, void), TRUE, typeid(dtype).name()), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+bool_t HashP2< type, dtype >::insert(HashPt< type > *hash, const dtype *key, type *ptr)
+{
+    return hash_insert_ptr(cast(hash, Hash), cast_const(key, void), cast(ptr, void), typeid(dtype).name());
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+bool_t HashP2< type, dtype >::ddelete(HashPt< type > *hash, const dtype *key, void (*func_destroy)(type **))
+{
+    return hash_delete_ptr(cast(hash, Hash), cast_const(key, void), (FPtr_destroy)func_destroy, typeid(dtype).name());
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+type *HashPt< type >::first(HashPt< type > *hash)
+{
+    return cast(hash_first_ptr(cast(hash, Hash)), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+const type *HashPt< type >::first(const HashPt< type > *hash)
+{
+    return cast_const(hash_first_ptr(cast(hash, Hash)), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+type *HashPt< type >::next(HashPt< type > *hash)
+{
+    return cast(hash_next_ptr(cast(hash, Hash)), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+const type *HashPt< type >::next(const HashPt< type > *hash)
+{
+    return cast_const(hash_next_ptr(cast(hash, Hash)), type);
+}
+
+#endif
@@ -0,0 +1,96 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: hashpt.hxx
+ *
+ */
+
+/* Pointer hash table macros for type checking at compile time */
+
+#define HashPtDebug(type) \
+    struct Hash##Pt##type \
+    { \
+        uint32_t elems; \
+        uint32_t capacity; \
+        uint16_t esize; \
+        uint16_t ksize; \
+        uint32_t it; \
+        uint32_t *hashes; \
+        type **data; \
+        FPtr_hash func_hash; \
+        FPtr_compare func_compare; \
+    }
+
+#define HashPtFuncs(type) \
+    HashPt(type); \
+\
+    static __TYPECHECK HashPt(type) *hashpt_##type##_create(FPtr_hash func_hash, FPtr_compare func_compare, const uint16_t esize, const uint16_t ksize, const char_t *ktype); \
+    static HashPt(type) *hashpt_##type##_create(FPtr_hash func_hash, FPtr_compare func_compare, const uint16_t esize, const uint16_t ksize, const char_t *ktype) \
+    { \
+        return cast(hash_create(func_hash, func_compare, esize, ksize, cast_const(HASHPT #type, char_t), ktype), HashPt(type)); \
+    } \
+\
+    static __TYPECHECK void hashpt_##type##_destroy(struct Hash##Pt##type **hash, void(func_destroy)(type **)); \
+    static void hashpt_##type##_destroy(struct Hash##Pt##type **hash, void(func_destroy)(type **)) \
+    { \
+        hash_destroy_ptr(dcast(hash, Hash), (FPtr_destroy)func_destroy, cast_const(HASHPT #type, char_t)); \
+    } \
+\
+    static __TYPECHECK uint32_t hashpt_##type##_size(const struct Hash##Pt##type *hash); \
+    static uint32_t hashpt_##type##_size(const struct Hash##Pt##type *hash) \
+    { \
+        return hash_size(cast_const(hash, Hash)); \
+    } \
+\
+    static __TYPECHECK type *hashpt_##type##_get(struct Hash##Pt##type *hash, const void *key, const char_t *ktype); \
+    static type *hashpt_##type##_get(struct Hash##Pt##type *hash, const void *key, const char_t *ktype) \
+    { \
+        return cast(hash_get(cast_const(hash, Hash), key, TRUE, ktype), type); \
+    } \
+\
+    static __TYPECHECK const type *hashpt_##type##_get_const(const struct Hash##Pt##type *hash, const void *key, const char_t *ktype); \
+    static const type *hashpt_##type##_get_const(const struct Hash##Pt##type *hash, const void *key, const char_t *ktype) \
+    { \
+        return cast_const(hash_get(cast_const(hash, Hash), key, TRUE, ktype), type); \
+    } \
+\
+    static __TYPECHECK bool_t hashpt_##type##_insert(struct Hash##Pt##type *hash, const void *key, type *ptr, const char_t *ktype); \
+    static bool_t hashpt_##type##_insert(struct Hash##Pt##type *hash, const void *key, type *ptr, const char_t *ktype) \
+    { \
+        return hash_insert_ptr(cast(hash, Hash), key, cast(ptr, void), ktype); \
+    } \
+\
+    static __TYPECHECK bool_t hashpt_##type##_delete(struct Hash##Pt##type *hash, const void *key, FPtr_destroy func_destroy, const char_t *ktype); \
+    static bool_t hashpt_##type##_delete(struct Hash##Pt##type *hash, const void *key, FPtr_destroy func_destroy, const char_t *ktype) \
+    { \
+        return hash_delete_ptr(cast(hash, Hash), key, func_destroy, ktype); \
+    } \
+\
+    static __TYPECHECK type *hashpt_##type##_first(struct Hash##Pt##type *hash); \
+    static type *hashpt_##type##_first(struct Hash##Pt##type *hash) \
+    { \
+        return cast(hash_first_ptr(cast(hash, Hash)), type); \
+    } \
+\
+    static __TYPECHECK const type *hashpt_##type##_first_const(const struct Hash##Pt##type *hash); \
+    static const type *hashpt_##type##_first_const(const struct Hash##Pt##type *hash) \
+    { \
+        return cast_const(hash_first_ptr(cast(hash, Hash)), type); \
+    } \
+\
+    static __TYPECHECK type *hashpt_##type##_next(struct Hash##Pt##type *hash); \
+    static type *hashpt_##type##_next(struct Hash##Pt##type *hash) \
+    { \
+        return cast(hash_next_ptr(cast(hash, Hash)), type); \
+    } \
+\
+    static __TYPECHECK const type *hashpt_##type##_next_const(const struct Hash##Pt##type *hash); \
+    static const type *hashpt_##type##_next_const(const struct Hash##Pt##type *hash) \
+    { \
+        return cast_const(hash_next_ptr(cast(hash, Hash)), type); \
+    } \
+\
+    typedef struct _hashptend##type##_t hashptend##type
@@ -0,0 +1,79 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: hashst.h
+ *
+ */
+
+/* Hash tables */
+
+#define hashst_create(func_hash, func_compare, type, ktype) \
+    (FUNC_CHECK_HASH(func_hash, ktype), \
+     FUNC_CHECK_COMPARE_KEY(func_compare, type, ktype), \
+     hashst_##type##_create((FPtr_hash)func_hash, (FPtr_compare)func_compare, (uint16_t)sizeof(type), (uint16_t)sizeof(ktype), cast_const(#ktype, char_t)))
+
+#define hashst_destroy(hash, func_remove, type) \
+    hashst_##type##_destroy(hash, func_remove)
+
+#define hashst_size(hash, type) \
+    hashst_##type##_size(hash)
+
+#define hashst_get(hash, key, type, ktype) \
+    ((void)((key) == cast_const(key, ktype)), \
+     hashst_##type##_get(hash, cast_const(key, void), cast_const(#ktype, char_t)))
+
+#define hashst_get_const(hash, key, type, ktype) \
+    ((void)((key) == cast_const(key, ktype)), \
+     hashst_##type##_get_const(hash, cast_const(key, void), cast_const(#ktype, char_t)))
+
+#define hashst_insert(hash, key, type, ktype) \
+    ((void)((key) == cast_const(key, ktype)), \
+     hashst_##type##_insert(hash, cast_const(key, void), cast_const(#ktype, char_t)))
+
+#define hashst_delete(hash, key, func_remove, type, ktype) \
+    ((void)((key) == cast_const(key, ktype)), \
+     FUNC_CHECK_REMOVE(func_remove, type), \
+     hashst_##type##_delete(hash, cast_const(key, void), (FPtr_remove)func_remove, cast_const(#ktype, char_t)))
+
+#define hashst_first(hash, type) \
+    hashst_##type##_first(hash)
+
+#define hashst_first_const(hash, type) \
+    hashst_##type##_first_const(hash)
+
+#define hashst_next(hash, type) \
+    hashst_##type##_next(hash)
+
+#define hashst_next_const(hash, type) \
+    hashst_##type##_next_const(hash)
+
+#define hashst_foreach(elem, hash, type) \
+    { \
+        type *elem = hashst_first(hash, type); \
+        uint32_t elem##_i = 0, elem##_total = hashst_size(hash, type); \
+        while (elem != NULL) \
+        {
+
+#define hashst_foreach_const(elem, hash, type) \
+    { \
+        const type *elem = hashst_first_const(hash, type); \
+        uint32_t elem##_i = 0, elem##_total = hashst_size(hash, type); \
+        while (elem != NULL) \
+        {
+
+#define hashst_fornext(elem, hash, type) \
+    elem = hashst_next(hash, type); \
+    elem##_i += 1; \
+    unref(elem##_total); \
+    } \
+    }
+
+#define hashst_fornext_const(elem, hash, type) \
+    elem = hashst_next_const(hash, type); \
+    elem##_i += 1; \
+    unref(elem##_total); \
+    } \
+    }
@@ -0,0 +1,156 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: hashst.hpp
+ *
+ */
+
+/* Hash tables */
+
+#ifndef __HASHST_HPP__
+#define __HASHST_HPP__
+
+#include <sewer/bstd.h>
+#include <sewer/nowarn.hxx>
+#include <typeinfo>
+#include <sewer/warn.hxx>
+
+template < class type >
+struct HashSt
+{
+    static void destroy(HashSt< type > **hash, void (*func_remove)(type *));
+
+    static uint32_t size(const HashSt< type > *hash);
+
+    static type *first(HashSt< type > *hash);
+
+    static const type *first(const HashSt< type > *hash);
+
+    static type *next(HashSt< type > *hash);
+
+    static const type *next(const HashSt< type > *hash);
+
+#if defined __ASSERTS__
+    // Only for debugger inspector (non used)
+    uint32_t elems;
+    uint32_t capacity;
+    uint16_t esize;
+    uint16_t ksize;
+    uint32_t it;
+    uint32_t *hashes;
+    type *data;
+    FPtr_hash func_hash;
+    FPtr_compare func_compare;
+#endif
+};
+
+template < typename type, typename dtype >
+struct HashS2
+{
+    static HashSt< type > *create(uint32_t(func_hash)(const dtype *), int(func_compare)(const type *, const dtype *));
+
+    static type *get(HashSt< type > *hash, const dtype *key);
+
+    static const type *get(const HashSt< type > *hash, const dtype *key);
+
+    static type *insert(HashSt< type > *hash, const dtype *key);
+
+    static bool_t ddelete(HashSt< type > *hash, const dtype *key, void (*func_remove)(type *));
+};
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+HashSt< type > *HashS2< type, dtype >::create(uint32_t(func_hash)(const dtype *), int(func_compare)(const type *, const dtype *))
+{
+    char_t ltype[64];
+    bstd_sprintf(ltype, sizeof(ltype), "HashSt<%s>", typeid(type).name());
+    return cast(hash_create((FPtr_hash)func_hash, (FPtr_compare)func_compare, (uint16_t)sizeof(type), (uint16_t)sizeof(dtype), ltype, typeid(dtype).name()), HashSt< type >);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+void HashSt< type >::destroy(HashSt< type > **hash, void (*func_remove)(type *))
+{
+    char_t ltype[64];
+    bstd_sprintf(ltype, sizeof(ltype), "HashSt<%s>", typeid(type).name());
+    hash_destroy(dcast(hash, Hash), (FPtr_remove)func_remove, ltype);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+uint32_t HashSt< type >::size(const HashSt< type > *hash)
+{
+    return hash_size(cast_const(hash, Hash));
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+type *HashS2< type, dtype >::get(HashSt< type > *hash, const dtype *key)
+{
+    return cast(hash_get(cast_const(hash, Hash), cast_const(key, void), FALSE, typeid(dtype).name()), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+const type *HashS2< type, dtype >::get(const HashSt< type > *hash, const dtype *key)
+{
+    return cast_const(hash_get(cast_const(hash, Hash), cast_const(key, void), FALSE, typeid(dtype).name()), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+type *HashS2< type, dtype >::insert(HashSt< type > *hash, const dtype *key)
+{
+    return cast(hash_insert(cast(hash, Hash), cast_const(key, void), typeid(dtype).name()), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type, typename dtype >
+bool_t HashS2< type, dtype >::ddelete(HashSt< type > *hash, const dtype *key, void (*func_remove)(type *))
+{
+    return hash_delete(cast(hash, Hash), cast_const(key, void), (FPtr_remove)func_remove, typeid(dtype).name());
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+type *HashSt< type >::first(HashSt< type > *hash)
+{
+    return cast(hash_first(cast(hash, Hash)), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+const type *HashSt< type >::first(const HashSt< type > *hash)
+{
+    return cast_const(hash_first(cast(hash, Hash)), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+type *HashSt< type >::next(HashSt< type > *hash)
+{
+    return cast(hash_next(cast(hash, Hash)), type);
+}
+
+/*---------------------------------------------------------------------------*/
+
+template < typename type >
+const type *HashSt< type >::next(const HashSt< type > *hash)
+{
+    return cast_const(hash_next(cast(hash, Hash)), type);
+}
+
+#endif
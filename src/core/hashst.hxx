@@ -0,0 +1,96 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: hashst.hxx
+ *
+ */
+
+/* Hash table macros for type checking at compile time */
+
+#define HashStDebug(type) \
+    struct Hash##St##type \
+    { \
+        uint32_t elems; \
+        uint32_t capacity; \
+        uint16_t esize; \
+        uint16_t ksize; \
+        uint32_t it; \
+        uint32_t *hashes; \
+        type *data; \
+        FPtr_hash func_hash; \
+        FPtr_compare func_compare; \
+    }
+
+#define HashStFuncs(type) \
+    HashSt(type); \
+\
+    static __TYPECHECK HashSt(type) *hashst_##type##_create(FPtr_hash func_hash, FPtr_compare func_compare, const uint16_t esize, const uint16_t ksize, const char_t *ktype); \
+    static HashSt(type) *hashst_##type##_create(FPtr_hash func_hash, FPtr_compare func_compare, const uint16_t esize, const uint16_t ksize, const char_t *ktype) \
+    { \
+        return cast(hash_create(func_hash, func_compare, esize, ksize, cast_const(HASHST #type, char_t), ktype), HashSt(type)); \
+    } \
+\
+    static __TYPECHECK void hashst_##type##_destroy(struct Hash##St##type **hash, void(func_remove)(type *)); \
+    static void hashst_##type##_destroy(struct Hash##St##type **hash, void(func_remove)(type *)) \
+    { \
+        hash_destroy(dcast(hash, Hash), (FPtr_remove)func_remove, cast_const(HASHST #type, char_t)); \
+    } \
+\
+    static __TYPECHECK uint32_t hashst_##type##_size(const struct Hash##St##type *hash); \
+    static uint32_t hashst_##type##_size(const struct Hash##St##type *hash) \
+    { \
+        return hash_size(cast_const(hash, Hash)); \
+    } \
+\
+    static __TYPECHECK type *hashst_##type##_get(struct Hash##St##type *hash, const void *key, const char_t *ktype); \
+    static type *hashst_##type##_get(struct Hash##St##type *hash, const void *key, const char_t *ktype) \
+    { \
+        return cast(hash_get(cast_const(hash, Hash), key, FALSE, ktype), type); \
+    } \
+\
+    static __TYPECHECK const type *hashst_##type##_get_const(const struct Hash##St##type *hash, const void *key, const char_t *ktype); \
+    static const type *hashst_##type##_get_const(const struct Hash##St##type *hash, const void *key, const char_t *ktype) \
+    { \
+        return cast_const(hash_get(cast_const(hash, Hash), key, FALSE, ktype), type); \
+    } \
+\
+    static __TYPECHECK type *hashst_##type##_insert(struct Hash##St##type *hash, const void *key, const char_t *ktype); \
+    static type *hashst_##type##_insert(struct Hash##St##type *hash, const void *key, const char_t *ktype) \
+    { \
+        return cast(hash_insert(cast(hash, Hash), key, ktype), type); \
+    } \
+\
+    static __TYPECHECK bool_t hashst_##type##_delete(struct Hash##St##type *hash, const void *key, FPtr_remove func_remove, const char_t *ktype); \
+    static bool_t hashst_##type##_delete(struct Hash##St##type *hash, const void *key, FPtr_remove func_remove, const char_t *ktype) \
+    { \
+        return hash_delete(cast(hash, Hash), key, func_remove, ktype); \
+    } \
+\
+    static __TYPECHECK type *hashst_##type##_first(struct Hash##St##type *hash); \
+    static type *hashst_##type##_first(struct Hash##St##type *hash) \
+    { \
+        return cast(hash_first(cast(hash, Hash)), type); \
+    } \
+\
+    static __TYPECHECK const type *hashst_##type##_first_const(const struct Hash##St##type *hash); \
+    static const type *hashst_##type##_first_const(const struct Hash##St##type *hash) \
+    { \
+        return cast_const(hash_first(cast(hash, Hash)), type); \
+    } \
+\
+    static __TYPECHECK type *hashst_##type##_next(struct Hash##St##type *hash); \
+    static type *hashst_##type##_next(struct Hash##St##type *hash) \
+    { \
+        return cast(hash_next(cast(hash, Hash)), type); \
+    } \
+\
+    static __TYPECHECK const type *hashst_##type##_next_const(const struct Hash##St##type *hash); \
+    static const type *hashst_##type##_next_const(const struct Hash##St##type *hash) \
+    { \
+        return cast_const(hash_next(cast(hash, Hash)), type); \
+    } \
+\
+    typedef struct _hashstend##type##_t hashstend##type
@@ -12,6 +12,8 @@
 
 #include "heap.h"
 #include "heap.inl"
+#include "arena.h"
+#include "arena.inl"
 #include "strings.h"
 #include <osbs/osbs.h>
 #include <osbs/bmutex.h>
@@ -22,6 +24,8 @@
 #include <sewer/cassert.h>
 
 typedef struct i_page_t i_Page;
+typedef struct i_stats_t i_Stats;
+typedef struct i_cache_t i_Cache;
 typedef struct i_memory_t i_Memory;
 
 #if defined(__MEMORY_AUDITOR__)
@@ -37,6 +41,16 @@ struct i_object_t
     uint64_t bytes_alloc;
     uint64_t bytes_dealloc;
     bool_t equal_sized;
+    bool_t typed;
+};
+
+typedef struct i_audit_t i_Audit;
+struct i_audit_t
+{
+    i_Object *objects;
+    uint32_t objects_alloc;
+    uint32_t num_objects;
+    uint32_t last;
 };
 
 typedef struct i_access_t i_Access;
@@ -51,23 +65,31 @@ struct i_access_t
 
 #endif
 
+#define NUM_SLAB_CLASSES 40
+#define SLAB_MAX_SIZE 1024
+
+/*
+ * General pages are bump allocated and only released when the whole page is free.
+ * Slab pages hold fixed-size slots of a single size class. Freed slots are
+ * linked in 'free_slots' and reused by the next allocation of the same class.
+ */
 struct i_page_t
 {
     uint32_t num_allocs;
     uint32_t used_memory;
     uint32_t offset;
     uint32_t mark;
+    uint32_t slot_size;
+    bool_t available;
+    byte_t *free_slots;
+    i_Page **slab_list;
+    i_Cache *cache;
     i_Page *next;
     i_Page *prev;
 };
 
-struct i_memory_t
+struct i_stats_t
 {
-    int main_thread_id;
-    Mutex *mutex;
-    uint32_t mtcount;
-    uint32_t page_size;
-    i_Page *current_page;
     uint64_t num_allocs;
     uint64_t total_bytes_allocated;
     uint64_t num_deallocs;
@@ -81,17 +103,51 @@ struct i_memory_t
     uint32_t great_pages_alloc;
     uint32_t std_pages_dealloc;
     uint32_t great_pages_dealloc;
+};
+
+/*
+ * Each thread allocates from its own cache (own page list and own lock),
+ * so worker threads don't contend in a single mutex. A block is always
+ * returned to the cache that owns its page, whatever thread frees it.
+ * Small blocks are served from slab lists. Objects of fixed size (heap_new)
+ * and variable-sized blocks (strings, arrays) use separate slabs.
+ * In multi-threaded mode, statistics and auditor objects are accumulated
+ * per cache and merged into the global ones lazily (heap_end_mt and _heap_finish).
+ */
+struct i_cache_t
+{
+    Mutex *mutex;
+    i_Page *current_page;
+    i_Page *obj_slabs[NUM_SLAB_CLASSES];
+    i_Page *var_slabs[NUM_SLAB_CLASSES];
+    i_Stats stats;
 
 #if defined(__MEMORY_AUDITOR__)
-    i_Object *objects;
-    uint32_t objects_alloc;
-    uint32_t num_objects;
+    i_Audit audit;
+#endif
+};
+
+struct i_memory_t
+{
+    int main_thread_id;
+    Mutex *mutex;
+    uint32_t mtcount;
+    uint32_t page_size;
+    uint32_t num_caches;
+    uint32_t next_cache;
+    i_Cache *caches;
+    i_Stats stats;
+
+#if defined(__MEMORY_AUDITOR__)
+    i_Audit audit;
 #endif
 };
 
 /*---------------------------------------------------------------------------*/
 
 static i_Memory i_MEMORY;
+static __THREAD_LOCAL i_Cache *i_THREAD_CACHE = NULL;
+static __THREAD_LOCAL Arena *i_THREAD_ARENA = NULL;
 
 #if defined(__x86__)
 #define DEFAULT_PAGE_SIZE 65536
@@ -104,10 +160,12 @@ static i_Memory i_MEMORY;
 #endif
 
 #define OBJECTS_ARRAY_GROW_SIZE 128
+#define MAX_THREAD_CACHES 64
 static uint32_t i_PAGESIZE = DEFAULT_PAGE_SIZE;
 static bool_t i_HEAP_VERBOSE = FALSE;
 static bool_t i_HEAP_STATS = TRUE;
 static bool_t i_HEAP_LEAKS = FALSE;
+static bool_t i_THREAD_CACHES = TRUE;
 
 /*---------------------------------------------------------------------------*/
 
@@ -118,31 +176,46 @@ static void i_init_page(i_Page *page)
     page->used_memory = 0;
     page->offset = sizeof(i_Page);
     page->mark = 0xA16F9B0C;
+    page->slot_size = 0;
+    page->available = FALSE;
+    page->free_slots = NULL;
+    page->slab_list = NULL;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static void i_new_page(const uint32_t page_size, i_Page **current_page, uint32_t *num_pages)
+static void i_new_page(const uint32_t page_size, i_Cache *cache, i_Stats *stats)
 {
     i_Page *new_page = NULL;
-    cassert_no_null(current_page);
-    cassert_no_null(num_pages);
+    cassert_no_null(cache);
+    cassert_no_null(stats);
     new_page = cast(bmem_malloc(page_size), i_Page);
-    *num_pages += 1;
+    stats->std_pages_alloc += 1;
     i_init_page(new_page);
+    new_page->cache = cache;
     new_page->next = NULL;
-    new_page->prev = *current_page;
+    new_page->prev = cache->current_page;
 
-    if ((*current_page) != NULL)
-        (*current_page)->next = new_page;
+    if (cache->current_page != NULL)
+        cache->current_page->next = new_page;
 
-    *current_page = new_page;
+    cache->current_page = new_page;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_num_caches(void)
+{
+    /* One cache for main thread and two per core for worker threads */
+    uint32_t n = 1 + 2 * osbs_ncpus();
+    return n < MAX_THREAD_CACHES ? n : MAX_THREAD_CACHES;
 }
 
 /*---------------------------------------------------------------------------*/
 
 static void i_init_memory(i_Memory *memory, const uint32_t page_size)
 {
+    uint32_t i;
     cassert_no_null(memory);
     /* Page size is power of 2 */
     cassert((page_size != 0) && (page_size & (page_size - 1)) == 0);
@@ -151,72 +224,608 @@ static void i_init_memory(i_Memory *memory, const uint32_t page_size)
     memory->mutex = bmutex_create();
     memory->mtcount = 0;
     memory->page_size = page_size;
-    i_new_page(memory->page_size, &memory->current_page, &memory->std_pages_alloc);
+    memory->num_caches = i_num_caches();
+    memory->next_cache = 1;
+    memory->caches = cast(bmem_malloc(memory->num_caches * sizeof32(i_Cache)), i_Cache);
+    bmem_set_zero(cast(memory->caches, byte_t), memory->num_caches * sizeof32(i_Cache));
+    for (i = 0; i < memory->num_caches; ++i)
+        memory->caches[i].mutex = bmutex_create();
+
+    /* First page for main thread */
+    i_new_page(memory->page_size, memory->caches, &memory->stats);
+    i_THREAD_CACHE = memory->caches;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_free_slabs(i_Page **slab_list)
+{
+    i_Page *page = NULL;
+    cassert_no_null(slab_list);
+    page = *slab_list;
+    while (page != NULL)
+    {
+        i_Page *next = page->next;
+        /* Slabs with live blocks are leaks (already reported) */
+        if (page->num_allocs == 0)
+            bmem_free(cast(page, byte_t));
+        page = next;
+    }
+
+    *slab_list = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
 
 #if defined(__MEMORY_AUDITOR__)
-    memory->objects_alloc = OBJECTS_ARRAY_GROW_SIZE;
-    memory->objects = cast(bmem_malloc((uint32_t)(memory->objects_alloc * sizeof(i_Object))), i_Object);
-    memory->num_objects = 0;
-#endif
+
+/*---------------------------------------------------------------------------*/
+
+/*
+static void i_dump_objects(void)
+{
+   uint32_t i;
+   log_printf("Num objects: %d", i_MEMORY.audit.num_objects);
+   for (i = 0; i < i_MEMORY.audit.num_objects; ++i)
+       log_printf("%s %d %d", i_MEMORY.audit.objects[i].name, i_MEMORY.audit.objects[i].num_allocs, i_MEMORY.audit.objects[i].num_deallocs);
+}
+ */
+
+/*---------------------------------------------------------------------------*/
+
+static void i_remove_audit(i_Audit *audit)
+{
+    cassert_no_null(audit);
+    if (audit->objects != NULL)
+        bmem_free(cast(audit->objects, byte_t));
+    audit->objects = NULL;
+    audit->num_objects = 0;
+    audit->objects_alloc = 0;
 }
 
 /*---------------------------------------------------------------------------*/
 
+static int i_object_key(const i_Object *object, const char_t *name)
+{
+    return str_cmp_cn(object->name, name, OBJECT_NAME_SIZE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static i_Object *i_find_object(i_Audit *audit, const char_t *name, uint32_t *index)
+{
+    cassert_no_null(audit);
+    cassert_no_null(index);
+    /* Objects of the same type usually come in a row (parsers, containers) */
+    if (audit->last < audit->num_objects && i_object_key(audit->objects + audit->last, name) == 0)
+    {
+        *index = audit->last;
+        return audit->objects + audit->last;
+    }
+
+    if (blib_bsearch(cast_const(audit->objects, byte_t), cast_const(name, byte_t), audit->num_objects, sizeof(i_Object), (FPtr_compare)i_object_key, index) == TRUE)
+    {
+        audit->last = *index;
+        return audit->objects + *index;
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static i_Object *i_new_object(i_Audit *audit, const char_t *name, const uint32_t index)
+{
+    i_Object *new_object = NULL;
+    cassert_no_null(audit);
+    if (audit->num_objects == audit->objects_alloc)
+    {
+        uint32_t objects_alloc = audit->objects_alloc + OBJECTS_ARRAY_GROW_SIZE;
+        if (audit->objects != NULL)
+            audit->objects = cast(bmem_realloc(cast(audit->objects, byte_t), audit->objects_alloc * (uint32_t)sizeof(i_Object), objects_alloc * (uint32_t)sizeof(i_Object)), i_Object);
+        else
+            audit->objects = cast(bmem_malloc(objects_alloc * (uint32_t)sizeof(i_Object)), i_Object);
+        audit->objects_alloc = objects_alloc;
+    }
+
+    /* Move all elems from index 1 postion right (keep the array sorted) */
+    if ((audit->num_objects - index) > 0)
+    {
+        bmem_move(cast(audit->objects + index + 1, byte_t),
+                  cast_const(audit->objects + index, byte_t),
+                  (audit->num_objects - index) * (uint32_t)sizeof(i_Object));
+    }
+
+    new_object = audit->objects + index;
+    bmem_zero(new_object, i_Object);
+    str_copy_c(new_object->name, OBJECT_NAME_SIZE, name);
+    audit->num_objects += 1;
+    audit->last = index;
+    return new_object;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static i_Object *i_get_object(i_Audit *audit, const char_t *name, const bool_t equal_sized, const uint32_t size)
+{
+    uint32_t index = UINT32_MAX;
+    i_Object *object = i_find_object(audit, name, &index);
+    if (object == NULL)
+        object = i_new_object(audit, name, index);
+
+    if (object->typed == TRUE)
+    {
+        cassert_msg(object->equal_sized == equal_sized, "heap auditor: Not 'equal_sized' property with same 'name'.");
+        cassert_msg(object->equal_sized == FALSE || object->size == size, "heap auditor: alloc 'equal_sized' object type with different size.");
+    }
+    else
+    {
+        object->equal_sized = equal_sized;
+        object->size = size;
+        object->typed = TRUE;
+    }
+
+    return object;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * In multi-threaded mode, a thread can release objects allocated by other.
+ * The cache keeps them without type until the merge.
+ */
+static i_Object *i_get_existing_object(i_Audit *audit, const char_t *name, const bool_t mt)
+{
+    uint32_t index = UINT32_MAX;
+    i_Object *object = i_find_object(audit, name, &index);
+    if (object == NULL)
+    {
+        cassert_fatal_msg(mt == TRUE, "heap auditor: non-existent 'name' object.");
+        object = i_new_object(audit, name, index);
+    }
+
+    return object;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_merge_audit(i_Audit *dest, const i_Audit *src, const bool_t typed)
+{
+    uint32_t i;
+    cassert_no_null(src);
+    for (i = 0; i < src->num_objects; ++i)
+    {
+        const i_Object *sobject = src->objects + i;
+        if (sobject->typed == typed)
+        {
+            i_Object *object = NULL;
+            if (typed == TRUE)
+                object = i_get_object(dest, sobject->name, sobject->equal_sized, sobject->size);
+            else
+                object = i_get_existing_object(dest, sobject->name, FALSE);
+
+            object->num_allocs += sobject->num_allocs;
+            object->num_deallocs += sobject->num_deallocs;
+            object->bytes_alloc += sobject->bytes_alloc;
+            object->bytes_dealloc += sobject->bytes_dealloc;
+        }
+    }
+}
+
+#endif
+
+/*---------------------------------------------------------------------------*/
+
 static void i_remove_memory(i_Memory *memory)
 {
+    uint32_t i;
     cassert_no_null(memory);
     cassert(bthread_current_id() == memory->main_thread_id);
     cassert(memory->mtcount == 0);
 
-    bmem_free(cast(memory->current_page, byte_t));
-    memory->current_page = NULL;
-    bmutex_close(&memory->mutex);
+    for (i = 0; i < memory->num_caches; ++i)
+    {
+        uint32_t j;
+        if (memory->caches[i].current_page != NULL)
+        {
+            bmem_free(cast(memory->caches[i].current_page, byte_t));
+            memory->caches[i].current_page = NULL;
+        }
+
+        for (j = 0; j < NUM_SLAB_CLASSES; ++j)
+        {
+            i_free_slabs(&memory->caches[i].obj_slabs[j]);
+            i_free_slabs(&memory->caches[i].var_slabs[j]);
+        }
+
+#if defined(__MEMORY_AUDITOR__)
+        i_remove_audit(&memory->caches[i].audit);
+#endif
+        bmutex_close(&memory->caches[i].mutex);
+    }
+
+    bmem_free(cast(memory->caches, byte_t));
+    memory->caches = NULL;
+    memory->num_caches = 0;
+    i_THREAD_CACHE = NULL;
+    bmutex_close(&memory->mutex);
+
+#if defined(__MEMORY_AUDITOR__)
+    i_remove_audit(&memory->audit);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_merge_stats(i_Stats *dest, i_Stats *src)
+{
+    cassert_no_null(dest);
+    cassert_no_null(src);
+    dest->num_allocs += src->num_allocs;
+    dest->total_bytes_allocated += src->total_bytes_allocated;
+    dest->num_deallocs += src->num_deallocs;
+    dest->total_bytes_deallocated += src->total_bytes_deallocated;
+    dest->num_reallocs += src->num_reallocs;
+    dest->num_effective_reallocs += src->num_effective_reallocs;
+    dest->total_bytes_moved_in_reallocs += src->total_bytes_moved_in_reallocs;
+    /* Per-cache 'bytes_allocated' is a delta that can wrap (blocks freed by other thread) */
+    dest->bytes_allocated += src->bytes_allocated;
+    dest->std_pages_alloc += src->std_pages_alloc;
+    dest->great_pages_alloc += src->great_pages_alloc;
+    dest->std_pages_dealloc += src->std_pages_dealloc;
+    dest->great_pages_dealloc += src->great_pages_dealloc;
+    bmem_zero(src, i_Stats);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * In multi-threaded mode, called with 'memory->mutex' locked.
+ * The global mutex is always taken before the cache ones.
+ */
+static void i_merge_caches(i_Memory *memory)
+{
+    uint64_t peak = 0;
+    uint32_t i;
+    cassert_no_null(memory);
+
+    /*
+     * Each cache keeps the peak of its own delta. The sum over the caches
+     * is an upper bound of the global peak of the multi-threaded section.
+     */
+    peak = memory->stats.bytes_allocated;
+    for (i = 0; i < memory->num_caches; ++i)
+    {
+        bmutex_lock(memory->caches[i].mutex);
+        peak += memory->caches[i].stats.max_bytes_allocated;
+        i_merge_stats(&memory->stats, &memory->caches[i].stats);
+#if defined(__MEMORY_AUDITOR__)
+        i_merge_audit(&memory->audit, &memory->caches[i].audit, TRUE);
+#endif
+        bmutex_unlock(memory->caches[i].mutex);
+    }
+
+#if defined(__MEMORY_AUDITOR__)
+    /* Objects released in a cache after all the allocated ones are merged */
+    for (i = 0; i < memory->num_caches; ++i)
+    {
+        bmutex_lock(memory->caches[i].mutex);
+        i_merge_audit(&memory->audit, &memory->caches[i].audit, FALSE);
+        memory->caches[i].audit.num_objects = 0;
+        bmutex_unlock(memory->caches[i].mutex);
+    }
+
+    for (i = 0; i < memory->audit.num_objects; ++i)
+        cassert_msg(memory->audit.objects[i].num_allocs >= memory->audit.objects[i].num_deallocs, "heap auditor: free object type without allocs.");
+#endif
+
+    if (peak > memory->stats.max_bytes_allocated)
+        memory->stats.max_bytes_allocated = peak;
+    if (memory->stats.bytes_allocated > memory->stats.max_bytes_allocated)
+        memory->stats.max_bytes_allocated = memory->stats.bytes_allocated;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE i_Cache *i_thread_cache(i_Memory *memory)
+{
+    cassert_no_null(memory);
+    if (__FALSE_EXPECTED(i_THREAD_CACHE == NULL))
+    {
+        /* First allocation of a worker thread. Bind it to a cache (round-robin). */
+        bmutex_lock(memory->mutex);
+        if (memory->num_caches > 1 && i_THREAD_CACHES == TRUE)
+        {
+            i_THREAD_CACHE = memory->caches + memory->next_cache;
+            memory->next_cache += 1;
+            if (memory->next_cache == memory->num_caches)
+                memory->next_cache = 1;
+        }
+        else
+        {
+            i_THREAD_CACHE = memory->caches;
+        }
+        bmutex_unlock(memory->mutex);
+    }
+
+    return i_THREAD_CACHE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE i_Stats *i_lock(i_Memory *memory, i_Cache *cache)
+{
+    cassert_no_null(memory);
+    cassert_no_null(cache);
+    if (memory->mtcount > 0)
+    {
+        bmutex_lock(cache->mutex);
+        return &cache->stats;
+    }
+
+    return &memory->stats;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_unlock(i_Memory *memory, i_Cache *cache)
+{
+    cassert_no_null(memory);
+    cassert_no_null(cache);
+    if (memory->mtcount > 0)
+        bmutex_unlock(cache->mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* In multi-threaded mode, per-cache 'bytes_allocated' is a delta (can be negative) */
+static ___INLINE void i_peak(i_Stats *stats)
+{
+    cassert_no_null(stats);
+    if ((int64_t)stats->bytes_allocated > (int64_t)stats->max_bytes_allocated)
+        stats->max_bytes_allocated = stats->bytes_allocated;
+}
+
+#if defined(__MEMORY_AUDITOR__)
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the cache locked */
+static ___INLINE i_Audit *i_audit(i_Memory *memory, i_Cache *cache)
+{
+    cassert_no_null(memory);
+    cassert_no_null(cache);
+    if (memory->mtcount > 0)
+        return &cache->audit;
+    return &memory->audit;
+}
+
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE i_Cache *i_alloc_cache(i_Memory *memory)
+{
+    cassert_no_null(memory);
+    if (memory->mtcount > 0)
+        return i_thread_cache(memory);
+    return memory->caches;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE bool_t i_is_paged(const uint32_t page_size, const uint32_t size, const uint32_t align)
+{
+    return (bool_t)(size + align + sizeof(i_Page) + sizeofptr < page_size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Size classes: 8 bytes step up to 128, 16 up to 256, 32 up to 512, 64 up to 1024 */
+static uint32_t i_slab_class(const uint32_t size, uint32_t *slot_size)
+{
+    uint32_t klass = 0;
+    cassert(size > 0 && size <= SLAB_MAX_SIZE);
+    cassert_no_null(slot_size);
+    if (size <= 128)
+    {
+        klass = (size - 1) / 8;
+        *slot_size = (klass + 1) * 8;
+    }
+    else if (size <= 256)
+    {
+        klass = (size - 129) / 16;
+        *slot_size = 128 + (klass + 1) * 16;
+        klass += 16;
+    }
+    else if (size <= 512)
+    {
+        klass = (size - 257) / 32;
+        *slot_size = 256 + (klass + 1) * 32;
+        klass += 24;
+    }
+    else
+    {
+        klass = (size - 513) / 64;
+        *slot_size = 512 + (klass + 1) * 64;
+        klass += 32;
+    }
+
+    cassert(klass < NUM_SLAB_CLASSES);
+    cassert(*slot_size >= size);
+    return klass;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_slab_unlink(i_Page *page)
+{
+    cassert_no_null(page);
+    cassert(page->available == TRUE);
+    if (page->prev != NULL)
+        page->prev->next = page->next;
+    else
+        *page->slab_list = page->next;
+
+    if (page->next != NULL)
+        page->next->prev = page->prev;
+
+    page->next = NULL;
+    page->prev = NULL;
+    page->available = FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_slab_link(i_Page *page)
+{
+    cassert_no_null(page);
+    cassert(page->available == FALSE);
+    page->prev = NULL;
+    page->next = *page->slab_list;
+    if (page->next != NULL)
+        page->next->prev = page;
+    *page->slab_list = page;
+    page->available = TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static byte_t *i_slab_malloc(const uint32_t page_size, i_Cache *cache, i_Stats *stats, const uint32_t size, const bool_t equal_sized)
+{
+    uint32_t slot_size = 0;
+    uint32_t klass = i_slab_class(size, &slot_size);
+    i_Page **slab_list = equal_sized == TRUE ? &cache->obj_slabs[klass] : &cache->var_slabs[klass];
+    i_Page *page = *slab_list;
+    byte_t *mem = NULL;
+
+    /* All slabs of this class are full */
+    if (page == NULL)
+    {
+        page = cast(bmem_malloc(page_size), i_Page);
+        stats->std_pages_alloc += 1;
+        i_init_page(page);
+        page->slot_size = slot_size;
+        page->slab_list = slab_list;
+        page->cache = cache;
+        i_slab_link(page);
+    }
+
+    cassert(page->slot_size == slot_size);
+
+    /* Reuse a freed slot */
+    if (page->free_slots != NULL)
+    {
+        mem = page->free_slots;
+        page->free_slots = *dcast(mem, byte_t);
+    }
+    /* Never used slot */
+    else
+    {
+        cassert(page->offset + slot_size + sizeofptr <= page_size);
+        mem = cast(page, byte_t) + page->offset;
+        page->offset += slot_size + (uint32_t)sizeofptr;
+    }
+
+    page->num_allocs += 1;
+    page->used_memory += size;
+
+    /* The slab is full, remove from available list */
+    if (page->free_slots == NULL && page->offset + slot_size + sizeofptr > page_size)
+        i_slab_unlink(page);
+
+    *dcast(mem + size, void) = cast(page, void);
+    return mem;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_slab_free(i_Page *page, i_Stats *stats, byte_t *mem, const uint32_t size)
+{
+    cassert_no_null(page);
+    cassert_no_null(stats);
+    cassert(page->slot_size >= size);
+    page->num_allocs -= 1;
+    page->used_memory -= size;
+
+    if (page->num_allocs == 0)
+    {
+        cassert(page->used_memory == 0);
 
-#if defined(__MEMORY_AUDITOR__)
-    bmem_free(cast(memory->objects, byte_t));
-    memory->objects = NULL;
-    memory->num_objects = 0;
-    memory->objects_alloc = 0;
-#endif
+        /* Empty slab. Release it, unless it's the last one of its class */
+        if (page->available == FALSE || page->prev != NULL || page->next != NULL)
+        {
+            if (page->available == TRUE)
+                i_slab_unlink(page);
+
+            bmem_free(cast(page, byte_t));
+            stats->std_pages_dealloc += 1;
+        }
+        else
+        {
+            page->offset = sizeof(i_Page);
+            page->free_slots = NULL;
+        }
+    }
+    else
+    {
+        *dcast(mem, byte_t) = page->free_slots;
+        page->free_slots = mem;
+        if (page->available == FALSE)
+            i_slab_link(page);
+    }
 }
 
 /*---------------------------------------------------------------------------*/
 
-static byte_t *i_malloc(i_Memory *memory, const uint32_t size, const uint32_t align)
+static byte_t *i_malloc(const uint32_t page_size, i_Cache *cache, i_Stats *stats, const uint32_t size, const uint32_t align, const bool_t equal_sized)
 {
     byte_t *mem = NULL;
 
-    cassert_no_null(memory);
-    cassert_no_null(memory->current_page);
+    cassert_no_null(cache);
+    cassert_no_null(stats);
 
+    /* Small block with default alignment, stored in a size class slab */
+    if (__TRUE_EXPECTED(size <= SLAB_MAX_SIZE && align == sizeofptr && SLAB_MAX_SIZE * 4 < page_size))
+    {
+        mem = i_slab_malloc(page_size, cache, stats, size, equal_sized);
+    }
     /* Block can be stored by paged allocator */
-    if (__TRUE_EXPECTED(size + align + sizeof(i_Page) + sizeofptr < memory->page_size))
+    else if (i_is_paged(page_size, size, align) == TRUE)
     {
-        uint32_t mod = memory->current_page->offset % align;
-        uint32_t offset = memory->current_page->offset;
+        uint32_t mod, offset;
+
+        /* First allocation in this cache */
+        if (__FALSE_EXPECTED(cache->current_page == NULL))
+            i_new_page(page_size, cache, stats);
+
+        mod = cache->current_page->offset % align;
+        offset = cache->current_page->offset;
 
         if (mod > 0)
             offset += align - mod;
 
         /* Block can't be stored in current page */
-        if (offset + size + sizeofptr >= memory->page_size)
+        if (offset + size + sizeofptr >= page_size)
         {
-            i_new_page(memory->page_size, &memory->current_page, &memory->std_pages_alloc);
-            offset = memory->current_page->offset + (memory->current_page->offset % align);
+            i_new_page(page_size, cache, stats);
+            offset = cache->current_page->offset + (cache->current_page->offset % align);
         }
 
-        cassert(offset + size + sizeofptr < memory->page_size);
-        memory->current_page->num_allocs += 1;
-        memory->current_page->used_memory += size;
-        memory->current_page->offset = offset + size + (uint32_t)sizeofptr;
-        mem = cast(memory->current_page, byte_t) + offset;
-        *dcast(mem + size, void) = cast(memory->current_page, void);
+        cassert(offset + size + sizeofptr < page_size);
+        cache->current_page->num_allocs += 1;
+        cache->current_page->used_memory += size;
+        cache->current_page->offset = offset + size + (uint32_t)sizeofptr;
+        mem = cast(cache->current_page, byte_t) + offset;
+        *dcast(mem + size, void) = cast(cache->current_page, void);
     }
     /* Block needs its own allocation */
     else
     {
-        mem = bmem_aligned_malloc(size, align);
-        memory->great_pages_alloc += 1;
+        /* Trailer is NULL, is not paged neither arena block */
+        mem = bmem_aligned_malloc(size + (uint32_t)sizeofptr, align);
+        *dcast(mem + size, void) = NULL;
+        stats->great_pages_alloc += 1;
     }
 
     cassert_fatal((mem != NULL) && ((intptr_t)mem % (intptr_t)align) == 0);
@@ -225,8 +834,77 @@ static byte_t *i_malloc(i_Memory *memory, const uint32_t size, const uint32_t al
 
 /*---------------------------------------------------------------------------*/
 
-static void i_free(i_Memory *memory, byte_t *mem, const uint32_t size, const uint32_t align)
+static void i_free_general(i_Page *page, i_Stats *stats, const uint32_t size)
+{
+    i_Cache *cache = NULL;
+    cassert_no_null(page);
+    cassert_no_null(stats);
+    cache = page->cache;
+    page->num_allocs -= 1;
+    page->used_memory -= size;
+
+    /* The whole page is freeded, we destroy the page */
+    if (page->num_allocs == 0)
+    {
+        cassert(page->used_memory == 0);
+
+        /* The page isn't the current page. Update list pointers and free. */
+        if (__TRUE_EXPECTED(page != cache->current_page))
+        {
+            cassert(page->next != NULL);
+            page->next->prev = page->prev;
+            if (page->prev != NULL)
+                page->prev->next = page->next;
+
+            bmem_free(cast(page, byte_t));
+            stats->std_pages_dealloc += 1;
+        }
+        /* Page for free is current page, we can reuse it. */
+        else
+        {
+            cassert(page->next == NULL);
+            i_init_page(page);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_free_page(i_Page *page, i_Stats *stats, byte_t *mem, const uint32_t size)
+{
+    cassert_no_null(page);
+    cassert(page->mark == 0xA16F9B0C);
+    cassert(page->num_allocs > 0);
+    cassert(page->used_memory >= size);
+    if (page->slot_size > 0)
+        i_slab_free(page, stats, mem, size);
+    else
+        i_free_general(page, stats, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_dealloc_stats(i_Memory *memory, const uint32_t num, const uint64_t bytes)
+{
+    i_Cache *cache = i_alloc_cache(memory);
+    i_Stats *stats = i_lock(memory, cache);
+    stats->num_deallocs += num;
+    stats->total_bytes_deallocated += bytes;
+    cassert_fatal(memory->mtcount > 0 || stats->bytes_allocated >= bytes);
+    stats->bytes_allocated -= bytes;
+    i_unlock(memory, cache);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * The block is returned to the cache that owns its page, locking only that cache.
+ * Only one cache is locked at a time, so cross-thread frees can't deadlock.
+ */
+static void i_free(i_Memory *memory, byte_t *mem, const uint32_t size, const uint32_t align, const bool_t count)
 {
+    i_Cache *cache = NULL;
+    i_Stats *stats = NULL;
     cassert_no_null(memory);
 
 /* Block filled with waste */
@@ -235,70 +913,94 @@ static void i_free(i_Memory *memory, byte_t *mem, const uint32_t size, const uin
 #endif
 
     /* Block was stored by paged allocator */
-    if (__TRUE_EXPECTED(size + align + sizeof(i_Page) + sizeofptr < memory->page_size))
+    if (__TRUE_EXPECTED(i_is_paged(memory->page_size, size, align) == TRUE))
     {
         i_Page *page = cast(*dcast(mem + size, void), i_Page);
         cassert_no_null(page);
-        cassert(page->mark == 0xA16F9B0C);
-        cassert(page->num_allocs > 0);
-        cassert(page->used_memory >= size);
-        page->num_allocs -= 1;
-        page->used_memory -= size;
-
-        /* The whole page is freeded, we destroy the page */
-        if (page->num_allocs == 0)
-        {
-            cassert(page->used_memory == 0);
-
-            /* The page isn't the current page. Update list pointers and free. */
-            if (__TRUE_EXPECTED(page != memory->current_page))
-            {
-                cassert(page->next != NULL);
-                page->next->prev = page->prev;
-                if (page->prev != NULL)
-                    page->prev->next = page->next;
-
-                bmem_free(cast(page, byte_t));
-                memory->std_pages_dealloc += 1;
-            }
-            /* Page for free is current page, we can reuse it. */
-            else
-            {
-                cassert(page->next == NULL);
-                i_init_page(page);
-            }
-        }
+        cache = page->cache;
+        stats = i_lock(memory, cache);
+        i_free_page(page, stats, mem, size);
     }
     /* Block was stored using an own block */
     else
     {
         bmem_free(mem);
-        memory->great_pages_dealloc += 1;
+        cache = i_alloc_cache(memory);
+        stats = i_lock(memory, cache);
+        stats->great_pages_dealloc += 1;
+    }
+
+    if (count == TRUE)
+    {
+        stats->num_deallocs += 1;
+        stats->total_bytes_deallocated += size;
+        cassert_fatal(memory->mtcount > 0 || stats->bytes_allocated >= size);
+        stats->bytes_allocated -= size;
     }
+
+    i_unlock(memory, cache);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* The new size uses the same slot of a slab page. Block remains in place. */
+static bool_t i_slab_inplace(i_Memory *memory, byte_t *mem, const uint32_t size, const uint32_t prev_size, const uint32_t align)
+{
+    i_Page *page = NULL;
+    uint32_t slot_size = 0;
+    cassert_no_null(memory);
+    if (size > SLAB_MAX_SIZE || align != sizeofptr || i_is_paged(memory->page_size, prev_size, align) == FALSE)
+        return FALSE;
+
+    page = cast(*dcast(mem + prev_size, void), i_Page);
+    cassert_no_null(page);
+    if (page->slot_size == 0)
+        return FALSE;
+
+    i_slab_class(size, &slot_size);
+    if (slot_size != page->slot_size)
+        return FALSE;
+
+    i_lock(memory, page->cache);
+    cassert(page->used_memory >= prev_size);
+    page->used_memory -= prev_size;
+    page->used_memory += size;
+    i_unlock(memory, page->cache);
+    *dcast(mem + size, void) = cast(page, void);
+    return TRUE;
 }
 
 /*---------------------------------------------------------------------------*/
 
 static byte_t *i_realloc(i_Memory *memory, byte_t *prev_mem, const uint32_t size, const uint32_t prev_size, const uint32_t align)
 {
+    i_Cache *cache = NULL;
+    i_Stats *stats = NULL;
     byte_t *mem = NULL;
     cassert_no_null(memory);
-    cassert_no_null(memory->current_page);
 
+    if (i_slab_inplace(memory, prev_mem, size, prev_size, align) == TRUE)
+    {
+        mem = prev_mem;
+    }
     /* Some of new/previous block can be/is stored in paged allocator */
-    if (__TRUE_EXPECTED((prev_size + align + sizeof(i_Page) + sizeofptr < memory->page_size) || (size + align + sizeof(i_Page) + sizeofptr < memory->page_size)))
+    else if (__TRUE_EXPECTED(i_is_paged(memory->page_size, prev_size, align) == TRUE || i_is_paged(memory->page_size, size, align) == TRUE))
     {
         uint32_t min_size;
-        mem = i_malloc(memory, size, align);
+        cache = i_alloc_cache(memory);
+        stats = i_lock(memory, cache);
+        mem = i_malloc(memory->page_size, cache, stats, size, align, FALSE);
+        i_unlock(memory, cache);
         min_size = prev_size < size ? prev_size : size;
         bmem_copy(mem, prev_mem, min_size);
-        i_free(memory, prev_mem, prev_size, align);
+        i_free(memory, prev_mem, prev_size, align, FALSE);
     }
     /* Previous block is in own allocation and new block needs its own allocation too. */
     /* We can call to system realloc. */
     else
     {
-        mem = bmem_aligned_realloc(prev_mem, prev_size, size, align);
+        mem = bmem_aligned_realloc(prev_mem, prev_size + (uint32_t)sizeofptr, size + (uint32_t)sizeofptr, align);
+        *dcast(mem + size, void) = NULL;
     }
 
     cassert_fatal((mem != NULL) && ((intptr_t)mem % (intptr_t)align) == 0);
@@ -316,14 +1018,16 @@ void _heap_start(void)
 
 void _heap_finish(void)
 {
+    i_merge_caches(&i_MEMORY);
+
 /* Show Objects Leaks*/
 #if defined(__MEMORY_AUDITOR__)
     {
         bool_t with_object_leaks = FALSE;
         uint32_t i;
-        for (i = 0; i < i_MEMORY.num_objects; ++i)
+        for (i = 0; i < i_MEMORY.audit.num_objects; ++i)
         {
-            if (i_MEMORY.objects[i].num_allocs != i_MEMORY.objects[i].num_deallocs)
+            if (i_MEMORY.audit.objects[i].num_allocs != i_MEMORY.audit.objects[i].num_deallocs)
             {
                 if (with_object_leaks == FALSE)
                 {
@@ -332,9 +1036,9 @@ void _heap_finish(void)
                     with_object_leaks = TRUE;
                 }
 
-                log_printf("'%s' a/deallocations: %u, %u (%u leaks)", i_MEMORY.objects[i].name, i_MEMORY.objects[i].num_allocs, i_MEMORY.objects[i].num_deallocs, (i_MEMORY.objects[i].num_allocs - i_MEMORY.objects[i].num_deallocs));
+                log_printf("'%s' a/deallocations: %u, %u (%u leaks)", i_MEMORY.audit.objects[i].name, i_MEMORY.audit.objects[i].num_allocs, i_MEMORY.audit.objects[i].num_deallocs, (i_MEMORY.audit.objects[i].num_allocs - i_MEMORY.audit.objects[i].num_deallocs));
             }
-            else if (i_MEMORY.objects[i].bytes_alloc != i_MEMORY.objects[i].bytes_dealloc)
+            else if (i_MEMORY.audit.objects[i].bytes_alloc != i_MEMORY.audit.objects[i].bytes_dealloc)
             {
                 if (with_object_leaks == FALSE)
                 {
@@ -343,7 +1047,7 @@ void _heap_finish(void)
                     with_object_leaks = TRUE;
                 }
 
-                log_printf("'%s' bytes a/deallocated: %" PRIu64 ", %" PRIu64 " (%" PRIu64 " bytes)", i_MEMORY.objects[i].name, i_MEMORY.objects[i].bytes_alloc, i_MEMORY.objects[i].bytes_dealloc, i_MEMORY.objects[i].bytes_alloc - i_MEMORY.objects[i].bytes_dealloc);
+                log_printf("'%s' bytes a/deallocated: %" PRIu64 ", %" PRIu64 " (%" PRIu64 " bytes)", i_MEMORY.audit.objects[i].name, i_MEMORY.audit.objects[i].bytes_alloc, i_MEMORY.audit.objects[i].bytes_dealloc, i_MEMORY.audit.objects[i].bytes_alloc - i_MEMORY.audit.objects[i].bytes_dealloc);
             }
         }
 
@@ -352,13 +1056,13 @@ void _heap_finish(void)
     }
 #endif
 
-    if (i_MEMORY.num_allocs != i_MEMORY.num_deallocs || i_MEMORY.total_bytes_allocated != i_MEMORY.total_bytes_deallocated || i_MEMORY.bytes_allocated > 0)
+    if (i_MEMORY.stats.num_allocs != i_MEMORY.stats.num_deallocs || i_MEMORY.stats.total_bytes_allocated != i_MEMORY.stats.total_bytes_deallocated || i_MEMORY.stats.bytes_allocated > 0)
     {
         log_printf("[FAIL] Heap Global Memory Leaks!!!");
         log_printf("==================================");
-        log_printf("Total a/dellocations: %" PRIu64 ", %" PRIu64 " (%" PRIu64 " leaks)", i_MEMORY.num_allocs, i_MEMORY.num_deallocs, i_MEMORY.num_allocs - i_MEMORY.num_deallocs);
-        log_printf("Total bytes a/dellocated: %" PRIu64 ", %" PRIu64 " (%" PRIu64 " bytes)", i_MEMORY.total_bytes_allocated, i_MEMORY.total_bytes_deallocated, i_MEMORY.total_bytes_allocated - i_MEMORY.total_bytes_deallocated);
-        log_printf("Max bytes allocated: %" PRIu64, i_MEMORY.max_bytes_allocated);
+        log_printf("Total a/dellocations: %" PRIu64 ", %" PRIu64 " (%" PRIu64 " leaks)", i_MEMORY.stats.num_allocs, i_MEMORY.stats.num_deallocs, i_MEMORY.stats.num_allocs - i_MEMORY.stats.num_deallocs);
+        log_printf("Total bytes a/dellocated: %" PRIu64 ", %" PRIu64 " (%" PRIu64 " bytes)", i_MEMORY.stats.total_bytes_allocated, i_MEMORY.stats.total_bytes_deallocated, i_MEMORY.stats.total_bytes_allocated - i_MEMORY.stats.total_bytes_deallocated);
+        log_printf("Max bytes allocated: %" PRIu64, i_MEMORY.stats.max_bytes_allocated);
         log_printf("==================================");
         i_HEAP_LEAKS = TRUE;
     }
@@ -368,21 +1072,21 @@ void _heap_finish(void)
         {
             log_printf("[OK] Heap Memory Statistics");
             log_printf("===========================");
-            log_printf("Total a/dellocations: %" PRIu64 ", %" PRIu64, i_MEMORY.num_allocs, i_MEMORY.num_deallocs);
-            log_printf("Total bytes a/dellocated: %" PRIu64 ", %" PRIu64, i_MEMORY.total_bytes_allocated, i_MEMORY.total_bytes_deallocated);
-            log_printf("Max bytes allocated: %" PRIu64, i_MEMORY.max_bytes_allocated);
-            log_printf("Effective reallocations: (%" PRIu64 "/%" PRIu64 ")", i_MEMORY.num_effective_reallocs, i_MEMORY.num_reallocs);
-            log_printf("Real allocations: %u pages of %u bytes", i_MEMORY.std_pages_alloc, i_MEMORY.page_size);
-            if (i_MEMORY.great_pages_alloc > 0)
-                log_printf("                  %u pages greater than %u bytes", i_MEMORY.great_pages_alloc, i_MEMORY.page_size);
+            log_printf("Total a/dellocations: %" PRIu64 ", %" PRIu64, i_MEMORY.stats.num_allocs, i_MEMORY.stats.num_deallocs);
+            log_printf("Total bytes a/dellocated: %" PRIu64 ", %" PRIu64, i_MEMORY.stats.total_bytes_allocated, i_MEMORY.stats.total_bytes_deallocated);
+            log_printf("Max bytes allocated: %" PRIu64, i_MEMORY.stats.max_bytes_allocated);
+            log_printf("Effective reallocations: (%" PRIu64 "/%" PRIu64 ")", i_MEMORY.stats.num_effective_reallocs, i_MEMORY.stats.num_reallocs);
+            log_printf("Real allocations: %u pages of %u bytes", i_MEMORY.stats.std_pages_alloc, i_MEMORY.page_size);
+            if (i_MEMORY.stats.great_pages_alloc > 0)
+                log_printf("                  %u pages greater than %u bytes", i_MEMORY.stats.great_pages_alloc, i_MEMORY.page_size);
             log_printf("============================");
 
 #if defined(__MEMORY_AUDITOR__)
             if (i_HEAP_VERBOSE == TRUE)
             {
                 uint32_t i;
-                for (i = 0; i < i_MEMORY.num_objects; ++i)
-                    log_printf("'%s' a/deallocations: %u, %u (%" PRIu64 ") bytes", i_MEMORY.objects[i].name, i_MEMORY.objects[i].num_allocs, i_MEMORY.objects[i].num_deallocs, i_MEMORY.objects[i].bytes_alloc);
+                for (i = 0; i < i_MEMORY.audit.num_objects; ++i)
+                    log_printf("'%s' a/deallocations: %u, %u (%" PRIu64 ") bytes", i_MEMORY.audit.objects[i].name, i_MEMORY.audit.objects[i].num_allocs, i_MEMORY.audit.objects[i].num_deallocs, i_MEMORY.audit.objects[i].bytes_alloc);
             }
 #endif
         }
@@ -424,124 +1128,114 @@ static uint32_t i_next_pow2(const uint32_t value)
 
 void _heap_page_size(const uint32_t size)
 {
-    cassert(i_MEMORY.current_page == NULL);
+    cassert(i_MEMORY.caches == NULL);
     i_PAGESIZE = i_next_pow2(size);
     if (i_PAGESIZE < 1024)
         i_PAGESIZE = 1024;
 }
 
-#if defined(__MEMORY_AUDITOR__)
-
 /*---------------------------------------------------------------------------*/
 
 /*
-static void i_dump_objects(void)
+ * Blocks allocated inside an arena scope carry the tagged arena pointer
+ * in the same trailer slot where paged blocks store their page.
+ */
+static ___INLINE Arena *i_block_arena(byte_t *mem, const uint32_t size)
 {
-   uint32_t i;
-   log_printf("Num objects: %d", i_MEMORY.num_objects);
-   for (i = 0; i < i_MEMORY.num_objects; ++i)
-       log_printf("%s %d %d", i_MEMORY.objects[i].name, i_MEMORY.objects[i].num_allocs, i_MEMORY.objects[i].num_deallocs);
+    intptr_t trailer = (intptr_t)*dcast(mem + size, void);
+    if (__FALSE_EXPECTED((trailer & 1) == 1))
+        return cast((void *)(trailer & ~(intptr_t)1), Arena);
+    return NULL;
 }
- */
 
 /*---------------------------------------------------------------------------*/
 
-static int i_object_key(const i_Object *object, const char_t *name)
+static byte_t *i_arena_realloc(Arena *arena, byte_t *mem, const uint32_t size, const uint32_t new_size, const uint32_t align, const char_t *name)
 {
-    return str_cmp_cn(object->name, name, OBJECT_NAME_SIZE);
+    Arena *scope = i_THREAD_ARENA;
+    byte_t *new_mem = NULL;
+    /* Arena blocks come from the heap itself */
+    i_THREAD_ARENA = NULL;
+    if (mem != NULL)
+        new_mem = _arena_realloc(arena, mem, size + (uint32_t)sizeofptr, new_size + (uint32_t)sizeofptr, align);
+    else
+        new_mem = arena_alloc(arena, new_size + (uint32_t)sizeofptr, align);
+    i_THREAD_ARENA = scope;
+    *dcast(new_mem + new_size, void) = (void *)((intptr_t)arena | 1);
+
+    /* The arena keeps the live objects until its memory is released */
+    if (mem != NULL)
+        _arena_obj_free(arena, name, size);
+    _arena_obj_alloc(arena, name, new_size);
+    return new_mem;
 }
 
 /*---------------------------------------------------------------------------*/
 
-static i_Object *i_get_object(const char_t *name, const bool_t equal_sized, const uint32_t size)
+static byte_t *i_malloc_imp(const uint32_t size, const uint32_t align, const char_t *name, const bool_t equal_sized)
 {
-    uint32_t index = UINT32_MAX;
-    if (blib_bsearch(cast_const(i_MEMORY.objects, byte_t), cast_const(name, byte_t), i_MEMORY.num_objects, sizeof(i_Object), (FPtr_compare)i_object_key, &index) == TRUE)
-    {
-        i_Object *object = i_MEMORY.objects + index;
-        cassert_msg(object->equal_sized == equal_sized, "heap auditor: Not 'equal_sized' property with same 'name'.");
-        cassert_msg(object->equal_sized == FALSE || object->size == size, "heap auditor: alloc 'equal_sized' object type with different size.");
-        return object;
-    }
-    else
-    {
-        i_Object *new_object = NULL;
-        if (i_MEMORY.num_objects == i_MEMORY.objects_alloc)
-        {
-            i_MEMORY.objects = cast(bmem_realloc(cast(i_MEMORY.objects, byte_t), i_MEMORY.objects_alloc * (uint32_t)sizeof(i_Object), (i_MEMORY.objects_alloc + OBJECTS_ARRAY_GROW_SIZE) * (uint32_t)sizeof(i_Object)), i_Object);
-            i_MEMORY.objects_alloc += OBJECTS_ARRAY_GROW_SIZE;
-        }
+    byte_t *mem = NULL;
+    i_Cache *cache = NULL;
+    i_Stats *stats = NULL;
 
-        /* Move all elems from index 1 postion right (keep the array sorted) */
-        if ((i_MEMORY.num_objects - index) > 0)
-        {
-            bmem_move(cast(i_MEMORY.objects + index + 1, byte_t),
-                      cast_const(i_MEMORY.objects + index, byte_t),
-                      (i_MEMORY.num_objects - index) * (uint32_t)sizeof(i_Object));
-        }
+    cassert(size > 0);
+    /* Scoped objects are accounted as any other heap object */
+    if (i_THREAD_ARENA != NULL)
+        mem = i_arena_realloc(i_THREAD_ARENA, NULL, 0, size, align, name);
 
-        new_object = i_MEMORY.objects + index;
-        bmem_zero(new_object, i_Object);
-        str_copy_c(new_object->name, OBJECT_NAME_SIZE, name);
-        new_object->equal_sized = equal_sized;
-        new_object->size = size;
-        i_MEMORY.num_objects += 1;
-        return new_object;
-    }
-}
+    cache = i_alloc_cache(&i_MEMORY);
+    stats = i_lock(&i_MEMORY, cache);
+    stats->num_allocs += 1;
+    stats->total_bytes_allocated += size;
+    stats->bytes_allocated += size;
+    i_peak(stats);
 
-/*---------------------------------------------------------------------------*/
+    if (__TRUE_EXPECTED(mem == NULL))
+        mem = i_malloc(i_MEMORY.page_size, cache, stats, size, align, equal_sized);
 
-static i_Object *i_get_existing_object(const char_t *name)
-{
-    uint32_t index = UINT32_MAX;
-    if (blib_bsearch(cast_const(i_MEMORY.objects, byte_t), cast_const(name, byte_t), i_MEMORY.num_objects, sizeof(i_Object), (FPtr_compare)i_object_key, &index) == TRUE)
-    {
-        return i_MEMORY.objects + index;
-    }
-    else
+#if defined(__MEMORY_AUDITOR__)
     {
-        cassert_fatal_msg(FALSE, "heap auditor: non-existent 'name' object.");
-        return NULL;
+        i_Object *object = i_get_object(i_audit(&i_MEMORY, cache), name, equal_sized, size);
+        object->num_allocs += 1;
+        object->bytes_alloc += size;
     }
-}
-
+#else
+    unref(name);
 #endif
 
+    i_unlock(&i_MEMORY, cache);
+    return mem;
+}
+
 /*---------------------------------------------------------------------------*/
 
-static ___INLINE byte_t *i_malloc_imp(const uint32_t size, const uint32_t align, const char_t *name, const bool_t equal_sized)
+Arena *_heap_arena(Arena *arena)
 {
-    byte_t *mem = NULL;
-
-    cassert(size > 0);
+    Arena *prev = i_THREAD_ARENA;
+    i_THREAD_ARENA = arena;
+    return prev;
+}
 
-    if (i_MEMORY.mutex != NULL)
-        bmutex_lock(i_MEMORY.mutex);
+/*---------------------------------------------------------------------------*/
 
-    i_MEMORY.num_allocs += 1;
-    i_MEMORY.total_bytes_allocated += size;
-    i_MEMORY.bytes_allocated += size;
-    if (i_MEMORY.bytes_allocated > i_MEMORY.max_bytes_allocated)
-        i_MEMORY.max_bytes_allocated = i_MEMORY.bytes_allocated;
+void _heap_arena_free(const char_t *name, const uint32_t num, const uint64_t bytes)
+{
+    i_dealloc_stats(&i_MEMORY, num, bytes);
 
 #if defined(__MEMORY_AUDITOR__)
     {
-        i_Object *object = i_get_object(name, equal_sized, size);
-        object->num_allocs += 1;
-        object->bytes_alloc += size;
+        i_Cache *cache = i_alloc_cache(&i_MEMORY);
+        i_Object *object = NULL;
+        i_lock(&i_MEMORY, cache);
+        object = i_get_existing_object(i_audit(&i_MEMORY, cache), name, (bool_t)(i_MEMORY.mtcount > 0));
+        cassert_msg(i_MEMORY.mtcount > 0 || object->num_allocs >= object->num_deallocs + num, "heap auditor: arena objects without allocs.");
+        object->num_deallocs += num;
+        object->bytes_dealloc += bytes;
+        i_unlock(&i_MEMORY, cache);
     }
 #else
     unref(name);
-    unref(equal_sized);
 #endif
-
-    mem = i_malloc(&i_MEMORY, size, align);
-
-    if (i_MEMORY.mutex != NULL)
-        bmutex_unlock(i_MEMORY.mutex);
-
-    return mem;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -560,9 +1254,26 @@ void heap_end_mt(void)
 {
     bmutex_lock(i_MEMORY.mutex);
     cassert(i_MEMORY.mtcount > 0);
-    i_MEMORY.mtcount -= 1;
-    if (i_MEMORY.mtcount == 0)
+    if (i_MEMORY.mtcount == 1)
+    {
+        /* Back to single-thread. Merge the per-thread statistics */
         osbs_memory_mt(NULL);
+        i_merge_caches(&i_MEMORY);
+        i_MEMORY.mtcount = 0;
+    }
+    else
+    {
+        i_MEMORY.mtcount -= 1;
+    }
+    bmutex_unlock(i_MEMORY.mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void heap_thread_caches(const bool_t enable)
+{
+    bmutex_lock(i_MEMORY.mutex);
+    i_THREAD_CACHES = enable;
     bmutex_unlock(i_MEMORY.mutex);
 }
 
@@ -605,7 +1316,7 @@ byte_t *heap_calloc_imp(const uint32_t size, const char_t *name, const bool_t eq
 
 /*---------------------------------------------------------------------------*/
 
-static ___INLINE byte_t *i_realloc_imp(byte_t *mem, const uint32_t size, const uint32_t new_size, const uint32_t align, const char_t *name)
+static byte_t *i_realloc_imp(byte_t *mem, const uint32_t size, const uint32_t new_size, const uint32_t align, const char_t *name)
 {
     cassert_no_null(mem);
     cassert(size > 0);
@@ -613,39 +1324,40 @@ static ___INLINE byte_t *i_realloc_imp(byte_t *mem, const uint32_t size, const u
 
     if (__TRUE_EXPECTED(size != new_size))
     {
+        Arena *arena = i_block_arena(mem, size);
         byte_t *new_mem = NULL;
-        bool_t locked = FALSE;
+        i_Cache *cache = NULL;
+        i_Stats *stats = NULL;
 
-        if (i_MEMORY.mtcount > 0)
-        {
-            bmutex_lock(i_MEMORY.mutex);
-            locked = TRUE;
-        }
+        if (__FALSE_EXPECTED(arena != NULL))
+            new_mem = i_arena_realloc(arena, mem, size, new_size, align, name);
+        else
+            new_mem = i_realloc(&i_MEMORY, mem, new_size, size, align);
 
-        new_mem = i_realloc(&i_MEMORY, mem, new_size, size, align);
-        i_MEMORY.num_reallocs += 1;
-        i_MEMORY.total_bytes_deallocated += size;
-        i_MEMORY.total_bytes_allocated += new_size;
+        cache = i_alloc_cache(&i_MEMORY);
+        stats = i_lock(&i_MEMORY, cache);
+        stats->num_reallocs += 1;
+        stats->total_bytes_deallocated += size;
+        stats->total_bytes_allocated += new_size;
 
         if (new_mem != mem)
-            i_MEMORY.total_bytes_moved_in_reallocs += size;
+            stats->total_bytes_moved_in_reallocs += size;
         else
-            i_MEMORY.num_effective_reallocs += 1;
+            stats->num_effective_reallocs += 1;
 
         if (new_size > size)
         {
-            i_MEMORY.bytes_allocated += new_size - size;
-            if (i_MEMORY.bytes_allocated > i_MEMORY.max_bytes_allocated)
-                i_MEMORY.max_bytes_allocated = i_MEMORY.bytes_allocated;
+            stats->bytes_allocated += new_size - size;
+            i_peak(stats);
         }
         else
         {
-            i_MEMORY.bytes_allocated -= size - new_size;
+            stats->bytes_allocated -= size - new_size;
         }
 
 #if defined(__MEMORY_AUDITOR__)
         {
-            i_Object *object = i_get_object(name, FALSE, UINT32_MAX);
+            i_Object *object = i_get_object(i_audit(&i_MEMORY, cache), name, FALSE, UINT32_MAX);
             object->bytes_alloc += new_size;
             object->bytes_dealloc += size;
         }
@@ -653,9 +1365,7 @@ static ___INLINE byte_t *i_realloc_imp(byte_t *mem, const uint32_t size, const u
         unref(name);
 #endif
 
-        if (locked == TRUE)
-            bmutex_unlock(i_MEMORY.mutex);
-
+        i_unlock(&i_MEMORY, cache);
         return new_mem;
     }
     else
@@ -700,91 +1410,244 @@ byte_t *heap_aligned_realloc(byte_t *mem, const uint32_t size, const uint32_t ne
 void heap_free(byte_t **mem, const uint32_t size, const char_t *name)
 {
     byte_t *mem_ptr = NULL;
-    bool_t locked = FALSE;
+    Arena *arena = NULL;
     cassert_no_null(mem);
     cassert_no_null(*mem);
     cassert(size > 0);
 
-    if (i_MEMORY.mtcount > 0)
-    {
-        bmutex_lock(i_MEMORY.mutex);
-        locked = TRUE;
-    }
-
     mem_ptr = *mem;
     *mem = NULL;
-    i_free(&i_MEMORY, mem_ptr, size, sizeofptr);
 
-    i_MEMORY.num_deallocs += 1;
-    i_MEMORY.total_bytes_deallocated += size;
-    cassert_fatal(i_MEMORY.bytes_allocated >= size);
-    i_MEMORY.bytes_allocated -= size;
+    /* Arena objects memory is released all at once in 'arena_reset' */
+    arena = i_block_arena(mem_ptr, size);
+    if (__FALSE_EXPECTED(arena != NULL))
+    {
+        _arena_obj_free(arena, name, size);
+        i_dealloc_stats(&i_MEMORY, 1, size);
+    }
+    else
+    {
+        i_free(&i_MEMORY, mem_ptr, size, sizeofptr, TRUE);
+    }
 
 #if defined(__MEMORY_AUDITOR__)
     {
-        i_Object *object = i_get_existing_object(name);
-        cassert_msg(object->equal_sized == FALSE || object->size == size, "heap auditor: free 'equal_sized' object type with different size.");
-        cassert_msg(object->num_allocs > 0, "heap auditor: free object type without allocs.");
+        i_Cache *cache = i_alloc_cache(&i_MEMORY);
+        i_Object *object = NULL;
+        i_lock(&i_MEMORY, cache);
+        object = i_get_existing_object(i_audit(&i_MEMORY, cache), name, (bool_t)(i_MEMORY.mtcount > 0));
+        cassert_msg(object->typed == FALSE || object->equal_sized == FALSE || object->size == size, "heap auditor: free 'equal_sized' object type with different size.");
+        cassert_msg(i_MEMORY.mtcount > 0 || object->num_allocs > 0, "heap auditor: free object type without allocs.");
         object->num_deallocs += 1;
         object->bytes_dealloc += size;
+        i_unlock(&i_MEMORY, cache);
     }
 #else
     unref(name);
 #endif
+}
+
+/*---------------------------------------------------------------------------*/
 
-    if (locked == TRUE)
-        bmutex_unlock(i_MEMORY.mutex);
+/*
+ * Blocks out of 32-bit range always have their own system allocation.
+ * They never live in pages, slabs or arenas. Smaller blocks are forwarded
+ * to the 32-bit functions, so both APIs can be mixed on the same block.
+ */
+#define i_HUGE_SIZE 0xFFFF0000
+
+static ___INLINE bool_t i_is_huge(const uint64_t size)
+{
+    return (bool_t)(size > i_HUGE_SIZE);
 }
 
 /*---------------------------------------------------------------------------*/
 
-void heap_auditor_add(const char_t *name)
+static void i_huge_stats(const uint64_t alloc, const uint64_t dealloc, const char_t *name)
 {
+    i_Cache *cache = i_alloc_cache(&i_MEMORY);
+    i_Stats *stats = i_lock(&i_MEMORY, cache);
+
+    /* heap_realloc64 between two huge blocks */
+    if (alloc > 0 && dealloc > 0)
+    {
+        stats->num_reallocs += 1;
+        stats->total_bytes_moved_in_reallocs += dealloc < alloc ? dealloc : alloc;
+    }
+    else if (alloc > 0)
+    {
+        stats->num_allocs += 1;
+        stats->great_pages_alloc += 1;
+    }
+    else
+    {
+        stats->num_deallocs += 1;
+        stats->great_pages_dealloc += 1;
+    }
+
+    stats->total_bytes_allocated += alloc;
+    stats->total_bytes_deallocated += dealloc;
+    cassert_fatal(i_MEMORY.mtcount > 0 || stats->bytes_allocated + alloc >= dealloc);
+    stats->bytes_allocated += alloc;
+    stats->bytes_allocated -= dealloc;
+    i_peak(stats);
+
 #if defined(__MEMORY_AUDITOR__)
     {
+        i_Audit *audit = i_audit(&i_MEMORY, cache);
         i_Object *object = NULL;
-        bool_t locked = FALSE;
-
-        if (i_MEMORY.mtcount > 0)
+        if (alloc > 0)
         {
-            bmutex_lock(i_MEMORY.mutex);
-            locked = TRUE;
+            object = i_get_object(audit, name, FALSE, UINT32_MAX);
+            if (dealloc == 0)
+                object->num_allocs += 1;
+        }
+        else
+        {
+            object = i_get_existing_object(audit, name, (bool_t)(i_MEMORY.mtcount > 0));
+            cassert_msg(i_MEMORY.mtcount > 0 || object->num_allocs > 0, "heap auditor: free object type without allocs.");
+            object->num_deallocs += 1;
         }
 
-        object = i_get_object(name, TRUE, 0);
-        object->num_allocs += 1;
-        i_MEMORY.num_allocs += 1;
-
-        if (locked == TRUE)
-            bmutex_unlock(i_MEMORY.mutex);
+        object->bytes_alloc += alloc;
+        object->bytes_dealloc += dealloc;
     }
 #else
     unref(name);
 #endif
+
+    i_unlock(&i_MEMORY, cache);
 }
 
 /*---------------------------------------------------------------------------*/
 
-void heap_auditor_delete(const char_t *name)
+/* In 32-bit systems, a 64-bit size can exceed the address space */
+static ___INLINE bool_t i_fits_system(const uint64_t size)
+{
+    return (bool_t)(size < (uint64_t)(size_t)-1 - sizeofptr);
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *_heap_try_malloc64(const uint64_t size, const char_t *name)
+{
+    if (i_is_huge(size) == TRUE)
+    {
+        byte_t *mem = NULL;
+        if (i_fits_system(size) == FALSE)
+            return NULL;
+
+        mem = bmem_aligned_malloc(size + sizeofptr, sizeofptr);
+        if (mem == NULL)
+            return NULL;
+
+        *dcast(mem + size, void) = NULL;
+        i_huge_stats(size, 0, name);
+        return mem;
+    }
+    else
+    {
+        return i_malloc_imp((uint32_t)size, sizeofptr, name, FALSE);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *heap_malloc64(const uint64_t size, const char_t *name)
+{
+    byte_t *mem = _heap_try_malloc64(size, name);
+    cassert_fatal_msg(mem != NULL, "heap: Out of memory.");
+    return mem;
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *heap_calloc64(const uint64_t size, const char_t *name)
+{
+    byte_t *mem = heap_malloc64(size, name);
+    bmem_set_zero(mem, size);
+    return mem;
+}
+
+/*---------------------------------------------------------------------------*/
+
+byte_t *heap_realloc64(byte_t *mem, const uint64_t size, const uint64_t new_size, const char_t *name)
+{
+    bool_t huge = i_is_huge(size);
+    bool_t new_huge = i_is_huge(new_size);
+    if (huge == FALSE && new_huge == FALSE)
+    {
+        return i_realloc_imp(mem, (uint32_t)size, (uint32_t)new_size, sizeofptr, name);
+    }
+    else if (huge == TRUE && new_huge == TRUE)
+    {
+        byte_t *new_mem = NULL;
+        cassert_fatal_msg(i_fits_system(new_size) == TRUE, "heap: Out of memory.");
+        new_mem = bmem_aligned_realloc(mem, size + sizeofptr, new_size + sizeofptr, sizeofptr);
+        cassert_fatal(new_mem != NULL);
+        *dcast(new_mem + new_size, void) = NULL;
+        i_huge_stats(new_size, size, name);
+        return new_mem;
+    }
+    /* Block crosses the 32-bit limit */
+    else
+    {
+        byte_t *new_mem = heap_malloc64(new_size, name);
+        bmem_copy(new_mem, mem, size < new_size ? size : new_size);
+        heap_free64(&mem, size, name);
+        return new_mem;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void heap_free64(byte_t **mem, const uint64_t size, const char_t *name)
+{
+    cassert_no_null(mem);
+    cassert_no_null(*mem);
+    if (i_is_huge(size) == TRUE)
+    {
+        bmem_free(*mem);
+        *mem = NULL;
+        i_huge_stats(0, size, name);
+    }
+    else
+    {
+        heap_free(mem, (uint32_t)size, name);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void heap_auditor_add(const char_t *name)
 {
 #if defined(__MEMORY_AUDITOR__)
     {
-        i_Object *object = NULL;
-        bool_t locked = FALSE;
+        i_Cache *cache = i_alloc_cache(&i_MEMORY);
+        i_Stats *stats = i_lock(&i_MEMORY, cache);
+        i_Object *object = i_get_object(i_audit(&i_MEMORY, cache), name, TRUE, 0);
+        object->num_allocs += 1;
+        stats->num_allocs += 1;
+        i_unlock(&i_MEMORY, cache);
+    }
+#else
+    unref(name);
+#endif
+}
 
-        if (i_MEMORY.mtcount > 0)
-        {
-            bmutex_lock(i_MEMORY.mutex);
-            locked = TRUE;
-        }
+/*---------------------------------------------------------------------------*/
 
-        object = i_get_existing_object(name);
-        cassert_msg(object->num_allocs > 0, "heap auditor: free auditor object type without allocs.");
+void heap_auditor_delete(const char_t *name)
+{
+#if defined(__MEMORY_AUDITOR__)
+    {
+        i_Cache *cache = i_alloc_cache(&i_MEMORY);
+        i_Stats *stats = i_lock(&i_MEMORY, cache);
+        i_Object *object = i_get_existing_object(i_audit(&i_MEMORY, cache), name, (bool_t)(i_MEMORY.mtcount > 0));
+        cassert_msg(i_MEMORY.mtcount > 0 || object->num_allocs > 0, "heap auditor: free auditor object type without allocs.");
         object->num_deallocs += 1;
-        i_MEMORY.num_deallocs += 1;
-
-        if (locked == TRUE)
-            bmutex_unlock(i_MEMORY.mutex);
+        stats->num_deallocs += 1;
+        i_unlock(&i_MEMORY, cache);
     }
 #else
     unref(name);
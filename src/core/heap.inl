@@ -10,7 +10,7 @@
 
 /* Basic memory system */
 
-#include <sewer/config.hxx>
+#include "core.hxx"
 
 __EXTERN_C
 
@@ -20,4 +20,10 @@ void _heap_finish(void);
 
 void _heap_page_size(const uint32_t size);
 
+Arena *_heap_arena(Arena *arena);
+
+void _heap_arena_free(const char_t *name, const uint32_t num, const uint64_t bytes);
+
+byte_t *_heap_try_malloc64(const uint64_t size, const char_t *name);
+
 __END_C
@@ -14,6 +14,7 @@
 #include "hfileh.h"
 #include "arrst.h"
 #include "buffer.h"
+#include "buffer.inl"
 #include "date.h"
 #include "event.h"
 #include "stream.h"
@@ -443,17 +444,26 @@ bool_t hfile_is_uptodate(const char_t *src, const char_t *dest)
 
 /*---------------------------------------------------------------------------*/
 
-static bool_t i_read_entire_file(const char_t *pathname, byte_t *file_data, const uint32_t file_size, ferror_t *error)
+static bool_t i_read_entire_file(const char_t *pathname, byte_t *file_data, const uint64_t file_size, ferror_t *error)
 {
     File *file = NULL;
-    uint32_t bytes_readed;
-    bool_t readed = FALSE;
+    uint64_t bytes_readed = 0;
+    bool_t readed = TRUE;
 
     file = bfile_open(pathname, ekREAD, error);
     if (__FALSE_EXPECTED(file == NULL))
         return FALSE;
 
-    readed = bfile_read(file, file_data, file_size, &bytes_readed, error);
+    /* The system can return less bytes than requested (or limit reads to 2GB) */
+    while (readed == TRUE && bytes_readed < file_size)
+    {
+        uint64_t remain = file_size - bytes_readed;
+        uint32_t chunk = remain > 0x40000000 ? 0x40000000 : (uint32_t)remain;
+        uint32_t rsize = 0;
+        readed = bfile_read(file, file_data + bytes_readed, chunk, &rsize, error);
+        bytes_readed += rsize;
+    }
+
     bfile_close(&file);
 
     if (readed == TRUE && bytes_readed == file_size)
@@ -518,22 +528,21 @@ Buffer *hfile_buffer(const char_t *pathname, ferror_t *error)
     {
         if (file_type == ekARCHIVE)
         {
-            if (file_size < 0xFFFFFFFF)
+            /* Not enough memory (or address space in 32-bit systems) */
+            Buffer *buffer = _buffer_try_create64(file_size);
+            if (buffer == NULL)
             {
-                Buffer *buffer = buffer_create((uint32_t)file_size);
-                if (i_read_entire_file(pathname, buffer_data(buffer), (uint32_t)file_size, error) == TRUE)
-                {
-                    return buffer;
-                }
-                else
-                {
-                    buffer_destroy(&buffer);
-                    return NULL;
-                }
+                ptr_assign(error, ekFBIG);
+                return NULL;
+            }
+
+            if (i_read_entire_file(pathname, buffer_data(buffer), file_size, error) == TRUE)
+            {
+                return buffer;
             }
             else
             {
-                ptr_assign(error, ekFBIG);
+                buffer_destroy(&buffer);
                 return NULL;
             }
         }
@@ -629,6 +638,43 @@ Stream *hfile_stream(const char_t *pathname, ferror_t *error)
 
 /*---------------------------------------------------------------------------*/
 
+/*
+ * Read-only view of the file. If the file is truncated while mapped, reading the
+ * lost pages raises SIGBUS (EXCEPTION_IN_PAGE_ERROR on Windows). Use 'hfile_buffer'
+ * for files that other processes can modify.
+ */
+const byte_t *hfile_mmap(const char_t *pathname, uint64_t *size, ferror_t *error)
+{
+    file_type_t file_type;
+    cassert_no_null(size);
+    *size = 0;
+    if (bfile_lstat(pathname, &file_type, NULL, NULL, error) == TRUE)
+    {
+        if (file_type == ekARCHIVE)
+        {
+            return bfile_mmap(pathname, size, error);
+        }
+        else
+        {
+            ptr_assign(error, ekFNOFILE);
+            return NULL;
+        }
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void hfile_munmap(const byte_t **data, const uint64_t size)
+{
+    bfile_munmap(data, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
 bool_t hfile_from_string(const char_t *pathname, const String *str, ferror_t *error)
 {
     File *file = bfile_create(pathname, error);
@@ -41,6 +41,10 @@ _core_api String *hfile_string(const char_t *pathname, ferror_t *error);
 
 _core_api Stream *hfile_stream(const char_t *pathname, ferror_t *error);
 
+_core_api const byte_t *hfile_mmap(const char_t *pathname, uint64_t *size, ferror_t *error);
+
+_core_api void hfile_munmap(const byte_t **data, const uint64_t size);
+
 _core_api bool_t hfile_from_string(const char_t *pathname, const String *str, ferror_t *error);
 
 _core_api bool_t hfile_from_data(const char_t *pathname, const byte_t *data, const uint32_t size, ferror_t *error);
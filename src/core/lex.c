@@ -13,6 +13,7 @@
 #include "lex.inl"
 #include "stream.inl"
 #include "heap.h"
+#include "heap.inl"
 #include "stream.h"
 #include "strings.h"
 #include <sewer/cassert.h>
@@ -74,9 +75,12 @@ struct _lexscn_t
 
 LexScn *_lexscn_create(void)
 {
+    /* The scanner belongs to a stream, never to an active arena scope */
+    Arena *arena = _heap_arena(NULL);
     LexScn *lex = heap_new0(LexScn);
     lex->lexsize = 256;
     lex->lexeme = cast(heap_malloc(lex->lexsize, "LexLexeme"), char_t);
+    _heap_arena(arena);
     return lex;
 }
 
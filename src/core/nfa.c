@@ -29,7 +29,8 @@ typedef enum _symbol_t
     ekCONCAT,
     ekCLOSURE,
     ekLEFT_PAR,
-    ekRIGH_PAR
+    ekRIGH_PAR,
+    ekGROUP
 } symbol_t;
 
 struct _ntoken_t
@@ -51,10 +52,15 @@ struct _nfa_t
     ArrSt(Trans) *ttable;
     ArrSt(uint32_t) *current;
     ArrSt(uint32_t) *temp;
+    uint32_t *mark;
+    uint32_t gen;
+    uint32_t ngroups;
 };
 
 #define MIN_UNICODE 5
 #define MAX_UNICODE 1114112
+/* Epsilon-transition that saves the input position in capture slot 'extra' */
+#define TAG_SYMBOL (UINT32_MAX - 1)
 DeclSt(NToken);
 DeclSt(Trans);
 DeclSt(symbol_t);
@@ -111,6 +117,10 @@ static void i_write_tokens(Stream *stm, const ArrSt(NToken) *tokens)
             stm_write_char(stm, token->from);
             break;
 
+        case ekGROUP:
+            stm_printf(stm, "$%d", token->from);
+            break;
+
         default:
             cassert_default(token->symbol);
         }
@@ -126,7 +136,11 @@ static void i_write_nfa(Stream *stm, const NFA *nfa)
 {
     cassert_no_null(nfa);
     arrst_foreach(trans, nfa->ttable, Trans)
-        if (trans->symbol != UINT32_MAX)
+        if (trans->symbol == TAG_SYMBOL)
+        {
+            stm_printf(stm, "%d [$%d] --> %d\n", trans_i, trans->extra, trans->state);
+        }
+        else if (trans->symbol != UINT32_MAX)
         {
             if (trans->extra == 0)
             {
@@ -229,6 +243,8 @@ void _nfa_destroy(NFA **nfa)
 {
     cassert_no_null(nfa);
     cassert_no_null(*nfa);
+    if ((*nfa)->mark != NULL)
+        heap_delete_n(&(*nfa)->mark, arrst_size((*nfa)->ttable, Trans), uint32_t);
     arrst_destroy(&(*nfa)->ttable, NULL, Trans);
     if ((*nfa)->current != NULL)
     {
@@ -251,6 +267,7 @@ static ArrSt(NToken) *i_tokens_unix_regex(const char_t *regex)
     ArrSt(NToken) *tokens = arrst_create(NToken);
     ArrSt(NToken) *opens = arrst_create(NToken);
     uint32_t codepoint = unicode_to_u32(regex, ekUTF8);
+    uint32_t groups = 0;
     bool_t backslash = FALSE;
     while (codepoint != 0 && ok)
     {
@@ -307,6 +324,7 @@ static ArrSt(NToken) *i_tokens_unix_regex(const char_t *regex)
             case '(':
                 token.symbol = ekLEFT_PAR;
                 token.from = '(';
+                token.to = ++groups;
                 arrst_append(opens, token, NToken);
                 break;
 
@@ -404,6 +422,7 @@ static void i_implicits_unix_regex(ArrSt(NToken) *tokens)
         case ekOR:
         case ekCONCAT:
         case ekCLOSURE:
+        case ekGROUP:
         default:
             break;
         }
@@ -480,11 +499,21 @@ static void i_regex_to_infix(ArrSt(NToken) **tokens)
                 else
                 {
                     cassert((token->from == ']' && top.from == '[') || (token->from == ')' && top.from == '('));
+                    /* Capture group: unary operator over the group contents */
+                    if (top.from == '(')
+                    {
+                        NToken group;
+                        group.symbol = ekGROUP;
+                        group.from = top.to;
+                        group.to = top.to;
+                        arrst_append(output, group, NToken);
+                    }
                     break;
                 }
             }
             break;
 
+        case ekGROUP:
         default:
             cassert_default(token->symbol);
         }
@@ -536,6 +565,30 @@ static void i_offset(ArrSt(Trans) *ttable, const uint32_t offset)
 
 /*---------------------------------------------------------------------------*/
 
+/* Adds an epsilon-transition from 'last' to 'state' */
+static void i_epsilon_last(ArrSt(Trans) *ttable, const uint32_t state)
+{
+    Trans *trans = arrst_last(ttable, Trans);
+    cassert(i_is_last(trans) == TRUE);
+
+    /* Base, Union and Concat NFA */
+    if (trans->state == UINT32_MAX)
+    {
+        trans->state = state;
+        trans->symbol = UINT32_MAX;
+        trans->extra = UINT32_MAX;
+    }
+    /* Closure NFA: keeps the loop epsilon-transition */
+    else
+    {
+        cassert(trans->symbol == UINT32_MAX);
+        cassert(trans->extra == UINT32_MAX);
+        trans->extra = state;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
 static NFA *i_nfa_base(const uint32_t from, const uint32_t to)
 {
     NFA *nfa = heap_new0(NFA);
@@ -577,18 +630,10 @@ static void i_nfa_union(NFA *nfa1, NFA *nfa2)
     trans->extra = n1 + 1;
 
     /* 4) Adds an epsilon-transition from nfa1-'last' to new 'last'  */
-    trans = arrst_last(nfa1->ttable, Trans);
-    cassert(i_is_last(trans) == TRUE);
-    trans->state = n1 + n2 + 1;
-    trans->symbol = UINT32_MAX;
-    trans->extra = UINT32_MAX;
+    i_epsilon_last(nfa1->ttable, n1 + n2 + 1);
 
     /* 5) Adds an epsilon-transition from nfa2-'last' to new 'last'  */
-    trans = arrst_last(nfa2->ttable, Trans);
-    cassert(i_is_last(trans) == TRUE);
-    trans->state = n1 + n2 + 1;
-    trans->symbol = UINT32_MAX;
-    trans->extra = UINT32_MAX;
+    i_epsilon_last(nfa2->ttable, n1 + n2 + 1);
 
     /* 6) Copy all df2 transitions to df1 */
     arrst_new_n(nfa1->ttable, n2, Trans);
@@ -620,22 +665,7 @@ static void i_nfa_concat(NFA *nfa1, NFA *nfa2)
     i_offset(nfa2->ttable, n1);
 
     /* 2) Adds an epsilon-transition from nfa1-'last' to nfa2-'0' */
-    trans = arrst_last(nfa1->ttable, Trans);
-    cassert(i_is_last(trans) == TRUE);
-    trans->symbol = UINT32_MAX;
-
-    /* Base, Union and Concat NFA */
-    if (trans->state == UINT32_MAX)
-    {
-        trans->state = n1;
-        trans->extra = UINT32_MAX;
-    }
-    /* Closure NFA */
-    else
-    {
-        cassert(trans->extra == UINT32_MAX);
-        trans->extra = n1;
-    }
+    i_epsilon_last(nfa1->ttable, n1);
 
     /* 3) Copy all df2 transitions to df1 */
     arrst_new_n(nfa1->ttable, n2, Trans);
@@ -664,24 +694,7 @@ static void i_nfa_closure(NFA *nfa1)
     trans->extra = n1 + 1;
 
     /* 3) Adds an epsilon-transition from nfa1-'last' to nfa1-'newlast' */
-    trans = arrst_last(nfa1->ttable, Trans);
-    cassert(i_is_last(trans) == TRUE);
-    cassert(trans->symbol == 0);
-    trans->symbol = UINT32_MAX;
-
-    /* Base, Union and Concat NFA */
-    if (trans->state == UINT32_MAX)
-    {
-        trans->state = n1 + 1;
-        trans->extra = UINT32_MAX;
-    }
-    /* Closure NFA */
-    else
-    {
-        cassert(trans->state == 0);
-        cassert(trans->extra == UINT32_MAX);
-        trans->extra = n1 + 1;
-    }
+    i_epsilon_last(nfa1->ttable, n1 + 1);
 
     /* 4) Adds a nfa1-'newlast' with a transition to nfa1-'0' */
     trans = arrst_new(nfa1->ttable, Trans);
@@ -692,10 +705,45 @@ static void i_nfa_closure(NFA *nfa1)
 
 /*---------------------------------------------------------------------------*/
 
+static void i_nfa_group(NFA *nfa1, const uint32_t group)
+{
+    uint32_t n1;
+    Trans *trans = NULL;
+    cassert_no_null(nfa1);
+    n1 = arrst_size(nfa1->ttable, Trans);
+
+    /* 1) Move one position all states in nfa1 (the new '0' state)  */
+    i_offset(nfa1->ttable, 1);
+
+    /* 2) Prepends a new '0' state with a tag-transition (group start) to nfa1-'0' */
+    trans = arrst_prepend_n(nfa1->ttable, 1, Trans);
+    trans->state = 1;
+    trans->symbol = TAG_SYMBOL;
+    trans->extra = 2 * group;
+
+    /* 3) Adds an epsilon-transition from nfa1-'last' to a new tag state */
+    i_epsilon_last(nfa1->ttable, n1 + 1);
+
+    /* 4) Adds the tag-transition (group end) to the new 'last' */
+    trans = arrst_new(nfa1->ttable, Trans);
+    trans->state = n1 + 2;
+    trans->symbol = TAG_SYMBOL;
+    trans->extra = 2 * group + 1;
+
+    /* 5) Add the last state (accept) */
+    trans = arrst_new(nfa1->ttable, Trans);
+    trans->state = UINT32_MAX;
+    trans->symbol = 0;
+    trans->extra = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static NFA *i_infix_to_NFA(const ArrSt(NToken) *tokens)
 {
     ArrPt(NFA) *stack = arrpt_create(NFA);
     NFA *nfa = NULL;
+    uint32_t ngroups = 0;
 
     arrst_foreach_const(token, tokens, NToken)
         switch (token->symbol)
@@ -740,6 +788,16 @@ static NFA *i_infix_to_NFA(const ArrSt(NToken) *tokens)
             break;
         }
 
+        case ekGROUP:
+        {
+            NFA *nfa1 = arrpt_last(stack, NFA);
+            i_nfa_group(nfa1, token->from);
+            cassert(i_check_nfa(nfa1) == TRUE);
+            if (token->from > ngroups)
+                ngroups = token->from;
+            break;
+        }
+
         case ekLEFT_PAR:
         case ekRIGH_PAR:
         default:
@@ -748,6 +806,7 @@ static NFA *i_infix_to_NFA(const ArrSt(NToken) *tokens)
     arrst_end()
 
     nfa = arrpt_last(stack, NFA);
+    nfa->ngroups = ngroups;
     arrpt_pop(stack, NULL, NFA);
     cassert(arrpt_size(stack, NFA) == 0);
     arrpt_destroy(&stack, NULL, NFA);
@@ -819,11 +878,43 @@ static void i_add_state(ArrSt(uint32_t) *states, const uint32_t state)
 
 /*---------------------------------------------------------------------------*/
 
-static void i_add_closure(const ArrSt(Trans) *ttable, ArrSt(uint32_t) *states, const uint32_t state)
+/* New closure visit. All the states are unvisited */
+static void i_new_visit(NFA *nfa)
 {
+    uint32_t n = arrst_size(nfa->ttable, Trans);
+    if (nfa->mark == NULL)
+    {
+        nfa->mark = heap_new_n0(n, uint32_t);
+        nfa->gen = 0;
+    }
+
+    nfa->gen += 1;
+    if (nfa->gen == 0)
+    {
+        bmem_zero_n(nfa->mark, n, uint32_t);
+        nfa->gen = 1;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_add_closure(NFA *nfa, ArrSt(uint32_t) *states, const uint32_t state)
+{
+    const ArrSt(Trans) *ttable = nfa->ttable;
     const Trans *trans = arrst_get_const(ttable, state, Trans);
 
-    if (trans->symbol != UINT32_MAX)
+    /* Each state is visited once. Avoids epsilon-cycles of nullable closures as '(a*)*' */
+    if (nfa->mark[state] == nfa->gen)
+        return;
+
+    nfa->mark[state] = nfa->gen;
+
+    /* Tags don't consume input */
+    if (trans->symbol == TAG_SYMBOL)
+    {
+        i_add_closure(nfa, states, trans->state);
+    }
+    else if (trans->symbol != UINT32_MAX)
     {
         i_add_state(states, state);
     }
@@ -835,11 +926,11 @@ static void i_add_closure(const ArrSt(Trans) *ttable, ArrSt(uint32_t) *states, c
         if (state == arrst_size(ttable, Trans) - 1)
             i_add_state(states, state);
 
-        i_add_closure(ttable, states, trans->state);
+        i_add_closure(nfa, states, trans->state);
 
         /* Two epsilons */
         if (trans->extra != UINT32_MAX)
-            i_add_closure(ttable, states, trans->extra);
+            i_add_closure(nfa, states, trans->extra);
     }
 }
 
@@ -859,7 +950,8 @@ void _nfa_start(NFA *nfa)
         arrst_clear(nfa->current, NULL, uint32_t);
     }
 
-    i_add_closure(nfa->ttable, nfa->current, 0);
+    i_new_visit(nfa);
+    i_add_closure(nfa, nfa->current, 0);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -868,10 +960,11 @@ bool_t _nfa_next(NFA *nfa, const uint32_t codepoint)
 {
     cassert_no_null(nfa);
     arrst_clear(nfa->temp, NULL, uint32_t);
+    i_new_visit(nfa);
     arrst_foreach(state, nfa->current, uint32_t)
         const Trans *trans = arrst_get(nfa->ttable, *state, Trans);
         if (codepoint >= trans->symbol && codepoint <= trans->extra)
-            i_add_closure(nfa->ttable, nfa->temp, trans->state);
+            i_add_closure(nfa, nfa->temp, trans->state);
     arrst_end()
 
     bmem_swap_type(&nfa->current, &nfa->temp, ArrSt(uint32_t) *);
@@ -891,3 +984,309 @@ bool_t _nfa_accept(NFA *nfa)
     arrst_end()
     return FALSE;
 }
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t _nfa_accept_state(const NFA *nfa)
+{
+    cassert_no_null(nfa);
+    return arrst_size(nfa->ttable, Trans) - 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Sorted code points where some transition range starts or ends */
+void _nfa_bounds(const NFA *nfa, ArrSt(uint32_t) *bounds)
+{
+    cassert_no_null(nfa);
+    i_add_state(bounds, 0);
+    arrst_foreach_const(trans, nfa->ttable, Trans)
+        if (trans->symbol != UINT32_MAX && trans->symbol != TAG_SYMBOL && trans->state != UINT32_MAX)
+        {
+            i_add_state(bounds, trans->symbol);
+            if (trans->extra < MAX_UNICODE)
+                i_add_state(bounds, trans->extra + 1);
+        }
+    arrst_end()
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _nfa_closure(NFA *nfa, const uint32_t state, ArrSt(uint32_t) *states)
+{
+    cassert_no_null(nfa);
+    i_new_visit(nfa);
+    i_add_closure(nfa, states, state);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _nfa_move(NFA *nfa, const uint32_t *states, const uint32_t n, const uint32_t codepoint, ArrSt(uint32_t) *next)
+{
+    const Trans *ttable = NULL;
+    uint32_t i;
+    cassert_no_null(nfa);
+    cassert_no_null(states);
+    ttable = arrst_all_const(nfa->ttable, Trans);
+    i_new_visit(nfa);
+    for (i = 0; i < n; ++i)
+    {
+        const Trans *trans = ttable + states[i];
+        if (trans->state != UINT32_MAX && codepoint >= trans->symbol && codepoint <= trans->extra)
+            i_add_closure(nfa, next, trans->state);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t _nfa_groups(const NFA *nfa)
+{
+    cassert_no_null(nfa);
+    return nfa->ngroups;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Capture extraction (Pike VM). Threads are kept in priority order (first
+ * epsilon before second), so the captures are those of the preferred path
+ * among all the paths that match the input span.
+ */
+typedef struct _pike_t Pike;
+typedef struct _plist_t PList;
+
+struct _plist_t
+{
+    uint32_t *states;
+    uint32_t *caps;
+    uint32_t size;
+};
+
+struct _pike_t
+{
+    const Trans *ttable;
+    uint32_t nstates;
+    uint32_t ncaps;
+    uint32_t gen;
+    uint32_t *mark;
+    uint32_t *work;
+    PList list[2];
+};
+
+/*---------------------------------------------------------------------------*/
+
+static void i_pike_thread(Pike *pike, PList *list, const uint32_t state)
+{
+    uint32_t i = list->size;
+    list->states[i] = state;
+    bmem_copy_n(list->caps + i * pike->ncaps, pike->work, pike->ncaps, uint32_t);
+    list->size += 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_pike_add(Pike *pike, PList *list, const uint32_t state, const uint32_t pos)
+{
+    const Trans *trans = pike->ttable + state;
+
+    if (pike->mark[state] == pike->gen)
+        return;
+
+    pike->mark[state] = pike->gen;
+    if (trans->symbol == TAG_SYMBOL)
+    {
+        uint32_t prev = pike->work[trans->extra];
+        pike->work[trans->extra] = pos;
+        i_pike_add(pike, list, trans->state, pos);
+        pike->work[trans->extra] = prev;
+    }
+    else if (trans->symbol == UINT32_MAX)
+    {
+        /* Closure last state (accept) */
+        if (state == pike->nstates - 1)
+            i_pike_thread(pike, list, state);
+
+        i_pike_add(pike, list, trans->state, pos);
+        if (trans->extra != UINT32_MAX)
+            i_pike_add(pike, list, trans->extra, pos);
+    }
+    else
+    {
+        i_pike_thread(pike, list, state);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_pike_init(Pike *pike, const NFA *nfa)
+{
+    uint32_t i;
+    cassert_no_null(pike);
+    cassert_no_null(nfa);
+    pike->ttable = arrst_all_const(nfa->ttable, Trans);
+    pike->nstates = arrst_size(nfa->ttable, Trans);
+    pike->ncaps = 2 * (nfa->ngroups + 1);
+    pike->gen = 1;
+    pike->mark = heap_new_n0(pike->nstates, uint32_t);
+    pike->work = heap_new_n(pike->ncaps, uint32_t);
+    for (i = 0; i < 2; ++i)
+    {
+        pike->list[i].states = heap_new_n(pike->nstates, uint32_t);
+        pike->list[i].caps = heap_new_n(pike->nstates * pike->ncaps, uint32_t);
+        pike->list[i].size = 0;
+    }
+
+    for (i = 0; i < pike->ncaps; ++i)
+        pike->work[i] = UINT32_MAX;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_pike_remove(Pike *pike)
+{
+    uint32_t i;
+    cassert_no_null(pike);
+    for (i = 0; i < 2; ++i)
+    {
+        heap_delete_n(&pike->list[i].states, pike->nstates, uint32_t);
+        heap_delete_n(&pike->list[i].caps, pike->nstates * pike->ncaps, uint32_t);
+    }
+
+    heap_delete_n(&pike->mark, pike->nstates, uint32_t);
+    heap_delete_n(&pike->work, pike->ncaps, uint32_t);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _nfa_captures(const NFA *nfa, const char_t *str, const uint32_t start, const uint32_t end, uint32_t *caps)
+{
+    Pike pike;
+    PList *clist = &pike.list[0];
+    PList *nlist = &pike.list[1];
+    const char_t *s = str + start;
+    uint32_t pos = start, i;
+    bool_t found = FALSE;
+    cassert_no_null(nfa);
+    cassert_no_null(str);
+    cassert_no_null(caps);
+    cassert(start <= end);
+    i_pike_init(&pike, nfa);
+    i_pike_add(&pike, clist, 0, pos);
+    while (pos < end && clist->size > 0)
+    {
+        uint32_t codepoint = unicode_to_u32(s, ekUTF8);
+        s = unicode_next(s, ekUTF8);
+        pos = (uint32_t)(s - str);
+        pike.gen += 1;
+        nlist->size = 0;
+        for (i = 0; i < clist->size; ++i)
+        {
+            const Trans *trans = pike.ttable + clist->states[i];
+            if (trans->state != UINT32_MAX && trans->symbol != UINT32_MAX && codepoint >= trans->symbol && codepoint <= trans->extra)
+            {
+                bmem_copy_n(pike.work, clist->caps + i * pike.ncaps, pike.ncaps, uint32_t);
+                i_pike_add(&pike, nlist, trans->state, pos);
+            }
+        }
+
+        bmem_swap_type(&clist, &nlist, PList *);
+    }
+
+    if (pos == end)
+    {
+        for (i = 0; i < clist->size; ++i)
+        {
+            if (clist->states[i] == pike.nstates - 1)
+            {
+                bmem_copy_n(caps, clist->caps + i * pike.ncaps, pike.ncaps, uint32_t);
+                caps[0] = start;
+                caps[1] = end;
+                found = TRUE;
+                break;
+            }
+        }
+    }
+
+    i_pike_remove(&pike);
+    return found;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Leftmost start of a match in 'str', in one forward pass. Each thread keeps
+ * its start in the slot 0. The lists are sorted by start (new threads are
+ * appended), so the first visit to a state comes from the smallest start.
+ * New starts are not added after the first match or beyond 'limit'.
+ */
+uint32_t _nfa_leftmost(const NFA *nfa, const char_t *str, const uint32_t limit)
+{
+    Pike pike;
+    PList *clist = &pike.list[0];
+    PList *nlist = &pike.list[1];
+    const char_t *s = str;
+    uint32_t leftmost = UINT32_MAX;
+    uint32_t pos = 0, i;
+    cassert_no_null(nfa);
+    cassert_no_null(str);
+    i_pike_init(&pike, nfa);
+    pike.work[0] = 0;
+    i_pike_add(&pike, clist, 0, pos);
+
+    for (;;)
+    {
+        uint32_t codepoint;
+
+        /* Sorted by start, the first accept is the leftmost at this position */
+        for (i = 0; i < clist->size; ++i)
+        {
+            if (clist->states[i] == pike.nstates - 1)
+            {
+                if (clist->caps[i * pike.ncaps] < leftmost)
+                    leftmost = clist->caps[i * pike.ncaps];
+                break;
+            }
+        }
+
+        if (leftmost == 0 || *s == '\0')
+            break;
+
+        if (clist->size == 0 && (leftmost != UINT32_MAX || pos >= limit))
+            break;
+
+        codepoint = unicode_to_u32(s, ekUTF8);
+        s = unicode_next(s, ekUTF8);
+        pos = (uint32_t)(s - str);
+        pike.gen += 1;
+        nlist->size = 0;
+        for (i = 0; i < clist->size; ++i)
+        {
+            const Trans *trans = pike.ttable + clist->states[i];
+            const uint32_t *caps = clist->caps + i * pike.ncaps;
+
+            /* Can't improve the leftmost match */
+            if (caps[0] >= leftmost)
+                break;
+
+            if (trans->state != UINT32_MAX && trans->symbol != UINT32_MAX && codepoint >= trans->symbol && codepoint <= trans->extra)
+            {
+                bmem_copy_n(pike.work, caps, pike.ncaps, uint32_t);
+                i_pike_add(&pike, nlist, trans->state, pos);
+            }
+        }
+
+        /* A match can start at this position */
+        if (leftmost == UINT32_MAX && pos <= limit)
+        {
+            for (i = 0; i < pike.ncaps; ++i)
+                pike.work[i] = UINT32_MAX;
+            pike.work[0] = pos;
+            i_pike_add(&pike, nlist, 0, pos);
+        }
+
+        bmem_swap_type(&clist, &nlist, PList *);
+    }
+
+    i_pike_remove(&pike);
+    return leftmost;
+}
@@ -26,4 +26,18 @@ bool_t _nfa_next(NFA *nfa, const uint32_t codepoint);
 
 bool_t _nfa_accept(NFA *nfa);
 
+uint32_t _nfa_accept_state(const NFA *nfa);
+
+void _nfa_bounds(const NFA *nfa, ArrSt(uint32_t) *bounds);
+
+void _nfa_closure(NFA *nfa, const uint32_t state, ArrSt(uint32_t) *states);
+
+void _nfa_move(NFA *nfa, const uint32_t *states, const uint32_t n, const uint32_t codepoint, ArrSt(uint32_t) *next);
+
+uint32_t _nfa_groups(const NFA *nfa);
+
+bool_t _nfa_captures(const NFA *nfa, const char_t *str, const uint32_t start, const uint32_t end, uint32_t *caps);
+
+uint32_t _nfa_leftmost(const NFA *nfa, const char_t *str, const uint32_t limit);
+
 __END_C
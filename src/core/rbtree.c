@@ -10,7 +10,6 @@
 
 /* Red - Black trees */
 
-#include "rbtree.h"
 #include "heap.h"
 #include "strings.h"
 #include <sewer/bmem.h>
@@ -26,6 +25,8 @@ typedef enum i_type_t
 typedef struct i_node_t i_Node;
 typedef i_Node *i_NodePt;
 typedef struct i_iterator_t i_Iterator;
+typedef struct i_chunk_t i_Chunk;
+typedef struct i_pool_t i_Pool;
 
 struct i_node_t
 {
@@ -41,6 +42,26 @@ struct i_iterator_t
     i_NodePt *path;
 };
 
+/*
+ * Nodes (header + key + element) are carved from chunks owned by the tree.
+ * Deleted nodes go to a free list and are reused by next insertions. Chunks
+ * are returned to the heap only when the tree is destroyed.
+ */
+struct i_chunk_t
+{
+    i_Chunk *next;
+    uint32_t size;
+};
+
+struct i_pool_t
+{
+    uint32_t nsize;
+    i_Chunk *chunks;
+    i_Node *free;
+    byte_t *next;
+    byte_t *end;
+};
+
 struct _rbtree_t
 {
     uint32_t elems;
@@ -50,17 +71,91 @@ struct _rbtree_t
     i_Node *root;
     FPtr_compare func_compare;
     i_Iterator it;
+    i_Pool pool;
 };
 
 #define i_NODE_DATA(node) \
     ((void)(cast(node, i_Node) == node), \
      (cast(node, byte_t) + sizeof(i_Node)))
 
+#define i_MIN_CHUNK_NODES 16
+#define i_MAX_CHUNK_BYTES (1024 * 1024)
+
 /*---------------------------------------------------------------------------*/
 
-static i_Node *i_create_node(const uint16_t esize, const uint16_t ksize)
+static void i_init_pool(i_Pool *pool, const uint16_t esize, const uint16_t ksize)
 {
-    i_Node *node = cast(heap_malloc(sizeof32(i_Node) + esize + ksize, "RBNode"), i_Node);
+    cassert_no_null(pool);
+    pool->nsize = sizeof32(i_Node) + esize + ksize;
+    pool->nsize += (sizeofptr - pool->nsize % sizeofptr) % sizeofptr;
+    pool->chunks = NULL;
+    pool->free = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_pool_chunk(i_Pool *pool, const uint32_t nodes)
+{
+    uint32_t size = 0;
+    i_Chunk *chunk = NULL;
+    cassert(nodes > 0 && nodes <= (0xFFFFFFFF - sizeof32(i_Chunk)) / pool->nsize);
+    size = sizeof32(i_Chunk) + nodes * pool->nsize;
+    chunk = cast(heap_malloc(size, "RBNodes"), i_Chunk);
+    cassert(sizeof(i_Chunk) % sizeofptr == 0);
+    chunk->next = pool->chunks;
+    chunk->size = size;
+    pool->chunks = chunk;
+    pool->next = cast(chunk, byte_t) + sizeof(i_Chunk);
+    pool->end = pool->next + nodes * pool->nsize;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_destroy_pool(i_Pool *pool)
+{
+    cassert_no_null(pool);
+    while (pool->chunks != NULL)
+    {
+        i_Chunk *next = pool->chunks->next;
+        heap_free(dcast(&pool->chunks, byte_t), pool->chunks->size, "RBNodes");
+        pool->chunks = next;
+    }
+
+    pool->free = NULL;
+    pool->next = NULL;
+    pool->end = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static i_Node *i_create_node(i_Pool *pool, const uint32_t elems)
+{
+    i_Node *node = NULL;
+    cassert_no_null(pool);
+    if (pool->free != NULL)
+    {
+        node = pool->free;
+        pool->free = node->lnode;
+    }
+    else
+    {
+        if (pool->next == pool->end)
+        {
+            /* Each new chunk roughly doubles the pool capacity */
+            uint32_t nodes = elems;
+            if (nodes > i_MAX_CHUNK_BYTES / pool->nsize)
+                nodes = i_MAX_CHUNK_BYTES / pool->nsize;
+            if (nodes < i_MIN_CHUNK_NODES)
+                nodes = i_MIN_CHUNK_NODES;
+            i_pool_chunk(pool, nodes);
+        }
+
+        node = cast(pool->next, i_Node);
+        pool->next += pool->nsize;
+    }
+
     node->type = i_RED_NODE;
     node->lnode = NULL;
     node->rnode = NULL;
@@ -69,9 +164,14 @@ static i_Node *i_create_node(const uint16_t esize, const uint16_t ksize)
 
 /*---------------------------------------------------------------------------*/
 
-static ___INLINE void i_dealloc_node(i_Node **node, const uint16_t esize, const uint16_t ksize)
+static ___INLINE void i_dealloc_node(i_Pool *pool, i_Node **node)
 {
-    heap_free(dcast(node, byte_t), sizeof32(i_Node) + esize + ksize, "RBNode");
+    cassert_no_null(pool);
+    cassert_no_null(node);
+    cassert_no_null(*node);
+    (*node)->lnode = pool->free;
+    pool->free = *node;
+    *node = NULL;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -112,7 +212,7 @@ static ___INLINE void i_destroy_node_data(
 /*---------------------------------------------------------------------------*/
 
 static void i_destroy_node(
-    i_Node **node,
+    i_Node *node,
     const uint16_t esize,
     const uint16_t ksize,
     FPtr_remove func_remove,
@@ -120,16 +220,14 @@ static void i_destroy_node(
     FPtr_destroy func_destroy_key)
 {
     cassert_no_null(node);
-    cassert_no_null(*node);
 
-    if ((*node)->lnode != NULL)
-        i_destroy_node(&(*node)->lnode, esize, ksize, func_remove, func_destroy, func_destroy_key);
+    if (node->lnode != NULL)
+        i_destroy_node(node->lnode, esize, ksize, func_remove, func_destroy, func_destroy_key);
 
-    if ((*node)->rnode != NULL)
-        i_destroy_node(&(*node)->rnode, esize, ksize, func_remove, func_destroy, func_destroy_key);
+    if (node->rnode != NULL)
+        i_destroy_node(node->rnode, esize, ksize, func_remove, func_destroy, func_destroy_key);
 
-    i_destroy_node_data(*node, __DEBUG_PARAMC(esize) ksize, func_remove, func_destroy, func_destroy_key);
-    i_dealloc_node(node, esize, ksize);
+    i_destroy_node_data(node, __DEBUG_PARAMC(esize) ksize, func_remove, func_destroy, func_destroy_key);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -139,9 +237,11 @@ static void i_destroy_rbtree(RBTree **tree, FPtr_remove func_remove, FPtr_destro
     cassert_no_null(tree);
     cassert_no_null(*tree);
 
-    if ((*tree)->root != NULL)
-        i_destroy_node(&(*tree)->root, (*tree)->esize, (*tree)->ksize, func_remove, func_destroy, func_destroy_key);
+    /* Nodes are released with their chunks, we only walk the tree to destroy the elements */
+    if ((*tree)->root != NULL && (func_remove != NULL || func_destroy != NULL || func_destroy_key != NULL))
+        i_destroy_node((*tree)->root, (*tree)->esize, (*tree)->ksize, func_remove, func_destroy, func_destroy_key);
 
+    i_destroy_pool(&(*tree)->pool);
     str_destroy(&(*tree)->ktype);
     heap_delete_n(&(*tree)->it.path, (*tree)->it.path_alloc, i_NodePt);
     heap_free(dcast(tree, byte_t), sizeof(RBTree), type);
@@ -161,6 +261,7 @@ RBTree *rbtree_create(FPtr_compare func_compare, const uint16_t esize, const uin
     tree->it.path_size = 0;
     tree->it.path_alloc = 8;
     tree->it.path = heap_new_n(tree->it.path_alloc, i_NodePt);
+    i_init_pool(&tree->pool, tree->esize, tree->ksize);
     return tree;
 }
 
@@ -196,6 +297,68 @@ static void i_update_iterator_size(const uint32_t nelems, i_Iterator *it)
 
 /*---------------------------------------------------------------------------*/
 
+/* Chunks of a sorted build are sized with the remaining nodes (no waste) */
+static i_Node *i_sorted_node(i_Pool *pool, uint32_t *remain)
+{
+    i_Node *node = NULL;
+    cassert_no_null(pool);
+    cassert_no_null(remain);
+    cassert(*remain > 0);
+    if (pool->next == pool->end)
+    {
+        uint32_t nodes = *remain;
+        if (nodes > i_MAX_CHUNK_BYTES / pool->nsize)
+            nodes = i_MAX_CHUNK_BYTES / pool->nsize;
+        i_pool_chunk(pool, nodes);
+    }
+
+    node = cast(pool->next, i_Node);
+    pool->next += pool->nsize;
+    *remain -= 1;
+    return node;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static i_Node *i_build_sorted(i_Pool *pool, const byte_t *data, const uint16_t esize, const uint32_t ksize, const uint32_t lo, const uint32_t hi, const uint32_t depth, const uint32_t red_depth, uint32_t *remain)
+{
+    if (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        i_Node *node = i_sorted_node(pool, remain);
+        /* All null links are at 'red_depth' or 'red_depth + 1': coloring the deepest level red keeps black heights equal */
+        node->type = depth == red_depth && depth > 0 ? i_RED_NODE : i_BLACK_NODE;
+        bmem_copy(i_NODE_DATA(node) + ksize, data + (uint64_t)mid * esize, esize);
+        node->lnode = i_build_sorted(pool, data, esize, ksize, lo, mid, depth + 1, red_depth, remain);
+        node->rnode = i_build_sorted(pool, data, esize, ksize, mid + 1, hi, depth + 1, red_depth, remain);
+        return node;
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+RBTree *rbtree_from_sorted(FPtr_compare func_compare, const uint16_t esize, const byte_t *data, const uint32_t n, const char_t *type, const char_t *ktype)
+{
+    RBTree *tree = rbtree_create(func_compare, esize, 0, type, ktype);
+    cassert(n == 0 || data != NULL);
+    if (n > 0)
+    {
+        uint32_t remain = n;
+        tree->root = i_build_sorted(&tree->pool, data, esize, tree->ksize, 0, n, 0, i_log2(n) - 1, &remain);
+        cassert(remain == 0);
+        tree->elems = n;
+        i_update_iterator_size(n, &tree->it);
+        cassert(tree->pool.next == tree->pool.end);
+        cassert(rbtree_check(tree) == TRUE);
+    }
+
+    return tree;
+}
+
+/*---------------------------------------------------------------------------*/
+
 void rbtree_destroy(RBTree **tree, FPtr_remove func_remove, FPtr_destroy func_destroy_key, const char_t *type)
 {
     i_destroy_rbtree(tree, func_remove, NULL, func_destroy_key, type);
@@ -629,8 +792,7 @@ static i_Node *i_insert_node(
     const bool_t isptr,
     FPtr_compare func_compare,
     i_Iterator *it,
-    const uint16_t esize,
-    const uint16_t ksize)
+    i_Pool *pool)
 {
     cassert_no_null(root);
     cassert_no_null(it);
@@ -645,7 +807,7 @@ static i_Node *i_insert_node(
         {
             i_Node *new_node = NULL;
             i_Node *parent = NULL;
-            new_node = i_create_node(esize, ksize);
+            new_node = i_create_node(pool, elems);
             parent = it->path[it->path_size - 1];
             cassert_no_null(parent);
 
@@ -674,7 +836,7 @@ static i_Node *i_insert_node(
     }
     else
     {
-        i_Node *new_node = i_create_node(ksize, esize);
+        i_Node *new_node = i_create_node(pool, elems);
         new_node->type = i_BLACK_NODE;
         *root = new_node;
         return new_node;
@@ -688,7 +850,7 @@ byte_t *rbtree_insert(RBTree *tree, const void *key, FPtr_copy func_key_copy, co
     i_Node *new_node = NULL;
     cassert_no_null(tree);
     cassert_unref(str_equ(tree->ktype, ktype) == TRUE, ktype);
-    new_node = i_insert_node(&tree->root, tree->elems, key, FALSE, tree->func_compare, &tree->it, tree->ksize, tree->esize);
+    new_node = i_insert_node(&tree->root, tree->elems, key, FALSE, tree->func_compare, &tree->it, &tree->pool);
     tree->it.path_size = 0;
     if (new_node != NULL)
     {
@@ -719,7 +881,7 @@ bool_t rbtree_insert_ptr(RBTree *tree, const void *key, void *ptr, const char_t
     i_Node *new_node = NULL;
     cassert_no_null(tree);
     cassert_unref(str_equ(tree->ktype, ktype) == TRUE, ktype);
-    new_node = i_insert_node(&tree->root, tree->elems, key, TRUE, tree->func_compare, &tree->it, tree->ksize, tree->esize);
+    new_node = i_insert_node(&tree->root, tree->elems, key, TRUE, tree->func_compare, &tree->it, &tree->pool);
     tree->it.path_size = 0;
     if (new_node != NULL)
     {
@@ -892,6 +1054,7 @@ static bool_t i_delete_element(
     i_Iterator *it,
     const uint16_t esize,
     const uint16_t ksize,
+    i_Pool *pool,
     FPtr_remove func_remove,
     FPtr_destroy func_destroy,
     FPtr_destroy func_destroy_key)
@@ -1003,7 +1166,7 @@ static bool_t i_delete_element(
                 cassert(*root == NULL);
             }
 
-            i_dealloc_node(&deleted_node, esize, ksize);
+            i_dealloc_node(pool, &deleted_node);
             return TRUE;
         }
         else
@@ -1023,7 +1186,7 @@ bool_t rbtree_delete(RBTree *tree, const void *key, FPtr_remove func_remove, FPt
 {
     cassert_no_null(tree);
     cassert_unref(str_equ(tree->ktype, ktype) == TRUE, ktype);
-    if (i_delete_element(&tree->root, tree->elems, key, (bool_t)(func_destroy_key != NULL), tree->func_compare, &tree->it, tree->esize, tree->ksize, func_remove, NULL, func_destroy_key) == TRUE)
+    if (i_delete_element(&tree->root, tree->elems, key, (bool_t)(func_destroy_key != NULL), tree->func_compare, &tree->it, tree->esize, tree->ksize, &tree->pool, func_remove, NULL, func_destroy_key) == TRUE)
     {
         cassert(tree->elems > 0);
         tree->it.path_size = 0;
@@ -1043,7 +1206,7 @@ bool_t rbtree_delete_ptr(RBTree *tree, const void *key, FPtr_destroy func_destro
 {
     cassert_no_null(tree);
     cassert_unref(str_equ(tree->ktype, ktype) == TRUE, ktype);
-    if (i_delete_element(&tree->root, tree->elems, key, TRUE, tree->func_compare, &tree->it, tree->esize, tree->ksize, NULL, func_destroy, func_destroy_key) == TRUE)
+    if (i_delete_element(&tree->root, tree->elems, key, TRUE, tree->func_compare, &tree->it, tree->esize, tree->ksize, &tree->pool, NULL, func_destroy, func_destroy_key) == TRUE)
     {
         cassert(tree->elems > 0);
         tree->it.path_size = 0;
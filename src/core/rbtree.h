@@ -16,6 +16,8 @@ __EXTERN_C
 
 _core_api RBTree *rbtree_create(FPtr_compare func_compare, const uint16_t esize, const uint16_t ksize, const char_t *type, const char_t *ktype);
 
+_core_api RBTree *rbtree_from_sorted(FPtr_compare func_compare, const uint16_t esize, const byte_t *data, const uint32_t n, const char_t *type, const char_t *ktype);
+
 _core_api void rbtree_destroy(RBTree **tree, FPtr_remove func_remove, FPtr_destroy func_destroy_key, const char_t *type);
 
 _core_api void rbtree_destroy_ptr(RBTree **tree, FPtr_destroy func_destroy, FPtr_destroy func_destroy_key, const char_t *type);
@@ -11,7 +11,14 @@
 /* Regular expresions */
 
 #include "regex.h"
+#include "regexh.h"
+#include "arrpt.h"
+#include "arrst.h"
+#include "dfa.inl"
+#include "heap.h"
 #include "nfa.inl"
+#include <sewer/cassert.h>
+#include <sewer/ptr.h>
 #include <sewer/unicode.h>
 
 /*
@@ -34,35 +41,319 @@ bool_t okF = regex_match(regex, "006_OCR_OK_01_009.png");
 regex_destroy(&regex);
  */
 
+struct _regex
+{
+    NFA *nfa;
+    DFA *dfa;
+    DFA *sdfa;
+};
+
+struct _regexset_t
+{
+    ArrPt(NFA) *nfas;
+    DFA *dfa;
+};
+
 /*---------------------------------------------------------------------------*/
 
 RegEx *regex_create(const char_t *pattern)
 {
-    return cast(_nfa_regex(pattern, FALSE), RegEx);
+    NFA *nfa = _nfa_regex(pattern, FALSE);
+    if (nfa != NULL)
+    {
+        RegEx *regex = heap_new(RegEx);
+        regex->nfa = nfa;
+        regex->dfa = _dfa_create(&regex->nfa, 1, FALSE);
+        regex->sdfa = _dfa_create(&regex->nfa, 1, TRUE);
+        return regex;
+    }
+
+    return NULL;
 }
 
 /*---------------------------------------------------------------------------*/
 
 void regex_destroy(RegEx **regex)
 {
-    _nfa_destroy(dcast(regex, NFA));
+    cassert_no_null(regex);
+    cassert_no_null(*regex);
+    _dfa_destroy(&(*regex)->dfa);
+    _dfa_destroy(&(*regex)->sdfa);
+    _nfa_destroy(&(*regex)->nfa);
+    heap_delete(regex, RegEx);
 }
 
 /*---------------------------------------------------------------------------*/
 
-bool_t regex_match(const RegEx *regex, const char_t *str)
+static bool_t i_nfa_match(NFA *nfa, const char_t *str)
 {
     uint32_t codepoint;
-    _nfa_start(cast(regex, NFA));
+    _nfa_start(nfa);
     codepoint = unicode_to_u32(str, ekUTF8);
     while (codepoint != 0)
     {
-        if (_nfa_next(cast(regex, NFA), codepoint) == FALSE)
+        if (_nfa_next(nfa, codepoint) == FALSE)
             return FALSE;
 
         str = unicode_next(str, ekUTF8);
         codepoint = unicode_to_u32(str, ekUTF8);
     }
 
-    return _nfa_accept(cast(regex, NFA));
+    return _nfa_accept(nfa);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Size of the longest match at the beginning of 'str'. UINT32_MAX if none. 'read' bytes until the NFA dies */
+static uint32_t i_nfa_longest(NFA *nfa, const char_t *str, uint32_t *read)
+{
+    const char_t *s = str;
+    uint32_t size = UINT32_MAX;
+    _nfa_start(nfa);
+    if (_nfa_accept(nfa) == TRUE)
+        size = 0;
+
+    while (*s != '\0')
+    {
+        if (_nfa_next(nfa, unicode_to_u32(s, ekUTF8)) == FALSE)
+            break;
+
+        s = unicode_next(s, ekUTF8);
+        if (_nfa_accept(nfa) == TRUE)
+            size = (uint32_t)(s - str);
+    }
+
+    *read = (uint32_t)(s - str);
+    return size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_longest(const RegEx *regex, const char_t *str, uint32_t *read)
+{
+    uint32_t size = UINT32_MAX;
+    if (_dfa_longest(regex->dfa, str, &size, read) == TRUE)
+        return size;
+
+    /* DFA cache exceeded */
+    return i_nfa_longest(regex->nfa, str, read);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Leftmost-longest match */
+static bool_t i_search(const RegEx *regex, const char_t *str, uint32_t *start, uint32_t *end)
+{
+    const char_t *s = str;
+    uint32_t first_end = UINT32_MAX;
+    uint32_t pos = 0, size = UINT32_MAX, read = 0;
+
+    /*
+     * One pass of the search DFA finds the earliest end of any match, or
+     * rejects the string. The leftmost match can't start after that position.
+     */
+    if (_dfa_first_end(regex->sdfa, str, &first_end) == TRUE && first_end == UINT32_MAX)
+        return FALSE;
+
+    /*
+     * Usually, a few restarts of the longest match find the leftmost one. If the
+     * restarts read too much (quadratic, as 'a*b' over 'aaa...a'), one NFA pass
+     * finds the leftmost start and the longest match runs once from it.
+     */
+    for (;;)
+    {
+        uint32_t nread = 0;
+        size = i_longest(regex, s, &nread);
+        if (size != UINT32_MAX)
+            break;
+
+        if (*s == '\0' || pos >= first_end)
+            return FALSE;
+
+        read += nread;
+        s = unicode_next(s, ekUTF8);
+        pos = (uint32_t)(s - str);
+        if (read > 2 * pos + 256)
+        {
+            uint32_t lstart = _nfa_leftmost(regex->nfa, s, first_end != UINT32_MAX ? first_end - pos : UINT32_MAX);
+            if (lstart == UINT32_MAX)
+                return FALSE;
+
+            pos += lstart;
+            s = str + pos;
+            size = i_longest(regex, s, &nread);
+            cassert(size != UINT32_MAX);
+            break;
+        }
+    }
+
+    *start = pos;
+    *end = pos + size;
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t regex_match(const RegEx *regex, const char_t *str)
+{
+    const uint32_t *accepts = NULL;
+    uint32_t naccepts = 0;
+    cassert_no_null(regex);
+    if (_dfa_match(regex->dfa, str, &accepts, &naccepts) == TRUE)
+        return (bool_t)(naccepts > 0);
+
+    /* DFA cache exceeded */
+    return i_nfa_match(regex->nfa, str);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t regex_search(const RegEx *regex, const char_t *str, uint32_t *start, uint32_t *end)
+{
+    uint32_t mstart = 0, mend = 0;
+    cassert_no_null(regex);
+    cassert_no_null(str);
+    if (i_search(regex, str, &mstart, &mend) == TRUE)
+    {
+        ptr_assign(start, mstart);
+        ptr_assign(end, mend);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t regex_groups(const RegEx *regex)
+{
+    cassert_no_null(regex);
+    return _nfa_groups(regex->nfa);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t regex_captures(const RegEx *regex, const char_t *str, uint32_t *starts, uint32_t *ends, const uint32_t size)
+{
+    uint32_t mstart = 0, mend = 0;
+    cassert_no_null(regex);
+    cassert_no_null(str);
+    cassert(size == 0 || (starts != NULL && ends != NULL));
+    if (i_search(regex, str, &mstart, &mend) == TRUE)
+    {
+        uint32_t i, ncaps = 2 * (_nfa_groups(regex->nfa) + 1);
+        uint32_t *caps = heap_new_n(ncaps, uint32_t);
+        bool_t ok = _nfa_captures(regex->nfa, str, mstart, mend, caps);
+        cassert_unref(ok == TRUE, ok);
+        for (i = 0; i < size; ++i)
+        {
+            if (2 * i < ncaps)
+            {
+                starts[i] = caps[2 * i];
+                ends[i] = caps[2 * i + 1];
+            }
+            else
+            {
+                starts[i] = UINT32_MAX;
+                ends[i] = UINT32_MAX;
+            }
+        }
+
+        heap_delete_n(&caps, ncaps, uint32_t);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t regex_match_nfa(const RegEx *regex, const char_t *str)
+{
+    cassert_no_null(regex);
+    return i_nfa_match(regex->nfa, str);
+}
+
+/*---------------------------------------------------------------------------*/
+
+RegExSet *regex_set_create(void)
+{
+    RegExSet *set = heap_new0(RegExSet);
+    set->nfas = arrpt_create(NFA);
+    return set;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void regex_set_destroy(RegExSet **set)
+{
+    cassert_no_null(set);
+    cassert_no_null(*set);
+    if ((*set)->dfa != NULL)
+        _dfa_destroy(&(*set)->dfa);
+    arrpt_destroy(&(*set)->nfas, _nfa_destroy, NFA);
+    heap_delete(set, RegExSet);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t regex_set_add(RegExSet *set, const char_t *pattern)
+{
+    NFA *nfa = NULL;
+    cassert_no_null(set);
+    nfa = _nfa_regex(pattern, FALSE);
+    if (nfa == NULL)
+        return FALSE;
+
+    /* All patterns share one (lazy) DFA, rebuilt with each new pattern */
+    arrpt_append(set->nfas, nfa, NFA);
+    if (set->dfa != NULL)
+        _dfa_destroy(&set->dfa);
+    set->dfa = _dfa_create(arrpt_all(set->nfas, NFA), arrpt_size(set->nfas, NFA), FALSE);
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t regex_set_size(const RegExSet *set)
+{
+    cassert_no_null(set);
+    return arrpt_size(set->nfas, NFA);
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t regex_set_match(const RegExSet *set, const char_t *str, ArrSt(uint32_t) *matches)
+{
+    const uint32_t *accepts = NULL;
+    uint32_t i, naccepts = 0;
+    cassert_no_null(set);
+    cassert_no_null(str);
+    if (matches != NULL)
+        arrst_clear(matches, NULL, uint32_t);
+
+    if (set->dfa == NULL)
+        return 0;
+
+    if (_dfa_match(set->dfa, str, &accepts, &naccepts) == TRUE)
+    {
+        if (matches != NULL)
+        {
+            for (i = 0; i < naccepts; ++i)
+                arrst_append(matches, accepts[i], uint32_t);
+        }
+
+        return naccepts;
+    }
+
+    /* DFA cache exceeded */
+    arrpt_foreach(nfa, set->nfas, NFA)
+        if (i_nfa_match(nfa, str) == TRUE)
+        {
+            if (matches != NULL)
+                arrst_append(matches, nfa_i, uint32_t);
+            naccepts += 1;
+        }
+    arrpt_end()
+    return naccepts;
 }
@@ -21,4 +21,20 @@ _core_api void regex_destroy(RegEx **regex);
 
 _core_api bool_t regex_match(const RegEx *regex, const char_t *str);
 
+_core_api bool_t regex_search(const RegEx *regex, const char_t *str, uint32_t *start, uint32_t *end);
+
+_core_api uint32_t regex_groups(const RegEx *regex);
+
+_core_api bool_t regex_captures(const RegEx *regex, const char_t *str, uint32_t *starts, uint32_t *ends, const uint32_t size);
+
+_core_api RegExSet *regex_set_create(void);
+
+_core_api void regex_set_destroy(RegExSet **set);
+
+_core_api bool_t regex_set_add(RegExSet *set, const char_t *pattern);
+
+_core_api uint32_t regex_set_size(const RegExSet *set);
+
+_core_api uint32_t regex_set_match(const RegExSet *set, const char_t *str, ArrSt(uint32_t) *matches);
+
 __END_C
@@ -0,0 +1,19 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: regexh.h
+ *
+ */
+
+/* Undocumented (hidden) API about regular expresions */
+
+#include "coreh.hxx"
+
+__EXTERN_C
+
+_core_api bool_t regex_match_nfa(const RegEx *regex, const char_t *str);
+
+__END_C
@@ -15,6 +15,10 @@
     (FUNC_CHECK_COMPARE_KEY(func_compare, type, ktype), \
      setpt_##type##_create((FPtr_compare)func_compare, (uint16_t)sizeof(type *), cast_const(#ktype, char_t)))
 
+#define setpt_from_sorted(func_compare, elems, n, type, ktype) \
+    (FUNC_CHECK_COMPARE_KEY(func_compare, type, ktype), \
+     setpt_##type##_from_sorted((FPtr_compare)func_compare, elems, n, (uint16_t)sizeof(type *), cast_const(#ktype, char_t)))
+
 #define setpt_destroy(set, func_destroy, type) \
     setpt_##type##_destroy(set, func_destroy)
 
@@ -64,6 +64,8 @@ struct SetP2
 {
     static SetPt< type > *create(int(func_compare)(const type *, const dtype *));
 
+    static SetPt< type > *from_sorted(int(func_compare)(const type *, const dtype *), type *const *elems, const uint32_t n);
+
     static type *get(SetPt< type > *set, const dtype *key);
 
     static const type *get(const SetPt< type > *set, const dtype *key);
@@ -85,6 +87,16 @@ SetPt< type > *SetP2< type, dtype >::create(int(func_compare)(const type *, cons
 
 /*---------------------------------------------------------------------------*/
 
+template < typename type, typename dtype >
+SetPt< type > *SetP2< type, dtype >::from_sorted(int(func_compare)(const type *, const dtype *), type *const *elems, const uint32_t n)
+{
+    char_t ltype[64];
+    bstd_sprintf(ltype, sizeof(ltype), "SetPt<%s>", typeid(type).name());
+    return cast(rbtree_from_sorted((FPtr_compare)func_compare, (uint16_t)sizeof(type *), cast_const(elems, byte_t), n, ltype, typeid(dtype).name()), SetPt< type >);
+}
+
+/*---------------------------------------------------------------------------*/
+
 template < typename type >
 void SetPt< type >::destroy(SetPt< type > **set, void (*func_destroy)(type **))
 {
@@ -37,6 +37,12 @@
     { \
         return cast(rbtree_create(func_compare, esize, 0, cast_const(SETPT #type, char_t), key_type), SetPt(type)); \
     } \
+\
+    static __TYPECHECK SetPt(type) *setpt_##type##_from_sorted(FPtr_compare func_compare, type *const *elems, const uint32_t n, const uint16_t esize, const char_t *key_type); \
+    static SetPt(type) *setpt_##type##_from_sorted(FPtr_compare func_compare, type *const *elems, const uint32_t n, const uint16_t esize, const char_t *key_type) \
+    { \
+        return cast(rbtree_from_sorted(func_compare, esize, cast_const(elems, byte_t), n, cast_const(SETPT #type, char_t), key_type), SetPt(type)); \
+    } \
 \
     static __TYPECHECK void setpt_##type##_destroy(struct Set##Pt##type **set, void(func_destroy)(type **)); \
     static void setpt_##type##_destroy(struct Set##Pt##type **set, void(func_destroy)(type **)) \
@@ -66,6 +66,8 @@ struct SetS2
 {
     static SetSt< type > *create(int(func_compare)(const type *, const dtype *));
 
+    static SetSt< type > *from_sorted(int(func_compare)(const type *, const dtype *), const type *elems, const uint32_t n);
+
     static type *get(SetSt< type > *set, const dtype *key);
 
     static const type *get(const SetSt< type > *set, const dtype *key);
@@ -87,6 +89,16 @@ SetSt< type > *SetS2< type, dtype >::create(int(func_compare)(const type *, cons
 
 /*---------------------------------------------------------------------------*/
 
+template < typename type, typename dtype >
+SetSt< type > *SetS2< type, dtype >::from_sorted(int(func_compare)(const type *, const dtype *), const type *elems, const uint32_t n)
+{
+    char_t ltype[64];
+    bstd_sprintf(ltype, sizeof(ltype), "SetSt<%s>", typeid(type).name());
+    return cast(rbtree_from_sorted((FPtr_compare)func_compare, (uint16_t)sizeof(type), cast_const(elems, byte_t), n, ltype, typeid(dtype).name()), SetSt< type >);
+}
+
+/*---------------------------------------------------------------------------*/
+
 template < typename type >
 void SetSt< type >::destroy(SetSt< type > **set, void (*func_remove)(type *))
 {
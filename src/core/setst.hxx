@@ -37,6 +37,12 @@
     { \
         return cast(rbtree_create(func_compare, esize, 0, cast_const(SETST #type, char_t), ktype), SetSt(type)); \
     } \
+\
+    static __TYPECHECK SetSt(type) *setst_##type##_from_sorted(FPtr_compare func_compare, const type *elems, const uint32_t n, const uint16_t esize, const char_t *ktype); \
+    static SetSt(type) *setst_##type##_from_sorted(FPtr_compare func_compare, const type *elems, const uint32_t n, const uint16_t esize, const char_t *ktype) \
+    { \
+        return cast(rbtree_from_sorted(func_compare, esize, cast_const(elems, byte_t), n, cast_const(SETST #type, char_t), ktype), SetSt(type)); \
+    } \
 \
     static __TYPECHECK void setst_##type##_destroy(struct Set##St##type **set, void(func_remove)(type *)); \
     static void setst_##type##_destroy(struct Set##St##type **set, void(func_remove)(type *)) \
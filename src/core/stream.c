@@ -12,8 +12,11 @@
 
 #include "stream.h"
 #include "stream.inl"
+#include "deflate.inl"
+#include "streamh.h"
 #include "lex.inl"
 #include "heap.h"
+#include "heap.inl"
 #include "strings.h"
 #include <osbs/osbs.h>
 #include <osbs/bfile.h>
@@ -25,6 +28,19 @@
 #include <sewer/ptr.h>
 #include <sewer/unicode.h>
 
+/* Vector width (bytes) of the line scanner. Scalar if undefined */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STM_SIMD 32
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define STM_SIMD 16
+#endif
+
+#if defined(STM_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 /* Stream state */
 #define END_BIT 1
 #define CORRUPTION_BIT 2
@@ -46,6 +62,7 @@
 #define SOCK_WRITE_CACHE 512
 #define STD_CACHE 2048
 #define PIPE_CACHE 2048
+#define ZIP_CACHE 16384
 Stream *kSTDIN = NULL;
 Stream *kSTDOUT = NULL;
 Stream *kSTDERR = NULL;
@@ -61,12 +78,15 @@ typedef enum i_type_t
     i_ekTOSTDOUT = 5,
     i_ekTOSTDERR = 6,
     i_ekFROMSTDIN = 7,
+    i_ekTODEFLATE = 8,
+    i_ekFROMINFLATE = 9,
 
     i_ekDEVNULL = 0xFF
 } type_t;
 
 typedef struct i_file_t i_File;
 typedef struct i_socket_t i_Socket;
+typedef struct i_zip_t i_Zip;
 typedef struct i_buffer_t i_Buffer;
 struct i_buffer_t
 {
@@ -89,10 +109,18 @@ struct i_socket_t
     serror_t sock_err;
 };
 
+struct i_zip_t
+{
+    Stream *stm;
+    Deflater *deflater;
+    Inflater *inflater;
+};
+
 typedef union i_channel_t
 {
     i_File file;
     i_Socket sock;
+    i_Zip zip;
 } i_Channel;
 
 struct _stream_t
@@ -116,6 +144,7 @@ struct _stream_t
     bool_t spaces;
     bool_t newlines;
     bool_t comments;
+    bool_t mapped;
 };
 
 /*---------------------------------------------------------------------------*/
@@ -125,12 +154,14 @@ static void i_to_mem_fill_cache(Stream *, const uint32_t size);
 static void i_from_mem_fill_cache(Stream *, const uint32_t size);
 static void i_file_fill_cache(Stream *, const uint32_t size);
 static void i_stdin_fill_cache(Stream *, const uint32_t size);
+static void i_inflate_fill_cache(Stream *, const uint32_t size);
 
 typedef void (*i_FPtr_write)(Stream *, const byte_t *data, const uint32_t size);
 static void i_file_write(Stream *, const byte_t *data, const uint32_t size);
 static void i_sock_write(Stream *, const byte_t *data, const uint32_t size);
 static void i_stdout_write(Stream *, const byte_t *data, const uint32_t size);
 static void i_stderr_write(Stream *, const byte_t *data, const uint32_t size);
+static void i_deflate_write(Stream *, const byte_t *data, const uint32_t size);
 
 static const i_FPtr_cache i_FUNC_FILL[] = {
     i_to_mem_fill_cache,   /* i_ekTOMEMORY */
@@ -140,7 +171,9 @@ static const i_FPtr_cache i_FUNC_FILL[] = {
     NULL,                  /* i_ekSOCKET */
     NULL,                  /* i_ekTOSTDOUT */
     NULL,                  /* i_ekTOSTDERR */
-    i_stdin_fill_cache};   /* i_ekFROMSTDIN */
+    i_stdin_fill_cache,    /* i_ekFROMSTDIN */
+    NULL,                  /* i_ekTODEFLATE */
+    i_inflate_fill_cache}; /* i_ekFROMINFLATE */
 
 static const i_FPtr_write i_FUNC_WRITE[] = {
     NULL,           /* i_ekTOMEMORY */
@@ -149,8 +182,21 @@ static const i_FPtr_write i_FUNC_WRITE[] = {
     NULL,           /* i_ekFROMFILE */
     i_sock_write,   /* i_ekSOCKET */
     i_stdout_write, /* i_ekTOSTDOUT */
-    i_stderr_write, /* i_ekTOSTDERR */
-    NULL};          /* i_ekFROMSTDIN */
+    i_stderr_write,  /* i_ekTOSTDERR */
+    NULL,            /* i_ekFROMSTDIN */
+    i_deflate_write, /* i_ekTODEFLATE */
+    NULL};           /* i_ekFROMINFLATE */
+
+/*---------------------------------------------------------------------------*/
+
+/* Stream internals outlive any arena scope active while reading or writing */
+static byte_t *i_heap_malloc(const uint32_t size, const char_t *name)
+{
+    Arena *arena = _heap_arena(NULL);
+    byte_t *mem = heap_malloc(size, name);
+    _heap_arena(arena);
+    return mem;
+}
 
 /*---------------------------------------------------------------------------*/
 
@@ -160,7 +206,7 @@ static void i_init_buffer(i_Buffer *buffer, const uint32_t size, const char_t *n
     buffer->dynamic_alloc = TRUE;
     buffer->size = size;
     if (size > 0)
-        buffer->data = heap_malloc(size, name);
+        buffer->data = i_heap_malloc(size, name);
     else
         buffer->data = NULL;
     buffer->roffset = 0;
@@ -250,6 +296,16 @@ static void i_close_channel(i_Channel *channel, const type_t type)
         bsocket_close(&channel->sock.socket);
         break;
 
+    /* The inner stream remains open */
+    case i_ekTODEFLATE:
+        _deflater_finish(channel->zip.deflater);
+        _deflater_destroy(&channel->zip.deflater);
+        break;
+
+    case i_ekFROMINFLATE:
+        _inflater_destroy(&channel->zip.inflater);
+        break;
+
     case i_ekFROMMEMORY:
     case i_ekTOMEMORY:
     case i_ekTOSTDOUT:
@@ -269,6 +325,12 @@ void stm_close(Stream **stm)
     cassert_no_null(stm);
     cassert_no_null(*stm);
     stm_flush(*stm);
+    if ((*stm)->mapped == TRUE)
+    {
+        const byte_t *data = (*stm)->buffer1.data;
+        bfile_munmap(&data, (*stm)->buffer1.size);
+    }
+
     i_remove_buffer(&(*stm)->buffer1, "StreamBuffer1");
     i_remove_buffer(&(*stm)->buffer2, "StreamBuffer2");
     i_remove_buffer(&(*stm)->textline, "StreamTextLine");
@@ -340,6 +402,43 @@ Stream *stm_from_file(const char_t *pathname, ferror_t *error)
 
 /*---------------------------------------------------------------------------*/
 
+/* The file pages are the stream buffer, no read cache and no copies */
+Stream *stm_from_mmap(const char_t *pathname, ferror_t *error)
+{
+    uint64_t size = 0;
+    const byte_t *data = bfile_mmap(pathname, &size, error);
+    if (data != NULL)
+    {
+        if (size < 0xFFFFFFFF)
+        {
+            Stream *stm = i_create_stream(i_ekFROMMEMORY);
+            if (size > 0)
+            {
+                i_init_const_buffer(&stm->buffer1, data, (uint32_t)size);
+                stm->buffer1.woffset = (uint32_t)size;
+                stm->mapped = TRUE;
+            }
+            else
+            {
+                i_init_buffer(&stm->buffer1, 0, "StreamBuffer1");
+                bfile_munmap(&data, size);
+            }
+
+            stm->input = &stm->buffer1;
+            return stm;
+        }
+        else
+        {
+            bfile_munmap(&data, size);
+            ptr_assign(error, ekFBIG);
+        }
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static Stream *i_to_file(File *file, const ferror_t lerror, ferror_t *error)
 {
     ptr_assign(error, lerror);
@@ -399,6 +498,38 @@ Stream *stm_socket(Socket *socket)
 
 /*---------------------------------------------------------------------------*/
 
+Stream *stm_deflate(Stream *stm)
+{
+    Stream *zstm = NULL;
+    cassert_no_null(stm);
+    zstm = i_create_stream(i_ekTODEFLATE);
+    i_init_buffer(&zstm->buffer1, ZIP_CACHE, "StreamBuffer1");
+    zstm->output = &zstm->buffer1;
+    zstm->input = NULL;
+    zstm->channel.zip.stm = stm;
+    zstm->channel.zip.deflater = _deflater_create(stm);
+    zstm->channel.zip.inflater = NULL;
+    return zstm;
+}
+
+/*---------------------------------------------------------------------------*/
+
+Stream *stm_inflate(Stream *stm)
+{
+    Stream *zstm = NULL;
+    cassert_no_null(stm);
+    zstm = i_create_stream(i_ekFROMINFLATE);
+    i_init_buffer(&zstm->buffer1, ZIP_CACHE, "StreamBuffer1");
+    zstm->output = NULL;
+    zstm->input = &zstm->buffer1;
+    zstm->channel.zip.stm = stm;
+    zstm->channel.zip.deflater = NULL;
+    zstm->channel.zip.inflater = _inflater_create(stm);
+    return zstm;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static Stream *i_stdout(void)
 {
     Stream *stm = i_create_stream(i_ekTOSTDOUT);
@@ -802,6 +933,17 @@ static void i_stderr_write(Stream *stm, const byte_t *data, const uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
+static void i_deflate_write(Stream *stm, const byte_t *data, const uint32_t size)
+{
+    cassert_no_null(stm);
+    cassert(stm->type == i_ekTODEFLATE);
+    _deflater_write(stm->channel.zip.deflater, data, size);
+    if (stm_state(stm->channel.zip.stm) != ekSTOK)
+        BIT_SET(stm->state, BROKEN_BIT);
+}
+
+/*---------------------------------------------------------------------------*/
+
 static void i_grow_buffer(i_Buffer *output, const uint32_t size, const uint32_t grow_size, const char_t *memname)
 {
     uint32_t current_datasize, reqsize;
@@ -810,18 +952,20 @@ static void i_grow_buffer(i_Buffer *output, const uint32_t size, const uint32_t
     cassert(output->woffset + size > output->size);
 
     current_datasize = output->woffset - output->roffset;
+    /* Memory buffers are 32-bit. Use file streams for bigger data */
+    cassert_fatal_msg(size <= UINT32_MAX - current_datasize, "Stream memory buffer exceeds 4GB.");
     reqsize = current_datasize + size;
 
     /* Not enough buffer size */
     if (reqsize > output->size)
     {
-        uint32_t new_size = output->size > 0 ? 2 * output->size : grow_size;
+        uint32_t new_size = output->size > 0 ? output->size : grow_size;
         byte_t *data = NULL;
 
-        while (reqsize > new_size)
-            new_size *= 2;
+        while (reqsize > new_size || new_size == output->size)
+            new_size = new_size <= 0x7FFFFFFF ? new_size * 2 : UINT32_MAX;
 
-        data = heap_malloc(new_size, memname);
+        data = i_heap_malloc(new_size, memname);
 
         /* Exists non-readed data in buffer, we have to preserve */
         if (output->data != NULL)
@@ -972,6 +1116,24 @@ void stm_write(Stream *stm, const byte_t *data, const uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
+/* The 32-bit functions move up to 1GB at once */
+#define i_CHUNK_SIZE 0x40000000
+
+void stm_write64(Stream *stm, const byte_t *data, const uint64_t size)
+{
+    uint64_t written = 0;
+    cassert_no_null(stm);
+    while (written < size && IS_WRITE_OK(stm->state))
+    {
+        uint64_t remain = size - written;
+        uint32_t chunk = remain > i_CHUNK_SIZE ? i_CHUNK_SIZE : (uint32_t)remain;
+        stm_write(stm, data + written, chunk);
+        written += chunk;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
 static void i_write_utf16(Stream *stm, const char_t *str)
 {
     uint32_t codepoint = unicode_to_u32(str, ekUTF8);
@@ -1346,6 +1508,29 @@ static void i_stdin_fill_cache(Stream *stm, const uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
+static void i_inflate_fill_cache(Stream *stm, const uint32_t size)
+{
+    i_Buffer *input = NULL;
+    cassert_no_null(stm);
+    cassert(stm->type == i_ekFROMINFLATE);
+    input = stm->input;
+    cassert_no_null(input);
+    cassert(input->woffset == input->roffset);
+    unref(size);
+    input->woffset = _inflater_read(stm->channel.zip.inflater, input->data, input->size);
+    input->roffset = 0;
+    if (input->woffset == 0)
+    {
+        /* Broken inner stream or bad compressed data */
+        if (_inflater_error(stm->channel.zip.inflater) == TRUE)
+            BIT_SET(stm->state, stm_state(stm->channel.zip.stm) == ekSTBROKEN ? BROKEN_BIT : CORRUPTION_BIT);
+        else
+            BIT_SET(stm->state, END_BIT);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
 static uint32_t i_read(Stream *stm, byte_t *data, const uint32_t size, const bool_t reverse)
 {
     uint32_t readed = 0;
@@ -1470,6 +1655,24 @@ uint32_t stm_read(Stream *stm, byte_t *data, const uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
+uint64_t stm_read64(Stream *stm, byte_t *data, const uint64_t size)
+{
+    uint64_t readed = 0;
+    cassert_no_null(stm);
+    while (readed < size)
+    {
+        uint64_t remain = size - readed;
+        uint32_t chunk = remain > i_CHUNK_SIZE ? i_CHUNK_SIZE : (uint32_t)remain;
+        uint32_t rsize = i_read(stm, data != NULL ? data + readed : NULL, chunk, FALSE);
+        readed += rsize;
+        if (rsize < chunk)
+            break;
+    }
+    return readed;
+}
+
+/*---------------------------------------------------------------------------*/
+
 void stm_skip(Stream *stm, const uint32_t size)
 {
     i_read(stm, NULL, size, FALSE);
@@ -1477,6 +1680,298 @@ void stm_skip(Stream *stm, const uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
+void stm_skip64(Stream *stm, const uint64_t size)
+{
+    stm_read64(stm, NULL, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* File position of the read cache first byte */
+static uint64_t i_cache_start(const Stream *stm, uint64_t *end)
+{
+    uint64_t pos = 0;
+    cassert_no_null(stm);
+    cassert(stm->type == i_ekFROMFILE);
+    cassert_no_null(end);
+    pos = bfile_pos(stm->channel.file.file);
+    cassert(pos >= stm->input->woffset);
+    *end = pos;
+    return pos - stm->input->woffset;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint64_t stm_tell(const Stream *stm)
+{
+    uint64_t pos = 0;
+    uint32_t restored = 0;
+    cassert_no_null(stm);
+    restored = stm->restore.woffset - stm->restore.roffset;
+    switch (stm->type)
+    {
+    case i_ekFROMMEMORY:
+    case i_ekTOMEMORY:
+        pos = stm->input->roffset;
+        break;
+
+    case i_ekFROMFILE:
+    {
+        uint64_t end = 0;
+        pos = i_cache_start(stm, &end) + stm->input->roffset;
+        break;
+    }
+
+    /* Pending bytes are not in the file yet */
+    case i_ekTOFILE:
+        return bfile_pos(stm->channel.file.file) + stm->output->woffset;
+
+    case i_ekTOSTDOUT:
+    case i_ekTOSTDERR:
+    case i_ekTODEFLATE:
+        return stm->write_offset;
+
+    case i_ekSOCKET:
+    case i_ekFROMSTDIN:
+    case i_ekFROMINFLATE:
+    case i_ekDEVNULL:
+        pos = stm->read_offset;
+        break;
+
+    default:
+        cassert_default(stm->type);
+    }
+
+    /* Bytes returned to the stream will be read again */
+    return pos >= restored ? pos - restored : 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t stm_seek(Stream *stm, const int64_t offset, const file_seek_t whence)
+{
+    uint64_t size = 0;
+    int64_t target = 0;
+    cassert_no_null(stm);
+    if (BIT_TEST(stm->state, CORRUPTION_BIT) == TRUE)
+        return FALSE;
+
+    switch (stm->type)
+    {
+    case i_ekFROMMEMORY:
+    case i_ekTOMEMORY:
+        size = stm->input->woffset;
+        break;
+
+    case i_ekFROMFILE:
+    case i_ekTOFILE:
+        stm_flush(stm);
+        if (bfile_fstat(stm->channel.file.file, NULL, &size, NULL, &stm->channel.file.file_err) == FALSE)
+            return FALSE;
+        break;
+
+    case i_ekSOCKET:
+    case i_ekTOSTDOUT:
+    case i_ekTOSTDERR:
+    case i_ekFROMSTDIN:
+    case i_ekTODEFLATE:
+    case i_ekFROMINFLATE:
+    case i_ekDEVNULL:
+        return FALSE;
+
+    default:
+        cassert_default(stm->type);
+    }
+
+    switch (whence)
+    {
+    case ekSEEKSET:
+        target = offset;
+        break;
+    case ekSEEKCUR:
+        target = (int64_t)stm_tell(stm) + offset;
+        break;
+    case ekSEEKEND:
+        target = (int64_t)size + offset;
+        break;
+    default:
+        cassert_default(whence);
+    }
+
+    if (target < 0)
+    {
+        if (stm->type == i_ekFROMFILE || stm->type == i_ekTOFILE)
+            stm->channel.file.file_err = ekFSEEKNEG;
+        return FALSE;
+    }
+
+    switch (stm->type)
+    {
+    case i_ekFROMMEMORY:
+    case i_ekTOMEMORY:
+        if ((uint64_t)target > size)
+            return FALSE;
+        stm->input->roffset = (uint32_t)target;
+        break;
+
+    case i_ekFROMFILE:
+    {
+        /* Inside the read cache, no system call and no refill */
+        uint64_t end = 0;
+        uint64_t start = i_cache_start(stm, &end);
+        if ((uint64_t)target >= start && (uint64_t)target <= end)
+        {
+            stm->input->roffset = (uint32_t)((uint64_t)target - start);
+        }
+        else
+        {
+            if (bfile_seek(stm->channel.file.file, target, ekSEEKSET, &stm->channel.file.file_err) == FALSE)
+                return FALSE;
+            stm->input->roffset = 0;
+            stm->input->woffset = 0;
+        }
+        break;
+    }
+
+    case i_ekTOFILE:
+        if (bfile_seek(stm->channel.file.file, target, ekSEEKSET, &stm->channel.file.file_err) == FALSE)
+            return FALSE;
+        stm->write_offset = (uint64_t)target;
+        return TRUE;
+
+    case i_ekSOCKET:
+    case i_ekTOSTDOUT:
+    case i_ekTOSTDERR:
+    case i_ekFROMSTDIN:
+    case i_ekTODEFLATE:
+    case i_ekFROMINFLATE:
+    case i_ekDEVNULL:
+    default:
+        cassert_default(stm->type);
+    }
+
+    /* Restored bytes belong to the previous position */
+    stm->restore.roffset = 0;
+    stm->restore.woffset = 0;
+    stm->read_offset = (uint64_t)target;
+    BIT_CLEAR(stm->state, END_BIT);
+    BIT_CLEAR(stm->state, BROKEN_BIT);
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t stm_read_at(Stream *stm, const uint64_t offset, byte_t *data, const uint32_t size)
+{
+    cassert_no_null(stm);
+    cassert_no_null(data);
+    switch (stm->type)
+    {
+    case i_ekFROMMEMORY:
+    case i_ekTOMEMORY:
+    {
+        uint64_t total = stm->input->woffset;
+        uint32_t n = 0;
+        if (offset < total)
+        {
+            n = total - offset < size ? (uint32_t)(total - offset) : size;
+            if (n > 0)
+                bmem_copy(data, stm->input->data + offset, n);
+        }
+        return n;
+    }
+
+    case i_ekFROMFILE:
+    {
+        File *file = stm->channel.file.file;
+        uint64_t end = 0;
+        uint64_t start = i_cache_start(stm, &end);
+        uint32_t readed = 0;
+        if (offset >= start && offset + size <= end)
+        {
+            if (size > 0)
+                bmem_copy(data, stm->input->data + (offset - start), size);
+            return size;
+        }
+
+        /* The file position is restored, so the read cache is still valid */
+        if (bfile_seek(file, (int64_t)offset, ekSEEKSET, &stm->channel.file.file_err) == TRUE)
+        {
+            uint32_t rsize = 0;
+            while (readed < size && bfile_read(file, data + readed, size - readed, &rsize, NULL) == TRUE)
+                readed += rsize;
+            bfile_seek(file, (int64_t)end, ekSEEKSET, NULL);
+        }
+
+        return readed;
+    }
+
+    case i_ekTOFILE:
+    case i_ekSOCKET:
+    case i_ekTOSTDOUT:
+    case i_ekTOSTDERR:
+    case i_ekFROMSTDIN:
+    case i_ekTODEFLATE:
+    case i_ekFROMINFLATE:
+    case i_ekDEVNULL:
+        return 0;
+
+    default:
+        cassert_default(stm->type);
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+const byte_t *stm_peek(Stream *stm, uint32_t *size)
+{
+    cassert_no_null(stm);
+    cassert_no_null(size);
+    *size = 0;
+    if (!IS_READ_OK(stm->state))
+        return NULL;
+
+    /* Restored data is always read first */
+    if (stm->restore.woffset > stm->restore.roffset)
+    {
+        *size = stm->restore.woffset - stm->restore.roffset;
+        return stm->restore.data + stm->restore.roffset;
+    }
+
+    if (stm->input != NULL)
+    {
+        i_Buffer *input = stm->input;
+        if (input->woffset == input->roffset)
+        {
+            cassert_no_nullf(i_FUNC_FILL[stm->type]);
+            i_FUNC_FILL[stm->type](stm, input->size);
+        }
+
+        *size = input->woffset - input->roffset;
+        return *size > 0 ? input->data + input->roffset : NULL;
+    }
+
+    /* Sockets doesn't use read cache. One byte at a time into 'restore' */
+    {
+        byte_t value = 0;
+        if (i_read(stm, &value, 1, FALSE) == 1 && IS_READ_OK(stm->state))
+        {
+            stm->restore.woffset = 0;
+            stm->restore.roffset = 0;
+            _stm_restore(stm, &value, 1);
+            stm->read_offset -= 1;
+            *size = 1;
+            return stm->restore.data;
+        }
+    }
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
 void stm_skip_bom(Stream *stm)
 {
     uint32_t pcol = stm_col(stm);
@@ -1597,7 +2092,7 @@ static void i_char_to_cache(Stream *stm, const uint32_t code)
     {
         if (line->size == 0)
         {
-            line->data = heap_malloc(256, "StreamTextLine");
+            line->data = i_heap_malloc(256, "StreamTextLine");
             line->size = 256;
         }
         else
@@ -1678,6 +2173,289 @@ const char_t *stm_read_line(Stream *stm)
 
 /*---------------------------------------------------------------------------*/
 
+#if defined(STM_SIMD)
+
+#if STM_SIMD == 32
+typedef __m256i i_Vec;
+#else
+typedef __m128i i_Vec;
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE i_Vec i_vset(const byte_t c)
+{
+#if STM_SIMD == 32
+    return _mm256_set1_epi8((char)c);
+#else
+    return _mm_set1_epi8((char)c);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE i_Vec i_vload(const byte_t *data)
+{
+#if STM_SIMD == 32
+    return _mm256_loadu_si256(cast_const(data, __m256i));
+#else
+    return _mm_loadu_si128(cast_const(data, __m128i));
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Bit 'i' is set if byte 'i' of 'v' is equal to 'c' */
+static ___INLINE uint32_t i_veq(const i_Vec v, const i_Vec c)
+{
+#if STM_SIMD == 32
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c));
+#else
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, c));
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Bit 'i' is set if byte 'i' of 'v' is not ASCII */
+static ___INLINE uint32_t i_vhigh(const i_Vec v)
+{
+#if STM_SIMD == 32
+    return (uint32_t)_mm256_movemask_epi8(v);
+#else
+    return (uint32_t)_mm_movemask_epi8(v);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint32_t i_ctz(const uint32_t mask)
+{
+    cassert(mask != 0);
+#if defined(_MSC_VER)
+    {
+        unsigned long i;
+        _BitScanForward(&i, mask);
+        return (uint32_t)i;
+    }
+#else
+    return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+/* Position of the first 'endchar' or '\0' byte ('size' if none). 'high' != 0 if non-ASCII bytes before */
+static uint32_t i_find_char(const byte_t *data, const uint32_t size, const byte_t endchar, uint32_t *high)
+{
+    uint32_t pos = 0;
+    cassert_no_null(high);
+#if defined(STM_SIMD)
+    {
+        const i_Vec end = i_vset(endchar);
+        const i_Vec zero = i_vset(0);
+        while (pos + STM_SIMD <= size)
+        {
+            i_Vec v = i_vload(data + pos);
+            uint32_t mask = i_veq(v, end) | i_veq(v, zero);
+            if (mask != 0)
+            {
+                uint32_t n = i_ctz(mask);
+                *high |= i_vhigh(v) & ((1u << n) - 1);
+                return pos + n;
+            }
+
+            *high |= i_vhigh(v);
+            pos += STM_SIMD;
+        }
+    }
+#endif
+
+    for (; pos < size; ++pos)
+    {
+        byte_t c = data[pos];
+        if (c == endchar || c == 0)
+            return pos;
+        *high |= (uint32_t)(c & 0x80);
+    }
+
+    return size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_line_space(i_Buffer *line, const uint32_t size)
+{
+    cassert_no_null(line);
+    if (line->roffset + size > line->size)
+    {
+        uint32_t nsize = line->size > 0 ? line->size : 256;
+        while (line->roffset + size > nsize)
+            nsize *= 2;
+
+        if (line->size == 0)
+            line->data = i_heap_malloc(nsize, "StreamTextLine");
+        else
+            line->data = heap_realloc(line->data, line->size, nsize, "StreamTextLine");
+
+        line->size = nsize;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Number of UTF-8 bytes of a well-formed sequence starting at 'data[0]', 0 if malformed */
+static uint32_t i_utf8_bytes(const byte_t *data, const uint32_t size)
+{
+    uint32_t i, n = 0;
+    if (data[0] < 0x80)
+        return 1;
+    else if ((data[0] & 0xE0) == 0xC0)
+        n = 2;
+    else if ((data[0] & 0xF0) == 0xE0)
+        n = 3;
+    else if ((data[0] & 0xF8) == 0xF0)
+        n = 4;
+    else
+        return 0;
+
+    if (n > size)
+        return 0;
+
+    for (i = 1; i < n; ++i)
+    {
+        if ((data[i] & 0xC0) != 0x80)
+            return 0;
+    }
+
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Invalid bytes are discarded, as 'stm_read_char()' loop does */
+static void i_utf8_filter(i_Buffer *line)
+{
+    uint32_t i = 0, j = 0;
+    cassert_no_null(line);
+    while (i < line->roffset)
+    {
+        uint32_t n = i_utf8_bytes(line->data + i, line->roffset - i);
+        if (n > 0)
+        {
+            if (i != j)
+                bmem_move(line->data + j, line->data + i, n);
+            i += n;
+            j += n;
+        }
+        else
+        {
+            i += 1;
+        }
+    }
+
+    line->roffset = j;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_track_chars(Stream *stm, const byte_t *data, const uint32_t size)
+{
+    uint32_t i;
+    for (i = 0; i < size; ++i)
+    {
+        if (data[i] == '\n')
+        {
+            stm->row += 1;
+            stm->col = 1;
+        }
+        /* Continuation bytes are not new characters */
+        else if ((data[i] & 0xC0) != 0x80)
+        {
+            stm->col += 1;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * UTF-8 with ASCII delimiter. The input cache is scanned in blocks and copied
+ * to the text line, without decoding. Validation is done once per line.
+ */
+static const char_t *i_read_to_ascii(Stream *stm, const byte_t endchar)
+{
+    i_Buffer *line = &stm->textline;
+    uint32_t high = 0;
+    bool_t found = FALSE;
+    line->roffset = 0;
+
+    while (found == FALSE)
+    {
+        uint32_t size = 0, n = 0;
+        const byte_t *data = stm_peek(stm, &size);
+        if (data == NULL)
+            break;
+
+        n = i_find_char(data, size, endchar, &high);
+        if (n > 0)
+        {
+            i_line_space(line, n + 1);
+            bmem_copy(line->data + line->roffset, data, n);
+            line->roffset += n;
+        }
+
+        if (n < size)
+        {
+            /* The delimiter (or '\0') is consumed but not included */
+            byte_t end = data[n];
+            if (high == 0 && endchar == '\n')
+                stm->col += line->roffset;
+            else
+                i_track_chars(stm, line->data, line->roffset);
+            i_track_chars(stm, &end, 1);
+            stm_skip(stm, n + 1);
+            found = TRUE;
+        }
+        else
+        {
+            stm_skip(stm, n);
+        }
+    }
+
+    /* 'stm_read_char()' counts the end of stream as a character */
+    if (found == FALSE)
+    {
+        i_track_chars(stm, line->data, line->roffset);
+        stm->col += 1;
+    }
+
+    if (high != 0)
+        i_utf8_filter(line);
+
+    /* Avoid '\r' */
+    if (line->roffset > 0)
+    {
+        if (line->data[line->roffset - 1] == '\r')
+            line->roffset -= 1;
+    }
+
+    i_line_space(line, 1);
+    line->data[line->roffset] = 0;
+
+    if (!IS_READ_OK(stm->state))
+    {
+        if (line->roffset == 0)
+            return NULL;
+    }
+
+    return cast_const(line->data, char_t);
+}
+
+/*---------------------------------------------------------------------------*/
+
 const char_t *stm_read_to_char(Stream *stm, const uint32_t endchar)
 {
     i_Buffer *line;
@@ -1686,6 +2464,9 @@ const char_t *stm_read_to_char(Stream *stm, const uint32_t endchar)
     if (!IS_READ_OK(stm->state))
         return NULL;
 
+    if (BIT_TEST(stm->state, READ_UTF8_BIT) == TRUE && endchar > 0 && endchar < 0x80)
+        return i_read_to_ascii(stm, (byte_t)endchar);
+
     line = &stm->textline;
     line->roffset = 0;
     code = stm_read_char(stm);
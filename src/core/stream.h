@@ -21,12 +21,18 @@ _core_api Stream *stm_memory(const uint32_t size);
 
 _core_api Stream *stm_from_file(const char_t *pathname, ferror_t *error);
 
+_core_api Stream *stm_from_mmap(const char_t *pathname, ferror_t *error);
+
 _core_api Stream *stm_to_file(const char_t *pathname, ferror_t *error);
 
 _core_api Stream *stm_append_file(const char_t *pathname, ferror_t *error);
 
 _core_api Stream *stm_socket(Socket *socket);
 
+_core_api Stream *stm_deflate(Stream *stm);
+
+_core_api Stream *stm_inflate(Stream *stm);
+
 _core_api void stm_close(Stream **stm);
 
 _core_api endian_t stm_get_write_endian(const Stream *stm);
@@ -83,6 +89,8 @@ _core_api uint32_t stm_buffer_size(const Stream *stm);
 
 _core_api void stm_write(Stream *stm, const byte_t *data, const uint32_t size);
 
+_core_api void stm_write64(Stream *stm, const byte_t *data, const uint64_t size);
+
 _core_api void stm_write_char(Stream *stm, const uint32_t codepoint);
 
 _core_api uint32_t stm_printf(Stream *stm, const char_t *format, ...) __PRINTF(2, 3);
@@ -113,6 +121,8 @@ _core_api void stm_write_r64(Stream *stm, const real64_t value);
 
 _core_api uint32_t stm_read(Stream *stm, byte_t *data, const uint32_t size);
 
+_core_api uint64_t stm_read64(Stream *stm, byte_t *data, const uint64_t size);
+
 _core_api uint32_t stm_read_char(Stream *stm);
 
 _core_api const char_t *stm_read_chars(Stream *stm, const uint32_t n);
@@ -169,6 +179,14 @@ _core_api real64_t stm_read_r64(Stream *stm);
 
 _core_api void stm_skip(Stream *stm, const uint32_t size);
 
+_core_api void stm_skip64(Stream *stm, const uint64_t size);
+
+_core_api bool_t stm_seek(Stream *stm, const int64_t offset, const file_seek_t whence);
+
+_core_api uint64_t stm_tell(const Stream *stm);
+
+_core_api uint32_t stm_read_at(Stream *stm, const uint64_t offset, byte_t *data, const uint32_t size);
+
 _core_api void stm_skip_bom(Stream *stm);
 
 _core_api void stm_skip_token(Stream *stm, const ltoken_t token);
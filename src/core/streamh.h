@@ -0,0 +1,19 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: streamh.h
+ *
+ */
+
+/* Undocumented (hidden) API about data streams */
+
+#include "coreh.hxx"
+
+__EXTERN_C
+
+_core_api const byte_t *stm_peek(Stream *stm, uint32_t *size);
+
+__END_C
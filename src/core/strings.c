@@ -11,6 +11,7 @@
 /* UTF8 strings */
 
 #include "strings.h"
+#include "arena.h"
 #include "arrpt.h"
 #include "heap.h"
 #include "stream.h"
@@ -155,6 +156,39 @@ String *str_copy(const String *str)
 
 /*---------------------------------------------------------------------------*/
 
+String *str_arena_c(Arena *arena, const char_t *str)
+{
+    String *lstr = NULL;
+    arena_scope_begin(arena);
+    lstr = str_c(str);
+    arena_scope_end(arena);
+    return lstr;
+}
+
+/*---------------------------------------------------------------------------*/
+
+String *str_arena_cn(Arena *arena, const char_t *str, const uint32_t n)
+{
+    String *lstr = NULL;
+    arena_scope_begin(arena);
+    lstr = str_cn(str, n);
+    arena_scope_end(arena);
+    return lstr;
+}
+
+/*---------------------------------------------------------------------------*/
+
+String *str_arena_copy(Arena *arena, const String *str)
+{
+    String *lstr = NULL;
+    arena_scope_begin(arena);
+    lstr = str_copy(str);
+    arena_scope_end(arena);
+    return lstr;
+}
+
+/*---------------------------------------------------------------------------*/
+
 String *str_printf(const char_t *format, ...)
 {
     String *str = NULL;
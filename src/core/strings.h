@@ -28,6 +28,12 @@ _core_api String *str_trim_n(const char_t *str, const uint32_t n);
 
 _core_api String *str_copy(const String *str);
 
+_core_api String *str_arena_c(Arena *arena, const char_t *str);
+
+_core_api String *str_arena_cn(Arena *arena, const char_t *str, const uint32_t n);
+
+_core_api String *str_arena_copy(Arena *arena, const String *str);
+
 _core_api String *str_printf(const char_t *format, ...) __PRINTF(1, 2);
 
 _core_api String *str_path(const platform_t platform, const char_t *format, ...) __PRINTF(2, 3);
@@ -0,0 +1,454 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: tpool.c
+ *
+ */
+
+/* Thread pool */
+
+#include "tpool.h"
+#include "tpool.inl"
+#include "heap.h"
+#include <osbs/bmutex.h>
+#include <osbs/bsem.h>
+#include <osbs/bthread.h>
+#include <osbs/osbs.h>
+#include <sewer/cassert.h>
+
+/*
+ * Each worker owns a queue of jobs. Jobs submitted from a worker go to its
+ * own queue and the owner takes the newest first (the data is still in cache).
+ * Other submissions are spread round-robin. Idle workers steal the oldest
+ * job of the other queues. Threads waiting for a future or for the pool run
+ * queued jobs meanwhile, so jobs can submit and wait for other jobs.
+ */
+
+typedef struct _job_t i_Job;
+typedef struct _queue_t i_Queue;
+typedef struct _worker_t i_Worker;
+
+struct _job_t
+{
+    FPtr_task func_task;
+    void *data;
+    Future *future;
+};
+
+struct _queue_t
+{
+    Mutex *mutex;
+    i_Job *jobs;
+    uint32_t head;
+    uint32_t size;
+    uint32_t capacity;
+};
+
+struct _worker_t
+{
+    ThreadPool *pool;
+    Thread *thread;
+    uint32_t index;
+    i_Queue queue;
+};
+
+struct _tpool_t
+{
+    i_Worker *workers;
+    uint32_t nworkers;
+    Mutex *mutex;
+    Semaphore *signal;
+    Semaphore *idle;
+    uint32_t next;
+    uint32_t pending;
+    uint32_t nwaiters;
+    uint32_t nfutures;
+    bool_t running;
+};
+
+struct _future_t
+{
+    ThreadPool *pool;
+    Semaphore *sem;
+    uint32_t rvalue;
+    bool_t done;
+};
+
+#define QUEUE_CAPACITY 64
+
+static Mutex *i_GLOBAL_MUTEX = NULL;
+static ThreadPool *i_GLOBAL_POOL = NULL;
+static __THREAD_LOCAL i_Worker *i_THREAD_WORKER = NULL;
+
+/*---------------------------------------------------------------------------*/
+
+void _tpool_start(void)
+{
+    cassert(i_GLOBAL_MUTEX == NULL);
+    i_GLOBAL_MUTEX = bmutex_create();
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _tpool_finish(void)
+{
+    if (i_GLOBAL_POOL != NULL)
+        tpool_destroy(&i_GLOBAL_POOL);
+    bmutex_close(&i_GLOBAL_MUTEX);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_queue_push(i_Queue *queue, const i_Job *job)
+{
+    bmutex_lock(queue->mutex);
+    if (queue->size == queue->capacity)
+    {
+        uint32_t i, capacity = queue->capacity * 2;
+        i_Job *jobs = heap_new_n(capacity, i_Job);
+        for (i = 0; i < queue->size; ++i)
+            jobs[i] = queue->jobs[(queue->head + i) % queue->capacity];
+        heap_delete_n(&queue->jobs, queue->capacity, i_Job);
+        queue->jobs = jobs;
+        queue->capacity = capacity;
+        queue->head = 0;
+    }
+
+    queue->jobs[(queue->head + queue->size) % queue->capacity] = *job;
+    queue->size += 1;
+    bmutex_unlock(queue->mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_queue_pop(i_Queue *queue, const bool_t newest, i_Job *job)
+{
+    bool_t ok = FALSE;
+    bmutex_lock(queue->mutex);
+    if (queue->size > 0)
+    {
+        if (newest == TRUE)
+        {
+            *job = queue->jobs[(queue->head + queue->size - 1) % queue->capacity];
+        }
+        else
+        {
+            *job = queue->jobs[queue->head];
+            queue->head = (queue->head + 1) % queue->capacity;
+        }
+
+        queue->size -= 1;
+        ok = TRUE;
+    }
+    bmutex_unlock(queue->mutex);
+    return ok;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_take(ThreadPool *pool, i_Job *job)
+{
+    i_Worker *worker = i_THREAD_WORKER;
+    uint32_t i, first = 0;
+    if (worker != NULL && worker->pool == pool)
+    {
+        if (i_queue_pop(&worker->queue, TRUE, job) == TRUE)
+            return TRUE;
+        first = worker->index + 1;
+    }
+
+    for (i = 0; i < pool->nworkers; ++i)
+    {
+        i_Worker *victim = &pool->workers[(first + i) % pool->nworkers];
+        if (i_queue_pop(&victim->queue, FALSE, job) == TRUE)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_run(ThreadPool *pool, const i_Job *job)
+{
+    uint32_t rvalue = job->func_task(job->data);
+    bmutex_lock(pool->mutex);
+    if (job->future != NULL)
+    {
+        job->future->rvalue = rvalue;
+        job->future->done = TRUE;
+        bsem_post(job->future->sem);
+    }
+
+    cassert(pool->pending > 0);
+    pool->pending -= 1;
+    if (pool->pending == 0)
+    {
+        for (; pool->nwaiters > 0; pool->nwaiters -= 1)
+            bsem_post(pool->idle);
+    }
+    bmutex_unlock(pool->mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_worker_main(i_Worker *worker)
+{
+    ThreadPool *pool = worker->pool;
+    bool_t running = TRUE;
+    i_THREAD_WORKER = worker;
+    while (running == TRUE)
+    {
+        i_Job job;
+        if (i_take(pool, &job) == TRUE)
+        {
+            i_run(pool, &job);
+        }
+        else
+        {
+            bsem_wait(pool->signal);
+            bmutex_lock(pool->mutex);
+            running = pool->running;
+            bmutex_unlock(pool->mutex);
+        }
+    }
+
+    i_THREAD_WORKER = NULL;
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+ThreadPool *tpool_create(const uint32_t nworkers)
+{
+    ThreadPool *pool = heap_new0(ThreadPool);
+    uint32_t i;
+    heap_start_mt();
+    pool->nworkers = nworkers > 0 ? nworkers : osbs_ncpus();
+    pool->workers = heap_new_n0(pool->nworkers, i_Worker);
+    pool->mutex = bmutex_create();
+    pool->signal = bsem_create(0);
+    pool->idle = bsem_create(0);
+    pool->running = TRUE;
+
+    /* All queues must exist before any worker tries to steal */
+    for (i = 0; i < pool->nworkers; ++i)
+    {
+        i_Worker *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        worker->queue.mutex = bmutex_create();
+        worker->queue.capacity = QUEUE_CAPACITY;
+        worker->queue.jobs = heap_new_n(QUEUE_CAPACITY, i_Job);
+    }
+
+    for (i = 0; i < pool->nworkers; ++i)
+        pool->workers[i].thread = bthread_create(i_worker_main, &pool->workers[i], i_Worker);
+
+    return pool;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void tpool_destroy(ThreadPool **pool)
+{
+    uint32_t i;
+    cassert_no_null(pool);
+    cassert_no_null(*pool);
+    tpool_wait(*pool);
+
+    /* Futures keep a pointer to the pool. Destroy them first */
+    cassert((*pool)->nfutures == 0);
+
+    bmutex_lock((*pool)->mutex);
+    (*pool)->running = FALSE;
+    bmutex_unlock((*pool)->mutex);
+
+    for (i = 0; i < (*pool)->nworkers; ++i)
+        bsem_post((*pool)->signal);
+
+    /* Workers steal from all the queues until they stop */
+    for (i = 0; i < (*pool)->nworkers; ++i)
+    {
+        bthread_wait((*pool)->workers[i].thread);
+        bthread_close(&(*pool)->workers[i].thread);
+    }
+
+    for (i = 0; i < (*pool)->nworkers; ++i)
+    {
+        i_Worker *worker = &(*pool)->workers[i];
+        cassert(worker->queue.size == 0);
+        heap_delete_n(&worker->queue.jobs, worker->queue.capacity, i_Job);
+        bmutex_close(&worker->queue.mutex);
+    }
+
+    bsem_close(&(*pool)->signal);
+    bsem_close(&(*pool)->idle);
+    bmutex_close(&(*pool)->mutex);
+    heap_delete_n(&(*pool)->workers, (*pool)->nworkers, i_Worker);
+    heap_delete(pool, ThreadPool);
+    heap_end_mt();
+}
+
+/*---------------------------------------------------------------------------*/
+
+ThreadPool *tpool_global(void)
+{
+    ThreadPool *pool = NULL;
+    cassert_no_null(i_GLOBAL_MUTEX);
+    bmutex_lock(i_GLOBAL_MUTEX);
+    if (i_GLOBAL_POOL == NULL)
+        i_GLOBAL_POOL = tpool_create(0);
+    pool = i_GLOBAL_POOL;
+    bmutex_unlock(i_GLOBAL_MUTEX);
+    return pool;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t tpool_nworkers(const ThreadPool *pool)
+{
+    cassert_no_null(pool);
+    return pool->nworkers;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static Future *i_submit(ThreadPool *pool, void *data, FPtr_task func_task, const bool_t future)
+{
+    i_Worker *worker = i_THREAD_WORKER;
+    i_Queue *queue = NULL;
+    i_Job job;
+    cassert_no_null(pool);
+    cassert_no_nullf(func_task);
+    job.func_task = func_task;
+    job.data = data;
+    job.future = NULL;
+    if (future == TRUE)
+    {
+        job.future = heap_new(Future);
+        job.future->pool = pool;
+        job.future->sem = bsem_create(0);
+        job.future->rvalue = 0;
+        job.future->done = FALSE;
+    }
+
+    bmutex_lock(pool->mutex);
+    cassert(pool->running == TRUE);
+    pool->pending += 1;
+    if (job.future != NULL)
+        pool->nfutures += 1;
+    if (worker != NULL && worker->pool == pool)
+    {
+        queue = &worker->queue;
+    }
+    else
+    {
+        queue = &pool->workers[pool->next].queue;
+        pool->next = (pool->next + 1) % pool->nworkers;
+    }
+    bmutex_unlock(pool->mutex);
+
+    i_queue_push(queue, &job);
+    bsem_post(pool->signal);
+    return job.future;
+}
+
+/*---------------------------------------------------------------------------*/
+
+Future *tpool_submit_imp(ThreadPool *pool, void *data, FPtr_task func_task)
+{
+    return i_submit(pool, data, func_task, TRUE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void tpool_run_imp(ThreadPool *pool, void *data, FPtr_task func_task)
+{
+    i_submit(pool, data, func_task, FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void tpool_wait(ThreadPool *pool)
+{
+    cassert_no_null(pool);
+    /* A job waiting for all jobs (itself included) would never return */
+    cassert(i_THREAD_WORKER == NULL || i_THREAD_WORKER->pool != pool);
+    for (;;)
+    {
+        i_Job job;
+        if (i_take(pool, &job) == TRUE)
+        {
+            i_run(pool, &job);
+        }
+        else
+        {
+            bmutex_lock(pool->mutex);
+            if (pool->pending == 0)
+            {
+                bmutex_unlock(pool->mutex);
+                return;
+            }
+
+            pool->nwaiters += 1;
+            bmutex_unlock(pool->mutex);
+            bsem_wait(pool->idle);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t future_ready(const Future *future, uint32_t *rvalue)
+{
+    bool_t done = FALSE;
+    cassert_no_null(future);
+    bmutex_lock(future->pool->mutex);
+    done = future->done;
+    if (done == TRUE && rvalue != NULL)
+        *rvalue = future->rvalue;
+    bmutex_unlock(future->pool->mutex);
+    return done;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t future_wait(Future *future)
+{
+    uint32_t rvalue = 0;
+    cassert_no_null(future);
+    while (future_ready(future, &rvalue) == FALSE)
+    {
+        i_Job job;
+        if (i_take(future->pool, &job) == TRUE)
+        {
+            i_run(future->pool, &job);
+        }
+        else
+        {
+            /* The semaphore is posted once, when the job finishes */
+            bsem_wait(future->sem);
+        }
+    }
+
+    return rvalue;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void future_destroy(Future **future)
+{
+    cassert_no_null(future);
+    cassert_no_null(*future);
+    future_wait(*future);
+    bmutex_lock((*future)->pool->mutex);
+    cassert((*future)->pool->nfutures > 0);
+    (*future)->pool->nfutures -= 1;
+    bmutex_unlock((*future)->pool->mutex);
+    bsem_close(&(*future)->sem);
+    heap_delete(future, Future);
+}
@@ -0,0 +1,49 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: tpool.h
+ *
+ */
+
+/* Thread pool */
+
+#include "core.hxx"
+
+__EXTERN_C
+
+_core_api ThreadPool *tpool_create(const uint32_t nworkers);
+
+_core_api void tpool_destroy(ThreadPool **pool);
+
+_core_api ThreadPool *tpool_global(void);
+
+_core_api uint32_t tpool_nworkers(const ThreadPool *pool);
+
+_core_api Future *tpool_submit_imp(ThreadPool *pool, void *data, FPtr_task func_task);
+
+_core_api void tpool_run_imp(ThreadPool *pool, void *data, FPtr_task func_task);
+
+_core_api void tpool_wait(ThreadPool *pool);
+
+_core_api bool_t future_ready(const Future *future, uint32_t *rvalue);
+
+_core_api uint32_t future_wait(Future *future);
+
+_core_api void future_destroy(Future **future);
+
+__END_C
+
+#define tpool_submit(pool, data, func_task, type) \
+    ( \
+        (void)(cast(data, type) == data), \
+        FUNC_CHECK_TASK(func_task, type), \
+        tpool_submit_imp(pool, cast(data, void), (FPtr_task)func_task))
+
+#define tpool_run(pool, data, func_task, type) \
+    ( \
+        (void)(cast(data, type) == data), \
+        FUNC_CHECK_TASK(func_task, type), \
+        tpool_run_imp(pool, cast(data, void), (FPtr_task)func_task))
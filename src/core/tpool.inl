@@ -0,0 +1,21 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: tpool.inl
+ *
+ */
+
+/* Thread pool */
+
+#include "core.hxx"
+
+__EXTERN_C
+
+void _tpool_start(void);
+
+void _tpool_finish(void);
+
+__END_C
@@ -223,16 +223,22 @@ static codec_t i_codec(const byte_t first)
 
 /*---------------------------------------------------------------------------*/
 
+/*
+ * Image is decoded straight from the file mapping, without a copy.
+ * The file must not be truncated while decoding (SIGBUS, see 'hfile_mmap').
+ */
 Image *image_from_file(const char_t *pathname, ferror_t *error)
 {
     Image *img = NULL;
-    Buffer *buffer = hfile_buffer(pathname, error);
-    if (buffer != NULL)
+    uint64_t size = 0;
+    const byte_t *data = hfile_mmap(pathname, &size, error);
+    if (data != NULL)
     {
-        const byte_t *data = buffer_data(buffer);
-        uint32_t size = buffer_size(buffer);
-        img = image_from_data(data, size);
-        buffer_destroy(&buffer);
+        if (size < 0xFFFFFFFF)
+            img = image_from_data(data, (uint32_t)size);
+        else
+            ptr_assign(error, ekFBIG);
+        hfile_munmap(&data, size);
     }
     return img;
 }
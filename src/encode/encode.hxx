@@ -17,9 +17,27 @@
 #include <core/core.hxx>
 #include "encode.hdf"
 
+typedef enum _jsonev_t
+{
+    ekJSON_BEGIN_OBJECT = 1,
+    ekJSON_END_OBJECT,
+    ekJSON_BEGIN_ARRAY,
+    ekJSON_END_ARRAY,
+    ekJSON_KEY,
+    ekJSON_STRING,
+    ekJSON_NUMBER,
+    ekJSON_BOOL,
+    ekJSON_NULL,
+    ekJSON_VALUE,
+    ekJSON_EOF,
+    ekJSON_ERROR
+} jsonev_t;
+
 typedef struct _url_t Url;
 typedef struct _json_t Json;
 typedef struct _jsonopts_t JsonOpts;
+typedef struct _jsonreader_t JsonReader;
+typedef struct _jsonwriter_t JsonWriter;
 
 struct _jsonopts_t
 {
@@ -12,10 +12,14 @@
 
 #include "json.h"
 #include "base64.h"
+#include <core/arena.h>
 #include <core/arrpt.h>
+#include <core/arrst.h>
+#include <core/dbind.h>
 #include <core/dbindh.h>
 #include <core/heap.h>
 #include <core/stream.h>
+#include <core/streamh.h>
 #include <core/strings.h>
 #include <sewer/bmath.h>
 #include <sewer/bmem.h>
@@ -24,6 +28,23 @@
 #include <sewer/ptr.h>
 #include <sewer/unicode.h>
 
+/* Vector width (bytes) of the Json scanner. Scalar if undefined */
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define JSON_SIMD 32
+#define JSON_SIMD_MASK 0xFFFFFFFF
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_SIMD 16
+#define JSON_SIMD_MASK 0xFFFF
+#endif
+
+#if defined(JSON_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define JSON_LEXEME 256
+
 typedef enum _jtoken_t
 {
     i_ekTRUE,
@@ -37,14 +58,32 @@ typedef enum _jtoken_t
     i_ekCLOSE_OBJECT,
     i_ekCOMMA,
     i_ekCOLON,
+    i_ekEOF,
     i_ekUNKNOWN
 } jtoken_t;
 
 typedef struct i_parser_t i_Parser;
 
+/*
+ * UTF-8 streams are scanned directly over the stream read cache ('data').
+ * Otherwise, the generic stream lexer is used ('scan' = FALSE).
+ * 'pending' = TRUE, the current token will be returned again by 'i_new_token'.
+ * 'corrupt' = TRUE, malformed text (encoding, strings or numbers). Whole parsing fails.
+ */
 struct i_parser_t
 {
     Stream *stm;
+    bool_t scan;
+    bool_t pending;
+    bool_t corrupt;
+    const byte_t *data;
+    uint32_t pos;
+    uint32_t size;
+    uint64_t offset;
+    uint64_t line;
+    uint32_t nrow;
+    char_t *buffer;
+    uint32_t bsize;
     jtoken_t token;
     bool_t minus;
     uint32_t col;
@@ -59,8 +98,8 @@ struct i_parser_t
 
 static byte_t *i_create_type(i_Parser *parser, const DBind *bind, const DBind *ebind);
 static bool_t i_jump_json_value(i_Parser *parser);
-static bool_t i_parse_json_value(i_Parser *parser, const DBind *bind, const DBind *ebind, const bool_t is_str_dptr, byte_t *data, bool_t *null_readed);
-static bool_t i_parse_json_object(i_Parser *parser, const DBind *stbind, byte_t *obj);
+static bool_t i_parse_json_value(i_Parser *parser, const DBind *bind, const DBind *ebind, const bool_t is_str_dptr, const bool_t lazy, byte_t *data, bool_t *null_readed);
+static bool_t i_parse_json_object(i_Parser *parser, const DBind *stbind, const bool_t lazy, byte_t *obj);
 static void i_write_json_value(Stream *stm, const DBind *bind, const DBind *ebind, const byte_t *data);
 
 /*---------------------------------------------------------------------------*/
@@ -69,7 +108,8 @@ static bool_t i_error(const bool_t cond, const bool_t fatal, i_Parser *parser, c
 {
     cassert_no_null(parser);
 
-    if (cond == FALSE && parser->log != NULL)
+    /* After a corruption error, the rest are consequences of it */
+    if (cond == FALSE && parser->log != NULL && parser->corrupt == FALSE)
     {
         String *msg = NULL;
 
@@ -89,7 +129,17 @@ static bool_t i_error(const bool_t cond, const bool_t fatal, i_Parser *parser, c
 
 /*---------------------------------------------------------------------------*/
 
-static void i_new_token(i_Parser *parser)
+static void i_corrupt(i_Parser *parser, const char_t *errmsg)
+{
+    cassert_no_null(parser);
+    i_error(FALSE, TRUE, parser, errmsg);
+    parser->corrupt = TRUE;
+    parser->token = i_ekUNKNOWN;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_lex_token(i_Parser *parser)
 {
     ltoken_t token;
     cassert_no_null(parser);
@@ -160,7 +210,7 @@ static void i_new_token(i_Parser *parser)
     case ekTMINUS:
         cassert(parser->minus == FALSE);
         parser->minus = TRUE;
-        i_new_token(parser);
+        i_lex_token(parser);
         break;
 
     case ekTSLCOM:
@@ -191,10 +241,16 @@ static void i_new_token(i_Parser *parser)
     case ekTBSLASH:
     case ekTAT:
     case ekTOCTAL:
-    case ekTHEX:
-    case ekTUNDEF:
     case ekTCORRUP:
+        i_corrupt(parser, "Corrupt Json text");
+        break;
+
     case ekTEOF:
+        parser->token = i_ekEOF;
+        break;
+
+    case ekTHEX:
+    case ekTUNDEF:
     case ekTRESERVED:
     default:
         parser->token = i_ekUNKNOWN;
@@ -204,6 +260,698 @@ static void i_new_token(i_Parser *parser)
 
 /*---------------------------------------------------------------------------*/
 
+#if defined(JSON_SIMD)
+
+#if JSON_SIMD == 32
+typedef __m256i i_Vec;
+#else
+typedef __m128i i_Vec;
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE i_Vec i_vset(const char_t c)
+{
+#if JSON_SIMD == 32
+    return _mm256_set1_epi8(c);
+#else
+    return _mm_set1_epi8(c);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE i_Vec i_vload(const byte_t *data)
+{
+#if JSON_SIMD == 32
+    return _mm256_loadu_si256(cast_const(data, __m256i));
+#else
+    return _mm_loadu_si128(cast_const(data, __m128i));
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Bit 'i' is set if byte 'i' of 'v' is equal to 'c' */
+static ___INLINE uint32_t i_veq(const i_Vec v, const i_Vec c)
+{
+#if JSON_SIMD == 32
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, c));
+#else
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, c));
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Bit 'i' is set if byte 'i' of 'v' is not ASCII */
+static ___INLINE uint32_t i_vhigh(const i_Vec v)
+{
+#if JSON_SIMD == 32
+    return (uint32_t)_mm256_movemask_epi8(v);
+#else
+    return (uint32_t)_mm_movemask_epi8(v);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Bit 'i' is set if byte 'i' of 'v' is a control char (< 0x20) */
+static ___INLINE uint32_t i_vctrl(const i_Vec v)
+{
+#if JSON_SIMD == 32
+    const __m256i max = _mm256_set1_epi8(0x1F);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v, max), v));
+#else
+    const __m128i max = _mm_set1_epi8(0x1F);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, max), v));
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint32_t i_ctz(const uint32_t mask)
+{
+    cassert(mask != 0);
+#if defined(_MSC_VER)
+    {
+        unsigned long i;
+        _BitScanForward(&i, mask);
+        return (uint32_t)i;
+    }
+#else
+    return (uint32_t)__builtin_ctz(mask);
+#endif
+}
+
+#endif
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE bool_t i_is_space(const byte_t c)
+{
+    return (bool_t)(c == ' ' || c == '\n' || c == '\r' || c == '\t');
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE bool_t i_is_number(const byte_t c)
+{
+    return (bool_t)((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '-' || c == '+');
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE bool_t i_is_word(const byte_t c)
+{
+    return (bool_t)((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_');
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Consume the current chunk and get the next one from the stream cache */
+static bool_t i_next_chunk(i_Parser *parser)
+{
+    cassert_no_null(parser);
+    cassert(parser->pos == parser->size);
+    stm_skip(parser->stm, parser->size);
+    parser->offset += parser->size;
+    parser->pos = 0;
+    parser->data = stm_peek(parser->stm, &parser->size);
+    return (bool_t)(parser->size > 0);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint32_t i_peek_byte(i_Parser *parser)
+{
+    if (parser->pos == parser->size && i_next_chunk(parser) == FALSE)
+        return UINT32_MAX;
+    return (uint32_t)parser->data[parser->pos];
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_newline(i_Parser *parser, const uint32_t pos)
+{
+    parser->nrow += 1;
+    parser->line = parser->offset + pos + 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* First non-space position in current chunk, from 'pos' */
+static uint32_t i_skip_spaces(i_Parser *parser, uint32_t pos)
+{
+    const byte_t *data = parser->data;
+    const uint32_t size = parser->size;
+#if defined(JSON_SIMD)
+    const i_Vec space = i_vset(' ');
+    const i_Vec eol = i_vset('\n');
+    const i_Vec cr = i_vset('\r');
+    const i_Vec tab = i_vset('\t');
+    while (pos + JSON_SIMD <= size)
+    {
+        i_Vec v = i_vload(data + pos);
+        uint32_t neol = i_veq(v, eol);
+        uint32_t stop = ~(neol | i_veq(v, space) | i_veq(v, cr) | i_veq(v, tab)) & JSON_SIMD_MASK;
+        if (stop != 0)
+            neol &= (1u << i_ctz(stop)) - 1;
+
+        while (neol != 0)
+        {
+            i_newline(parser, pos + i_ctz(neol));
+            neol &= neol - 1;
+        }
+
+        if (stop != 0)
+            return pos + i_ctz(stop);
+
+        pos += JSON_SIMD;
+    }
+#endif
+
+    while (pos < size && i_is_space(data[pos]) == TRUE)
+    {
+        if (data[pos] == '\n')
+            i_newline(parser, pos);
+        pos += 1;
+    }
+
+    return pos;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* First '"', '\\' or control char in current chunk, from 'pos' */
+static uint32_t i_string_end(const byte_t *data, uint32_t pos, const uint32_t size, uint32_t *high)
+{
+#if defined(JSON_SIMD)
+    const i_Vec quote = i_vset('\"');
+    const i_Vec bslash = i_vset('\\');
+    while (pos + JSON_SIMD <= size)
+    {
+        i_Vec v = i_vload(data + pos);
+        uint32_t mask = i_veq(v, quote) | i_veq(v, bslash) | i_vctrl(v);
+        if (mask != 0)
+        {
+            uint32_t n = i_ctz(mask);
+            *high |= i_vhigh(v) & ((1u << n) - 1);
+            return pos + n;
+        }
+
+        *high |= i_vhigh(v);
+        pos += JSON_SIMD;
+    }
+#endif
+
+    while (pos < size && data[pos] != '\"' && data[pos] != '\\' && data[pos] >= 0x20)
+    {
+        *high |= (uint32_t)(data[pos] & 0x80);
+        pos += 1;
+    }
+
+    return pos;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_lexeme_space(i_Parser *parser, const uint32_t size)
+{
+    cassert_no_null(parser);
+    if (size > parser->bsize)
+    {
+        uint32_t nsize = parser->bsize * 2;
+        while (nsize < size)
+            nsize *= 2;
+        parser->buffer = cast(heap_realloc(cast(parser->buffer, byte_t), parser->bsize, nsize, "JsonLexeme"), char_t);
+        parser->bsize = nsize;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_lexeme_append(i_Parser *parser, uint32_t *n, const byte_t *data, const uint32_t size)
+{
+    cassert_no_null(n);
+    /* Always room for an UTF-8 char and the null terminator */
+    i_lexeme_space(parser, *n + size + 5);
+    if (size > 0)
+    {
+        bmem_copy(cast(parser->buffer + *n, byte_t), data, size);
+        *n += size;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_scan_hex4(i_Parser *parser)
+{
+    uint32_t i, code = 0;
+    for (i = 0; i < 4; ++i)
+    {
+        uint32_t c = i_peek_byte(parser);
+        if (c >= '0' && c <= '9')
+            code = (code << 4) | (c - '0');
+        else if (c >= 'a' && c <= 'f')
+            code = (code << 4) | (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F')
+            code = (code << 4) | (c - 'A' + 10);
+        else
+            return UINT32_MAX;
+        parser->pos += 1;
+    }
+
+    return code;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* FALSE if invalid '\\u' sequence or '\\u0000' */
+static bool_t i_scan_escape(i_Parser *parser, uint32_t *n)
+{
+    uint32_t code = i_peek_byte(parser);
+    if (code == UINT32_MAX)
+        return TRUE;
+
+    parser->pos += 1;
+    switch (code)
+    {
+    case 'b':
+        code = 0x08;
+        break;
+    case 'f':
+        code = 0x0C;
+        break;
+    case 'n':
+        code = 0x0A;
+        break;
+    case 'r':
+        code = 0x0D;
+        break;
+    case 't':
+        code = 0x09;
+        break;
+    case 'u':
+        code = i_scan_hex4(parser);
+        if (code == UINT32_MAX || code == 0)
+            return FALSE;
+
+        /* UTF-16 surrogate pair */
+        if (code >= 0xD800 && code <= 0xDBFF && i_peek_byte(parser) == '\\')
+        {
+            parser->pos += 1;
+            if (i_peek_byte(parser) == 'u')
+            {
+                uint32_t low = 0;
+                parser->pos += 1;
+                low = i_scan_hex4(parser);
+                if (low == UINT32_MAX || low == 0)
+                    return FALSE;
+
+                /* Unpaired high surrogate is ignored */
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                else
+                    code = low;
+            }
+            else
+            {
+                /* Unpaired surrogate followed by other escape sequence */
+                return i_scan_escape(parser, n);
+            }
+        }
+        break;
+    default:
+        /* '\"', '\\', '/' and unknown sequences are the char itself */
+        break;
+    }
+
+    if (unicode_valid(code) == TRUE && (code < 0xD800 || code > 0xDFFF))
+    {
+        i_lexeme_space(parser, *n + 5);
+        *n += unicode_to_char(code, parser->buffer + *n, ekUTF8);
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Well-formed UTF-8: no overlong forms, surrogates or codepoints beyond U+10FFFF */
+static bool_t i_valid_utf8(const char_t *str, const uint32_t size)
+{
+    uint32_t i = 0;
+    while (i < size)
+    {
+        byte_t c = (byte_t)str[i];
+        byte_t min = 0x80, max = 0xBF;
+        uint32_t j, n = 0;
+        if (c < 0x80)
+            n = 0;
+        else if (c >= 0xC2 && c <= 0xDF)
+            n = 1;
+        else if (c >= 0xE0 && c <= 0xEF)
+            n = 2;
+        else if (c >= 0xF0 && c <= 0xF4)
+            n = 3;
+        else
+            return FALSE;
+
+        if (c == 0xE0)
+            min = 0xA0;
+        else if (c == 0xED)
+            max = 0x9F;
+        else if (c == 0xF0)
+            min = 0x90;
+        else if (c == 0xF4)
+            max = 0x8F;
+
+        if (i + n >= size)
+            return FALSE;
+
+        for (j = 1; j <= n; ++j)
+        {
+            byte_t cc = (byte_t)str[i + j];
+            if (cc < min || cc > max)
+                return FALSE;
+            min = 0x80;
+            max = 0xBF;
+        }
+
+        i += n + 1;
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_scan_string(i_Parser *parser)
+{
+    uint32_t n = 0;
+    uint32_t high = 0;
+    const char_t *errmsg = NULL;
+    cassert_no_null(parser);
+    cassert(parser->data[parser->pos] == '\"');
+    parser->pos += 1;
+    parser->token = i_ekUNKNOWN;
+    for (;;)
+    {
+        uint32_t end = 0;
+        if (parser->pos == parser->size && i_next_chunk(parser) == FALSE)
+            break;
+
+        end = i_string_end(parser->data, parser->pos, parser->size, &high);
+        i_lexeme_append(parser, &n, parser->data + parser->pos, end - parser->pos);
+        parser->pos = end;
+        if (end < parser->size)
+        {
+            if (parser->data[end] < 0x20)
+            {
+                errmsg = "Control char in Json string";
+                break;
+            }
+
+            parser->pos += 1;
+            if (parser->data[end] == '\"')
+            {
+                parser->token = i_ekSTRING;
+                break;
+            }
+
+            if (i_scan_escape(parser, &n) == FALSE)
+            {
+                errmsg = "Invalid Json escape sequence";
+                break;
+            }
+        }
+    }
+
+    parser->buffer[n] = '\0';
+    parser->lexeme = parser->buffer;
+    parser->lexsize = n;
+
+    /* Escaped chars are always valid, only raw bytes are checked */
+    if (errmsg == NULL && high != 0 && i_valid_utf8(parser->buffer, n) == FALSE)
+        errmsg = "Invalid UTF-8 Json string";
+
+    if (errmsg != NULL)
+        i_corrupt(parser, errmsg);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Json numbers -?D+(.D+)?([eE][+-]?D+)? also accepting "01", "1." and ".5", as the stream lexer does */
+static bool_t i_valid_number(const char_t *number)
+{
+    uint32_t n = 0;
+    cassert_no_null(number);
+    if (*number == '-')
+        number += 1;
+
+    while (*number >= '0' && *number <= '9')
+    {
+        number += 1;
+        n += 1;
+    }
+
+    if (*number == '.')
+    {
+        number += 1;
+        while (*number >= '0' && *number <= '9')
+        {
+            number += 1;
+            n += 1;
+        }
+    }
+
+    if (n == 0)
+        return FALSE;
+
+    if (*number == 'e' || *number == 'E')
+    {
+        number += 1;
+        if (*number == '+' || *number == '-')
+            number += 1;
+
+        if (*number < '0' || *number > '9')
+            return FALSE;
+
+        while (*number >= '0' && *number <= '9')
+            number += 1;
+    }
+
+    return (bool_t)(*number == '\0');
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_scan_number(i_Parser *parser)
+{
+    uint32_t n = 0;
+    bool_t overflow = FALSE;
+    cassert_no_null(parser);
+    for (;;)
+    {
+        uint32_t pos = parser->pos;
+        while (pos < parser->size && i_is_number(parser->data[pos]) == TRUE)
+            pos += 1;
+
+        if (n + pos - parser->pos >= sizeof32(parser->number))
+        {
+            overflow = TRUE;
+        }
+        else if (pos > parser->pos)
+        {
+            bmem_copy(cast(parser->number + n, byte_t), parser->data + parser->pos, pos - parser->pos);
+            n += pos - parser->pos;
+        }
+
+        parser->pos = pos;
+        if (pos < parser->size || i_next_chunk(parser) == FALSE)
+            break;
+    }
+
+    parser->number[n] = '\0';
+    parser->lexeme = parser->number;
+    parser->lexsize = n;
+    parser->token = overflow == TRUE ? i_ekUNKNOWN : i_ekNUMBER;
+    if (parser->token == i_ekNUMBER && i_valid_number(parser->number) == FALSE)
+        i_corrupt(parser, "Invalid Json number");
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_scan_word(i_Parser *parser)
+{
+    uint32_t n = 0;
+    cassert_no_null(parser);
+    for (;;)
+    {
+        uint32_t pos = parser->pos;
+        while (pos < parser->size && i_is_word(parser->data[pos]) == TRUE)
+            pos += 1;
+
+        i_lexeme_append(parser, &n, parser->data + parser->pos, pos - parser->pos);
+        parser->pos = pos;
+        if (pos < parser->size || i_next_chunk(parser) == FALSE)
+            break;
+    }
+
+    /* Invalid char */
+    if (n == 0 && parser->pos < parser->size)
+    {
+        i_lexeme_append(parser, &n, parser->data + parser->pos, 1);
+        parser->pos += 1;
+    }
+
+    parser->buffer[n] = '\0';
+    parser->lexeme = parser->buffer;
+    parser->lexsize = n;
+
+    if (str_equ_c(parser->lexeme, "true") == TRUE)
+        parser->token = i_ekTRUE;
+    else if (str_equ_c(parser->lexeme, "false") == TRUE)
+        parser->token = i_ekFALSE;
+    else if (str_equ_c(parser->lexeme, "null") == TRUE)
+        parser->token = i_ekNULL;
+    else
+        parser->token = i_ekUNKNOWN;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_scan_token(i_Parser *parser)
+{
+    byte_t c = 0;
+    cassert_no_null(parser);
+    for (;;)
+    {
+        if (parser->pos < parser->size)
+        {
+            if (parser->data[parser->pos] > ' ')
+                break;
+
+            parser->pos = i_skip_spaces(parser, parser->pos);
+            if (parser->pos < parser->size)
+                break;
+        }
+
+        if (i_next_chunk(parser) == FALSE)
+        {
+            parser->token = i_ekEOF;
+            parser->lexeme = NULL;
+            parser->lexsize = 0;
+            return;
+        }
+    }
+
+    parser->row = parser->nrow;
+    parser->col = (uint32_t)(parser->offset + parser->pos - parser->line) + 1;
+    c = parser->data[parser->pos];
+    switch (c)
+    {
+    case '\"':
+        i_scan_string(parser);
+        return;
+
+    case '-':
+    case '.':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9':
+        i_scan_number(parser);
+        return;
+
+    case '{':
+        parser->token = i_ekOPEN_OBJECT;
+        break;
+
+    case '}':
+        parser->token = i_ekCLOSE_OBJECT;
+        break;
+
+    case '[':
+        parser->token = i_ekOPEN_ARRAY;
+        break;
+
+    case ']':
+        parser->token = i_ekCLOSE_ARRAY;
+        break;
+
+    case ',':
+        parser->token = i_ekCOMMA;
+        break;
+
+    case ':':
+        parser->token = i_ekCOLON;
+        break;
+
+    default:
+        i_scan_word(parser);
+        return;
+    }
+
+    parser->buffer[0] = (char_t)c;
+    parser->buffer[1] = '\0';
+    parser->lexeme = parser->buffer;
+    parser->lexsize = 1;
+    parser->pos += 1;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE void i_new_token(i_Parser *parser)
+{
+    cassert_no_null(parser);
+    if (parser->pending == TRUE)
+        parser->pending = FALSE;
+    else if (parser->corrupt == TRUE)
+        parser->token = i_ekUNKNOWN;
+    else if (parser->scan == TRUE)
+        i_scan_token(parser);
+    else
+        i_lex_token(parser);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static real64_t i_number(const char_t *number, bool_t *err)
+{
+    /* Integers up to 15 digits are exact in real64_t, avoiding 'strtod' */
+    const char_t *str = number;
+    uint64_t value = 0;
+    uint32_t n = 0;
+    cassert_no_null(number);
+    cassert_no_null(err);
+    if (*str == '-')
+        str += 1;
+
+    while (str[n] >= '0' && str[n] <= '9' && n < 16)
+    {
+        value = value * 10 + (uint64_t)(str[n] - '0');
+        n += 1;
+    }
+
+    if (str[n] == '\0' && n > 0 && n < 16)
+    {
+        *err = FALSE;
+        return str == number ? (real64_t)value : -(real64_t)value;
+    }
+
+    return str_to_r64(number, err);
+}
+
+/*---------------------------------------------------------------------------*/
+
 static bool_t i_jump_json_array(i_Parser *parser)
 {
     bool_t ok = i_jump_json_value(parser);
@@ -303,6 +1051,8 @@ static bool_t i_jump_json_value(i_Parser *parser)
         return i_error(FALSE, TRUE, parser, "Unexpected Json token ','");
     case i_ekCOLON:
         return i_error(FALSE, TRUE, parser, "Unexpected Json token ':'");
+    case i_ekEOF:
+        return i_error(FALSE, TRUE, parser, "Unexpected end of Json data");
     case i_ekUNKNOWN:
         return i_error(FALSE, TRUE, parser, "Unknown Json token");
     default:
@@ -315,13 +1065,25 @@ static bool_t i_jump_json_value(i_Parser *parser)
 
 /*---------------------------------------------------------------------------*/
 
+static void i_init_elem(const DBind *ebind, const bool_t lazy, byte_t *data)
+{
+    if (lazy == TRUE)
+        dbind_init_data_lazy(ebind, data);
+    else
+        dbind_init_data(ebind, data);
+}
+
+/*---------------------------------------------------------------------------*/
+
 static bool_t i_parse_json_array(i_Parser *parser, const DBind *bind, const DBind *ebind, byte_t *cont)
 {
     bool_t ok = FALSE;
     byte_t *data = dbind_container_append(bind, ebind, cont);
+    /* Struct elements are created without default strings, only missing members will get them */
+    bool_t lazy = (bool_t)(dbind_type(ebind) == ekDTYPE_STRUCT && dbind_st_count(ebind) <= 64);
 
-    dbind_init_data(ebind, data);
-    ok = i_parse_json_value(parser, ebind, NULL, FALSE, data, NULL);
+    i_init_elem(ebind, lazy, data);
+    ok = i_parse_json_value(parser, ebind, NULL, FALSE, lazy, data, NULL);
 
     if (ok == FALSE)
     {
@@ -353,8 +1115,8 @@ static bool_t i_parse_json_array(i_Parser *parser, const DBind *bind, const DBin
             return i_error(FALSE, TRUE, parser, "Comma expected in 'array'");
 
         data = dbind_container_append(bind, ebind, cont);
-        dbind_init_data(ebind, data);
-        ok = i_parse_json_value(parser, ebind, NULL, FALSE, data, NULL);
+        i_init_elem(ebind, lazy, data);
+        ok = i_parse_json_value(parser, ebind, NULL, FALSE, lazy, data, NULL);
         if (ok == FALSE)
             dbind_set_value_null(ebind, NULL, FALSE, data);
     }
@@ -393,7 +1155,7 @@ static bool_t i_parse_json_arrpt(i_Parser *parser, const DBind *bind, const DBin
 
 /*---------------------------------------------------------------------------*/
 
-static bool_t i_parse_json_value(i_Parser *parser, const DBind *bind, const DBind *ebind, const bool_t is_str_dptr, byte_t *data, bool_t *null_readed)
+static bool_t i_parse_json_value(i_Parser *parser, const DBind *bind, const DBind *ebind, const bool_t is_str_dptr, const bool_t lazy, byte_t *data, bool_t *null_readed)
 {
     dtype_t type = dbind_type(bind);
     bindset_t rset = ekBINDSET_NOT_ALLOWED;
@@ -417,7 +1179,17 @@ static bool_t i_parse_json_value(i_Parser *parser, const DBind *bind, const DBin
     case i_ekNUMBER:
     {
         bool_t err;
-        real64_t value = str_to_r64(parser->number, &err);
+        real64_t value = i_number(parser->number, &err);
+        if (err == FALSE && type == ekDTYPE_INT)
+        {
+            /* The integer doesn't fit in the binded type */
+            int64_t min, max;
+            real64_t ivalue = bmath_roundd(value);
+            dbind_int_range(bind, &min, &max);
+            if (ivalue < (real64_t)min || ivalue >= (real64_t)max + 1.)
+                return i_error(FALSE, TRUE, parser, "JSON 'number' out of range");
+        }
+
         if (err == FALSE)
         {
             rset = dbind_set_value_real(bind, data, value);
@@ -468,11 +1240,11 @@ static bool_t i_parse_json_value(i_Parser *parser, const DBind *bind, const DBin
             {
                 if (*dcast(data, byte_t) == NULL)
                     *dcast(data, byte_t) = dbind_create_data(bind, ebind);
-                return i_parse_json_object(parser, bind, *dcast(data, byte_t));
+                return i_parse_json_object(parser, bind, FALSE, *dcast(data, byte_t));
             }
             else
             {
-                return i_parse_json_object(parser, bind, data);
+                return i_parse_json_object(parser, bind, lazy, data);
             }
         }
         else
@@ -494,6 +1266,9 @@ static bool_t i_parse_json_value(i_Parser *parser, const DBind *bind, const DBin
     case i_ekCOLON:
         return i_error(FALSE, TRUE, parser, "Unexpected Json token ':'");
 
+    case i_ekEOF:
+        return i_error(FALSE, TRUE, parser, "Unexpected end of Json data");
+
     case i_ekUNKNOWN:
         return i_error(FALSE, TRUE, parser, "Unknown Json token");
 
@@ -506,9 +1281,13 @@ static bool_t i_parse_json_value(i_Parser *parser, const DBind *bind, const DBin
 
 /*---------------------------------------------------------------------------*/
 
-static bool_t i_parse_json_object(i_Parser *parser, const DBind *stbind, byte_t *obj)
+static bool_t i_parse_json_object(i_Parser *parser, const DBind *stbind, const bool_t lazy, byte_t *obj)
 {
     bool_t comma_state = FALSE;
+    /* Members usually come in declaration order, so we first try the next one */
+    uint32_t next_id = 0;
+    /* Readed members, in 'lazy' objects (up to 64 members) */
+    uint64_t readed = 0;
     /* For all object members */
     for (;;)
     {
@@ -520,9 +1299,15 @@ static bool_t i_parse_json_object(i_Parser *parser, const DBind *stbind, byte_t
         if (parser->token == i_ekCLOSE_OBJECT)
         {
             if (comma_state == FALSE)
+            {
+                if (lazy == TRUE)
+                    dbind_st_init_lazy(stbind, obj, readed);
                 return TRUE;
+            }
             else
+            {
                 return i_error(FALSE, TRUE, parser, "Unexpected Json '}' (member opened)");
+            }
         }
 
         /* ',' */
@@ -543,7 +1328,9 @@ static bool_t i_parse_json_object(i_Parser *parser, const DBind *stbind, byte_t
         if (parser->token != i_ekSTRING)
             return i_error(FALSE, TRUE, parser, "Expected Json 'string' (member name)");
 
-        member_id = dbind_st_member_id(stbind, parser->lexeme);
+        member_id = dbind_st_member_id_hint(stbind, parser->lexeme, next_id);
+        if (member_id != UINT32_MAX)
+            next_id = member_id + 1;
 
         /* ":" */
         i_new_token(parser);
@@ -553,12 +1340,14 @@ static bool_t i_parse_json_object(i_Parser *parser, const DBind *stbind, byte_t
         /* "member_value" */
         if (member_id != UINT32_MAX)
         {
-            const DBind *bind = dbind_st_member(stbind, member_id);
-            const DBind *ebind = dbind_st_ebind(stbind, member_id);
-            bool_t is_str_dptr = dbind_st_is_str_dptr(stbind, member_id);
-            byte_t *data = obj + dbind_st_offset(stbind, member_id);
+            const DBind *ebind = NULL;
+            bool_t is_str_dptr = FALSE;
+            uint16_t offset = 0;
+            const DBind *bind = dbind_st_member_info(stbind, member_id, &ebind, &is_str_dptr, &offset);
             bool_t null_readed = FALSE;
-            if (i_parse_json_value(parser, bind, ebind, is_str_dptr, data, &null_readed) == FALSE)
+            if (lazy == TRUE)
+                readed |= (uint64_t)1 << member_id;
+            if (i_parse_json_value(parser, bind, ebind, is_str_dptr, FALSE, obj + offset, &null_readed) == FALSE)
                 dbind_st_set_value_null(stbind, member_id, obj);
             else if (null_readed == TRUE)
                 dbind_st_set_value_null(stbind, member_id, obj);
@@ -616,55 +1405,97 @@ static byte_t *i_create_type(i_Parser *parser, const DBind *bind, const DBind *e
     if (cdata != NULL)
     {
         bool_t null_readed = FALSE;
-        if (i_parse_json_value(parser, bind, ebind, FALSE, cdata, &null_readed) == FALSE)
+        if (i_parse_json_value(parser, bind, ebind, FALSE, FALSE, cdata, &null_readed) == FALSE)
         {
             if (data != NULL)
                 dbind_destroy_data(&data, bind, ebind);
         }
-        else if (null_readed == TRUE)
+        else if (null_readed == TRUE || parser->corrupt == TRUE)
         {
+            /* Partial objects from corrupt Json are not returned */
             if (data != NULL)
                 dbind_destroy_data(&data, bind, ebind);
         }
     }
     else
     {
-        cassert(data == NULL);
+        cassert(data == NULL);
+    }
+
+    return data;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_bind_from_typename(const char_t *type, const DBind **bind, const DBind **ebind)
+{
+    cassert_no_null(bind);
+    *bind = dbind_handle_bind(dbind_handle_imp(type), type, ebind);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_parser_init(i_Parser *parser, Stream *stm, const JsonOpts *opts)
+{
+    cassert_no_null(parser);
+    bmem_zero(parser, i_Parser);
+    parser->stm = stm;
+    stm_token_escapes(parser->stm, TRUE);
+    stm_skip_bom(parser->stm);
+    parser->scan = (bool_t)(stm_get_read_utf(stm) == ekUTF8);
+    parser->nrow = 1;
+    parser->log = opts ? opts->log : NULL;
+
+    if (parser->scan == TRUE)
+    {
+        parser->data = stm_peek(stm, &parser->size);
+        parser->buffer = cast(heap_malloc(JSON_LEXEME, "JsonLexeme"), char_t);
+        parser->bsize = JSON_LEXEME;
     }
+}
 
-    return data;
+/*---------------------------------------------------------------------------*/
+
+static void i_parser_end(i_Parser *parser)
+{
+    cassert_no_null(parser);
+    if (parser->scan == TRUE)
+    {
+        /* Only consume the bytes used by the Json value */
+        stm_skip(parser->stm, parser->pos);
+        heap_free(dcast(&parser->buffer, byte_t), parser->bsize, "JsonLexeme");
+    }
 }
 
 /*---------------------------------------------------------------------------*/
 
-static void i_bind_from_typename(const char_t *type, const DBind **bind, const DBind **ebind)
+static void *i_json_read(Stream *stm, const JsonOpts *opts, const DBind *bind, const DBind *ebind)
 {
-    cassert_no_null(bind);
-    cassert_no_null(ebind);
-    *bind = dbind_from_typename(type, NULL);
-    *ebind = NULL;
-    if (dbind_type(*bind) == ekDTYPE_CONTAINER)
-        *ebind = dbind_container_type(*bind, type);
+    i_Parser parser;
+    void *obj = NULL;
+    i_parser_init(&parser, stm, opts);
+    obj = i_create_type(&parser, bind, ebind);
+    i_parser_end(&parser);
+    return obj;
 }
 
 /*---------------------------------------------------------------------------*/
 
 void *json_read_imp(Stream *stm, const JsonOpts *opts, const char_t *type)
 {
-    i_Parser parser;
     const DBind *bind = NULL;
     const DBind *ebind = NULL;
-    parser.stm = stm;
-    stm_token_escapes(parser.stm, TRUE);
-    stm_skip_bom(parser.stm);
-    parser.col = 0;
-    parser.row = 0;
-    parser.lexeme = NULL;
-    parser.lexsize = 0;
-    parser.minus = FALSE;
-    parser.log = opts ? opts->log : NULL;
     i_bind_from_typename(type, &bind, &ebind);
-    return i_create_type(&parser, bind, ebind);
+    return i_json_read(stm, opts, bind, ebind);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void *json_hread_imp(Stream *stm, const JsonOpts *opts, const DBindType *htype, const char_t *type)
+{
+    const DBind *ebind = NULL;
+    const DBind *bind = dbind_handle_bind(htype, type, &ebind);
+    return i_json_read(stm, opts, bind, ebind);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -688,6 +1519,18 @@ void *json_read_str_imp(const char_t *str, const JsonOpts *opts, const char_t *t
 
 /*---------------------------------------------------------------------------*/
 
+void *json_read_arena_imp(Stream *stm, const JsonOpts *opts, Arena *arena, const char_t *type)
+{
+    /* All the objects will be released in 'arena_reset' or 'arena_destroy' */
+    void *obj = NULL;
+    arena_scope_begin(arena);
+    obj = json_read_imp(stm, opts, type);
+    arena_scope_end(arena);
+    return obj;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static void i_write_escape_str(Stream *stm, const char_t *cstr)
 {
     uint32_t cp = unicode_to_u32(cstr, ekUTF8);
@@ -875,6 +1718,17 @@ void json_write_imp(Stream *stm, const void *data, const JsonOpts *opts, const c
 
 /*---------------------------------------------------------------------------*/
 
+void json_hwrite_imp(Stream *stm, const void *data, const JsonOpts *opts, const DBindType *htype, const char_t *type)
+{
+    const DBind *ebind = NULL;
+    const DBind *bind = dbind_handle_bind(htype, type, &ebind);
+    i_write_json_value(stm, bind, ebind, data);
+    stm_write_char(stm, 0);
+    unref(opts);
+}
+
+/*---------------------------------------------------------------------------*/
+
 String *json_write_str_imp(const void *data, const JsonOpts *opts, const char_t *type)
 {
     Stream *stm = stm_memory(1024);
@@ -903,3 +1757,423 @@ void json_destopt_imp(void **data, const char_t *type)
     if (*data != NULL)
         json_destroy_imp(data, type);
 }
+
+/*---------------------------------------------------------------------------*/
+
+/* Container levels of JsonReader and JsonWriter */
+#define i_LEVEL_ARRAY 1
+#define i_LEVEL_ITEMS 2
+
+struct _jsonreader_t
+{
+    i_Parser parser;
+    ArrSt(uint8_t) *levels;
+    jsonev_t event;
+    bool_t key;
+    bool_t done;
+};
+
+struct _jsonwriter_t
+{
+    Stream *stm;
+    ArrSt(uint8_t) *levels;
+    bool_t key;
+};
+
+/*---------------------------------------------------------------------------*/
+
+JsonReader *json_reader_create(Stream *stm, const JsonOpts *opts)
+{
+    JsonReader *reader = heap_new0(JsonReader);
+    cassert_no_null(stm);
+    i_parser_init(&reader->parser, stm, opts);
+    reader->levels = arrst_create(uint8_t);
+    reader->event = ekJSON_NULL;
+    return reader;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_reader_destroy(JsonReader **reader)
+{
+    cassert_no_null(reader);
+    cassert_no_null(*reader);
+    i_parser_end(&(*reader)->parser);
+    arrst_destroy(&(*reader)->levels, NULL, uint8_t);
+    heap_delete(reader, JsonReader);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_reader_error(JsonReader *reader, const char_t *errmsg)
+{
+    cassert_no_null(reader);
+    i_error(FALSE, TRUE, &reader->parser, errmsg);
+    reader->event = ekJSON_ERROR;
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Moves to the next item of the current container, processing ',' and ':'.
+ * TRUE: 'parser->token' is the first token of a value.
+ * FALSE: 'reader->event' is a key, a container end, the end of data or an error.
+ */
+static bool_t i_reader_advance(JsonReader *reader)
+{
+    i_Parser *parser = NULL;
+    uint8_t *level = NULL;
+    cassert_no_null(reader);
+    parser = &reader->parser;
+
+    if (reader->event == ekJSON_ERROR || reader->event == ekJSON_EOF)
+        return FALSE;
+
+    /* Root value */
+    if (arrst_size(reader->levels, uint8_t) == 0)
+    {
+        if (reader->done == TRUE)
+        {
+            /* Only spaces can follow the root value */
+            i_new_token(parser);
+            if (parser->token != i_ekEOF)
+                return i_reader_error(reader, "Unexpected Json data after the root value");
+            reader->event = ekJSON_EOF;
+            return FALSE;
+        }
+
+        reader->done = TRUE;
+        i_new_token(parser);
+        return TRUE;
+    }
+
+    /* Member value */
+    if (reader->key == TRUE)
+    {
+        reader->key = FALSE;
+        i_new_token(parser);
+        if (parser->token != i_ekCOLON)
+            return i_reader_error(reader, "Expected Json ':' (object member)");
+        i_new_token(parser);
+        return TRUE;
+    }
+
+    level = arrst_last(reader->levels, uint8_t);
+    i_new_token(parser);
+
+    if ((*level & i_LEVEL_ARRAY) != 0 && parser->token == i_ekCLOSE_ARRAY)
+    {
+        arrst_pop(reader->levels, NULL, uint8_t);
+        reader->event = ekJSON_END_ARRAY;
+        return FALSE;
+    }
+
+    if ((*level & i_LEVEL_ARRAY) == 0 && parser->token == i_ekCLOSE_OBJECT)
+    {
+        arrst_pop(reader->levels, NULL, uint8_t);
+        reader->event = ekJSON_END_OBJECT;
+        return FALSE;
+    }
+
+    if ((*level & i_LEVEL_ITEMS) != 0)
+    {
+        if (parser->token != i_ekCOMMA)
+            return i_reader_error(reader, "Unexpected Json token (',' expected)");
+        i_new_token(parser);
+    }
+
+    *level |= i_LEVEL_ITEMS;
+    if ((*level & i_LEVEL_ARRAY) != 0)
+        return TRUE;
+
+    if (parser->token != i_ekSTRING)
+        return i_reader_error(reader, "Expected Json 'string' (member name)");
+
+    reader->key = TRUE;
+    reader->event = ekJSON_KEY;
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+jsonev_t json_reader_next(JsonReader *reader)
+{
+    cassert_no_null(reader);
+    if (i_reader_advance(reader) == TRUE)
+    {
+        switch (reader->parser.token)
+        {
+        case i_ekOPEN_OBJECT:
+            arrst_append(reader->levels, 0, uint8_t);
+            reader->event = ekJSON_BEGIN_OBJECT;
+            break;
+
+        case i_ekOPEN_ARRAY:
+            arrst_append(reader->levels, i_LEVEL_ARRAY, uint8_t);
+            reader->event = ekJSON_BEGIN_ARRAY;
+            break;
+
+        case i_ekSTRING:
+            reader->event = ekJSON_STRING;
+            break;
+
+        case i_ekNUMBER:
+            reader->event = ekJSON_NUMBER;
+            break;
+
+        case i_ekTRUE:
+        case i_ekFALSE:
+            reader->event = ekJSON_BOOL;
+            break;
+
+        case i_ekNULL:
+            reader->event = ekJSON_NULL;
+            break;
+
+        case i_ekCLOSE_ARRAY:
+        case i_ekCLOSE_OBJECT:
+        case i_ekCOMMA:
+        case i_ekCOLON:
+        case i_ekEOF:
+        case i_ekUNKNOWN:
+            i_reader_error(reader, "Unexpected Json token");
+            break;
+
+        default:
+            cassert_default(reader->parser.token);
+        }
+    }
+
+    return reader->event;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void *json_reader_value_imp(JsonReader *reader, const char_t *type)
+{
+    const DBind *bind = NULL;
+    const DBind *ebind = NULL;
+    void *obj = NULL;
+    cassert_no_null(reader);
+    i_bind_from_typename(type, &bind, &ebind);
+    if (i_reader_advance(reader) == TRUE)
+    {
+        reader->parser.pending = TRUE;
+        obj = i_create_type(&reader->parser, bind, ebind);
+        reader->event = ekJSON_VALUE;
+    }
+
+    return obj;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_reader_skip(JsonReader *reader)
+{
+    cassert_no_null(reader);
+    if (i_reader_advance(reader) == TRUE)
+    {
+        reader->parser.pending = TRUE;
+        if (i_jump_json_value(&reader->parser) == TRUE)
+            reader->event = ekJSON_VALUE;
+        else
+            i_reader_error(reader, "Unexpected Json token");
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+jsonev_t json_reader_event(const JsonReader *reader)
+{
+    cassert_no_null(reader);
+    return reader->event;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t json_reader_depth(const JsonReader *reader)
+{
+    cassert_no_null(reader);
+    return arrst_size(reader->levels, uint8_t);
+}
+
+/*---------------------------------------------------------------------------*/
+
+const char_t *json_reader_text(const JsonReader *reader)
+{
+    cassert_no_null(reader);
+    cassert(reader->event == ekJSON_KEY || reader->event == ekJSON_STRING || reader->event == ekJSON_NUMBER);
+    /* In lexer mode, the '-' is a separate token. 'number' keeps the signed text */
+    if (reader->event == ekJSON_NUMBER)
+        return reader->parser.number;
+    return reader->parser.lexeme;
+}
+
+/*---------------------------------------------------------------------------*/
+
+real64_t json_reader_real(const JsonReader *reader)
+{
+    bool_t err = FALSE;
+    cassert_no_null(reader);
+    cassert(reader->event == ekJSON_NUMBER);
+    return i_number(reader->parser.number, &err);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t json_reader_bool(const JsonReader *reader)
+{
+    cassert_no_null(reader);
+    cassert(reader->event == ekJSON_BOOL);
+    return (bool_t)(reader->parser.token == i_ekTRUE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+JsonWriter *json_writer_create(Stream *stm)
+{
+    JsonWriter *writer = heap_new0(JsonWriter);
+    cassert_no_null(stm);
+    writer->stm = stm;
+    writer->levels = arrst_create(uint8_t);
+    return writer;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_destroy(JsonWriter **writer)
+{
+    cassert_no_null(writer);
+    cassert_no_null(*writer);
+    cassert(arrst_size((*writer)->levels, uint8_t) == 0);
+    arrst_destroy(&(*writer)->levels, NULL, uint8_t);
+    heap_delete(writer, JsonWriter);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Separator before a new value */
+static void i_writer_value(JsonWriter *writer)
+{
+    cassert_no_null(writer);
+    if (writer->key == TRUE)
+    {
+        writer->key = FALSE;
+    }
+    else if (arrst_size(writer->levels, uint8_t) > 0)
+    {
+        uint8_t *level = arrst_last(writer->levels, uint8_t);
+        cassert((*level & i_LEVEL_ARRAY) != 0);
+        if ((*level & i_LEVEL_ITEMS) != 0)
+            stm_writef(writer->stm, ", ");
+        *level |= i_LEVEL_ITEMS;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_begin_object(JsonWriter *writer)
+{
+    i_writer_value(writer);
+    arrst_append(writer->levels, 0, uint8_t);
+    stm_writef(writer->stm, "{");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_end_object(JsonWriter *writer)
+{
+    cassert_no_null(writer);
+    cassert(writer->key == FALSE);
+    cassert((*arrst_last(writer->levels, uint8_t) & i_LEVEL_ARRAY) == 0);
+    arrst_pop(writer->levels, NULL, uint8_t);
+    stm_writef(writer->stm, " }");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_begin_array(JsonWriter *writer)
+{
+    i_writer_value(writer);
+    arrst_append(writer->levels, i_LEVEL_ARRAY, uint8_t);
+    stm_writef(writer->stm, "[ ");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_end_array(JsonWriter *writer)
+{
+    cassert_no_null(writer);
+    cassert((*arrst_last(writer->levels, uint8_t) & i_LEVEL_ARRAY) != 0);
+    arrst_pop(writer->levels, NULL, uint8_t);
+    stm_writef(writer->stm, " ]");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_key(JsonWriter *writer, const char_t *key)
+{
+    uint8_t *level = NULL;
+    cassert_no_null(writer);
+    cassert(writer->key == FALSE);
+    level = arrst_last(writer->levels, uint8_t);
+    cassert((*level & i_LEVEL_ARRAY) == 0);
+    if ((*level & i_LEVEL_ITEMS) != 0)
+        stm_writef(writer->stm, ", ");
+    *level |= i_LEVEL_ITEMS;
+    i_write_escape_str(writer->stm, key);
+    stm_writef(writer->stm, " : ");
+    writer->key = TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_str(JsonWriter *writer, const char_t *str)
+{
+    i_writer_value(writer);
+    i_write_escape_str(writer->stm, str);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_int(JsonWriter *writer, const int64_t value)
+{
+    i_writer_value(writer);
+    stm_printf(writer->stm, "%" PRId64, value);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_real(JsonWriter *writer, const real64_t value)
+{
+    i_writer_value(writer);
+    stm_printf(writer->stm, "%g", value);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_bool(JsonWriter *writer, const bool_t value)
+{
+    i_writer_value(writer);
+    stm_writef(writer->stm, value ? "true" : "false");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_null(JsonWriter *writer)
+{
+    i_writer_value(writer);
+    stm_writef(writer->stm, "null");
+}
+
+/*---------------------------------------------------------------------------*/
+
+void json_writer_value_imp(JsonWriter *writer, const void *data, const char_t *type)
+{
+    const DBind *bind = NULL;
+    const DBind *ebind = NULL;
+    i_bind_from_typename(type, &bind, &ebind);
+    i_writer_value(writer);
+    i_write_json_value(writer->stm, bind, ebind, cast_const(data, byte_t));
+}
@@ -19,14 +19,66 @@ _encode_api void *json_read_imp(Stream *stm, const JsonOpts *opts, const char_t
 
 _encode_api void *json_read_str_imp(const char_t *str, const JsonOpts *opts, const char_t *type);
 
+_encode_api void *json_read_arena_imp(Stream *stm, const JsonOpts *opts, Arena *arena, const char_t *type);
+
 _encode_api void json_write_imp(Stream *stm, const void *data, const JsonOpts *opts, const char_t *type);
 
+_encode_api void *json_hread_imp(Stream *stm, const JsonOpts *opts, const DBindType *htype, const char_t *type);
+
+_encode_api void json_hwrite_imp(Stream *stm, const void *data, const JsonOpts *opts, const DBindType *htype, const char_t *type);
+
 _encode_api String *json_write_str_imp(const void *data, const JsonOpts *opts, const char_t *type);
 
 _encode_api void json_destroy_imp(void **data, const char_t *type);
 
 _encode_api void json_destopt_imp(void **data, const char_t *type);
 
+_encode_api JsonReader *json_reader_create(Stream *stm, const JsonOpts *opts);
+
+_encode_api void json_reader_destroy(JsonReader **reader);
+
+_encode_api jsonev_t json_reader_next(JsonReader *reader);
+
+_encode_api void *json_reader_value_imp(JsonReader *reader, const char_t *type);
+
+_encode_api void json_reader_skip(JsonReader *reader);
+
+_encode_api jsonev_t json_reader_event(const JsonReader *reader);
+
+_encode_api uint32_t json_reader_depth(const JsonReader *reader);
+
+_encode_api const char_t *json_reader_text(const JsonReader *reader);
+
+_encode_api real64_t json_reader_real(const JsonReader *reader);
+
+_encode_api bool_t json_reader_bool(const JsonReader *reader);
+
+_encode_api JsonWriter *json_writer_create(Stream *stm);
+
+_encode_api void json_writer_destroy(JsonWriter **writer);
+
+_encode_api void json_writer_begin_object(JsonWriter *writer);
+
+_encode_api void json_writer_end_object(JsonWriter *writer);
+
+_encode_api void json_writer_begin_array(JsonWriter *writer);
+
+_encode_api void json_writer_end_array(JsonWriter *writer);
+
+_encode_api void json_writer_key(JsonWriter *writer, const char_t *key);
+
+_encode_api void json_writer_str(JsonWriter *writer, const char_t *str);
+
+_encode_api void json_writer_int(JsonWriter *writer, const int64_t value);
+
+_encode_api void json_writer_real(JsonWriter *writer, const real64_t value);
+
+_encode_api void json_writer_bool(JsonWriter *writer, const bool_t value);
+
+_encode_api void json_writer_null(JsonWriter *writer);
+
+_encode_api void json_writer_value_imp(JsonWriter *writer, const void *data, const char_t *type);
+
 __END_C
 
 #define json_read(stm, opts, type) \
@@ -35,10 +87,20 @@ __END_C
 #define json_read_str(str, opts, type) \
     cast(json_read_str_imp(str, opts, cast_const(#type, char_t)), type)
 
+#define json_read_arena(stm, opts, arena, type) \
+    cast(json_read_arena_imp(stm, opts, arena, cast_const(#type, char_t)), type)
+
+#define json_hread(stm, opts, htype, type) \
+    cast(json_hread_imp(stm, opts, htype, cast_const(#type, char_t)), type)
+
 #define json_write(stm, data, opts, type) \
     ((void)(cast_const(data, type) == data), \
      json_write_imp(stm, cast_const(data, void), opts, cast_const(#type, char_t)))
 
+#define json_hwrite(stm, data, opts, htype, type) \
+    ((void)(cast_const(data, type) == data), \
+     json_hwrite_imp(stm, cast_const(data, void), opts, htype, cast_const(#type, char_t)))
+
 #define json_write_str(data, opts, type) \
     ((void)(cast_const(data, type) == data), \
      json_write_str_imp(cast_const(data, void), opts, cast_const(#type, char_t)))
@@ -50,3 +112,10 @@ __END_C
 #define json_destopt(data, type) \
     ((void)(dcast(data, type) == data), \
      json_destopt_imp(dcast(data, void), cast_const(#type, char_t)))
+
+#define json_reader_value(reader, type) \
+    cast(json_reader_value_imp(reader, cast_const(#type, char_t)), type)
+
+#define json_writer_value(writer, data, type) \
+    ((void)(cast_const(data, type) == data), \
+     json_writer_value_imp(writer, cast_const(data, void), cast_const(#type, char_t)))
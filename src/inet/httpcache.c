@@ -0,0 +1,1086 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: httpcache.c
+ *
+ */
+
+/* On-disk HTTP response cache */
+
+#include "httpcache.h"
+#include "httpcache.inl"
+#include <core/arrst.h>
+#include <core/bhash.h>
+#include <core/hashpt.h>
+#include <core/heap.h>
+#include <core/hfile.h>
+#include <core/stream.h>
+#include <core/strings.h>
+#include <osbs/bfile.h>
+#include <osbs/bmutex.h>
+#include <osbs/btime.h>
+#include <sewer/cassert.h>
+#include <sewer/ptr.h>
+
+/*
+ * Responses to http_get() without body (also http_dget()) are kept in a
+ * folder of the application data directory, with two files per url named
+ * by its hash: 'hash.hdr' (url, response time and headers) and 'hash.body'.
+ * Fresh responses (Cache-Control max-age, Expires or a heuristic from
+ * Last-Modified) are served without network I/O. Stale responses with
+ * ETag or Last-Modified are revalidated with a conditional request and a
+ * '304 Not Modified' serves the stored body. When the cache exceeds its
+ * size, the least recently used responses are removed. The 'index' file
+ * keeps the use order between sessions. Entries are found by the url hash
+ * and linked from the oldest to the newest use. The folder belongs to a
+ * single process: the index lives in memory and 'httpcache_enable' deletes
+ * the temporal files and the responses out of the index. Two applications
+ * (or instances) must use different folders.
+ */
+
+typedef struct _entry_t i_Entry;
+typedef struct _field_t i_Field;
+
+struct _entry_t
+{
+    uint32_t hash;
+    uint64_t size;
+    uint64_t access;
+    i_Entry *older;
+    i_Entry *newer;
+};
+
+struct _field_t
+{
+    String *name;
+    String *value;
+};
+
+DeclPt(i_Entry);
+DeclSt(i_Field);
+
+#define i_INDEX_VERSION 1
+#define i_HEURISTIC_MAX 86400
+
+static Mutex *i_MUTEX = NULL;
+static String *i_FOLDER = NULL;
+static HashPt(i_Entry) *i_ENTRIES = NULL;
+static i_Entry *i_OLDEST = NULL;
+static i_Entry *i_NEWEST = NULL;
+static uint64_t i_MAX_SIZE = 0;
+static uint64_t i_SIZE = 0;
+static uint64_t i_ACCESS = 0;
+static uint32_t i_TMP = 0;
+
+/*---------------------------------------------------------------------------*/
+
+void _httpcache_start(void)
+{
+    cassert(i_MUTEX == NULL);
+    i_MUTEX = bmutex_create();
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _httpcache_finish(void)
+{
+    httpcache_disable();
+    bmutex_close(&i_MUTEX);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_remove_field(i_Field *field)
+{
+    cassert_no_null(field);
+    str_destroy(&field->name);
+    str_destroy(&field->value);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int64_t i_now(void)
+{
+    return (int64_t)(btime_now() / 1000000);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_hash(const char_t *url)
+{
+    return bhash_from_block(cast_const(url, byte_t), str_len_c(url));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static String *i_path(const uint32_t hash, const char_t *ext)
+{
+    cassert_no_null(i_FOLDER);
+    return str_cpath("%s/%08x.%s", tc(i_FOLDER), hash, ext);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_delete(const uint32_t hash, const char_t *ext)
+{
+    String *path = i_path(hash, ext);
+    bfile_delete(tc(path), NULL);
+    str_destroy(&path);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint64_t i_file_size(const uint32_t hash, const char_t *ext)
+{
+    String *path = i_path(hash, ext);
+    file_type_t type = ENUM_MAX(file_type_t);
+    uint64_t size = UINT64_MAX;
+    if (bfile_lstat(tc(path), &type, &size, NULL, NULL) == FALSE || type != ekARCHIVE)
+        size = UINT64_MAX;
+    str_destroy(&path);
+    return size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_entry_hash(const uint32_t *hash)
+{
+    /* Already a hash of the url */
+    return *hash;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int i_entry_cmp(const i_Entry *entry, const uint32_t *hash)
+{
+    cassert_no_null(entry);
+    if (entry->hash < *hash)
+        return -1;
+    if (entry->hash > *hash)
+        return 1;
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_destroy_entry(i_Entry **entry)
+{
+    heap_delete(entry, i_Entry);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static i_Entry *i_entry(const uint32_t hash)
+{
+    return hashpt_get(i_ENTRIES, &hash, i_Entry, uint32_t);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_unlink(i_Entry *entry)
+{
+    cassert_no_null(entry);
+    if (entry->older != NULL)
+        entry->older->newer = entry->newer;
+    else
+        i_OLDEST = entry->newer;
+
+    if (entry->newer != NULL)
+        entry->newer->older = entry->older;
+    else
+        i_NEWEST = entry->older;
+
+    entry->older = NULL;
+    entry->newer = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Keeps the list sorted by access. New accesses are the newest */
+static void i_link(i_Entry *entry)
+{
+    i_Entry *older = i_NEWEST;
+    cassert_no_null(entry);
+    while (older != NULL && older->access > entry->access)
+        older = older->older;
+
+    entry->older = older;
+    entry->newer = older != NULL ? older->newer : i_OLDEST;
+    if (entry->newer != NULL)
+        entry->newer->older = entry;
+    else
+        i_NEWEST = entry;
+
+    if (older != NULL)
+        older->newer = entry;
+    else
+        i_OLDEST = entry;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the mutex locked */
+static void i_touch(i_Entry *entry)
+{
+    cassert_no_null(entry);
+    entry->access = ++i_ACCESS;
+    i_unlink(entry);
+    i_link(entry);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the mutex locked */
+static void i_new_entry(const uint32_t hash, const uint64_t size, const uint64_t access)
+{
+    i_Entry *entry = heap_new0(i_Entry);
+    bool_t ok = FALSE;
+    entry->hash = hash;
+    entry->size = size;
+    entry->access = access;
+    ok = hashpt_insert(i_ENTRIES, &hash, entry, i_Entry, uint32_t);
+    cassert_unref(ok == TRUE, ok);
+    i_link(entry);
+    i_SIZE += size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the mutex locked */
+static void i_delete_entry(i_Entry *entry)
+{
+    uint32_t hash = 0;
+    bool_t ok = FALSE;
+    cassert_no_null(entry);
+    cassert(i_SIZE >= entry->size);
+    hash = entry->hash;
+    i_delete(hash, "hdr");
+    i_delete(hash, "body");
+    i_SIZE -= entry->size;
+    i_unlink(entry);
+    ok = hashpt_delete(i_ENTRIES, &hash, i_destroy_entry, i_Entry, uint32_t);
+    cassert_unref(ok == TRUE, ok);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the mutex locked */
+static void i_evict(void)
+{
+    while (i_SIZE > i_MAX_SIZE)
+    {
+        cassert_no_null(i_OLDEST);
+        i_delete_entry(i_OLDEST);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the mutex locked */
+static void i_save_index(void)
+{
+    String *path = str_cpath("%s/index", tc(i_FOLDER));
+    Stream *stm = stm_to_file(tc(path), NULL);
+    if (stm != NULL)
+    {
+        const i_Entry *entry = i_OLDEST;
+        stm_write_u32(stm, i_INDEX_VERSION);
+        stm_write_u32(stm, hashpt_size(i_ENTRIES, i_Entry));
+        for (; entry != NULL; entry = entry->newer)
+        {
+            stm_write_u32(stm, entry->hash);
+            stm_write_u64(stm, entry->access);
+        }
+
+        stm_close(&stm);
+    }
+
+    str_destroy(&path);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* 'hash.ext' with 8 hexadecimal digits */
+static bool_t i_file_hash(const char_t *name, uint32_t *hash)
+{
+    char_t hex[9];
+    bool_t error = FALSE;
+    cassert_no_null(hash);
+    if (str_len_c(name) < 10 || name[8] != '.')
+        return FALSE;
+    str_copy_cn(hex, sizeof(hex), name, 8);
+    *hash = str_to_u32(hex, 16, &error);
+    return (bool_t)(error == FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the mutex locked */
+static void i_load_index(void)
+{
+    String *path = str_cpath("%s/index", tc(i_FOLDER));
+    Stream *stm = stm_from_file(tc(path), NULL);
+    ArrSt(DirEntry) *files = NULL;
+
+    if (stm != NULL)
+    {
+        if (stm_read_u32(stm) == i_INDEX_VERSION)
+        {
+            uint32_t i, n = stm_read_u32(stm);
+            for (i = 0; i < n && stm_state(stm) == ekSTOK; ++i)
+            {
+                uint32_t hash = stm_read_u32(stm);
+                uint64_t access = stm_read_u64(stm);
+                uint64_t hsize = i_file_size(hash, "hdr");
+                uint64_t bsize = i_file_size(hash, "body");
+                if (stm_state(stm) == ekSTOK && hsize != UINT64_MAX && bsize != UINT64_MAX && i_entry(hash) == NULL)
+                {
+                    i_new_entry(hash, hsize + bsize, access);
+                    if (access > i_ACCESS)
+                        i_ACCESS = access;
+                }
+            }
+        }
+
+        stm_close(&stm);
+    }
+
+    /* Temporal files and responses out of the index (unfinished sessions) */
+    files = hfile_dir_list(tc(i_FOLDER), FALSE, NULL);
+    if (files != NULL)
+    {
+        arrst_foreach_const(file, files, DirEntry)
+            uint32_t hash = 0;
+            if (i_file_hash(tc(file->name), &hash) == TRUE && (str_equ_end(tc(file->name), ".tmp") == TRUE || i_entry(hash) == NULL))
+            {
+                String *fpath = str_cpath("%s/%s", tc(i_FOLDER), tc(file->name));
+                bfile_delete(tc(fpath), NULL);
+                str_destroy(&fpath);
+            }
+        arrst_end()
+        arrst_destroy(&files, hfile_dir_entry_remove, DirEntry);
+    }
+
+    str_destroy(&path);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t httpcache_enable(const char_t *folder, const uint64_t max_size)
+{
+    String *path = hfile_appdata(folder != NULL ? folder : "httpcache");
+    bool_t ok = FALSE;
+    httpcache_disable();
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    if (path != NULL && hfile_dir_create(tc(path), NULL) == TRUE)
+    {
+        i_FOLDER = path;
+        i_ENTRIES = hashpt_create(i_entry_hash, i_entry_cmp, i_Entry, uint32_t);
+        i_OLDEST = NULL;
+        i_NEWEST = NULL;
+        i_MAX_SIZE = max_size;
+        i_SIZE = 0;
+        i_ACCESS = 0;
+        path = NULL;
+        i_load_index();
+        i_evict();
+        i_save_index();
+        ok = TRUE;
+    }
+
+    bmutex_unlock(i_MUTEX);
+    str_destopt(&path);
+    return ok;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void httpcache_disable(void)
+{
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    if (i_FOLDER != NULL)
+    {
+        i_save_index();
+        hashpt_destroy(&i_ENTRIES, i_destroy_entry, i_Entry);
+        i_OLDEST = NULL;
+        i_NEWEST = NULL;
+        str_destroy(&i_FOLDER);
+        i_SIZE = 0;
+    }
+
+    bmutex_unlock(i_MUTEX);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void httpcache_clear(void)
+{
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    if (i_FOLDER != NULL)
+    {
+        while (i_OLDEST != NULL)
+            i_delete_entry(i_OLDEST);
+        i_save_index();
+    }
+
+    bmutex_unlock(i_MUTEX);
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint64_t httpcache_size(void)
+{
+    uint64_t size = 0;
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    size = i_SIZE;
+    bmutex_unlock(i_MUTEX);
+    return size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _httpcache_enabled(void)
+{
+    bool_t enabled = FALSE;
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    enabled = (bool_t)(i_FOLDER != NULL);
+    bmutex_unlock(i_MUTEX);
+    return enabled;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Status line and header fields */
+static String *i_parse(const char_t *headers, ArrSt(i_Field) *fields)
+{
+    Stream *stm = stm_from_block(cast_const(headers, byte_t), str_len_c(headers));
+    String *status = NULL;
+    stm_lines(line, stm)
+        if (status == NULL)
+        {
+            status = str_trim(line);
+        }
+        else if (str_str(line, ":") != NULL)
+        {
+            i_Field *field = arrst_new(fields, i_Field);
+            str_split_trim(line, ":", &field->name, &field->value);
+        }
+    stm_next(line, stm)
+    stm_close(&stm);
+    return status != NULL ? status : str_c("");
+}
+
+/*---------------------------------------------------------------------------*/
+
+static const char_t *i_field(const ArrSt(i_Field) *fields, const char_t *name)
+{
+    arrst_foreach_const(field, fields, i_Field)
+        if (str_equ_nocase(tc(field->name), name) == TRUE)
+            return tc(field->value);
+    arrst_end()
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_status(const char_t *status)
+{
+    const char_t *code = str_str(status, " ");
+    uint32_t rcode = 0, i;
+    if (code == NULL)
+        return 0;
+
+    for (i = 1; i <= 3; ++i)
+    {
+        if (code[i] < '0' || code[i] > '9')
+            return 0;
+        rcode = rcode * 10 + (uint32_t)(code[i] - '0');
+    }
+
+    return rcode;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE char_t i_lower(const char_t c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char_t)(c + 32) : c;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Case-insensitive 'token' at the beginning of 'str' */
+static bool_t i_prefix(const char_t *str, const char_t *token)
+{
+    while (*token != '\0')
+    {
+        if (i_lower(*str) != *token)
+            return FALSE;
+        str += 1;
+        token += 1;
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_digits(const char_t **str, uint32_t *ndigits)
+{
+    uint32_t value = 0;
+    *ndigits = 0;
+    while (**str >= '0' && **str <= '9')
+    {
+        if (value < 429496729)
+            value = value * 10 + (uint32_t)(**str - '0');
+        *str += 1;
+        *ndigits += 1;
+    }
+
+    return value;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_cache_control(const ArrSt(i_Field) *fields, bool_t *no_store, bool_t *no_cache, int64_t *max_age)
+{
+    const char_t *value = i_field(fields, "Cache-Control");
+    *no_store = FALSE;
+    *no_cache = FALSE;
+    *max_age = -1;
+
+    if (value == NULL)
+    {
+        const char_t *pragma = i_field(fields, "Pragma");
+        if (pragma != NULL && i_prefix(pragma, "no-cache") == TRUE)
+            *no_cache = TRUE;
+        return;
+    }
+
+    while (*value != '\0')
+    {
+        while (*value == ' ' || *value == ',' || *value == '\t')
+            value += 1;
+
+        if (i_prefix(value, "no-store") == TRUE)
+        {
+            *no_store = TRUE;
+        }
+        else if (i_prefix(value, "no-cache") == TRUE)
+        {
+            *no_cache = TRUE;
+        }
+        else if (i_prefix(value, "max-age=") == TRUE)
+        {
+            uint32_t n = 0, age = 0;
+            value += 8;
+            if (*value == '"')
+                value += 1;
+            age = i_digits(&value, &n);
+            if (n > 0)
+                *max_age = (int64_t)age;
+        }
+
+        while (*value != ',' && *value != '\0')
+            value += 1;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int64_t i_days(const int64_t year, const uint32_t month, const uint32_t day)
+{
+    int64_t y = month <= 2 ? year - 1 : year;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (int64_t)(month > 2 ? month - 3 : month + 9) + 2) / 5 + (int64_t)day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/*
+ * Seconds since 1970 (UTC) of IMF-fixdate 'Sun, 06 Nov 1994 08:49:37 GMT',
+ * RFC 850 'Sunday, 06-Nov-94 08:49:37 GMT' and asctime 'Sun Nov  6 08:49:37 1994'.
+ */
+static bool_t i_http_date(const char_t *str, int64_t *secs)
+{
+    static const char_t *i_MONTHS = "janfebmaraprmayjunjulaugsepoctnovdec";
+    uint32_t day = 0, month = 0, year = 0, hour = UINT32_MAX, min = 0, sec = 0;
+
+    if (str == NULL)
+        return FALSE;
+
+    for (;;)
+    {
+        while (*str == ' ' || *str == ',' || *str == '-' || *str == '\t')
+            str += 1;
+
+        if (*str == '\0')
+            break;
+
+        if (*str >= '0' && *str <= '9')
+        {
+            uint32_t n = 0;
+            uint32_t value = i_digits(&str, &n);
+            if (*str == ':')
+            {
+                uint32_t n1 = 0, n2 = 0;
+                str += 1;
+                min = i_digits(&str, &n1);
+                if (*str != ':')
+                    return FALSE;
+                str += 1;
+                sec = i_digits(&str, &n2);
+                if (n1 == 0 || n2 == 0)
+                    return FALSE;
+                hour = value;
+            }
+            else if (day == 0 && n <= 2)
+            {
+                day = value;
+            }
+            else
+            {
+                year = value;
+                if (n <= 2)
+                    year += year >= 70 ? 1900 : 2000;
+            }
+        }
+        else
+        {
+            const char_t *token = str;
+            while (*str != '\0' && *str != ' ' && *str != ',' && *str != '-' && *str != '\t')
+                str += 1;
+
+            if (month == 0 && str - token >= 3)
+            {
+                uint32_t i;
+                for (i = 0; i < 12; ++i)
+                {
+                    const char_t *m = i_MONTHS + i * 3;
+                    if (i_lower(token[0]) == m[0] && i_lower(token[1]) == m[1] && i_lower(token[2]) == m[2])
+                    {
+                        month = i + 1;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    if (day < 1 || day > 31 || month == 0 || year < 1970 || hour > 23 || min > 59 || sec > 60)
+        return FALSE;
+
+    *secs = i_days((int64_t)year, month, day) * 86400 + (int64_t)(hour * 3600 + min * 60 + sec);
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Freshness lifetime (RFC 9111, 4.2.1) */
+static int64_t i_lifetime(const ArrSt(i_Field) *fields, const int64_t max_age, const int64_t date)
+{
+    int64_t expires = 0, modified = 0;
+
+    if (max_age >= 0)
+        return max_age;
+
+    if (i_field(fields, "Expires") != NULL)
+    {
+        /* Invalid dates (as '0') are in the past */
+        if (i_http_date(i_field(fields, "Expires"), &expires) == TRUE && expires > date)
+            return expires - date;
+        return 0;
+    }
+
+    if (i_http_date(i_field(fields, "Last-Modified"), &modified) == TRUE && modified < date)
+    {
+        int64_t lifetime = (date - modified) / 10;
+        return lifetime < i_HEURISTIC_MAX ? lifetime : i_HEURISTIC_MAX;
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_fresh(const ArrSt(i_Field) *fields, const int64_t rtime, const int64_t now)
+{
+    bool_t no_store = FALSE, no_cache = FALSE;
+    int64_t max_age = -1, date = rtime, age = 0, lifetime = 0;
+    const char_t *hage = i_field(fields, "Age");
+
+    i_cache_control(fields, &no_store, &no_cache, &max_age);
+    if (no_store == TRUE || no_cache == TRUE)
+        return FALSE;
+
+    if (i_http_date(i_field(fields, "Date"), &date) == FALSE)
+        date = rtime;
+
+    lifetime = i_lifetime(fields, max_age, date);
+
+    /* Current age (RFC 9111, 4.2.3) */
+    if (rtime > date)
+        age = rtime - date;
+
+    if (hage != NULL)
+    {
+        uint32_t n = 0;
+        int64_t value = (int64_t)i_digits(&hage, &n);
+        if (value > age)
+            age = value;
+    }
+
+    age += now - rtime;
+    return (bool_t)(lifetime > age);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_storable(const char_t *headers)
+{
+    ArrSt(i_Field) *fields = arrst_create(i_Field);
+    String *status = i_parse(headers, fields);
+    bool_t storable = FALSE;
+
+    if (i_status(tc(status)) == 200)
+    {
+        bool_t no_store = FALSE, no_cache = FALSE;
+        int64_t max_age = -1, date = i_now();
+        const char_t *vary = i_field(fields, "Vary");
+        i_cache_control(fields, &no_store, &no_cache, &max_age);
+        i_http_date(i_field(fields, "Date"), &date);
+
+        /* The request headers are not part of the key */
+        if (no_store == FALSE && (vary == NULL || str_equ_nocase(vary, "Accept-Encoding") == TRUE))
+        {
+            if (i_lifetime(fields, max_age, date) > 0)
+                storable = TRUE;
+            else if (i_field(fields, "ETag") != NULL || i_field(fields, "Last-Modified") != NULL)
+                storable = TRUE;
+        }
+    }
+
+    arrst_destroy(&fields, i_remove_field, i_Field);
+    str_destroy(&status);
+    return storable;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* 'url\nresponse_time\nheaders' */
+static String *i_read_hdr(const uint32_t hash, const char_t *url, int64_t *rtime)
+{
+    String *path = i_path(hash, "hdr");
+    String *file = hfile_string(tc(path), NULL);
+    String *headers = NULL;
+    str_destroy(&path);
+
+    if (file != NULL)
+    {
+        const char_t *furl = tc(file);
+        const char_t *ftime = str_str(furl, "\n");
+        if (ftime != NULL && str_equ_cn(furl, url, (uint32_t)(ftime - furl)) == TRUE && str_len_c(url) == (uint32_t)(ftime - furl))
+        {
+            const char_t *fheaders = NULL;
+            uint32_t n = 0;
+            ftime += 1;
+            fheaders = ftime;
+            *rtime = (int64_t)i_digits(&fheaders, &n);
+            if (n > 0 && *fheaders == '\n')
+                headers = str_c(fheaders + 1);
+        }
+
+        str_destroy(&file);
+    }
+
+    return headers;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the mutex locked */
+static uint64_t i_write_hdr(const uint32_t hash, const char_t *url, const char_t *headers)
+{
+    String *path = i_path(hash, "hdr");
+    Stream *stm = stm_to_file(tc(path), NULL);
+    uint64_t size = UINT64_MAX;
+    if (stm != NULL)
+    {
+        stm_printf(stm, "%s\n%u\n", url, (uint32_t)i_now());
+        stm_writef(stm, headers);
+        if (stm_state(stm) == ekSTOK)
+            size = stm_bytes_written(stm);
+        stm_close(&stm);
+    }
+
+    str_destroy(&path);
+    return size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+String *_httpcache_lookup(const char_t *url, bool_t *fresh, Stream **body, uint64_t *size)
+{
+    String *headers = NULL;
+    cassert_no_null(fresh);
+    cassert_no_null(body);
+    cassert_no_null(size);
+    cassert_no_null(i_MUTEX);
+    *fresh = FALSE;
+    *body = NULL;
+    *size = 0;
+    bmutex_lock(i_MUTEX);
+    if (i_FOLDER != NULL)
+    {
+        uint32_t hash = i_hash(url);
+        i_Entry *entry = i_entry(hash);
+        if (entry != NULL)
+        {
+            int64_t rtime = 0;
+            headers = i_read_hdr(hash, url, &rtime);
+            if (headers != NULL)
+            {
+                /* Opened with the headers, both from the same response */
+                String *path = i_path(hash, "body");
+                *size = i_file_size(hash, "body");
+                if (*size != UINT64_MAX)
+                    *body = stm_from_file(tc(path), NULL);
+                str_destroy(&path);
+            }
+
+            if (*body != NULL)
+            {
+                ArrSt(i_Field) *fields = arrst_create(i_Field);
+                String *status = i_parse(tc(headers), fields);
+                *fresh = i_fresh(fields, rtime, i_now());
+                i_touch(entry);
+                arrst_destroy(&fields, i_remove_field, i_Field);
+                str_destroy(&status);
+            }
+            else
+            {
+                str_destopt(&headers);
+                *size = 0;
+            }
+        }
+    }
+
+    bmutex_unlock(i_MUTEX);
+    return headers;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _httpcache_validators(const char_t *headers, String **etag, String **modified)
+{
+    ArrSt(i_Field) *fields = arrst_create(i_Field);
+    String *status = i_parse(headers, fields);
+    const char_t *value = NULL;
+    cassert_no_null(etag);
+    cassert_no_null(modified);
+    value = i_field(fields, "ETag");
+    *etag = value != NULL ? str_c(value) : NULL;
+    value = i_field(fields, "Last-Modified");
+    *modified = value != NULL ? str_c(value) : NULL;
+    arrst_destroy(&fields, i_remove_field, i_Field);
+    str_destroy(&status);
+}
+
+/*---------------------------------------------------------------------------*/
+
+String *_httpcache_tmp(void)
+{
+    String *path = NULL;
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    if (i_FOLDER != NULL)
+    {
+        /* Unique in this process (the cache folder is not shared) */
+        uint32_t id = (uint32_t)btime_now() ^ bhash_append_uint32(0, ++i_TMP);
+        path = str_cpath("%s/%08x.%u.tmp", tc(i_FOLDER), id, i_TMP);
+    }
+
+    bmutex_unlock(i_MUTEX);
+    return path;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _httpcache_store(const char_t *url, const char_t *headers, String **tmp)
+{
+    bool_t stored = FALSE;
+    bool_t storable = i_storable(headers);
+    cassert_no_null(tmp);
+    cassert_no_null(*tmp);
+    cassert_no_null(i_MUTEX);
+
+    bmutex_lock(i_MUTEX);
+    if (i_FOLDER != NULL)
+    {
+        uint32_t hash = i_hash(url);
+        i_Entry *entry = i_entry(hash);
+
+        /* Replaced even if the new response is not storable (RFC 9111, 4.4). Collisions, the last url wins */
+        if (entry != NULL)
+            i_delete_entry(entry);
+
+        if (storable == TRUE)
+        {
+            String *body = i_path(hash, "body");
+            file_type_t type = ENUM_MAX(file_type_t);
+            uint64_t bsize = 0;
+
+            if (bfile_lstat(tc(*tmp), &type, &bsize, NULL, NULL) == TRUE && bsize <= i_MAX_SIZE && bfile_rename(tc(*tmp), tc(body), NULL) == TRUE)
+            {
+                uint64_t hsize = i_write_hdr(hash, url, headers);
+                if (hsize != UINT64_MAX)
+                {
+                    i_new_entry(hash, hsize + bsize, ++i_ACCESS);
+                    i_evict();
+                }
+                else
+                {
+                    i_delete(hash, "hdr");
+                    i_delete(hash, "body");
+                }
+
+                stored = TRUE;
+            }
+
+            str_destroy(&body);
+        }
+
+        if (entry != NULL || stored == TRUE)
+            i_save_index();
+    }
+
+    bmutex_unlock(i_MUTEX);
+
+    if (stored == FALSE)
+        bfile_delete(tc(*tmp), NULL);
+
+    str_destroy(tmp);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_keep_stored(const char_t *name)
+{
+    /* The 304 headers describe the stored body (RFC 9111, 3.2) */
+    if (str_equ_nocase(name, "Content-Length") == TRUE)
+        return TRUE;
+    if (str_equ_nocase(name, "Content-Encoding") == TRUE)
+        return TRUE;
+    if (str_equ_nocase(name, "Transfer-Encoding") == TRUE)
+        return TRUE;
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+String *_httpcache_refresh(const char_t *url, const char_t *stored, const char_t *headers)
+{
+    ArrSt(i_Field) *fields = arrst_create(i_Field);
+    ArrSt(i_Field) *nfields = arrst_create(i_Field);
+    String *status = i_parse(stored, fields);
+    String *nstatus = i_parse(headers, nfields);
+    Stream *stm = stm_memory(1024);
+    String *merged = NULL;
+
+    arrst_foreach(nfield, nfields, i_Field)
+        if (i_keep_stored(tc(nfield->name)) == FALSE)
+        {
+            i_Field *field = NULL;
+            arrst_foreach(lfield, fields, i_Field)
+                if (str_equ_nocase(tc(lfield->name), tc(nfield->name)) == TRUE)
+                {
+                    field = lfield;
+                    break;
+                }
+            arrst_end()
+
+            if (field == NULL)
+            {
+                field = arrst_new(fields, i_Field);
+                field->name = str_copy(nfield->name);
+            }
+            else
+            {
+                str_destroy(&field->value);
+            }
+
+            field->value = str_copy(nfield->value);
+        }
+    arrst_end()
+
+    stm_printf(stm, "%s\n", tc(status));
+    arrst_foreach_const(field, fields, i_Field)
+        stm_printf(stm, "%s: %s\n", tc(field->name), tc(field->value));
+    arrst_end()
+    merged = stm_str(stm);
+
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    if (i_FOLDER != NULL)
+    {
+        uint32_t hash = i_hash(url);
+        i_Entry *entry = i_entry(hash);
+        if (entry != NULL)
+        {
+            uint64_t hsize = i_write_hdr(hash, url, tc(merged));
+            uint64_t bsize = i_file_size(hash, "body");
+            if (hsize != UINT64_MAX && bsize != UINT64_MAX)
+            {
+                i_SIZE -= entry->size;
+                entry->size = hsize + bsize;
+                i_SIZE += entry->size;
+                i_touch(entry);
+                i_evict();
+            }
+            else
+            {
+                i_delete_entry(entry);
+            }
+
+            i_save_index();
+        }
+    }
+
+    bmutex_unlock(i_MUTEX);
+    stm_close(&stm);
+    arrst_destroy(&fields, i_remove_field, i_Field);
+    arrst_destroy(&nfields, i_remove_field, i_Field);
+    str_destroy(&status);
+    str_destroy(&nstatus);
+    return merged;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _httpcache_remove(const char_t *url)
+{
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    if (i_FOLDER != NULL)
+    {
+        i_Entry *entry = i_entry(i_hash(url));
+        if (entry != NULL)
+        {
+            i_delete_entry(entry);
+            i_save_index();
+        }
+    }
+
+    bmutex_unlock(i_MUTEX);
+}
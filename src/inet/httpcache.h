@@ -0,0 +1,25 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: httpcache.h
+ *
+ */
+
+/* On-disk HTTP response cache */
+
+#include "inet.hxx"
+
+__EXTERN_C
+
+_inet_api bool_t httpcache_enable(const char_t *folder, const uint64_t max_size);
+
+_inet_api void httpcache_disable(void);
+
+_inet_api void httpcache_clear(void);
+
+_inet_api uint64_t httpcache_size(void);
+
+__END_C
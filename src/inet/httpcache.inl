@@ -0,0 +1,35 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: httpcache.inl
+ *
+ */
+
+/* On-disk HTTP response cache */
+
+#include "inet.ixx"
+
+__EXTERN_C
+
+void _httpcache_start(void);
+
+void _httpcache_finish(void);
+
+bool_t _httpcache_enabled(void);
+
+String *_httpcache_lookup(const char_t *url, bool_t *fresh, Stream **body, uint64_t *size);
+
+void _httpcache_validators(const char_t *headers, String **etag, String **modified);
+
+String *_httpcache_tmp(void);
+
+void _httpcache_store(const char_t *url, const char_t *headers, String **tmp);
+
+String *_httpcache_refresh(const char_t *url, const char_t *stored, const char_t *headers);
+
+void _httpcache_remove(const char_t *url);
+
+__END_C
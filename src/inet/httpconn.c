@@ -0,0 +1,196 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: httpconn.c
+ *
+ */
+
+/* Keep-alive connection cache */
+
+#include "httpconn.inl"
+#include "oshttpreq.inl"
+#include <core/arrst.h>
+#include <core/strings.h>
+#include <osbs/bmutex.h>
+#include <osbs/btime.h>
+#include <sewer/cassert.h>
+
+/*
+ * Destroyed Http objects leave their backend handle here, with its open
+ * connection (and TLS session). New Http objects to the same scheme, host
+ * and port take the most recent one, so http_dget() and http_exists() don't
+ * connect again. The server can close an idle connection at any time: the
+ * backends detect it and reconnect transparently.
+ */
+
+typedef struct _idle_t i_Idle;
+
+struct _idle_t
+{
+    OSHttp *http;
+    String *host;
+    uint16_t port;
+    bool_t secure;
+    uint64_t time;
+};
+
+DeclSt(i_Idle);
+
+#define i_MAX_IDLE 64
+
+static Mutex *i_MUTEX = NULL;
+static ArrSt(i_Idle) *i_IDLE = NULL;
+static uint32_t i_MAX_HOST = 4;
+static uint64_t i_TIMEOUT = 30000000;
+
+/*---------------------------------------------------------------------------*/
+
+static void i_remove_idle(i_Idle *idle)
+{
+    cassert_no_null(idle);
+    oshttp_destroy(&idle->http);
+    str_destroy(&idle->host);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _httpconn_start(void)
+{
+    cassert(i_MUTEX == NULL);
+    cassert(i_IDLE == NULL);
+    i_MUTEX = bmutex_create();
+    i_IDLE = arrst_create(i_Idle);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _httpconn_finish(void)
+{
+    arrst_destroy(&i_IDLE, i_remove_idle, i_Idle);
+    bmutex_close(&i_MUTEX);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_same(const i_Idle *idle, const char_t *host, const uint16_t port, const bool_t secure)
+{
+    cassert_no_null(idle);
+    if (idle->secure != secure || idle->port != port)
+        return FALSE;
+    return str_equ_nocase(tc(idle->host), host);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called with the mutex locked */
+static void i_purge(const uint64_t now)
+{
+    uint32_t i = arrst_size(i_IDLE, i_Idle);
+    while (i > 0)
+    {
+        const i_Idle *idle = arrst_get_const(i_IDLE, --i, i_Idle);
+        if (now - idle->time >= i_TIMEOUT || i_MAX_HOST == 0)
+            arrst_delete(i_IDLE, i, i_remove_idle, i_Idle);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _httpconn_config(const uint32_t max_host, const uint32_t idle_timeout_ms)
+{
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    i_MAX_HOST = max_host;
+    i_TIMEOUT = (uint64_t)idle_timeout_ms * 1000;
+    i_purge(btime_now());
+    bmutex_unlock(i_MUTEX);
+}
+
+/*---------------------------------------------------------------------------*/
+
+OSHttp *_httpconn_get(const char_t *host, const uint16_t port, const bool_t secure)
+{
+    OSHttp *http = NULL;
+    uint32_t i;
+    cassert_no_null(i_MUTEX);
+    bmutex_lock(i_MUTEX);
+    i_purge(btime_now());
+
+    /* The most recent is the most likely to be alive */
+    i = arrst_size(i_IDLE, i_Idle);
+    while (i > 0)
+    {
+        i_Idle *idle = arrst_get(i_IDLE, --i, i_Idle);
+        if (i_same(idle, host, port, secure) == TRUE)
+        {
+            http = idle->http;
+            str_destroy(&idle->host);
+            arrst_delete(i_IDLE, i, NULL, i_Idle);
+            break;
+        }
+    }
+
+    bmutex_unlock(i_MUTEX);
+
+    if (http == NULL)
+        http = oshttp_create(host, port, secure);
+
+    return http;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _httpconn_put(OSHttp **http, const char_t *host, const uint16_t port, const bool_t secure)
+{
+    cassert_no_null(http);
+    cassert_no_null(*http);
+    cassert_no_null(i_MUTEX);
+
+    /* Handles with errors are not reused */
+    if (oshttp_recycle(*http) == TRUE)
+    {
+        uint64_t now = btime_now();
+        bmutex_lock(i_MUTEX);
+        i_purge(now);
+
+        if (i_MAX_HOST > 0)
+        {
+            uint32_t i, n = arrst_size(i_IDLE, i_Idle);
+            uint32_t count = 0, oldest = UINT32_MAX;
+            i_Idle *idle = NULL;
+
+            for (i = 0; i < n; ++i)
+            {
+                const i_Idle *lidle = arrst_get_const(i_IDLE, i, i_Idle);
+                if (i_same(lidle, host, port, secure) == TRUE)
+                {
+                    if (oldest == UINT32_MAX)
+                        oldest = i;
+                    count += 1;
+                }
+            }
+
+            /* Per-host and global limits drop the oldest connection */
+            if (count >= i_MAX_HOST)
+                arrst_delete(i_IDLE, oldest, i_remove_idle, i_Idle);
+            else if (n >= i_MAX_IDLE)
+                arrst_delete(i_IDLE, 0, i_remove_idle, i_Idle);
+
+            idle = arrst_new(i_IDLE, i_Idle);
+            idle->http = *http;
+            idle->host = str_c(host);
+            idle->port = port;
+            idle->secure = secure;
+            idle->time = now;
+            *http = NULL;
+        }
+
+        bmutex_unlock(i_MUTEX);
+    }
+
+    if (*http != NULL)
+        oshttp_destroy(http);
+}
@@ -0,0 +1,27 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: httpconn.inl
+ *
+ */
+
+/* Keep-alive connection cache */
+
+#include "inet.ixx"
+
+__EXTERN_C
+
+void _httpconn_start(void);
+
+void _httpconn_finish(void);
+
+void _httpconn_config(const uint32_t max_host, const uint32_t idle_timeout_ms);
+
+OSHttp *_httpconn_get(const char_t *host, const uint16_t port, const bool_t secure);
+
+void _httpconn_put(OSHttp **http, const char_t *host, const uint16_t port, const bool_t secure);
+
+__END_C
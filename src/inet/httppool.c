@@ -0,0 +1,492 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: httppool.c
+ *
+ */
+
+/* Concurrent HTTP requests */
+
+#include "httppool.h"
+#include "httpreq.inl"
+#include "oshttpreq.inl"
+#include <core/arrpt.h>
+#include <core/arrst.h>
+#include <core/buffer.h>
+#include <core/heap.h>
+#include <core/strings.h>
+#include <osbs/bmutex.h>
+#include <osbs/bthread.h>
+#include <osbs/btime.h>
+#include <sewer/cassert.h>
+#include <sewer/ptr.h>
+
+typedef enum _verb_t
+{
+    i_ekGET,
+    i_ekPOST,
+    i_ekPUT,
+    i_ekPATCH,
+    i_ekDELETE
+} verb_t;
+
+typedef struct _req_t i_Req;
+typedef struct _done_t i_Done;
+
+struct _req_t
+{
+    HttpPool *pool;
+    Http *http;
+    verb_t verb;
+    String *path;
+    Buffer *data;
+    Thread *thread;
+    bool_t finished;
+    ierror_t error;
+};
+
+struct _done_t
+{
+    Http *http;
+    ierror_t error;
+};
+
+DeclPt(i_Req);
+DeclSt(i_Done);
+
+/*
+ * Platforms with a multi-transfer interface (libcurl) drive all the requests
+ * from the calling thread. The others run each active request in a thread.
+ * In both cases, the pool limits the total and per-host active requests.
+ */
+struct _httppool_t
+{
+    OSHttpMulti *multi;
+    Mutex *mutex;
+    uint32_t max_connections;
+    uint32_t max_host;
+    ArrPt(i_Req) *queue;
+    ArrPt(i_Req) *active;
+    ArrSt(i_Done) *done;
+    FPtr_http_done func_done;
+    void *data;
+};
+
+/*---------------------------------------------------------------------------*/
+
+HttpPool *httppool_create(const uint32_t max_connections, const uint32_t max_host)
+{
+    HttpPool *pool = heap_new0(HttpPool);
+    cassert(max_connections > 0);
+    cassert(max_host > 0);
+    pool->multi = oshttp_multi_create(max_connections, max_host);
+    if (pool->multi == NULL)
+        pool->mutex = bmutex_create();
+    pool->max_connections = max_connections;
+    pool->max_host = max_host;
+    pool->queue = arrpt_create(i_Req);
+    pool->active = arrpt_create(i_Req);
+    pool->done = arrst_create(i_Done);
+    return pool;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_destroy_req(i_Req **req)
+{
+    cassert_no_null(req);
+    cassert_no_null(*req);
+    if ((*req)->thread != NULL)
+    {
+        bthread_wait((*req)->thread);
+        bthread_close(&(*req)->thread);
+    }
+
+    str_destroy(&(*req)->path);
+    ptr_destopt(buffer_destroy, &(*req)->data, Buffer);
+    heap_delete(req, i_Req);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void httppool_destroy(HttpPool **pool)
+{
+    cassert_no_null(pool);
+    cassert_no_null(*pool);
+
+    /* Active transfers are cancelled. Threads can't be, so we wait for them */
+    if ((*pool)->multi != NULL)
+    {
+        arrpt_foreach(req, (*pool)->active, i_Req)
+            oshttp_multi_remove((*pool)->multi, _http_oshttp(req->http));
+        arrpt_end()
+        oshttp_multi_destroy(&(*pool)->multi);
+    }
+
+    arrpt_destroy(&(*pool)->queue, i_destroy_req, i_Req);
+    arrpt_destroy(&(*pool)->active, i_destroy_req, i_Req);
+    arrst_destroy(&(*pool)->done, NULL, i_Done);
+    ptr_destopt(bmutex_close, &(*pool)->mutex, Mutex);
+    heap_delete(pool, HttpPool);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void httppool_callback_imp(HttpPool *pool, FPtr_http_done func_done, void *data)
+{
+    cassert_no_null(pool);
+    pool->func_done = func_done;
+    pool->data = data;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static const char_t *i_verb(const verb_t verb)
+{
+    switch (verb)
+    {
+    case i_ekGET:
+        return "GET";
+    case i_ekPOST:
+        return "POST";
+    case i_ekPUT:
+        return "PUT";
+    case i_ekPATCH:
+        return "PATCH";
+    case i_ekDELETE:
+        return "DELETE";
+    default:
+        cassert_default(verb);
+    }
+
+    return "";
+}
+
+/*---------------------------------------------------------------------------*/
+
+static const byte_t *i_data(const i_Req *req, uint32_t *size)
+{
+    cassert_no_null(req);
+    cassert_no_null(size);
+    if (req->data != NULL)
+    {
+        *size = buffer_size(req->data);
+        return buffer_const(req->data);
+    }
+
+    *size = 0;
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_thread_main(i_Req *req)
+{
+    OSHttp *oshttp = NULL;
+    const byte_t *data = NULL;
+    uint32_t size = 0;
+    ierror_t error = ekIUNDEF;
+    cassert_no_null(req);
+    oshttp = _http_oshttp(req->http);
+    data = i_data(req, &size);
+
+    switch (req->verb)
+    {
+    case i_ekGET:
+        oshttp_get(oshttp, tc(req->path), data, size, TRUE, &error);
+        break;
+    case i_ekPOST:
+        oshttp_post(oshttp, tc(req->path), data, size, TRUE, &error);
+        break;
+    case i_ekPUT:
+        oshttp_put(oshttp, tc(req->path), data, size, TRUE, &error);
+        break;
+    case i_ekPATCH:
+        oshttp_patch(oshttp, tc(req->path), data, size, TRUE, &error);
+        break;
+    case i_ekDELETE:
+        oshttp_delete(oshttp, tc(req->path), data, size, TRUE, &error);
+        break;
+    default:
+        cassert_default(req->verb);
+    }
+
+    bmutex_lock(req->pool->mutex);
+    req->error = error;
+    req->finished = TRUE;
+    bmutex_unlock(req->pool->mutex);
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_finish(HttpPool *pool, i_Req *req, const ierror_t error)
+{
+    i_Done *done = arrst_new(pool->done, i_Done);
+    done->http = req->http;
+    done->error = error;
+    _http_end(req->http, error);
+    i_destroy_req(&req);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_start(HttpPool *pool, i_Req *req)
+{
+    if (pool->multi != NULL)
+    {
+        const byte_t *data = NULL;
+        uint32_t size = 0;
+        ierror_t error = ekIUNDEF;
+        data = i_data(req, &size);
+        if (oshttp_multi_add(pool->multi, _http_oshttp(req->http), i_verb(req->verb), tc(req->path), data, size, TRUE, &error) == TRUE)
+            arrpt_append(pool->active, req, i_Req);
+        else
+            i_finish(pool, req, error);
+    }
+    else
+    {
+        arrpt_append(pool->active, req, i_Req);
+        req->thread = bthread_create(i_thread_main, req, i_Req);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_host_active(const HttpPool *pool, const Http *http)
+{
+    uint32_t n = 0;
+    arrpt_foreach_const(req, pool->active, i_Req)
+        if (_http_same_host(req->http, http) == TRUE)
+            n += 1;
+    arrpt_end()
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Queued requests start in order, skipping the hosts already at their limit */
+static void i_schedule(HttpPool *pool)
+{
+    uint32_t i = 0;
+    while (i < arrpt_size(pool->queue, i_Req) && arrpt_size(pool->active, i_Req) < pool->max_connections)
+    {
+        i_Req *req = arrpt_get(pool->queue, i, i_Req);
+        if (i_host_active(pool, req->http) < pool->max_host)
+        {
+            arrpt_delete(pool->queue, i, NULL, i_Req);
+            i_start(pool, req);
+        }
+        else
+        {
+            i += 1;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_pending(const HttpPool *pool, const Http *http)
+{
+    arrpt_foreach_const(req, pool->queue, i_Req)
+        if (req->http == http)
+            return TRUE;
+    arrpt_end()
+
+    arrpt_foreach_const(req, pool->active, i_Req)
+        if (req->http == http)
+            return TRUE;
+    arrpt_end()
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_add(HttpPool *pool, Http *http, const verb_t verb, const char_t *path, const byte_t *data, const uint32_t size)
+{
+    i_Req *req = NULL;
+    cassert_no_null(pool);
+    cassert_no_null(http);
+
+    /* The same Http can't have two requests in progress */
+    if (i_pending(pool, http) == TRUE)
+        return FALSE;
+
+    req = heap_new0(i_Req);
+    req->pool = pool;
+    req->http = http;
+    req->verb = verb;
+    req->path = str_c(path);
+    req->error = ekIUNDEF;
+    if (data != NULL)
+        req->data = buffer_with_data(data, size);
+
+    _http_begin(http);
+    arrpt_append(pool->queue, req, i_Req);
+    i_schedule(pool);
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t httppool_get(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size)
+{
+    return i_add(pool, http, i_ekGET, path, data, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t httppool_post(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size)
+{
+    return i_add(pool, http, i_ekPOST, path, data, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t httppool_put(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size)
+{
+    return i_add(pool, http, i_ekPUT, path, data, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t httppool_patch(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size)
+{
+    return i_add(pool, http, i_ekPATCH, path, data, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t httppool_delete(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size)
+{
+    return i_add(pool, http, i_ekDELETE, path, data, size);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static i_Req *i_active(HttpPool *pool, const OSHttp *oshttp, uint32_t *pos)
+{
+    arrpt_foreach(req, pool->active, i_Req)
+        if (_http_oshttp(req->http) == oshttp)
+        {
+            *pos = req_i;
+            return req;
+        }
+    arrpt_end()
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_collect(HttpPool *pool)
+{
+    if (pool->multi != NULL)
+    {
+        ierror_t error = ekIUNDEF;
+        OSHttp *oshttp = NULL;
+        while ((oshttp = oshttp_multi_done(pool->multi, &error)) != NULL)
+        {
+            uint32_t pos = UINT32_MAX;
+            i_Req *req = i_active(pool, oshttp, &pos);
+            cassert_no_null(req);
+            arrpt_delete(pool->active, pos, NULL, i_Req);
+            i_finish(pool, req, error);
+        }
+    }
+    else
+    {
+        uint32_t i = 0;
+        while (i < arrpt_size(pool->active, i_Req))
+        {
+            i_Req *req = arrpt_get(pool->active, i, i_Req);
+            bool_t finished;
+            bmutex_lock(pool->mutex);
+            finished = req->finished;
+            bmutex_unlock(pool->mutex);
+            if (finished == TRUE)
+            {
+                arrpt_delete(pool->active, i, NULL, i_Req);
+                i_finish(pool, req, req->error);
+            }
+            else
+            {
+                i += 1;
+            }
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_dispatch(HttpPool *pool)
+{
+    /* The callback can add new requests */
+    while (pool->func_done != NULL && arrst_size(pool->done, i_Done) > 0)
+    {
+        i_Done done = *arrst_get(pool->done, 0, i_Done);
+        arrst_delete(pool->done, 0, NULL, i_Done);
+        pool->func_done(pool->data, done.http, done.error);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t httppool_wait(HttpPool *pool, const uint32_t timeout_ms)
+{
+    uint64_t start = btime_now();
+    cassert_no_null(pool);
+
+    for (;;)
+    {
+        uint64_t elapsed = 0;
+        uint32_t remain = 0;
+        i_collect(pool);
+        i_schedule(pool);
+
+        if (arrst_size(pool->done, i_Done) > 0)
+            break;
+
+        if (httppool_pending(pool) == 0)
+            break;
+
+        elapsed = (btime_now() - start) / 1000;
+        if (elapsed >= (uint64_t)timeout_ms)
+            break;
+
+        remain = (uint32_t)((uint64_t)timeout_ms - elapsed);
+        if (pool->multi != NULL)
+            oshttp_multi_wait(pool->multi, remain);
+        else
+            bthread_sleep(1);
+    }
+
+    i_dispatch(pool);
+    return httppool_pending(pool);
+}
+
+/*---------------------------------------------------------------------------*/
+
+Http *httppool_next(HttpPool *pool, ierror_t *error)
+{
+    i_Done done;
+    cassert_no_null(pool);
+    if (arrst_size(pool->done, i_Done) == 0)
+        return NULL;
+
+    done = *arrst_get(pool->done, 0, i_Done);
+    arrst_delete(pool->done, 0, NULL, i_Done);
+    ptr_assign(error, done.error);
+    return done.http;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t httppool_pending(const HttpPool *pool)
+{
+    cassert_no_null(pool);
+    return arrpt_size(pool->queue, i_Req) + arrpt_size(pool->active, i_Req);
+}
@@ -0,0 +1,45 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: httppool.h
+ *
+ */
+
+/* Concurrent HTTP requests */
+
+#include "inet.hxx"
+
+__EXTERN_C
+
+_inet_api HttpPool *httppool_create(const uint32_t max_connections, const uint32_t max_host);
+
+_inet_api void httppool_destroy(HttpPool **pool);
+
+_inet_api void httppool_callback_imp(HttpPool *pool, FPtr_http_done func_done, void *data);
+
+_inet_api bool_t httppool_get(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size);
+
+_inet_api bool_t httppool_post(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size);
+
+_inet_api bool_t httppool_put(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size);
+
+_inet_api bool_t httppool_patch(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size);
+
+_inet_api bool_t httppool_delete(HttpPool *pool, Http *http, const char_t *path, const byte_t *data, const uint32_t size);
+
+_inet_api uint32_t httppool_wait(HttpPool *pool, const uint32_t timeout_ms);
+
+_inet_api Http *httppool_next(HttpPool *pool, ierror_t *error);
+
+_inet_api uint32_t httppool_pending(const HttpPool *pool);
+
+__END_C
+
+#define httppool_callback(pool, func_done, data, type) \
+    ( \
+        (void)(cast(data, type) == data), \
+        FUNC_CHECK_HTTP_DONE(func_done, type), \
+        httppool_callback_imp(pool, (FPtr_http_done)func_done, cast(data, void)))
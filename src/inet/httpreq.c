@@ -11,12 +11,16 @@
 /* HTTP request */
 
 #include "httpreq.h"
+#include "httpreq.inl"
+#include "httpcache.inl"
+#include "httpconn.inl"
 #include "oshttpreq.inl"
 #include <encode/url.h>
 #include <core/arrst.h>
 #include <core/heap.h>
 #include <core/stream.h>
 #include <core/strings.h>
+#include <osbs/bfile.h>
 #include <sewer/cassert.h>
 #include <sewer/ptr.h>
 #include <sewer/unicode.h>
@@ -35,16 +39,30 @@ struct _http_t
     String *host_name;
     uint32_t host_ip;
     uint16_t host_port;
+    bool_t secure;
     ierror_t error;
     uint32_t rcode;
     String *rprotocol;
     String *rmsg;
     ArrSt(Field) *headers;
     ArrSt(Field) *cookies;
+    ArrSt(Field) *request;
+    bool_t redirected;
+    Stream *sink;
+    FPtr_http_chunk func_chunk;
+    void *chunk_data;
+    FPtr_http_progress func_progress;
+    void *progress_data;
+    Stream *body;
+    Stream *cache;
+    uint64_t received;
 };
 
 DeclSt(Field);
 
+static bool_t i_cacheable_request(const Http *http);
+static void i_cache_get(Http *http, const char_t *path);
+
 /*---------------------------------------------------------------------------*/
 
 static bool_t i_valid_header_name_char(const unsigned char c)
@@ -266,12 +284,15 @@ void http_destroy(Http **http)
 {
     cassert_no_null(http);
     cassert_no_null(*http);
+    /* The connection is kept for other Http to the same host */
+    _httpconn_put(&(*http)->oshttp, tc((*http)->host_name), (*http)->host_port, (*http)->secure);
     str_destroy(&(*http)->host_name);
     ptr_destopt(str_destroy, &(*http)->rprotocol, String);
     ptr_destopt(str_destroy, &(*http)->rmsg, String);
     arrst_destroy(&(*http)->headers, i_remove_field, Field);
     arrst_destroy(&(*http)->cookies, i_remove_field, Field);
-    oshttp_destroy(&(*http)->oshttp);
+    arrst_destroy(&(*http)->request, i_remove_field, Field);
+    ptr_destopt(stm_close, &(*http)->body, Stream);
     heap_delete(http, Http);
 }
 
@@ -280,15 +301,26 @@ void http_destroy(Http **http)
 static Http *i_create(const char_t *host, const uint16_t port, const bool_t secure)
 {
     Http *http = heap_new(Http);
-    http->oshttp = oshttp_create(host, port, secure);
+    http->oshttp = _httpconn_get(host, port, secure);
     http->host_name = str_c(host);
     http->host_port = port;
+    http->secure = secure;
     http->error = ENUM_MAX(ierror_t);
     http->rcode = UINT32_MAX;
     http->rmsg = NULL;
     http->rprotocol = NULL;
     http->headers = arrst_create(Field);
     http->cookies = arrst_create(Field);
+    http->request = arrst_create(Field);
+    http->redirected = FALSE;
+    http->sink = NULL;
+    http->func_chunk = NULL;
+    http->chunk_data = NULL;
+    http->func_progress = NULL;
+    http->progress_data = NULL;
+    http->body = NULL;
+    http->cache = NULL;
+    http->received = 0;
     return http;
 }
 
@@ -312,6 +344,7 @@ void http_clear_headers(Http *http)
 {
     cassert_no_null(http);
     oshttp_clear_headers(http->oshttp);
+    arrst_clear(http->request, i_remove_field, Field);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -323,7 +356,16 @@ bool_t http_add_header(Http *http, const char_t *name, const char_t *value)
     if (i_valid_header(name, value) == FALSE)
         return FALSE;
 
-    return oshttp_add_header(http->oshttp, name, value);
+    if (oshttp_add_header(http->oshttp, name, value) == TRUE)
+    {
+        /* Needed to restore the headers after a conditional request */
+        Field *field = arrst_new(http->request, Field);
+        field->name = str_c(name);
+        field->value = str_c(value);
+        return TRUE;
+    }
+
+    return FALSE;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -457,6 +499,9 @@ static void i_clear_response(Http *http)
     ptr_destopt(str_destroy, &http->rprotocol, String);
     ptr_destopt(str_destroy, &http->rmsg, String);
     arrst_clear(http->headers, i_remove_field, Field);
+    ptr_destopt(stm_close, &http->body, Stream);
+    http->redirected = FALSE;
+    http->received = 0;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -465,7 +510,10 @@ bool_t http_get(Http *http, const char_t *path, const byte_t *data, const uint32
 {
     cassert_no_null(http);
     i_clear_response(http);
-    oshttp_get(http->oshttp, path, data, size, TRUE, &http->error);
+    if (data == NULL && i_cacheable_request(http) == TRUE)
+        i_cache_get(http, path);
+    else
+        oshttp_get(http->oshttp, path, data, size, TRUE, &http->error);
     ptr_assign(error, http->error);
     return http->error == ekIOK ? TRUE : FALSE;
 }
@@ -516,6 +564,102 @@ bool_t http_delete(Http *http, const char_t *path, const byte_t *data, const uin
 
 /*---------------------------------------------------------------------------*/
 
+bool_t http_post_stream(Http *http, const char_t *path, Stream *data, const uint64_t size, ierror_t *error)
+{
+    cassert_no_null(http);
+    i_clear_response(http);
+    oshttp_request_stream(http->oshttp, "POST", path, data, size, TRUE, &http->error);
+    ptr_assign(error, http->error);
+    return http->error == ekIOK ? TRUE : FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t http_put_stream(Http *http, const char_t *path, Stream *data, const uint64_t size, ierror_t *error)
+{
+    cassert_no_null(http);
+    i_clear_response(http);
+    oshttp_request_stream(http->oshttp, "PUT", path, data, size, TRUE, &http->error);
+    ptr_assign(error, http->error);
+    return http->error == ekIOK ? TRUE : FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Called by the backend for each body chunk, while the request is running */
+static bool_t i_OnBody(Http *http, const byte_t *chunk, const uint32_t size, const uint64_t total)
+{
+    cassert_no_null(http);
+    http->received += size;
+
+    if (http->cache != NULL)
+        stm_write(http->cache, chunk, size);
+
+    if (http->sink != NULL)
+    {
+        stm_write(http->sink, chunk, size);
+        if (stm_state(http->sink) != ekSTOK)
+            return FALSE;
+    }
+    else if (http->func_chunk == NULL)
+    {
+        /* Only progress, the body is kept for http_response_body */
+        if (http->body == NULL)
+            http->body = stm_memory(16 * 1024);
+        stm_write(http->body, chunk, size);
+    }
+
+    if (http->func_chunk != NULL && http->func_chunk(http->chunk_data, chunk, size) == FALSE)
+        return FALSE;
+
+    if (http->func_progress != NULL)
+        http->func_progress(http->progress_data, http->received, total);
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_update_sink(Http *http)
+{
+    cassert_no_null(http);
+    if (http->sink != NULL || http->func_chunk != NULL || http->func_progress != NULL)
+        oshttp_response_sink(http->oshttp, (FPtr_oshttp_body)i_OnBody, http);
+    else
+        oshttp_response_sink(http->oshttp, NULL, NULL);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void http_response_stream(Http *http, Stream *body)
+{
+    cassert_no_null(http);
+    http->sink = body;
+    i_update_sink(http);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void http_response_callback_imp(Http *http, FPtr_http_chunk func_chunk, void *data)
+{
+    cassert_no_null(http);
+    http->func_chunk = func_chunk;
+    http->chunk_data = data;
+    i_update_sink(http);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void http_progress_imp(Http *http, FPtr_http_progress func_progress, void *data)
+{
+    cassert_no_null(http);
+    http->func_progress = func_progress;
+    http->progress_data = data;
+    i_update_sink(http);
+}
+
+/*---------------------------------------------------------------------------*/
+
 static bool_t i_is_status_line(const char_t *line)
 {
     cassert_no_null(line);
@@ -586,6 +730,65 @@ static bool_t i_parse_status_line(const char_t *line, String **protocol, uint32_
 
 /*---------------------------------------------------------------------------*/
 
+static bool_t i_parse_response(Http *http, Stream *stm)
+{
+    cassert_no_null(http);
+    cassert(http->rprotocol == NULL);
+    cassert(http->rmsg == NULL);
+
+    stm_lines(line, stm)
+
+        if (str_empty_c(line) == FALSE)
+        {
+            /* The headers could contain several responses (redirection)
+            We get the last one */
+            if (i_is_status_line(line) == TRUE)
+            {
+                String *protocol = NULL;
+                String *rmsg = NULL;
+                uint32_t rcode = UINT32_MAX;
+
+                if (i_parse_status_line(line, &protocol, &rcode, &rmsg) == FALSE)
+                {
+                    http->error = ekISERVER;
+                    return FALSE;
+                }
+
+                if (http->rcode != UINT32_MAX)
+                    http->redirected = TRUE;
+
+                str_destopt(&http->rprotocol);
+                str_destopt(&http->rmsg);
+                http->rprotocol = protocol;
+                http->rcode = rcode;
+                http->rmsg = rmsg;
+                arrst_clear(http->headers, i_remove_field, Field);
+            }
+            else if (str_str(line, ":") != NULL && http->rcode != UINT32_MAX)
+            {
+                Field *header = arrst_new(http->headers, Field);
+                str_split_trim(line, ":", &header->name, &header->value);
+            }
+            else
+            {
+                http->error = ekISERVER;
+                return FALSE;
+            }
+        }
+
+    stm_next(line, stm)
+
+    if (http->rcode == UINT32_MAX)
+    {
+        http->error = ekISERVER;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static bool_t i_response(Http *http)
 {
     cassert_no_null(http);
@@ -596,59 +799,9 @@ static bool_t i_response(Http *http)
             Stream *stm = oshttp_response(http->oshttp);
             if (stm != NULL)
             {
-                cassert(http->rprotocol == NULL);
-                cassert(http->rmsg == NULL);
-
-                stm_lines(line, stm)
-
-                    if (str_empty_c(line) == FALSE)
-                    {
-                        /* The headers could contain several responses (redirection)
-                        We get the last one */
-                        if (i_is_status_line(line) == TRUE)
-                        {
-                            String *protocol = NULL;
-                            String *rmsg = NULL;
-                            uint32_t rcode = UINT32_MAX;
-
-                            if (i_parse_status_line(line, &protocol, &rcode, &rmsg) == FALSE)
-                            {
-                                http->error = ekISERVER;
-                                stm_close(&stm);
-                                return FALSE;
-                            }
-
-                            str_destopt(&http->rprotocol);
-                            str_destopt(&http->rmsg);
-                            http->rprotocol = protocol;
-                            http->rcode = rcode;
-                            http->rmsg = rmsg;
-                            arrst_clear(http->headers, i_remove_field, Field);
-                        }
-                        else if (str_str(line, ":") != NULL && http->rcode != UINT32_MAX)
-                        {
-                            Field *header = arrst_new(http->headers, Field);
-                            str_split_trim(line, ":", &header->name, &header->value);
-                        }
-                        else
-                        {
-                            http->error = ekISERVER;
-                            stm_close(&stm);
-                            return FALSE;
-                        }
-                    }
-
-                stm_next(line, stm)
-
-                if (http->rcode == UINT32_MAX)
-                {
-                    http->error = ekISERVER;
-                    stm_close(&stm);
-                    return FALSE;
-                }
-
+                bool_t ok = i_parse_response(http, stm);
                 stm_close(&stm);
-                return TRUE;
+                return ok;
             }
             else
             {
@@ -759,15 +912,249 @@ const char_t *http_response_header(const Http *http, const char_t *name)
 
 bool_t http_response_body(const Http *http, Stream *body, ierror_t *error)
 {
-    ierror_t lerror;
+    ierror_t lerror = ekIOK;
     cassert_no_null(http);
-    oshttp_response_body(http->oshttp, body, &lerror);
+    if (http->body != NULL)
+    {
+        Http *lhttp = cast(http, Http);
+        stm_write(body, stm_buffer(lhttp->body), stm_buffer_size(lhttp->body));
+        stm_close(&lhttp->body);
+    }
+    /* The body has already been written to the sink */
+    else if (http->sink == NULL && http->func_chunk == NULL)
+    {
+        oshttp_response_body(http->oshttp, body, &lerror);
+    }
+
     ptr_assign(error, lerror);
     return lerror == ekIOK ? TRUE : FALSE;
 }
 
 /*---------------------------------------------------------------------------*/
 
+/* Requests that decide themselves about the cache */
+static bool_t i_cacheable_request(const Http *http)
+{
+    cassert_no_null(http);
+    arrst_foreach_const(field, http->request, Field)
+        const char_t *name = tc(field->name);
+        if (str_equ_nocase(name, "Range") == TRUE)
+            return FALSE;
+        if (str_equ_nocase(name, "Authorization") == TRUE)
+            return FALSE;
+        if (str_equ_nocase(name, "Cache-Control") == TRUE)
+            return FALSE;
+        if (str_equ_nocase(name, "If-None-Match") == TRUE)
+            return FALSE;
+        if (str_equ_nocase(name, "If-Modified-Since") == TRUE)
+            return FALSE;
+    arrst_end()
+    return _httpcache_enabled();
+}
+
+/*---------------------------------------------------------------------------*/
+
+static String *i_cache_url(const Http *http, const char_t *path)
+{
+    cassert_no_null(http);
+    return str_printf("%s://%s:%d%s", http->secure == TRUE ? "https" : "http", tc(http->host_name), http->host_port, path);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Status line and headers of the last response */
+static String *i_cache_headers(const Http *http)
+{
+    Stream *stm = stm_memory(1024);
+    String *headers = NULL;
+    cassert_no_null(http);
+    stm_printf(stm, "%s %u %s\n", tc(http->rprotocol), http->rcode, tc(http->rmsg));
+    arrst_foreach_const(field, http->headers, Field)
+        stm_printf(stm, "%s: %s\n", tc(field->name), tc(field->value));
+    arrst_end()
+    headers = stm_str(stm);
+    stm_close(&stm);
+    return headers;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Stored response, without network I/O */
+static void i_cache_serve(Http *http, const char_t *headers, Stream **body, const uint64_t size)
+{
+    Stream *stm = NULL;
+    cassert_no_null(http);
+    cassert_no_null(body);
+    i_clear_response(http);
+    http->error = ekIOK;
+    if (http->sink == NULL && http->func_chunk == NULL)
+        http->body = stm_memory(16 * 1024);
+
+    stm = stm_from_block(cast_const(headers, byte_t), str_len_c(headers));
+    if (i_parse_response(http, stm) == TRUE)
+    {
+        byte_t buffer[16 * 1024];
+        uint32_t rsize = 0;
+        while ((rsize = stm_read(*body, buffer, sizeof(buffer))) > 0)
+        {
+            if (i_OnBody(http, buffer, rsize, size) == FALSE)
+            {
+                http->error = ekISTREAM;
+                break;
+            }
+        }
+    }
+
+    stm_close(&stm);
+    stm_close(body);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_restore_headers(Http *http)
+{
+    cassert_no_null(http);
+    oshttp_clear_headers(http->oshttp);
+    arrst_foreach_const(field, http->request, Field)
+        oshttp_add_header(http->oshttp, tc(field->name), tc(field->value));
+    arrst_end()
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_cache_get(Http *http, const char_t *path)
+{
+    String *url = i_cache_url(http, path);
+    bool_t fresh = FALSE;
+    Stream *body = NULL;
+    uint64_t size = 0;
+    String *stored = _httpcache_lookup(tc(url), &fresh, &body, &size);
+    String *tmp = NULL;
+    cassert_no_null(http);
+
+    if (stored != NULL && fresh == TRUE)
+    {
+        i_cache_serve(http, tc(stored), &body, size);
+        str_destroy(&url);
+        str_destroy(&stored);
+        return;
+    }
+
+    /* Stale response, revalidate with the server */
+    if (stored != NULL)
+    {
+        String *etag = NULL;
+        String *modified = NULL;
+        _httpcache_validators(tc(stored), &etag, &modified);
+        if (etag != NULL)
+            oshttp_add_header(http->oshttp, "If-None-Match", tc(etag));
+        if (modified != NULL)
+            oshttp_add_header(http->oshttp, "If-Modified-Since", tc(modified));
+        str_destopt(&etag);
+        str_destopt(&modified);
+    }
+
+    /* The body goes to the cache and to the Http sink */
+    tmp = _httpcache_tmp();
+    if (tmp != NULL)
+        http->cache = stm_to_file(tc(tmp), NULL);
+    if (http->sink == NULL && http->func_chunk == NULL)
+        http->body = stm_memory(16 * 1024);
+
+    oshttp_response_sink(http->oshttp, (FPtr_oshttp_body)i_OnBody, http);
+    oshttp_get(http->oshttp, path, NULL, 0, TRUE, &http->error);
+    i_update_sink(http);
+
+    if (stored != NULL)
+        i_restore_headers(http);
+
+    if (http->cache != NULL)
+    {
+        bool_t ok = (bool_t)(stm_state(http->cache) == ekSTOK);
+        stm_close(&http->cache);
+        if (ok == FALSE)
+        {
+            bfile_delete(tc(tmp), NULL);
+            str_destroy(&tmp);
+        }
+    }
+
+    if (i_response(http) == TRUE)
+    {
+        String *headers = i_cache_headers(http);
+        if (http->rcode == 304 && stored != NULL)
+        {
+            /* The body opened in the lookup, even if the entry was evicted meanwhile */
+            String *merged = _httpcache_refresh(tc(url), tc(stored), tc(headers));
+            i_cache_serve(http, tc(merged), &body, size);
+            str_destroy(&merged);
+        }
+        else if (tmp != NULL && http->redirected == FALSE)
+        {
+            /* Release the stored body before replacing it */
+            ptr_destopt(stm_close, &body, Stream);
+            _httpcache_store(tc(url), tc(headers), &tmp);
+        }
+
+        str_destroy(&headers);
+    }
+
+    if (tmp != NULL)
+    {
+        bfile_delete(tc(tmp), NULL);
+        str_destroy(&tmp);
+    }
+
+    ptr_destopt(stm_close, &body, Stream);
+    str_destroy(&url);
+    str_destopt(&stored);
+}
+
+/*---------------------------------------------------------------------------*/
+
+OSHttp *_http_oshttp(Http *http)
+{
+    cassert_no_null(http);
+    return http->oshttp;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _http_same_host(const Http *http1, const Http *http2)
+{
+    cassert_no_null(http1);
+    cassert_no_null(http2);
+    if (http1->secure != http2->secure)
+        return FALSE;
+    if (http1->host_port != http2->host_port)
+        return FALSE;
+    return str_equ_nocase(tc(http1->host_name), tc(http2->host_name));
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _http_begin(Http *http)
+{
+    i_clear_response(http);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _http_end(Http *http, const ierror_t error)
+{
+    cassert_no_null(http);
+    http->error = error;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void http_keepalive(const uint32_t max_host, const uint32_t idle_timeout_ms)
+{
+    _httpconn_config(max_host, idle_timeout_ms);
+}
+
+/*---------------------------------------------------------------------------*/
+
 Stream *http_dget(const char_t *url, uint32_t *result, ierror_t *error)
 {
     Url *uurl = url_parse(url);
@@ -787,14 +1174,17 @@ Stream *http_dget(const char_t *url, uint32_t *result, ierror_t *error)
     if (http != NULL)
     {
         String *res = url_resource(uurl);
+        /* Avoid an intermediate copy of the body */
+        stm = stm_memory(2048);
+        http_response_stream(http, stm);
         if (http_get(http, tc(res), NULL, 0, error) == TRUE)
         {
             if (result != NULL)
                 *result = http_response_status(http);
-
-            stm = stm_memory(2048);
-            if (http_response_body(http, stm, error) == FALSE)
-                stm_close(&stm);
+        }
+        else
+        {
+            stm_close(&stm);
         }
 
         http_destroy(&http);
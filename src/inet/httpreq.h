@@ -51,6 +51,16 @@ _inet_api bool_t http_patch(Http *http, const char_t *path, const byte_t *data,
 
 _inet_api bool_t http_delete(Http *http, const char_t *path, const byte_t *data, const uint32_t size, ierror_t *error);
 
+_inet_api bool_t http_post_stream(Http *http, const char_t *path, Stream *data, const uint64_t size, ierror_t *error);
+
+_inet_api bool_t http_put_stream(Http *http, const char_t *path, Stream *data, const uint64_t size, ierror_t *error);
+
+_inet_api void http_response_stream(Http *http, Stream *body);
+
+_inet_api void http_response_callback_imp(Http *http, FPtr_http_chunk func_chunk, void *data);
+
+_inet_api void http_progress_imp(Http *http, FPtr_http_progress func_progress, void *data);
+
 _inet_api uint32_t http_response_status(const Http *http);
 
 _inet_api const char_t *http_response_protocol(const Http *http);
@@ -67,8 +77,22 @@ _inet_api const char_t *http_response_header(const Http *http, const char_t *nam
 
 _inet_api bool_t http_response_body(const Http *http, Stream *body, ierror_t *error);
 
+_inet_api void http_keepalive(const uint32_t max_host, const uint32_t idle_timeout_ms);
+
 _inet_api Stream *http_dget(const char_t *url, uint32_t *result, ierror_t *error);
 
 _inet_api bool_t http_exists(const char_t *url);
 
 __END_C
+
+#define http_response_callback(http, func_chunk, data, type) \
+    ( \
+        (void)(cast(data, type) == data), \
+        FUNC_CHECK_HTTP_CHUNK(func_chunk, type), \
+        http_response_callback_imp(http, (FPtr_http_chunk)func_chunk, cast(data, void)))
+
+#define http_progress(http, func_progress, data, type) \
+    ( \
+        (void)(cast(data, type) == data), \
+        FUNC_CHECK_HTTP_PROGRESS(func_progress, type), \
+        http_progress_imp(http, (FPtr_http_progress)func_progress, cast(data, void)))
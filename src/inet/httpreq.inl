@@ -0,0 +1,25 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: httpreq.inl
+ *
+ */
+
+/* HTTP request */
+
+#include "inet.ixx"
+
+__EXTERN_C
+
+OSHttp *_http_oshttp(Http *http);
+
+bool_t _http_same_host(const Http *http1, const Http *http2);
+
+void _http_begin(Http *http);
+
+void _http_end(Http *http, const ierror_t error);
+
+__END_C
@@ -11,6 +11,8 @@
 /* inet library */
 
 #include "inet.h"
+#include "httpcache.inl"
+#include "httpconn.inl"
 #include "oshttpreq.inl"
 #include <encode/encode.h>
 #include <osbs/log.h>
@@ -35,6 +37,8 @@ void inet_start(void)
     {
         encode_start();
         oshttp_init();
+        _httpconn_start();
+        _httpcache_start();
         blib_atexit(i_inet_atexit);
     }
 
@@ -48,6 +52,8 @@ void inet_finish(void)
     cassert(i_NUM_USERS > 0);
     if (i_NUM_USERS == 1)
     {
+        _httpcache_finish();
+        _httpconn_finish();
         oshttp_finish();
         encode_finish();
     }
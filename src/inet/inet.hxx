@@ -36,5 +36,18 @@ typedef enum _cookies_t
 } cookies_t;
 
 typedef struct _http_t Http;
+typedef struct _httppool_t HttpPool;
+
+typedef void (*FPtr_http_done)(void *data, Http *http, const ierror_t error);
+#define FUNC_CHECK_HTTP_DONE(func, type) \
+    (void)((void (*)(type *, Http *, const ierror_t))func == func)
+
+typedef bool_t (*FPtr_http_chunk)(void *data, const byte_t *chunk, const uint32_t size);
+#define FUNC_CHECK_HTTP_CHUNK(func, type) \
+    (void)((bool_t(*)(type *, const byte_t *, const uint32_t))func == func)
+
+typedef void (*FPtr_http_progress)(void *data, const uint64_t received, const uint64_t total);
+#define FUNC_CHECK_HTTP_PROGRESS(func, type) \
+    (void)((void (*)(type *, const uint64_t, const uint64_t))func == func)
 
 #endif
@@ -16,5 +16,8 @@
 #include "inet.hxx"
 
 typedef struct _oshttp_t OSHttp;
+typedef struct _oshttpmulti_t OSHttpMulti;
+
+typedef bool_t (*FPtr_oshttp_body)(void *data, const byte_t *chunk, const uint32_t size, const uint64_t total);
 
 #endif
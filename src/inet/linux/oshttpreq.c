@@ -31,8 +31,13 @@ struct _oshttp_t
     String *host;
     bool_t secure;
     cookies_t cookies;
+    bool_t flush;
     Stream *resp_headers;
     Stream *resp_data;
+    FPtr_oshttp_body func_body;
+    void *body_data;
+    Stream *upload;
+    uint64_t upload_size;
     ierror_t error;
 };
 
@@ -68,10 +73,15 @@ OSHttp *oshttp_create(const char_t *host, const uint16_t port, const bool_t secu
     http->curl = curl_easy_init();
     http->error = ekIOK;
     http->cookies = ekCOOKIES_ALL;
+    http->flush = FALSE;
     http->secure = secure;
     http->headers = NULL;
     http->resp_headers = NULL;
     http->resp_data = NULL;
+    http->func_body = NULL;
+    http->body_data = NULL;
+    http->upload = NULL;
+    http->upload_size = 0;
     http->host = str_c(host);
 
     if (http->curl != NULL)
@@ -116,6 +126,34 @@ void oshttp_destroy(OSHttp **http)
 
 /*---------------------------------------------------------------------------*/
 
+/*
+ * The easy handle keeps its live connections, DNS and TLS session caches.
+ * All the request options are set again in i_setup().
+ */
+bool_t oshttp_recycle(OSHttp *http)
+{
+    cassert_no_null(http);
+    if (http->curl == NULL || http->error != ekIOK)
+        return FALSE;
+
+    /* Cookies are written in curl_easy_cleanup(). Flush them only after requests (not on cache hits) */
+    if (http->cookies == ekCOOKIES_ALL && http->flush == TRUE)
+        curl_easy_setopt(http->curl, CURLOPT_COOKIELIST, "FLUSH");
+
+    http->flush = FALSE;
+    oshttp_clear_headers(http);
+    http->cookies = ekCOOKIES_ALL;
+    http->func_body = NULL;
+    http->body_data = NULL;
+    http->upload = NULL;
+    http->upload_size = 0;
+    ptr_destopt(stm_close, &http->resp_headers, Stream);
+    ptr_destopt(stm_close, &http->resp_data, Stream);
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
 void oshttp_clear_headers(OSHttp *http)
 {
     cassert_no_null(http);
@@ -164,7 +202,60 @@ static size_t i_write_response(char *buffer, size_t size, size_t nitems, void *u
 
 /*---------------------------------------------------------------------------*/
 
-static void i_request(OSHttp *http, const char *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
+static size_t i_write_sink(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    OSHttp *http = cast(userdata, OSHttp);
+    uint64_t total = 0;
+    cassert_no_null(http);
+    cassert_no_nullf(http->func_body);
+
+    /* Content-Length, if any */
+    {
+#if LIBCURL_VERSION_NUM >= 0x073700
+        curl_off_t length = -1;
+        if (curl_easy_getinfo(http->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length) == CURLE_OK && length > 0)
+            total = (uint64_t)length;
+#else
+        double length = -1;
+        if (curl_easy_getinfo(http->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &length) == CURLE_OK && length > 0)
+            total = (uint64_t)length;
+#endif
+    }
+
+    /* Other than size * nitems aborts the transfer with CURLE_WRITE_ERROR */
+    if (http->func_body(http->body_data, cast_const(buffer, byte_t), (uint32_t)(size * nitems), total) == FALSE)
+        return 0;
+
+    return nitems * size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Never read beyond the body size: socket streams would block */
+static size_t i_read_request(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    OSHttp *http = cast(userdata, OSHttp);
+    uint64_t bsize = (uint64_t)(size * nitems);
+    uint32_t rsize = 0;
+    cassert_no_null(http);
+    cassert_no_null(http->upload);
+    if (bsize > http->upload_size)
+        bsize = http->upload_size;
+
+    if (bsize == 0)
+        return 0;
+
+    rsize = stm_read(http->upload, cast(buffer, byte_t), (uint32_t)bsize);
+    if (rsize == 0)
+        return CURL_READFUNC_ABORT;
+
+    http->upload_size -= rsize;
+    return (size_t)rsize;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_setup(OSHttp *http, const char *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
 {
     int res = 0;
     cassert_no_null(http);
@@ -172,7 +263,7 @@ static void i_request(OSHttp *http, const char *verb, const char_t *path, const
     if (http->error != ekIOK)
     {
         ptr_assign(error, http->error);
-        return;
+        return FALSE;
     }
 
     /* Seems that CURLOPT_FOLLOWLOCATION fails */
@@ -186,11 +277,9 @@ static void i_request(OSHttp *http, const char *verb, const char_t *path, const
         str_destroy(&url);
     }
 
-    if (http->headers != NULL)
-    {
-        res = curl_easy_setopt(http->curl, CURLOPT_HTTPHEADER, http->headers);
-        cassert_unref(res == CURLE_OK, res);
-    }
+    /* NULL after oshttp_clear_headers() */
+    res = curl_easy_setopt(http->curl, CURLOPT_HTTPHEADER, http->headers);
+    cassert_unref(res == CURLE_OK, res);
 
     if (data != NULL)
     {
@@ -199,6 +288,12 @@ static void i_request(OSHttp *http, const char *verb, const char_t *path, const
         res = curl_easy_setopt(http->curl, CURLOPT_POSTFIELDS, cast(data, char));
         cassert_unref(res == CURLE_OK, res);
     }
+    else
+    {
+        /* Forget the body of a previous request */
+        res = curl_easy_setopt(http->curl, CURLOPT_HTTPGET, 1L);
+        cassert_unref(res == CURLE_OK, res);
+    }
 
     res = curl_easy_setopt(http->curl, CURLOPT_CUSTOMREQUEST, verb);
     cassert_unref(res == CURLE_OK, res);
@@ -222,6 +317,7 @@ static void i_request(OSHttp *http, const char *verb, const char_t *path, const
         curl_easy_setopt(http->curl, CURLOPT_COOKIEFILE, tc(cfile));
         /* Means, "write cookies to this file" */
         curl_easy_setopt(http->curl, CURLOPT_COOKIEJAR, tc(cfile));
+        http->flush = TRUE;
         str_destroy(&cname);
         str_destroy(&cfile);
         break;
@@ -236,28 +332,56 @@ static void i_request(OSHttp *http, const char *verb, const char_t *path, const
     if (http->resp_data != NULL)
         stm_close(&http->resp_data);
 
-    http->resp_headers = stm_memory(100 * 1024);
-    http->resp_data = stm_memory(1024 * 1024);
+    /* Memory streams grow as needed */
+    http->resp_headers = stm_memory(4 * 1024);
 
     res = curl_easy_setopt(http->curl, CURLOPT_HEADERFUNCTION, i_write_response);
     cassert(res == CURLE_OK);
     res = curl_easy_setopt(http->curl, CURLOPT_HEADERDATA, http->resp_headers);
     cassert(res == CURLE_OK);
 
-    res = curl_easy_setopt(http->curl, CURLOPT_WRITEFUNCTION, i_write_response);
-    cassert(res == CURLE_OK);
-    res = curl_easy_setopt(http->curl, CURLOPT_WRITEDATA, http->resp_data);
-    cassert(res == CURLE_OK);
-
-    res = curl_easy_perform(http->curl);
-    if (res == CURLE_OK)
+    if (http->func_body != NULL)
     {
-        ptr_assign(error, ekIOK);
+        res = curl_easy_setopt(http->curl, CURLOPT_WRITEFUNCTION, i_write_sink);
+        cassert(res == CURLE_OK);
+        res = curl_easy_setopt(http->curl, CURLOPT_WRITEDATA, http);
+        cassert(res == CURLE_OK);
     }
     else
     {
-        /* TODO: Error codes */
-        ptr_assign(error, ekISERVER);
+        http->resp_data = stm_memory(16 * 1024);
+        res = curl_easy_setopt(http->curl, CURLOPT_WRITEFUNCTION, i_write_response);
+        cassert(res == CURLE_OK);
+        res = curl_easy_setopt(http->curl, CURLOPT_WRITEDATA, http->resp_data);
+        cassert(res == CURLE_OK);
+    }
+
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ierror_t i_error(const CURLcode code)
+{
+    if (code == CURLE_OK)
+        return ekIOK;
+
+    /* Aborted by the body sink or request stream */
+    if (code == CURLE_WRITE_ERROR || code == CURLE_READ_ERROR || code == CURLE_ABORTED_BY_CALLBACK)
+        return ekISTREAM;
+
+    /* TODO: Error codes */
+    return ekISERVER;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_request(OSHttp *http, const char *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
+{
+    if (i_setup(http, verb, path, data, size, auto_redirect, error) == TRUE)
+    {
+        CURLcode res = curl_easy_perform(http->curl);
+        ptr_assign(error, i_error(res));
     }
 }
 
@@ -298,6 +422,41 @@ void oshttp_delete(OSHttp *http, const char_t *path, const byte_t *data, const u
 
 /*---------------------------------------------------------------------------*/
 
+void oshttp_request_stream(OSHttp *http, const char_t *verb, const char_t *path, Stream *data, const uint64_t size, const bool_t auto_redirect, ierror_t *error)
+{
+    cassert_no_null(data);
+    if (i_setup(http, verb, path, NULL, 0, auto_redirect, error) == TRUE)
+    {
+        CURLcode res = curl_easy_setopt(http->curl, CURLOPT_POST, 1L);
+        cassert_unref(res == CURLE_OK, res);
+        /* NULL fields: the body comes from the read function */
+        res = curl_easy_setopt(http->curl, CURLOPT_POSTFIELDS, NULL);
+        cassert_unref(res == CURLE_OK, res);
+        res = curl_easy_setopt(http->curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)size);
+        cassert_unref(res == CURLE_OK, res);
+        res = curl_easy_setopt(http->curl, CURLOPT_READFUNCTION, i_read_request);
+        cassert_unref(res == CURLE_OK, res);
+        res = curl_easy_setopt(http->curl, CURLOPT_READDATA, http);
+        cassert_unref(res == CURLE_OK, res);
+        http->upload = data;
+        http->upload_size = size;
+        res = curl_easy_perform(http->curl);
+        http->upload = NULL;
+        ptr_assign(error, i_error(res));
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_response_sink(OSHttp *http, FPtr_oshttp_body func_body, void *data)
+{
+    cassert_no_null(http);
+    http->func_body = func_body;
+    http->body_data = data;
+}
+
+/*---------------------------------------------------------------------------*/
+
 Stream *oshttp_response(OSHttp *http)
 {
     Stream *stm = NULL;
@@ -314,10 +473,14 @@ void oshttp_response_body(OSHttp *http, Stream *body, ierror_t *error)
     const byte_t *data = NULL;
     uint32_t size = 0;
     cassert_no_null(http);
-    data = stm_buffer(http->resp_data);
-    size = stm_buffer_size(http->resp_data);
-    stm_write(body, data, size);
-    stm_close(&http->resp_data);
+    if (http->resp_data != NULL)
+    {
+        data = stm_buffer(http->resp_data);
+        size = stm_buffer_size(http->resp_data);
+        stm_write(body, data, size);
+        stm_close(&http->resp_data);
+    }
+
     ptr_assign(error, ekIOK);
 }
 
@@ -424,6 +587,7 @@ void oshttp_cookie_delete(OSHttp *http, const char_t *name)
                 String *cdel = str_printf("%s\t%s\t%s\t%s\t0\t%s\t", fields[COOKIE_DOMAIN], fields[COOKIE_SUBDOMAINS], fields[COOKIE_PATH], fields[COOKIE_SECURE], fields[COOKIE_NAME]);
                 res = curl_easy_setopt(http->curl, CURLOPT_COOKIELIST, tc(cdel));
                 cassert_unref(res == CURLE_OK, res);
+                http->flush = TRUE;
                 str_destroy(&cdel);
                 break;
             }
@@ -432,3 +596,122 @@ void oshttp_cookie_delete(OSHttp *http, const char_t *name)
 
     curl_slist_free_all(cookies);
 }
+
+/*---------------------------------------------------------------------------*/
+
+struct _oshttpmulti_t
+{
+    CURLM *multi;
+};
+
+/*---------------------------------------------------------------------------*/
+
+OSHttpMulti *oshttp_multi_create(const uint32_t max_connections, const uint32_t max_host)
+{
+    CURLM *cmulti = curl_multi_init();
+    OSHttpMulti *multi = NULL;
+    CURLMcode res;
+
+    if (cmulti == NULL)
+        return NULL;
+
+    /* Easy handles in the same multi share the connection and DNS caches */
+    res = curl_multi_setopt(cmulti, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)max_connections);
+    cassert_unref(res == CURLM_OK, res);
+    res = curl_multi_setopt(cmulti, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max_host);
+    cassert_unref(res == CURLM_OK, res);
+    res = curl_multi_setopt(cmulti, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    cassert_unref(res == CURLM_OK, res);
+
+    multi = heap_new(OSHttpMulti);
+    multi->multi = cmulti;
+    return multi;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_destroy(OSHttpMulti **multi)
+{
+    cassert_no_null(multi);
+    cassert_no_null(*multi);
+    curl_multi_cleanup((*multi)->multi);
+    heap_delete(multi, OSHttpMulti);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t oshttp_multi_add(OSHttpMulti *multi, OSHttp *http, const char_t *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
+{
+    cassert_no_null(multi);
+    cassert_no_null(http);
+    if (i_setup(http, verb, path, data, size, auto_redirect, error) == TRUE)
+    {
+        CURLcode res = curl_easy_setopt(http->curl, CURLOPT_PRIVATE, http);
+        cassert_unref(res == CURLE_OK, res);
+        if (curl_multi_add_handle(multi->multi, http->curl) == CURLM_OK)
+            return TRUE;
+
+        ptr_assign(error, ekIUNDEF);
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_remove(OSHttpMulti *multi, OSHttp *http)
+{
+    cassert_no_null(multi);
+    cassert_no_null(http);
+    curl_multi_remove_handle(multi->multi, http->curl);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_wait(OSHttpMulti *multi, const uint32_t timeout_ms)
+{
+    int running = 0;
+    int timeout = timeout_ms > INT32_MAX ? INT32_MAX : (int)timeout_ms;
+    CURLMcode res;
+    cassert_no_null(multi);
+    res = curl_multi_perform(multi->multi, &running);
+    if (res == CURLM_OK && running > 0)
+    {
+#if LIBCURL_VERSION_NUM >= 0x074200
+        res = curl_multi_poll(multi->multi, NULL, 0, timeout, NULL);
+#else
+        res = curl_multi_wait(multi->multi, NULL, 0, timeout, NULL);
+#endif
+        if (res == CURLM_OK)
+            res = curl_multi_perform(multi->multi, &running);
+    }
+
+    cassert_unref(res == CURLM_OK, res);
+}
+
+/*---------------------------------------------------------------------------*/
+
+OSHttp *oshttp_multi_done(OSHttpMulti *multi, ierror_t *error)
+{
+    CURLMsg *msg = NULL;
+    int nmsgs = 0;
+    cassert_no_null(multi);
+    while ((msg = curl_multi_info_read(multi->multi, &nmsgs)) != NULL)
+    {
+        if (msg->msg == CURLMSG_DONE)
+        {
+            OSHttp *http = NULL;
+            CURL *curl = msg->easy_handle;
+            CURLcode code = msg->data.result;
+            curl_easy_getinfo(curl, CURLINFO_PRIVATE, cast(&http, char *));
+            cassert_no_null(http);
+            cassert(http->curl == curl);
+            /* The easy handle can be used again (also synchronously) */
+            curl_multi_remove_handle(multi->multi, curl);
+            ptr_assign(error, i_error(code));
+            return http;
+        }
+    }
+
+    return NULL;
+}
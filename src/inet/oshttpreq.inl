@@ -22,6 +22,9 @@ OSHttp *oshttp_create(const char_t *host, const uint16_t port, const bool_t secu
 
 void oshttp_destroy(OSHttp **http);
 
+/* Clears the handle state, keeping its connection. FALSE if it can't be reused */
+bool_t oshttp_recycle(OSHttp *http);
+
 void oshttp_clear_headers(OSHttp *http);
 
 bool_t oshttp_add_header(OSHttp *http, const char_t *name, const char_t *value);
@@ -38,6 +41,11 @@ void oshttp_patch(OSHttp *http, const char_t *path, const byte_t *data, const ui
 
 void oshttp_delete(OSHttp *http, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error);
 
+void oshttp_request_stream(OSHttp *http, const char_t *verb, const char_t *path, Stream *data, const uint64_t size, const bool_t auto_redirect, ierror_t *error);
+
+/* The response body goes to 'func_body' as it arrives. NULL to keep it for oshttp_response_body */
+void oshttp_response_sink(OSHttp *http, FPtr_oshttp_body func_body, void *data);
+
 Stream *oshttp_response(OSHttp *http);
 
 void oshttp_response_body(OSHttp *http, Stream *body, ierror_t *error);
@@ -46,4 +54,17 @@ Stream *oshttp_cookies(OSHttp *http);
 
 void oshttp_cookie_delete(OSHttp *http, const char_t *name);
 
+/* Returns NULL if the platform has no multi-transfer interface */
+OSHttpMulti *oshttp_multi_create(const uint32_t max_connections, const uint32_t max_host);
+
+void oshttp_multi_destroy(OSHttpMulti **multi);
+
+bool_t oshttp_multi_add(OSHttpMulti *multi, OSHttp *http, const char_t *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error);
+
+void oshttp_multi_remove(OSHttpMulti *multi, OSHttp *http);
+
+void oshttp_multi_wait(OSHttpMulti *multi, const uint32_t timeout_ms);
+
+OSHttp *oshttp_multi_done(OSHttpMulti *multi, ierror_t *error);
+
 __END_C
@@ -60,6 +60,8 @@ struct _oshttp_t
     String *protocol;
     Stream *headers;
     Stream *body;
+    FPtr_oshttp_body func_body;
+    void *body_data;
 };
 
 /*---------------------------------------------------------------------------*/
@@ -147,6 +149,8 @@ OSHttp *oshttp_create(const char_t *host, const uint16_t port, const bool_t secu
     http->protocol = NULL;
     http->headers = NULL;
     http->body = NULL;
+    http->func_body = NULL;
+    http->body_data = NULL;
     return http;
 }
 
@@ -177,6 +181,27 @@ void oshttp_destroy(OSHttp **http)
 
 /*---------------------------------------------------------------------------*/
 
+bool_t oshttp_recycle(OSHttp *http)
+{
+    cassert_no_null(http);
+    if (http->request == nil)
+        return FALSE;
+
+    /* Request headers are kept in NSMutableURLRequest */
+    [http->request release];
+    http->request = [[NSMutableURLRequest alloc] init];
+    http->response = FALSE;
+    http->cookies = ekCOOKIES_ALL;
+    http->func_body = NULL;
+    http->body_data = NULL;
+    str_destopt(&http->protocol);
+    ptr_destopt(stm_close, &http->headers, Stream);
+    ptr_destopt(stm_close, &http->body, Stream);
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static ___INLINE bool_t i_reserved_header(const char_t *header)
 {
     if (str_equ_nocase(header, "content-length") == TRUE)
@@ -208,7 +233,12 @@ static ___INLINE bool_t i_reserved_header(const char_t *header)
 void oshttp_clear_headers(OSHttp *http)
 {
     cassert_no_null(http);
-    unref(http);
+    if (http->request != nil)
+    {
+        /* Request headers are kept in NSMutableURLRequest */
+        [http->request release];
+        http->request = [[NSMutableURLRequest alloc] init];
+    }
 }
 
 /*---------------------------------------------------------------------------*/
@@ -442,6 +472,15 @@ static void i_request(OSHttp *http, NSString *verb, const char_t *path, const by
     }
 #endif
 
+    /* The completion handler gets the whole body, it's delivered in one chunk */
+    if (http->error == ekIOK && http->func_body != NULL)
+    {
+        uint32_t bsize = stm_buffer_size(http->body);
+        if (bsize > 0 && http->func_body(http->body_data, stm_buffer(http->body), bsize, (uint64_t)bsize) == FALSE)
+            http->error = ekISTREAM;
+        stm_close(&http->body);
+    }
+
     ptr_assign(error, http->error);
 }
 
@@ -482,6 +521,37 @@ void oshttp_delete(OSHttp *http, const char_t *path, const byte_t *data, const u
 
 /*---------------------------------------------------------------------------*/
 
+void oshttp_request_stream(OSHttp *http, const char_t *verb, const char_t *path, Stream *data, const uint64_t size, const bool_t auto_redirect, ierror_t *error)
+{
+    /* The body is sent from memory */
+    uint32_t dsize = size < UINT32_MAX ? (uint32_t)size : UINT32_MAX;
+    byte_t *ddata = heap_new_n(dsize > 0 ? dsize : 1, byte_t);
+    NSString *nsverb = [NSString stringWithUTF8String:verb];
+    cassert_no_null(data);
+    if (dsize > 0 && stm_read(data, ddata, dsize) != dsize)
+    {
+        http->error = ekISTREAM;
+        ptr_assign(error, ekISTREAM);
+    }
+    else
+    {
+        i_request(http, nsverb, path, ddata, dsize, auto_redirect, error);
+    }
+
+    heap_delete_n(&ddata, dsize > 0 ? dsize : 1, byte_t);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_response_sink(OSHttp *http, FPtr_oshttp_body func_body, void *data)
+{
+    cassert_no_null(http);
+    http->func_body = func_body;
+    http->body_data = data;
+}
+
+/*---------------------------------------------------------------------------*/
+
 Stream *oshttp_response(OSHttp *http)
 {
     Stream *stm = NULL;
@@ -503,7 +573,7 @@ void oshttp_response_body(OSHttp *http, Stream *body, ierror_t *error)
     cassert_no_null(http);
     cassert(http->response == TRUE);
 
-    if (http->error == ekIOK)
+    if (http->error == ekIOK && http->body != NULL)
     {
         uint32_t size = stm_buffer_size(http->body);
         stm_pipe(http->body, body, size);
@@ -587,3 +657,65 @@ void oshttp_cookie_delete(OSHttp *http, const char_t *name)
         }
     }
 }
+
+/*---------------------------------------------------------------------------*/
+
+/* Requests in HttpPool run synchronously in worker threads */
+OSHttpMulti *oshttp_multi_create(const uint32_t max_connections, const uint32_t max_host)
+{
+    unref(max_connections);
+    unref(max_host);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_destroy(OSHttpMulti **multi)
+{
+    unref(multi);
+    cassert(FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t oshttp_multi_add(OSHttpMulti *multi, OSHttp *http, const char_t *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
+{
+    unref(multi);
+    unref(http);
+    unref(verb);
+    unref(path);
+    unref(data);
+    unref(size);
+    unref(auto_redirect);
+    ptr_assign(error, ekINOIMPL);
+    cassert(FALSE);
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_remove(OSHttpMulti *multi, OSHttp *http)
+{
+    unref(multi);
+    unref(http);
+    cassert(FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_wait(OSHttpMulti *multi, const uint32_t timeout_ms)
+{
+    unref(multi);
+    unref(timeout_ms);
+    cassert(FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+OSHttp *oshttp_multi_done(OSHttpMulti *multi, ierror_t *error)
+{
+    unref(multi);
+    unref(error);
+    cassert(FALSE);
+    return NULL;
+}
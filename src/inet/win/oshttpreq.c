@@ -16,6 +16,7 @@
 #include <core/heap.h>
 #include <core/stream.h>
 #include <core/strings.h>
+#include <sewer/bmem.h>
 #include <sewer/bstd.h>
 #include <sewer/cassert.h>
 #include <sewer/ptr.h>
@@ -43,6 +44,8 @@ struct _oshttp_t
     cookies_t cookies;
     String *url;
     Stream *headers;
+    FPtr_oshttp_body func_body;
+    void *body_data;
 };
 
 /*---------------------------------------------------------------------------*/
@@ -111,6 +114,28 @@ void oshttp_destroy(OSHttp **http)
 
 /*---------------------------------------------------------------------------*/
 
+/* WinINet keeps the connection in hInternet if the last body was read */
+bool_t oshttp_recycle(OSHttp *http)
+{
+    cassert_no_null(http);
+    if (http->error != ekIOK)
+        return FALSE;
+
+    if (http->hRequest != NULL)
+    {
+        InternetCloseHandle(http->hRequest);
+        http->hRequest = NULL;
+    }
+
+    oshttp_clear_headers(http);
+    http->cookies = ekCOOKIES_ALL;
+    http->func_body = NULL;
+    http->body_data = NULL;
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
 void oshttp_clear_headers(OSHttp *http)
 {
     cassert_no_null(http);
@@ -144,11 +169,9 @@ void oshttp_cookies_policy(OSHttp *http, const cookies_t cookies)
 
 /*---------------------------------------------------------------------------*/
 
-static void i_request(OSHttp *http, const WCHAR *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
+static bool_t i_open(OSHttp *http, const WCHAR *verb, const char_t *path, const bool_t auto_redirect, ierror_t *error)
 {
     WCHAR wpath[1024];
-    uint64_t hsize = 0;
-    BOOL status = FALSE;
     DWORD flags = 0;
 
     cassert_no_null(http);
@@ -156,7 +179,7 @@ static void i_request(OSHttp *http, const WCHAR *verb, const char_t *path, const
     if (http->error != ekIOK)
     {
         ptr_assign(error, http->error);
-        return;
+        return FALSE;
     }
 
     unicode_convers(path, cast(wpath, char_t), ekUTF8, ekUTF16, sizeof(wpath));
@@ -192,23 +215,58 @@ static void i_request(OSHttp *http, const WCHAR *verb, const char_t *path, const
     if (http->hRequest == NULL)
     {
         ptr_assign(error, ekISERVER);
-        return;
+        return FALSE;
     }
 
-    hsize = stm_bytes_written(http->headers);
-    if (hsize > 0)
-    {
-        WCHAR *lpszHeaders = cast(stm_buffer(http->headers), WCHAR);
-        status = HttpSendRequest(http->hRequest, lpszHeaders, (DWORD)hsize / sizeof(WCHAR), (LPVOID)data, (DWORD)size);
-    }
-    else
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* With a sink, the body is read just after the request */
+static void i_read_sink(OSHttp *http, ierror_t *error)
+{
+    char szBuffer[4096];
+    DWORD dwByteRead = 0;
+    DWORD length = 0;
+    DWORD lsize = sizeof(DWORD);
+    uint64_t total = 0;
+
+    cassert_no_null(http);
+    cassert_no_nullf(http->func_body);
+    if (HttpQueryInfo(http->hRequest, HTTP_QUERY_CONTENT_LENGTH | HTTP_QUERY_FLAG_NUMBER, &length, &lsize, NULL) == TRUE)
+        total = (uint64_t)length;
+
+    do
     {
-        status = HttpSendRequest(http->hRequest, NULL, (DWORD)-1, (LPVOID)data, (DWORD)size);
-    }
+        if (InternetReadFile(http->hRequest, szBuffer, sizeof(szBuffer), &dwByteRead) == FALSE)
+        {
+            ptr_assign(error, ekISTREAM);
+            return;
+        }
+
+        if (dwByteRead > 0 && http->func_body(http->body_data, cast_const(szBuffer, byte_t), (uint32_t)dwByteRead, total) == FALSE)
+        {
+            ptr_assign(error, ekISTREAM);
+            return;
+        }
 
+    } while (dwByteRead);
+
+    ptr_assign(error, ekIOK);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_sent(OSHttp *http, const BOOL status, ierror_t *error)
+{
+    cassert_no_null(http);
     if (status == TRUE)
     {
-        ptr_assign(error, ekIOK);
+        if (http->func_body != NULL)
+            i_read_sink(http, error);
+        else
+            ptr_assign(error, ekIOK);
     }
     else
     {
@@ -220,6 +278,28 @@ static void i_request(OSHttp *http, const WCHAR *verb, const char_t *path, const
 
 /*---------------------------------------------------------------------------*/
 
+static void i_request(OSHttp *http, const WCHAR *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
+{
+    if (i_open(http, verb, path, auto_redirect, error) == TRUE)
+    {
+        uint64_t hsize = stm_bytes_written(http->headers);
+        BOOL status = FALSE;
+        if (hsize > 0)
+        {
+            WCHAR *lpszHeaders = cast(stm_buffer(http->headers), WCHAR);
+            status = HttpSendRequest(http->hRequest, lpszHeaders, (DWORD)hsize / sizeof(WCHAR), (LPVOID)data, (DWORD)size);
+        }
+        else
+        {
+            status = HttpSendRequest(http->hRequest, NULL, (DWORD)-1, (LPVOID)data, (DWORD)size);
+        }
+
+        i_sent(http, status, error);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
 void oshttp_get(OSHttp *http, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
 {
     i_request(http, L"GET", path, data, size, auto_redirect, error);
@@ -255,6 +335,60 @@ void oshttp_delete(OSHttp *http, const char_t *path, const byte_t *data, const u
 
 /*---------------------------------------------------------------------------*/
 
+void oshttp_request_stream(OSHttp *http, const char_t *verb, const char_t *path, Stream *data, const uint64_t size, const bool_t auto_redirect, ierror_t *error)
+{
+    WCHAR wverb[16];
+    cassert_no_null(data);
+    unicode_convers(verb, cast(wverb, char_t), ekUTF8, ekUTF16, sizeof(wverb));
+    if (i_open(http, wverb, path, auto_redirect, error) == TRUE)
+    {
+        INTERNET_BUFFERS buffers;
+        uint64_t hsize = stm_bytes_written(http->headers);
+        BOOL status = FALSE;
+        bmem_zero(&buffers, INTERNET_BUFFERS);
+        buffers.dwStructSize = sizeof(INTERNET_BUFFERS);
+        buffers.dwBufferTotal = (DWORD)size;
+        if (hsize > 0)
+        {
+            buffers.lpcszHeader = cast(stm_buffer(http->headers), WCHAR);
+            buffers.dwHeadersLength = (DWORD)hsize / sizeof(WCHAR);
+        }
+
+        status = HttpSendRequestEx(http->hRequest, &buffers, NULL, 0, 0);
+        if (status == TRUE)
+        {
+            byte_t buffer[4096];
+            uint64_t remain = size;
+            while (remain > 0 && status == TRUE)
+            {
+                uint32_t rsize = stm_read(data, buffer, remain < sizeof(buffer) ? (uint32_t)remain : sizeof32(buffer));
+                DWORD written = 0;
+                if (rsize == 0)
+                    status = FALSE;
+                else
+                    status = InternetWriteFile(http->hRequest, buffer, (DWORD)rsize, &written);
+                remain -= rsize;
+            }
+
+            if (status == TRUE)
+                status = HttpEndRequest(http->hRequest, NULL, 0, 0);
+        }
+
+        i_sent(http, status, error);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_response_sink(OSHttp *http, FPtr_oshttp_body func_body, void *data)
+{
+    cassert_no_null(http);
+    http->func_body = func_body;
+    http->body_data = data;
+}
+
+/*---------------------------------------------------------------------------*/
+
 Stream *oshttp_response(OSHttp *http)
 {
     cassert_no_null(http);
@@ -386,3 +520,65 @@ void oshttp_cookie_delete(OSHttp *http, const char_t *name)
     wstring_remove(&str1);
     wstring_remove(&str2);
 }
+
+/*---------------------------------------------------------------------------*/
+
+/* Requests in HttpPool run synchronously in worker threads */
+OSHttpMulti *oshttp_multi_create(const uint32_t max_connections, const uint32_t max_host)
+{
+    unref(max_connections);
+    unref(max_host);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_destroy(OSHttpMulti **multi)
+{
+    unref(multi);
+    cassert(FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t oshttp_multi_add(OSHttpMulti *multi, OSHttp *http, const char_t *verb, const char_t *path, const byte_t *data, const uint32_t size, const bool_t auto_redirect, ierror_t *error)
+{
+    unref(multi);
+    unref(http);
+    unref(verb);
+    unref(path);
+    unref(data);
+    unref(size);
+    unref(auto_redirect);
+    ptr_assign(error, ekINOIMPL);
+    cassert(FALSE);
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_remove(OSHttpMulti *multi, OSHttp *http)
+{
+    unref(multi);
+    unref(http);
+    cassert(FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void oshttp_multi_wait(OSHttpMulti *multi, const uint32_t timeout_ms)
+{
+    unref(multi);
+    unref(timeout_ms);
+    cassert(FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+
+OSHttp *oshttp_multi_done(OSHttpMulti *multi, ierror_t *error)
+{
+    unref(multi);
+    unref(error);
+    cassert(FALSE);
+    return NULL;
+}
@@ -27,8 +27,8 @@
 #include <core/hfile.h>
 #include <core/objh.h>
 #include <core/strings.h>
+#include <core/tpool.h>
 #include <osbs/bfile.h>
-#include <osbs/bthread.h>
 #include <osbs/log.h>
 #include <sewer/bstd.h>
 #include <sewer/cassert.h>
@@ -60,7 +60,7 @@ typedef enum _task_state_t
 struct i_task_t
 {
     OSApp *osapp;
-    Thread *thread;
+    Future *future;
     void *data;
     real64_t updtime;
     real64_t lastupd;
@@ -88,6 +88,7 @@ struct i_app_t
     FPtr_gctx_call func_async_call;
     String *locale;
     ArrPt(i_Task) *scheduler;
+    ThreadPool *task_pool;
 };
 
 DeclSt(i_Task);
@@ -99,7 +100,7 @@ static void i_destroy_task(i_Task **task)
 {
     cassert_no_null(task);
     cassert_no_null(*task);
-    bthread_close(&(*task)->thread);
+    ptr_destopt(future_destroy, &(*task)->future, Future);
     heap_delete(task, i_Task);
 }
 
@@ -122,6 +123,7 @@ static void i_destroy_app(i_App **app)
     ptr_destopt(clock_destroy, &(*app)->app_clock, Clock);
     str_destroy(&(*app)->locale);
     arrpt_destroy(&(*app)->scheduler, i_destroy_task, i_Task);
+    ptr_destopt(tpool_destroy, &(*app)->task_pool, ThreadPool);
     guictx_destroy(&(*app)->native_gui);
     obj_delete(app, i_App);
 }
@@ -150,19 +152,16 @@ static void i_terminate(void)
 
 /*---------------------------------------------------------------------------*/
 
-/* This function will run in a secondary thread
+/* This function will run in a worker thread of the task pool
 It should not call GUI functions */
 static uint32_t i_dispatch_task(i_Task *task)
 {
     uint32_t rvalue = UINT32_MAX;
     void *data;
     cassert_no_null(task);
-    cassert(task->state == i_ekSTATE_WAITING);
-    task->state = i_ekSTATE_RUNNING;
     data = _osapp_begin_thread(task->osapp);
     cassert_no_nullf(task->func_main);
     rvalue = task->func_main(task->data);
-    task->state = i_ekSTATE_FINISH;
     _osapp_end_thread(task->osapp, data);
     return rvalue;
 }
@@ -170,20 +169,26 @@ static uint32_t i_dispatch_task(i_Task *task)
 /*---------------------------------------------------------------------------*/
 
 /* This function runs in the MAIN thread */
-static void i_scheduler_cycle(ArrPt(i_Task) *scheduler, const real64_t crtime)
+static void i_scheduler_cycle(ArrPt(i_Task) *scheduler, ThreadPool *pool, const real64_t crtime)
 {
     i_Task *deleted_task = NULL;
 
     arrpt_foreach(task, scheduler, i_Task)
+        uint32_t rvalue = 0;
         if (task->state == i_ekSTATE_WAITING)
         {
-            cassert(task->thread == NULL);
-            task->thread = bthread_create(i_dispatch_task, task, i_Task);
+            cassert(task->future == NULL);
+            task->future = tpool_submit(pool, task, i_dispatch_task, i_Task);
+            task->state = i_ekSTATE_RUNNING;
             task->lastupd = crtime;
         }
         else if (task->state == i_ekSTATE_RUNNING)
         {
-            if (task->func_update != NULL)
+            if (future_ready(task->future, &rvalue) == TRUE)
+            {
+                task->state = i_ekSTATE_FINISH;
+            }
+            else if (task->func_update != NULL)
             {
                 if (crtime - task->lastupd > task->updtime)
                 {
@@ -192,11 +197,12 @@ static void i_scheduler_cycle(ArrPt(i_Task) *scheduler, const real64_t crtime)
                 }
             }
         }
-        else if (task->state == i_ekSTATE_FINISH)
+
+        if (task->state == i_ekSTATE_FINISH)
         {
             if (deleted_task == NULL)
             {
-                uint32_t rvalue = bthread_wait(task->thread);
+                rvalue = future_wait(task->future);
                 if (task->func_end != NULL)
                     task->func_end(task->data, rvalue);
                 deleted_task = task;
@@ -221,7 +227,7 @@ static void i_OnTimerSignal(i_App *app)
     {
         if (app->state == i_ekSTATE_RUNNING)
         {
-            i_scheduler_cycle(app->scheduler, crtime);
+            i_scheduler_cycle(app->scheduler, app->task_pool, crtime);
             gui_update_transitions(prtime, crtime);
 
             if (app->func_update != NULL)
@@ -356,6 +362,7 @@ void osmain_imp(
     app->func_async_call = NULL;
     app->locale = str_c("");
     app->scheduler = arrpt_create(i_Task);
+    app->task_pool = NULL;
     app->initialized = FALSE;
     app->terminated = FALSE;
     guictx_set_current(app->native_gui);
@@ -398,8 +405,11 @@ void osapp_task_imp(void *data, const real32_t updtime, FPtr_task_main func_task
     i_App *app = _osapp_listener(i_App);
     i_Task *task = heap_new0(i_Task);
     cassert_no_null(app);
+    /* Tasks can block on I/O. Not in the global pool, used by parallel algorithms */
+    if (app->task_pool == NULL)
+        app->task_pool = tpool_create(0);
     task->osapp = app->osapp;
-    task->thread = NULL;
+    task->future = NULL;
     task->data = data;
     task->updtime = updtime <= 0 && func_task_update ? .04 : updtime;
     task->lastupd = 0.;
@@ -55,6 +55,10 @@ _osbs_api bool_t bfile_seek(File *file, const int64_t offset, const file_seek_t
 
 _osbs_api uint64_t bfile_pos(const File *file);
 
+_osbs_api const byte_t *bfile_mmap(const char_t *pathname, uint64_t *size, ferror_t *error);
+
+_osbs_api void bfile_munmap(const byte_t **data, const uint64_t size);
+
 _osbs_api bool_t bfile_delete(const char_t *pathname, ferror_t *error);
 
 _osbs_api bool_t bfile_rename(const char_t *current_pathname, const char_t *new_pathname, ferror_t *error);
@@ -0,0 +1,426 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bpoll.c
+ *
+ */
+
+/* Socket readiness multiplexer */
+
+#include "bpoll.h"
+#include "bpoll.inl"
+#include "btime.h"
+#include "osbs.inl"
+#include <sewer/bmem.h>
+#include <sewer/cassert.h>
+
+typedef struct _entry_t i_Entry;
+typedef struct _timer_t i_Timer;
+
+struct _entry_t
+{
+    Socket *socket;
+    uint32_t events;
+    FPtr_poll_event func_event;
+    void *data;
+    i_Entry *next;
+};
+
+struct _timer_t
+{
+    uint64_t deadline;
+    uint32_t period;
+    uint32_t id;
+    FPtr_poll_timer func_timer;
+    void *data;
+};
+
+#define i_MAX_EVENTS 256
+
+struct _socketpoll_t
+{
+    PollImp *imp;
+    i_Entry **entries;
+    uint32_t nentries;
+    uint32_t maxentries;
+    i_Entry *zombies;
+    i_Timer *timers;
+    uint32_t ntimers;
+    uint32_t maxtimers;
+    uint32_t timer_id;
+    bool_t stop;
+    void *ready[i_MAX_EVENTS];
+    uint32_t revents[i_MAX_EVENTS];
+};
+
+/*---------------------------------------------------------------------------*/
+
+SocketPoll *bpoll_create(void)
+{
+    PollImp *imp = _bpoll_imp_create();
+    SocketPoll *poll = NULL;
+    if (imp == NULL)
+        return NULL;
+
+    poll = cast(bmem_malloc(sizeof(SocketPoll)), SocketPoll);
+    bmem_zero(poll, SocketPoll);
+    poll->imp = imp;
+    poll->maxentries = 16;
+    poll->entries = cast(bmem_malloc(poll->maxentries * sizeofptr), i_Entry *);
+    poll->maxtimers = 8;
+    poll->timers = cast(bmem_malloc(poll->maxtimers * sizeof(i_Timer)), i_Timer);
+    _osbs_poll_alloc();
+    return poll;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_free_zombies(SocketPoll *poll)
+{
+    while (poll->zombies != NULL)
+    {
+        i_Entry *next = poll->zombies->next;
+        bmem_free(cast(poll->zombies, byte_t));
+        poll->zombies = next;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bpoll_destroy(SocketPoll **poll)
+{
+    uint32_t i;
+    cassert_no_null(poll);
+    cassert_no_null(*poll);
+
+    /* Sockets are owned by the caller. Only the registrations are released */
+    for (i = 0; i < (*poll)->nentries; ++i)
+        bmem_free(cast((*poll)->entries[i], byte_t));
+
+    i_free_zombies(*poll);
+    bmem_free(cast((*poll)->entries, byte_t));
+    bmem_free(cast((*poll)->timers, byte_t));
+    _bpoll_imp_destroy(&(*poll)->imp);
+    bmem_free(cast(*poll, byte_t));
+    _osbs_poll_dealloc();
+    *poll = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Registrations sorted by socket handle */
+static bool_t i_search(const SocketPoll *poll, const Socket *socket, uint32_t *pos)
+{
+    uint32_t lo = 0, hi = poll->nentries;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        const Socket *msocket = poll->entries[mid]->socket;
+        if (msocket == socket)
+        {
+            *pos = mid;
+            return TRUE;
+        }
+
+        if ((uintptr_t)msocket < (uintptr_t)socket)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    *pos = lo;
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t bpoll_add_imp(SocketPoll *poll, Socket *socket, const uint32_t events, FPtr_poll_event func_event, void *data)
+{
+    i_Entry *entry = NULL;
+    uint32_t pos = 0;
+    cassert_no_null(poll);
+    cassert_no_null(socket);
+    cassert_no_nullf(func_event);
+
+    if (i_search(poll, socket, &pos) == TRUE)
+    {
+        /* Already registered */
+        cassert(FALSE);
+        return FALSE;
+    }
+
+    entry = cast(bmem_malloc(sizeof(i_Entry)), i_Entry);
+    entry->socket = socket;
+    entry->events = events;
+    entry->func_event = func_event;
+    entry->data = data;
+    entry->next = NULL;
+
+    if (_bpoll_imp_add(poll->imp, socket, events, entry) == FALSE)
+    {
+        bmem_free(cast(entry, byte_t));
+        return FALSE;
+    }
+
+    if (poll->nentries == poll->maxentries)
+    {
+        uint32_t maxentries = poll->maxentries * 2;
+        poll->entries = cast(bmem_realloc(cast(poll->entries, byte_t), poll->maxentries * sizeofptr, maxentries * sizeofptr), i_Entry *);
+        poll->maxentries = maxentries;
+    }
+
+    if (pos < poll->nentries)
+        bmem_move(cast(poll->entries + pos + 1, byte_t), cast(poll->entries + pos, byte_t), (poll->nentries - pos) * sizeofptr);
+    poll->entries[pos] = entry;
+    poll->nentries += 1;
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t bpoll_modify(SocketPoll *poll, Socket *socket, const uint32_t events)
+{
+    uint32_t pos = 0;
+    cassert_no_null(poll);
+    if (i_search(poll, socket, &pos) == TRUE)
+    {
+        i_Entry *entry = poll->entries[pos];
+        if (entry->events == events)
+            return TRUE;
+
+        if (_bpoll_imp_modify(poll->imp, socket, events, entry) == TRUE)
+        {
+            entry->events = events;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bpoll_remove(SocketPoll *poll, Socket *socket)
+{
+    uint32_t pos = 0;
+    cassert_no_null(poll);
+    if (i_search(poll, socket, &pos) == TRUE)
+    {
+        i_Entry *entry = poll->entries[pos];
+        _bpoll_imp_remove(poll->imp, socket);
+        if (pos + 1 < poll->nentries)
+            bmem_move(cast(poll->entries + pos, byte_t), cast(poll->entries + pos + 1, byte_t), (poll->nentries - pos - 1) * sizeofptr);
+        poll->nentries -= 1;
+
+        /* Events of this round could still point to the entry. It is released at the end */
+        entry->func_event = NULL;
+        entry->next = poll->zombies;
+        poll->zombies = entry;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t bpoll_size(const SocketPoll *poll)
+{
+    cassert_no_null(poll);
+    return poll->nentries;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint64_t i_now_ms(void)
+{
+    return btime_now() / 1000;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Timers are a binary min-heap by deadline */
+static void i_timer_up(i_Timer *timers, uint32_t i)
+{
+    i_Timer timer = timers[i];
+    while (i > 0)
+    {
+        uint32_t parent = (i - 1) / 2;
+        if (timers[parent].deadline <= timer.deadline)
+            break;
+        timers[i] = timers[parent];
+        i = parent;
+    }
+
+    timers[i] = timer;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_timer_down(i_Timer *timers, const uint32_t n, uint32_t i)
+{
+    i_Timer timer = timers[i];
+    for (;;)
+    {
+        uint32_t child = 2 * i + 1;
+        if (child >= n)
+            break;
+        if (child + 1 < n && timers[child + 1].deadline < timers[child].deadline)
+            child += 1;
+        if (timer.deadline <= timers[child].deadline)
+            break;
+        timers[i] = timers[child];
+        i = child;
+    }
+
+    timers[i] = timer;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_timer_push(SocketPoll *poll, const i_Timer *timer)
+{
+    if (poll->ntimers == poll->maxtimers)
+    {
+        uint32_t maxtimers = poll->maxtimers * 2;
+        poll->timers = cast(bmem_realloc(cast(poll->timers, byte_t), poll->maxtimers * sizeof32(i_Timer), maxtimers * sizeof32(i_Timer)), i_Timer);
+        poll->maxtimers = maxtimers;
+    }
+
+    poll->timers[poll->ntimers] = *timer;
+    poll->ntimers += 1;
+    i_timer_up(poll->timers, poll->ntimers - 1);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_timer_delete(SocketPoll *poll, const uint32_t i)
+{
+    cassert(i < poll->ntimers);
+    poll->ntimers -= 1;
+    if (i < poll->ntimers)
+    {
+        poll->timers[i] = poll->timers[poll->ntimers];
+        i_timer_up(poll->timers, i);
+        i_timer_down(poll->timers, poll->ntimers, i);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t bpoll_timer_imp(SocketPoll *poll, const uint32_t timeout_ms, const bool_t repeat, FPtr_poll_timer func_timer, void *data)
+{
+    i_Timer timer;
+    cassert_no_null(poll);
+    cassert_no_nullf(func_timer);
+    cassert(repeat == FALSE || timeout_ms > 0);
+    poll->timer_id += 1;
+    if (poll->timer_id == 0)
+        poll->timer_id = 1;
+    timer.deadline = i_now_ms() + timeout_ms;
+    timer.period = repeat == TRUE ? timeout_ms : 0;
+    timer.id = poll->timer_id;
+    timer.func_timer = func_timer;
+    timer.data = data;
+    i_timer_push(poll, &timer);
+    return timer.id;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bpoll_timer_cancel(SocketPoll *poll, const uint32_t timer_id)
+{
+    uint32_t i;
+    cassert_no_null(poll);
+    for (i = 0; i < poll->ntimers; ++i)
+    {
+        if (poll->timers[i].id == timer_id)
+        {
+            i_timer_delete(poll, i);
+            return;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_fire_timers(SocketPoll *poll)
+{
+    uint64_t now = i_now_ms();
+    uint32_t n = 0;
+    while (poll->ntimers > 0 && poll->timers[0].deadline <= now)
+    {
+        i_Timer timer = poll->timers[0];
+        i_timer_delete(poll, 0);
+
+        /* Rescheduled before the call, so the callback can cancel it */
+        if (timer.period > 0)
+        {
+            i_Timer next = timer;
+            next.deadline += timer.period;
+            if (next.deadline <= now)
+                next.deadline = now + timer.period;
+            i_timer_push(poll, &next);
+        }
+
+        timer.func_timer(timer.data, timer.id);
+        n += 1;
+    }
+
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t bpoll_wait(SocketPoll *poll, const uint32_t timeout_ms)
+{
+    uint32_t wait_ms = timeout_ms;
+    uint32_t nready, i, n = 0;
+    cassert_no_null(poll);
+
+    if (poll->ntimers > 0)
+    {
+        uint64_t now = i_now_ms();
+        uint64_t deadline = poll->timers[0].deadline;
+        uint64_t due = deadline > now ? deadline - now : 0;
+        if (due < (uint64_t)wait_ms)
+            wait_ms = (uint32_t)due;
+    }
+
+    nready = _bpoll_imp_wait(poll->imp, wait_ms, poll->ready, poll->revents, i_MAX_EVENTS);
+    for (i = 0; i < nready; ++i)
+    {
+        i_Entry *entry = cast(poll->ready[i], i_Entry);
+        if (entry == NULL)
+        {
+            poll->stop = TRUE;
+        }
+        else if (entry->func_event != NULL)
+        {
+            entry->func_event(entry->data, entry->socket, poll->revents[i]);
+            n += 1;
+        }
+    }
+
+    n += i_fire_timers(poll);
+    i_free_zombies(poll);
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bpoll_run(SocketPoll *poll)
+{
+    cassert_no_null(poll);
+    poll->stop = FALSE;
+    while (poll->stop == FALSE)
+        bpoll_wait(poll, UINT32_MAX);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bpoll_stop(SocketPoll *poll)
+{
+    cassert_no_null(poll);
+    _bpoll_imp_wake(poll->imp);
+}
@@ -0,0 +1,51 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bpoll.h
+ *
+ */
+
+/* Socket readiness multiplexer (epoll, kqueue, select) */
+
+#include "osbs.hxx"
+
+__EXTERN_C
+
+_osbs_api SocketPoll *bpoll_create(void);
+
+_osbs_api void bpoll_destroy(SocketPoll **poll);
+
+_osbs_api bool_t bpoll_add_imp(SocketPoll *poll, Socket *socket, const uint32_t events, FPtr_poll_event func_event, void *data);
+
+_osbs_api bool_t bpoll_modify(SocketPoll *poll, Socket *socket, const uint32_t events);
+
+_osbs_api void bpoll_remove(SocketPoll *poll, Socket *socket);
+
+_osbs_api uint32_t bpoll_size(const SocketPoll *poll);
+
+_osbs_api uint32_t bpoll_timer_imp(SocketPoll *poll, const uint32_t timeout_ms, const bool_t repeat, FPtr_poll_timer func_timer, void *data);
+
+_osbs_api void bpoll_timer_cancel(SocketPoll *poll, const uint32_t timer_id);
+
+_osbs_api uint32_t bpoll_wait(SocketPoll *poll, const uint32_t timeout_ms);
+
+_osbs_api void bpoll_run(SocketPoll *poll);
+
+_osbs_api void bpoll_stop(SocketPoll *poll);
+
+__END_C
+
+#define bpoll_add(poll, socket, events, func_event, data, type) \
+    ( \
+        (void)(cast(data, type) == data), \
+        FUNC_CHECK_POLL_EVENT(func_event, type), \
+        bpoll_add_imp(poll, socket, events, (FPtr_poll_event)func_event, cast(data, void)))
+
+#define bpoll_timer(poll, timeout_ms, repeat, func_timer, data, type) \
+    ( \
+        (void)(cast(data, type) == data), \
+        FUNC_CHECK_POLL_TIMER(func_timer, type), \
+        bpoll_timer_imp(poll, timeout_ms, repeat, (FPtr_poll_timer)func_timer, cast(data, void)))
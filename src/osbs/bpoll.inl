@@ -0,0 +1,34 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bpoll.inl
+ *
+ */
+
+/* Socket readiness multiplexer (platform backend) */
+
+#include "osbs.hxx"
+
+__EXTERN_C
+
+typedef struct _pollimp_t PollImp;
+
+PollImp *_bpoll_imp_create(void);
+
+void _bpoll_imp_destroy(PollImp **imp);
+
+bool_t _bpoll_imp_add(PollImp *imp, Socket *socket, const uint32_t events, void *entry);
+
+bool_t _bpoll_imp_modify(PollImp *imp, Socket *socket, const uint32_t events, void *entry);
+
+void _bpoll_imp_remove(PollImp *imp, Socket *socket);
+
+/* Returns the ready sockets. A NULL entry means a wake-up from _bpoll_imp_wake() */
+uint32_t _bpoll_imp_wait(PollImp *imp, const uint32_t timeout_ms, void **entries, uint32_t *events, const uint32_t max_events);
+
+void _bpoll_imp_wake(PollImp *imp);
+
+__END_C
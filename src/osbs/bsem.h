@@ -0,0 +1,25 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bsem.h
+ *
+ */
+
+/* Counting semaphores */
+
+#include "osbs.hxx"
+
+__EXTERN_C
+
+_osbs_api Semaphore *bsem_create(const uint32_t count);
+
+_osbs_api void bsem_close(Semaphore **sem);
+
+_osbs_api void bsem_wait(Semaphore *sem);
+
+_osbs_api void bsem_post(Semaphore *sem);
+
+__END_C
@@ -35,6 +35,12 @@ _osbs_api bool_t bsocket_read(Socket *socket, byte_t *data, const uint32_t size,
 
 _osbs_api bool_t bsocket_write(Socket *socket, const byte_t *data, const uint32_t size, uint32_t *wsize, serror_t *error);
 
+_osbs_api void bsocket_nonblocking(Socket *socket, const bool_t nonblocking);
+
+_osbs_api bool_t bsocket_recv(Socket *socket, byte_t *data, const uint32_t size, uint32_t *rsize, serror_t *error);
+
+_osbs_api bool_t bsocket_send(Socket *socket, const byte_t *data, const uint32_t size, uint32_t *wsize, serror_t *error);
+
 _osbs_api uint32_t bsocket_url_ip(const char_t *url, serror_t *error);
 
 _osbs_api uint32_t bsocket_str_ip(const char_t *ip);
@@ -0,0 +1,188 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bpoll.c
+ *
+ */
+
+/* Socket readiness multiplexer (epoll) */
+
+#include "../bpoll.inl"
+#include <sewer/bmem.h>
+#include <sewer/cassert.h>
+
+#if !defined(__LINUX__)
+#error This file is only for Linux system
+#endif
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define i_MAX_EVENTS 256
+
+struct _pollimp_t
+{
+    int epfd;
+    int wakefd;
+    struct epoll_event events[i_MAX_EVENTS];
+};
+
+/*---------------------------------------------------------------------------*/
+
+PollImp *_bpoll_imp_create(void)
+{
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    int wakefd = -1;
+    PollImp *imp = NULL;
+    struct epoll_event ev;
+
+    if (epfd == -1)
+        return NULL;
+
+    wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakefd == -1)
+    {
+        close(epfd);
+        return NULL;
+    }
+
+    /* Wake-ups come with a NULL entry */
+    bmem_zero(&ev, struct epoll_event);
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, wakefd, &ev) == -1)
+    {
+        close(wakefd);
+        close(epfd);
+        return NULL;
+    }
+
+    imp = cast(bmem_malloc(sizeof(PollImp)), PollImp);
+    imp->epfd = epfd;
+    imp->wakefd = wakefd;
+    return imp;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_destroy(PollImp **imp)
+{
+    cassert_no_null(imp);
+    cassert_no_null(*imp);
+    close((*imp)->wakefd);
+    close((*imp)->epfd);
+    bmem_free(*dcast(imp, byte_t));
+    *imp = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_epoll_events(const uint32_t events)
+{
+    uint32_t ev = 0;
+    if (events & ekPOLL_READ)
+        ev |= EPOLLIN | EPOLLRDHUP;
+    if (events & ekPOLL_WRITE)
+        ev |= EPOLLOUT;
+    if (events & ekPOLL_EDGE)
+        ev |= EPOLLET;
+    return ev;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_ctl(PollImp *imp, const int op, Socket *socket, const uint32_t events, void *entry)
+{
+    struct epoll_event ev;
+    cassert_no_null(imp);
+    bmem_zero(&ev, struct epoll_event);
+    ev.events = i_epoll_events(events);
+    ev.data.ptr = entry;
+    return (bool_t)(epoll_ctl(imp->epfd, op, (int)(intptr_t)socket, &ev) == 0);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _bpoll_imp_add(PollImp *imp, Socket *socket, const uint32_t events, void *entry)
+{
+    return i_ctl(imp, EPOLL_CTL_ADD, socket, events, entry);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _bpoll_imp_modify(PollImp *imp, Socket *socket, const uint32_t events, void *entry)
+{
+    return i_ctl(imp, EPOLL_CTL_MOD, socket, events, entry);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_remove(PollImp *imp, Socket *socket)
+{
+    struct epoll_event ev;
+    cassert_no_null(imp);
+    bmem_zero(&ev, struct epoll_event);
+    /* Fails if the socket is already closed (and removed by the kernel) */
+    epoll_ctl(imp->epfd, EPOLL_CTL_DEL, (int)(intptr_t)socket, &ev);
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t _bpoll_imp_wait(PollImp *imp, const uint32_t timeout_ms, void **entries, uint32_t *events, const uint32_t max_events)
+{
+    int timeout = timeout_ms == UINT32_MAX ? -1 : (timeout_ms > INT32_MAX ? INT32_MAX : (int)timeout_ms);
+    int max = (int)(max_events < i_MAX_EVENTS ? max_events : i_MAX_EVENTS);
+    int i, n;
+    cassert_no_null(imp);
+    cassert_no_null(entries);
+    cassert_no_null(events);
+
+    n = epoll_wait(imp->epfd, imp->events, max, timeout);
+    if (n <= 0)
+    {
+        /* Timeout or EINTR */
+        cassert(n == 0 || errno == EINTR);
+        return 0;
+    }
+
+    for (i = 0; i < n; ++i)
+    {
+        uint32_t ev = imp->events[i].events;
+        uint32_t rev = 0;
+        entries[i] = imp->events[i].data.ptr;
+        if (entries[i] == NULL)
+        {
+            uint64_t value;
+            ssize_t r = read(imp->wakefd, &value, sizeof(value));
+            unref(r);
+        }
+
+        if (ev & EPOLLIN)
+            rev |= ekPOLL_READ;
+        if (ev & EPOLLOUT)
+            rev |= ekPOLL_WRITE;
+        if (ev & (EPOLLHUP | EPOLLRDHUP))
+            rev |= ekPOLL_CLOSE;
+        if (ev & EPOLLERR)
+            rev |= ekPOLL_ERROR;
+        events[i] = rev;
+    }
+
+    return (uint32_t)n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_wake(PollImp *imp)
+{
+    uint64_t value = 1;
+    ssize_t r;
+    cassert_no_null(imp);
+    r = write(imp->wakefd, &value, sizeof(value));
+    unref(r);
+}
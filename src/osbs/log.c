@@ -12,27 +12,94 @@
 
 #include "log.h"
 #include "log.inl"
+#include "osbs.h"
 #include "bfile.h"
 #include "bmutex.h"
+#include "bthread.h"
 #include "btime.h"
 #include <sewer/blib.h>
+#include <sewer/bmem.h>
 #include <sewer/cassert.h>
 #include <sewer/bstd.h>
 
+typedef struct _ring_t i_Ring;
+
+struct _ring_t
+{
+    Mutex *mutex;
+    byte_t *data;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropped;
+};
+
 /*---------------------------------------------------------------------------*/
 
 static Mutex *i_LOG_MUTEX = NULL;
 static bool_t i_LOG_STDOUT = TRUE;
 static bool_t i_LOG_STDERR = FALSE;
 static char_t i_LOG_FILEPATH[512] = "";
+static uint64_t i_LOG_FILESIZE = 0;
+static uint64_t i_LOG_FILETIME = 0;
+static uint64_t i_LOG_MAXSIZE = 0;
+static uint32_t i_LOG_MAXSECS = 0;
+static uint32_t i_LOG_MAXFILES = 0;
+
+/* Asynchronous mode: per-thread rings drained by a writer thread */
+static Mutex *i_LOG_DRAIN = NULL;
+static i_Ring *i_LOG_RINGS = NULL;
+static uint32_t i_LOG_NUM_RINGS = 0;
+static uint32_t i_LOG_NEXT_RING = 0;
+static uint32_t i_LOG_RINGS_ID = 0;
+static uint32_t i_LOG_RING_SIZE = 0;
+static logfull_t i_LOG_FULL = ekLOG_DROP;
+static volatile bool_t i_LOG_ASYNC = FALSE;
+static bool_t i_LOG_RUNNING = FALSE;
+static Thread *i_LOG_WRITER = NULL;
+static File *i_LOG_FILE = NULL;
+static byte_t *i_LOG_CHUNK = NULL;
+static byte_t *i_LOG_FBATCH = NULL;
+static byte_t *i_LOG_SBATCH = NULL;
+static __THREAD_LOCAL i_Ring *i_THREAD_RING = NULL;
+static __THREAD_LOCAL uint32_t i_THREAD_RINGS_ID = 0;
+
 #define BUFSIZE 2048
+#define MIN_RING_SIZE 8192
+#define MAX_RING_SIZE 0x10000000
+#define MAX_RINGS 64
+#define WRITER_SLEEP 10
 
 /*---------------------------------------------------------------------------*/
 
 void _log_start(void)
 {
     cassert(i_LOG_MUTEX == NULL);
+    cassert(i_LOG_DRAIN == NULL);
     i_LOG_MUTEX = bmutex_create();
+    i_LOG_DRAIN = bmutex_create();
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_async_stop(void);
+
+/*---------------------------------------------------------------------------*/
+
+static void i_free_buffers(void)
+{
+    if (i_LOG_RING_SIZE > 0)
+    {
+        uint32_t i;
+        for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+            bmem_free(i_LOG_RINGS[i].data);
+        bmem_free(i_LOG_CHUNK);
+        bmem_free(i_LOG_FBATCH);
+        bmem_free(i_LOG_SBATCH);
+        i_LOG_CHUNK = NULL;
+        i_LOG_FBATCH = NULL;
+        i_LOG_SBATCH = NULL;
+        i_LOG_RING_SIZE = 0;
+    }
 }
 
 /*---------------------------------------------------------------------------*/
@@ -40,6 +107,21 @@ void _log_start(void)
 void _log_finish(void)
 {
     cassert(i_LOG_MUTEX != NULL);
+    cassert(i_LOG_DRAIN != NULL);
+    i_async_stop();
+    if (i_LOG_RINGS != NULL)
+    {
+        uint32_t i;
+        i_free_buffers();
+        for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+            bmutex_close(&i_LOG_RINGS[i].mutex);
+        bmem_free(cast(i_LOG_RINGS, byte_t));
+        i_LOG_RINGS = NULL;
+        i_LOG_NUM_RINGS = 0;
+        i_LOG_NEXT_RING = 0;
+    }
+
+    bmutex_close(&i_LOG_DRAIN);
     bmutex_close(&i_LOG_MUTEX);
 }
 
@@ -61,10 +143,374 @@ static void i_unlock(void)
 
 /*---------------------------------------------------------------------------*/
 
+static void i_create_file(void)
+{
+    File *file = bfile_create(i_LOG_FILEPATH, NULL);
+    if (file != NULL)
+        bfile_close(&file);
+    i_LOG_FILESIZE = 0;
+    i_LOG_FILETIME = btime_now();
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* 'log.txt' -> 'log.txt.1' -> ... -> 'log.txt.n' (deleted) */
+static void i_rotate(void)
+{
+    if (i_LOG_FILE != NULL)
+        bfile_close(&i_LOG_FILE);
+
+    if (i_LOG_MAXFILES > 0)
+    {
+        char_t src[544];
+        char_t dest[544];
+        uint32_t i;
+        bstd_sprintf(dest, sizeof32(dest), "%s.%u", i_LOG_FILEPATH, i_LOG_MAXFILES);
+        bfile_delete(dest, NULL);
+        for (i = i_LOG_MAXFILES; i > 1; --i)
+        {
+            bstd_sprintf(src, sizeof32(src), "%s.%u", i_LOG_FILEPATH, i - 1);
+            bstd_sprintf(dest, sizeof32(dest), "%s.%u", i_LOG_FILEPATH, i);
+            bfile_rename(src, dest, NULL);
+        }
+
+        bstd_sprintf(dest, sizeof32(dest), "%s.1", i_LOG_FILEPATH);
+        bfile_rename(i_LOG_FILEPATH, dest, NULL);
+    }
+
+    i_create_file();
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_write_file(const byte_t *data, const uint32_t size)
+{
+    cassert(i_LOG_FILEPATH[0] != '\0');
+    if (i_LOG_MAXSIZE > 0 && i_LOG_FILESIZE > 0 && i_LOG_FILESIZE + size > i_LOG_MAXSIZE)
+        i_rotate();
+    else if (i_LOG_MAXSECS > 0 && btime_now() - i_LOG_FILETIME >= (uint64_t)i_LOG_MAXSECS * 1000000)
+        i_rotate();
+
+    /* Asynchronous mode keeps the file open between batches */
+    if (i_LOG_FILE == NULL && i_LOG_ASYNC == TRUE)
+        i_LOG_FILE = bfile_open(i_LOG_FILEPATH, ekAPPEND, NULL);
+
+    if (i_LOG_FILE != NULL)
+    {
+        bfile_write(i_LOG_FILE, data, size, NULL, NULL);
+    }
+    else
+    {
+        File *file = bfile_open(i_LOG_FILEPATH, ekAPPEND, NULL);
+        if (file != NULL)
+        {
+            bfile_write(file, data, size, NULL, NULL);
+            bfile_close(&file);
+        }
+    }
+
+    i_LOG_FILESIZE += size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_ring_write(i_Ring *ring, const byte_t *data, const uint32_t size)
+{
+    uint32_t pos = ring->head & (i_LOG_RING_SIZE - 1);
+    uint32_t n = i_LOG_RING_SIZE - pos;
+    if (n >= size)
+    {
+        bmem_copy(ring->data + pos, data, size);
+    }
+    else
+    {
+        bmem_copy(ring->data + pos, data, n);
+        bmem_copy(ring->data, data + n, size - n);
+    }
+    ring->head += size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_ring_read(i_Ring *ring, byte_t *data)
+{
+    uint32_t size = ring->head - ring->tail;
+    if (size > 0)
+    {
+        uint32_t pos = ring->tail & (i_LOG_RING_SIZE - 1);
+        uint32_t n = i_LOG_RING_SIZE - pos;
+        if (n >= size)
+        {
+            bmem_copy(data, ring->data + pos, size);
+        }
+        else
+        {
+            bmem_copy(data, ring->data + pos, n);
+            bmem_copy(data + n, ring->data, size - n);
+        }
+        ring->tail = ring->head;
+    }
+    return size;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_write_batch(const uint32_t fsize, const uint32_t ssize)
+{
+    bmutex_lock(i_LOG_MUTEX);
+
+    if (i_LOG_STDOUT == TRUE)
+        bstd_write(i_LOG_SBATCH, ssize, NULL);
+
+    if (i_LOG_STDERR == TRUE)
+        bstd_ewrite(i_LOG_SBATCH, ssize, NULL);
+
+    if (i_LOG_FILEPATH[0] != '\0')
+        i_write_file(i_LOG_FBATCH, fsize);
+
+    bmutex_unlock(i_LOG_MUTEX);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Ring records are [uint32_t size][line], without end of line */
+static void i_format(const byte_t *chunk, const uint32_t size, uint32_t *fsize, uint32_t *ssize)
+{
+    uint32_t i = 0;
+    cassert_no_null(fsize);
+    cassert_no_null(ssize);
+    while (i < size)
+    {
+        uint32_t n;
+        bmem_copy(cast(&n, byte_t), chunk + i, sizeof32(uint32_t));
+        i += sizeof32(uint32_t);
+        cassert(n > 0 && i + n <= size);
+        bmem_copy(i_LOG_FBATCH + *fsize, chunk + i, n);
+        bmem_copy(i_LOG_SBATCH + *ssize, chunk + i, n);
+        i_LOG_FBATCH[*fsize + n] = '\r';
+        i_LOG_FBATCH[*fsize + n + 1] = '\n';
+        i_LOG_SBATCH[*ssize + n] = '\n';
+        *fsize += n + 2;
+        *ssize += n + 1;
+        i += n;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Empty all rings in as few writes as possible */
+static uint32_t i_drain(void)
+{
+    uint32_t total = 0;
+    uint32_t fsize = 0;
+    uint32_t ssize = 0;
+    uint32_t i;
+
+    bmutex_lock(i_LOG_DRAIN);
+    for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+    {
+        i_Ring *ring = i_LOG_RINGS + i;
+        uint32_t n;
+        bmutex_lock(ring->mutex);
+        n = i_ring_read(ring, i_LOG_CHUNK);
+        bmutex_unlock(ring->mutex);
+
+        if (n > 0)
+        {
+            /* A formatted chunk is never bigger than the chunk itself */
+            if (fsize + n > 2 * i_LOG_RING_SIZE)
+            {
+                i_write_batch(fsize, ssize);
+                fsize = 0;
+                ssize = 0;
+            }
+
+            i_format(i_LOG_CHUNK, n, &fsize, &ssize);
+            total += n;
+        }
+    }
+
+    if (fsize > 0)
+        i_write_batch(fsize, ssize);
+
+    bmutex_unlock(i_LOG_DRAIN);
+    return total;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_writer_main(i_Ring *rings)
+{
+    bool_t running = TRUE;
+    unref(rings);
+    while (running == TRUE)
+    {
+        /* Sleeping while the queues are almost empty groups lines in bigger writes */
+        if (i_drain() < i_LOG_RING_SIZE / 2)
+            bthread_sleep(WRITER_SLEEP);
+
+        bmutex_lock(i_LOG_MUTEX);
+        running = i_LOG_RUNNING;
+        bmutex_unlock(i_LOG_MUTEX);
+    }
+
+    i_drain();
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static i_Ring *i_thread_ring(void)
+{
+    if (__FALSE_EXPECTED(i_THREAD_RING == NULL || i_THREAD_RINGS_ID != i_LOG_RINGS_ID))
+    {
+        bmutex_lock(i_LOG_MUTEX);
+        i_THREAD_RING = i_LOG_RINGS + i_LOG_NEXT_RING;
+        i_THREAD_RINGS_ID = i_LOG_RINGS_ID;
+        i_LOG_NEXT_RING += 1;
+        if (i_LOG_NEXT_RING == i_LOG_NUM_RINGS)
+            i_LOG_NEXT_RING = 0;
+        bmutex_unlock(i_LOG_MUTEX);
+    }
+
+    return i_THREAD_RING;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_async_push(const char_t *line, const uint32_t size, bool_t *dropped)
+{
+    i_Ring *ring = i_thread_ring();
+    cassert_no_null(dropped);
+    for (;;)
+    {
+        bmutex_lock(ring->mutex);
+
+        /* Async mode has been disabled while we were waiting for the ring */
+        if (i_LOG_ASYNC == FALSE)
+        {
+            bmutex_unlock(ring->mutex);
+            return FALSE;
+        }
+
+        if (ring->head - ring->tail + size + sizeof32(uint32_t) <= i_LOG_RING_SIZE)
+        {
+            i_ring_write(ring, cast_const(&size, byte_t), sizeof32(uint32_t));
+            i_ring_write(ring, cast_const(line, byte_t), size);
+            bmutex_unlock(ring->mutex);
+            *dropped = FALSE;
+            return TRUE;
+        }
+
+        if (i_LOG_FULL == ekLOG_DROP)
+        {
+            ring->dropped += 1;
+            bmutex_unlock(ring->mutex);
+            *dropped = TRUE;
+            return TRUE;
+        }
+
+        /* Backpressure: the producer empties the queues by itself */
+        bmutex_unlock(ring->mutex);
+        i_drain();
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static uint32_t i_num_rings(void)
+{
+    /* One ring for main thread and two per core for worker threads */
+    uint32_t n = 1 + 2 * osbs_ncpus();
+    return n < MAX_RINGS ? n : MAX_RINGS;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_async_start(const uint32_t ring_size, const logfull_t full)
+{
+    uint32_t size = MIN_RING_SIZE;
+    uint32_t i;
+    cassert(i_LOG_ASYNC == FALSE);
+    cassert(i_LOG_WRITER == NULL);
+
+    while (size < ring_size && size < MAX_RING_SIZE)
+        size <<= 1;
+
+    if (i_LOG_RINGS == NULL)
+    {
+        i_LOG_NUM_RINGS = i_num_rings();
+        i_LOG_RINGS = cast(bmem_malloc(i_LOG_NUM_RINGS * sizeof32(i_Ring)), i_Ring);
+        for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+        {
+            i_LOG_RINGS[i].mutex = bmutex_create();
+            i_LOG_RINGS[i].data = NULL;
+            i_LOG_RINGS[i].dropped = 0;
+        }
+        i_LOG_RINGS_ID += 1;
+    }
+
+    /* Rings are empty and untouched while async mode is off */
+    if (size != i_LOG_RING_SIZE)
+    {
+        i_free_buffers();
+        for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+            i_LOG_RINGS[i].data = bmem_malloc(size);
+        i_LOG_CHUNK = bmem_malloc(size);
+        i_LOG_FBATCH = bmem_malloc(2 * size);
+        i_LOG_SBATCH = bmem_malloc(2 * size);
+        i_LOG_RING_SIZE = size;
+    }
+
+    for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+    {
+        i_LOG_RINGS[i].head = 0;
+        i_LOG_RINGS[i].tail = 0;
+    }
+
+    bmutex_lock(i_LOG_MUTEX);
+    i_LOG_FULL = full;
+    i_LOG_RUNNING = TRUE;
+    i_LOG_ASYNC = TRUE;
+    bmutex_unlock(i_LOG_MUTEX);
+    i_LOG_WRITER = bthread_create(i_writer_main, i_LOG_RINGS, i_Ring);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_async_stop(void)
+{
+    uint32_t i;
+    if (i_LOG_ASYNC == FALSE)
+        return;
+
+    /* After this, no producer can push into the rings */
+    for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+        bmutex_lock(i_LOG_RINGS[i].mutex);
+
+    i_LOG_ASYNC = FALSE;
+
+    for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+        bmutex_unlock(i_LOG_RINGS[i].mutex);
+
+    /* The writer empties the rings before exit */
+    bmutex_lock(i_LOG_MUTEX);
+    i_LOG_RUNNING = FALSE;
+    bmutex_unlock(i_LOG_MUTEX);
+    bthread_wait(i_LOG_WRITER);
+    bthread_close(&i_LOG_WRITER);
+
+    bmutex_lock(i_LOG_MUTEX);
+    if (i_LOG_FILE != NULL)
+        bfile_close(&i_LOG_FILE);
+    bmutex_unlock(i_LOG_MUTEX);
+}
+
+/*---------------------------------------------------------------------------*/
+
 uint32_t log_printf(const char_t *format, ...)
 {
-    char_t time_buffer[32];
-    char_t msg_buffer[BUFSIZE];
+    char_t line[BUFSIZE + 32];
     uint32_t time_size = 0;
     uint32_t msg_size = 0;
     uint32_t total_size = 0;
@@ -72,36 +518,42 @@ uint32_t log_printf(const char_t *format, ...)
     {
         Date date;
         btime_date(&date);
-        time_size = bstd_sprintf(time_buffer, 32, "[%02d:%02d:%02d] ", date.hour, date.minute, date.second);
+        time_size = bstd_sprintf(line, 32, "[%02d:%02d:%02d] ", date.hour, date.minute, date.second);
     }
 
     {
         va_list args;
         va_start(args, format);
-        msg_size = bstd_vsprintf(msg_buffer, BUFSIZE, format, args);
+        msg_size = bstd_vsprintf(line + time_size, BUFSIZE, format, args);
         va_end(args);
-        if (msg_size > BUFSIZE)
-            msg_size = BUFSIZE;
+        if (msg_size >= BUFSIZE)
+            msg_size = BUFSIZE - 1;
+    }
+
+    if (i_LOG_ASYNC == TRUE)
+    {
+        bool_t dropped = FALSE;
+        if (i_async_push(line, time_size + msg_size, &dropped) == TRUE)
+        {
+            if (dropped == FALSE && (i_LOG_STDOUT == TRUE || i_LOG_STDERR == TRUE))
+                total_size = time_size + msg_size + 1;
+            return total_size;
+        }
     }
 
     i_lock();
 
     if (i_LOG_STDOUT == TRUE)
-        total_size = bstd_printf("%s%s\n", time_buffer, msg_buffer);
+        total_size = bstd_printf("%s\n", line);
 
     if (i_LOG_STDERR == TRUE)
-        total_size = bstd_eprintf("%s%s\n", time_buffer, msg_buffer);
+        total_size = bstd_eprintf("%s\n", line);
 
     if (i_LOG_FILEPATH[0] != '\0')
     {
-        File *file = bfile_open(i_LOG_FILEPATH, ekAPPEND, NULL);
-        if (file != NULL)
-        {
-            bfile_write(file, cast_const(time_buffer, byte_t), time_size, NULL, NULL);
-            bfile_write(file, cast_const(msg_buffer, byte_t), msg_size, NULL, NULL);
-            bfile_write(file, cast_const("\r\n", byte_t), 2, NULL, NULL);
-            bfile_close(&file);
-        }
+        line[time_size + msg_size] = '\r';
+        line[time_size + msg_size + 1] = '\n';
+        i_write_file(cast_const(line, byte_t), time_size + msg_size + 2);
     }
 
     i_unlock();
@@ -123,13 +575,13 @@ void log_output(const bool_t std, const bool_t err)
 void log_file(const char_t *pathname)
 {
     i_lock();
+    if (i_LOG_FILE != NULL)
+        bfile_close(&i_LOG_FILE);
+
     if (pathname != NULL)
     {
-        File *file = NULL;
         blib_strcpy(i_LOG_FILEPATH, 512, pathname);
-        file = bfile_create(i_LOG_FILEPATH, NULL);
-        if (file != NULL)
-            bfile_close(&file);
+        i_create_file();
     }
     else
     {
@@ -147,3 +599,47 @@ const char_t *log_get_file(void)
     else
         return i_LOG_FILEPATH;
 }
+
+/*---------------------------------------------------------------------------*/
+
+void log_async(const uint32_t ring_size, const logfull_t full)
+{
+    cassert(i_LOG_MUTEX != NULL);
+    i_async_stop();
+    if (ring_size > 0)
+        i_async_start(ring_size, full);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void log_flush(void)
+{
+    if (i_LOG_ASYNC == TRUE)
+        i_drain();
+}
+
+/*---------------------------------------------------------------------------*/
+
+void log_rotate(const uint64_t max_size, const uint32_t max_secs, const uint32_t max_files)
+{
+    i_lock();
+    i_LOG_MAXSIZE = max_size;
+    i_LOG_MAXSECS = max_secs;
+    i_LOG_MAXFILES = max_files;
+    i_unlock();
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t log_dropped(void)
+{
+    uint32_t dropped = 0;
+    uint32_t i;
+    for (i = 0; i < i_LOG_NUM_RINGS; ++i)
+    {
+        bmutex_lock(i_LOG_RINGS[i].mutex);
+        dropped += i_LOG_RINGS[i].dropped;
+        bmutex_unlock(i_LOG_RINGS[i].mutex);
+    }
+    return dropped;
+}
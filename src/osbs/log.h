@@ -23,4 +23,12 @@ _osbs_api void log_file(const char_t *pathname);
 
 _osbs_api const char_t *log_get_file(void);
 
+_osbs_api void log_async(const uint32_t ring_size, const logfull_t full);
+
+_osbs_api void log_flush(void);
+
+_osbs_api void log_rotate(const uint64_t max_size, const uint32_t max_secs, const uint32_t max_files);
+
+_osbs_api uint32_t log_dropped(void);
+
 __END_C
@@ -32,6 +32,8 @@ static uint32_t i_NUM_FILES_OPENED = 0;
 static uint32_t i_NUM_FILES_CLOSED = 0;
 static uint32_t i_NUM_MUTEX_ALLOC = 0;
 static uint32_t i_NUM_MUTEX_DEALLOC = 0;
+static uint32_t i_NUM_SEMS_ALLOC = 0;
+static uint32_t i_NUM_SEMS_DEALLOC = 0;
 static uint32_t i_NUM_PROCS_ALLOC = 0;
 static uint32_t i_NUM_PROCS_DEALLOC = 0;
 static uint32_t i_NUM_DLIBS_ALLOC = 0;
@@ -40,6 +42,8 @@ static uint32_t i_NUM_THREADS_ALLOC = 0;
 static uint32_t i_NUM_THREADS_DEALLOC = 0;
 static uint32_t i_NUM_SOCKETS_ALLOC = 0;
 static uint32_t i_NUM_SOCKETS_DEALLOC = 0;
+static uint32_t i_NUM_POLLS_ALLOC = 0;
+static uint32_t i_NUM_POLLS_DEALLOC = 0;
 
 /*---------------------------------------------------------------------------*/
 
@@ -96,8 +100,8 @@ void osbs_finish(void)
     if (i_NUM_USERS == 1)
     {
         _osbs_finish_sockets();
-        sewer_finish();
         _log_finish();
+        sewer_finish();
 
         i_NUM_USERS = 0;
 
@@ -113,6 +117,9 @@ void osbs_finish(void)
         if (i_NUM_MUTEX_ALLOC != i_NUM_MUTEX_DEALLOC)
             log_printf("Non-dealloc Mutex: %u/%u", i_NUM_MUTEX_ALLOC, i_NUM_MUTEX_DEALLOC);
 
+        if (i_NUM_SEMS_ALLOC != i_NUM_SEMS_DEALLOC)
+            log_printf("Non-dealloc Semaphores: %u/%u", i_NUM_SEMS_ALLOC, i_NUM_SEMS_DEALLOC);
+
         if (i_NUM_PROCS_ALLOC != i_NUM_PROCS_DEALLOC)
             log_printf("Non-dealloc Procs: %u/%u", i_NUM_PROCS_ALLOC, i_NUM_PROCS_DEALLOC);
 
@@ -124,6 +131,9 @@ void osbs_finish(void)
 
         if (i_NUM_SOCKETS_ALLOC != i_NUM_SOCKETS_DEALLOC)
             log_printf("Non-closed Sockets: %u/%u", i_NUM_SOCKETS_ALLOC, i_NUM_SOCKETS_DEALLOC);
+
+        if (i_NUM_POLLS_ALLOC != i_NUM_POLLS_DEALLOC)
+            log_printf("Non-dealloc SocketPolls: %u/%u", i_NUM_POLLS_ALLOC, i_NUM_POLLS_DEALLOC);
     }
     else
     {
@@ -177,6 +187,13 @@ void _osbs_mutex_alloc(void)
 
 /*---------------------------------------------------------------------------*/
 
+void _osbs_sem_alloc(void)
+{
+    i_incr(&i_NUM_SEMS_ALLOC);
+}
+
+/*---------------------------------------------------------------------------*/
+
 void _osbs_proc_alloc(void)
 {
     i_incr(&i_NUM_PROCS_ALLOC);
@@ -205,6 +222,13 @@ void _osbs_socket_alloc(void)
 
 /*---------------------------------------------------------------------------*/
 
+void _osbs_poll_alloc(void)
+{
+    i_incr(&i_NUM_POLLS_ALLOC);
+}
+
+/*---------------------------------------------------------------------------*/
+
 void _osbs_directory_dealloc(void)
 {
     i_incr(&i_NUM_DIRECTORIES_CLOSED);
@@ -226,6 +250,13 @@ void _osbs_mutex_dealloc(void)
 
 /*---------------------------------------------------------------------------*/
 
+void _osbs_sem_dealloc(void)
+{
+    i_incr(&i_NUM_SEMS_DEALLOC);
+}
+
+/*---------------------------------------------------------------------------*/
+
 void _osbs_proc_dealloc(void)
 {
     i_incr(&i_NUM_PROCS_DEALLOC);
@@ -251,3 +282,10 @@ void _osbs_socket_dealloc(void)
 {
     i_incr(&i_NUM_SOCKETS_DEALLOC);
 }
+
+/*---------------------------------------------------------------------------*/
+
+void _osbs_poll_dealloc(void)
+{
+    i_incr(&i_NUM_POLLS_DEALLOC);
+}
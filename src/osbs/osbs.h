@@ -27,6 +27,8 @@ _osbs_api macos_t osbs_macos(void);
 
 _osbs_api endian_t osbs_endian(void);
 
+_osbs_api uint32_t osbs_ncpus(void);
+
 _osbs_api void osbs_memory_mt(Mutex *mutex);
 
 __END_C
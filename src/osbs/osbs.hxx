@@ -157,23 +157,49 @@ typedef enum _serror_t
     ekSNOHOST,
     ekSTIMEOUT,
     ekSSTREAM,
+    ekSWOULDBLOCK,
     ekSUNDEF,
     ekSOK
 } serror_t;
 
+typedef enum _pollev_t
+{
+    ekPOLL_READ = 1,
+    ekPOLL_WRITE = 1 << 1,
+    ekPOLL_EDGE = 1 << 2,
+    ekPOLL_CLOSE = 1 << 3,
+    ekPOLL_ERROR = 1 << 4
+} pollev_t;
+
+typedef enum _logfull_t
+{
+    ekLOG_DROP = 1,
+    ekLOG_WAIT
+} logfull_t;
+
 typedef struct _date_t Date;
 typedef struct _dir_t Dir;
 typedef struct _file_t File;
 typedef struct _mutex_t Mutex;
+typedef struct _semaphore_t Semaphore;
 typedef struct _process_t Proc;
 typedef struct _dlib_t DLib;
 typedef struct _thread_t Thread;
 typedef struct _socket_t Socket;
+typedef struct _socketpoll_t SocketPoll;
 
 typedef uint32_t (*FPtr_thread_main)(void *data);
 #define FUNC_CHECK_THREAD_MAIN(func, type) \
     (void)((uint32_t(*)(type *))func == func)
 
+typedef void (*FPtr_poll_event)(void *data, Socket *socket, const uint32_t events);
+#define FUNC_CHECK_POLL_EVENT(func, type) \
+    (void)((void (*)(type *, Socket *, const uint32_t))func == func)
+
+typedef void (*FPtr_poll_timer)(void *data, const uint32_t timer_id);
+#define FUNC_CHECK_POLL_TIMER(func, type) \
+    (void)((void (*)(type *, const uint32_t))func == func)
+
 typedef void (*FPtr_libproc)(void);
 
 struct _date_t
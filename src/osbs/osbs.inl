@@ -24,6 +24,8 @@ void _osbs_file_alloc(void);
 
 void _osbs_mutex_alloc(void);
 
+void _osbs_sem_alloc(void);
+
 void _osbs_proc_alloc(void);
 
 void _osbs_dlib_alloc(void);
@@ -32,12 +34,16 @@ void _osbs_thread_alloc(void);
 
 void _osbs_socket_alloc(void);
 
+void _osbs_poll_alloc(void);
+
 void _osbs_directory_dealloc(void);
 
 void _osbs_file_dealloc(void);
 
 void _osbs_mutex_dealloc(void);
 
+void _osbs_sem_dealloc(void);
+
 void _osbs_proc_dealloc(void);
 
 void _osbs_dlib_dealloc(void);
@@ -46,4 +52,6 @@ void _osbs_thread_dealloc(void);
 
 void _osbs_socket_dealloc(void);
 
+void _osbs_poll_dealloc(void);
+
 __END_C
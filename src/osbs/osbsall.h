@@ -13,7 +13,9 @@
 #include "osbs.h"
 #include "bfile.h"
 #include "bmutex.h"
+#include "bpoll.h"
 #include "bproc.h"
+#include "bsem.h"
 #include "bsocket.h"
 #include "bthread.h"
 #include "btime.h"
@@ -0,0 +1,163 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bpoll.c
+ *
+ */
+
+/* Socket readiness multiplexer (kqueue) */
+
+#include "../bpoll.inl"
+#include <sewer/bmem.h>
+#include <sewer/cassert.h>
+
+#if !defined(__MACOS__)
+#error This file is only for OSX
+#endif
+
+#include <sys/types.h>
+#include <sys/event.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <errno.h>
+
+#define i_MAX_EVENTS 256
+#define i_WAKE_IDENT 1
+
+struct _pollimp_t
+{
+    int kq;
+    struct kevent events[i_MAX_EVENTS];
+};
+
+/*---------------------------------------------------------------------------*/
+
+PollImp *_bpoll_imp_create(void)
+{
+    int kq = kqueue();
+    PollImp *imp = NULL;
+    struct kevent kev;
+
+    if (kq == -1)
+        return NULL;
+
+    /* Wake-ups come with a NULL entry */
+    EV_SET(&kev, i_WAKE_IDENT, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, NULL);
+    if (kevent(kq, &kev, 1, NULL, 0, NULL) == -1)
+    {
+        close(kq);
+        return NULL;
+    }
+
+    imp = cast(bmem_malloc(sizeof(PollImp)), PollImp);
+    imp->kq = kq;
+    return imp;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_destroy(PollImp **imp)
+{
+    cassert_no_null(imp);
+    cassert_no_null(*imp);
+    close((*imp)->kq);
+    bmem_free(*dcast(imp, byte_t));
+    *imp = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* One filter per direction. Disabled filters keep the registration */
+static bool_t i_ctl(PollImp *imp, Socket *socket, const uint32_t events, void *entry)
+{
+    struct kevent kev[2];
+    uint16_t flags = EV_ADD;
+    int fd = (int)(intptr_t)socket;
+    cassert_no_null(imp);
+    if (events & ekPOLL_EDGE)
+        flags |= EV_CLEAR;
+    EV_SET(&kev[0], fd, EVFILT_READ, flags | ((events & ekPOLL_READ) ? EV_ENABLE : EV_DISABLE), 0, 0, entry);
+    EV_SET(&kev[1], fd, EVFILT_WRITE, flags | ((events & ekPOLL_WRITE) ? EV_ENABLE : EV_DISABLE), 0, 0, entry);
+    return (bool_t)(kevent(imp->kq, kev, 2, NULL, 0, NULL) == 0);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _bpoll_imp_add(PollImp *imp, Socket *socket, const uint32_t events, void *entry)
+{
+    return i_ctl(imp, socket, events, entry);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _bpoll_imp_modify(PollImp *imp, Socket *socket, const uint32_t events, void *entry)
+{
+    return i_ctl(imp, socket, events, entry);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_remove(PollImp *imp, Socket *socket)
+{
+    struct kevent kev[2];
+    int fd = (int)(intptr_t)socket;
+    cassert_no_null(imp);
+    EV_SET(&kev[0], fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+    EV_SET(&kev[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+    /* Fails if the socket is already closed (and removed by the kernel) */
+    kevent(imp->kq, kev, 2, NULL, 0, NULL);
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t _bpoll_imp_wait(PollImp *imp, const uint32_t timeout_ms, void **entries, uint32_t *events, const uint32_t max_events)
+{
+    struct timespec timeout;
+    int max = (int)(max_events < i_MAX_EVENTS ? max_events : i_MAX_EVENTS);
+    int i, n;
+    cassert_no_null(imp);
+    cassert_no_null(entries);
+    cassert_no_null(events);
+
+    timeout.tv_sec = (time_t)(timeout_ms / 1000);
+    timeout.tv_nsec = (long)(timeout_ms % 1000) * 1000000;
+    n = kevent(imp->kq, NULL, 0, imp->events, max, timeout_ms == UINT32_MAX ? NULL : &timeout);
+    if (n <= 0)
+    {
+        /* Timeout or EINTR */
+        cassert(n == 0 || errno == EINTR);
+        return 0;
+    }
+
+    /* Read and write readiness of the same socket come in different events */
+    for (i = 0; i < n; ++i)
+    {
+        const struct kevent *kev = &imp->events[i];
+        uint32_t rev = 0;
+        entries[i] = kev->udata;
+        if (kev->filter == EVFILT_READ)
+            rev |= ekPOLL_READ;
+        else if (kev->filter == EVFILT_WRITE)
+            rev |= ekPOLL_WRITE;
+        if (kev->flags & EV_EOF)
+            rev |= ekPOLL_CLOSE;
+        if (kev->flags & EV_ERROR)
+            rev |= ekPOLL_ERROR;
+        events[i] = rev;
+    }
+
+    return (uint32_t)n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_wake(PollImp *imp)
+{
+    struct kevent kev;
+    cassert_no_null(imp);
+    EV_SET(&kev, i_WAKE_IDENT, EVFILT_USER, 0, NOTE_TRIGGER, 0, NULL);
+    kevent(imp->kq, &kev, 1, NULL, 0, NULL);
+}
@@ -25,6 +25,7 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -674,6 +675,83 @@ uint64_t bfile_pos(const File *file)
 
 /*---------------------------------------------------------------------------*/
 
+static const byte_t i_EMPTY_MAP[1] = {0};
+
+/*---------------------------------------------------------------------------*/
+
+const byte_t *bfile_mmap(const char_t *pathname, uint64_t *size, ferror_t *error)
+{
+    int file_id = open(cast_const(pathname, char), O_RDONLY, 0);
+    File *file = i_after_open_file(file_id, error);
+    const byte_t *data = NULL;
+    cassert_no_null(size);
+    *size = 0;
+    if (file != NULL)
+    {
+        struct stat info;
+        if (fstat(file_id, &info) == 0 && S_ISREG(info.st_mode))
+        {
+            uint64_t fsize = (uint64_t)info.st_size;
+            if (fsize == 0)
+            {
+                data = i_EMPTY_MAP;
+            }
+            else if (fsize <= (uint64_t)(size_t)-1)
+            {
+                void *mem = mmap(NULL, (size_t)fsize, PROT_READ, MAP_PRIVATE, file_id, 0);
+                if (mem != MAP_FAILED)
+                {
+                    /* Parsers go from start to end, ask for aggressive read-ahead */
+                    posix_madvise(mem, (size_t)fsize, POSIX_MADV_SEQUENTIAL);
+                    data = cast(mem, byte_t);
+                    *size = fsize;
+                }
+                else
+                {
+                    ptr_assign(error, ekFBIG);
+                }
+            }
+            else
+            {
+                ptr_assign(error, ekFBIG);
+            }
+        }
+        else
+        {
+            ptr_assign(error, ekFNOFILE);
+        }
+
+        /* The mapping remains valid after closing the descriptor */
+        bfile_close(&file);
+        if (data != NULL)
+            _osbs_file_alloc();
+    }
+
+    return data;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bfile_munmap(const byte_t **data, const uint64_t size)
+{
+    cassert_no_null(data);
+    cassert_no_null(*data);
+    if (size > 0)
+    {
+        int ret = munmap(cast(*data, void), (size_t)size);
+        cassert_unref(ret == 0, ret);
+    }
+    else
+    {
+        cassert(*data == i_EMPTY_MAP);
+    }
+
+    _osbs_file_dealloc();
+    *data = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
 bool_t bfile_delete(const char_t *filepath, ferror_t *error)
 {
     int res = unlink(cast_const(filepath, char));
@@ -0,0 +1,100 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bsem.c
+ *
+ */
+
+/* Counting semaphores */
+
+#include "../bsem.h"
+#include "../osbs.inl"
+#include <sewer/cassert.h>
+
+#if !defined(__UNIX__)
+#error This file is for Unix/Unix-like system
+#endif
+
+#include <stdlib.h>
+#include <pthread.h>
+
+/* Unnamed POSIX semaphores are not available in macOS */
+typedef struct _sem_t i_Sem;
+
+struct _sem_t
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+};
+
+/*---------------------------------------------------------------------------*/
+
+Semaphore *bsem_create(const uint32_t count)
+{
+    i_Sem *sem = cast(malloc(sizeof(i_Sem)), i_Sem);
+    int ret = pthread_mutex_init(&sem->mutex, NULL);
+    cassert_unref(ret == 0, ret);
+    ret = pthread_cond_init(&sem->cond, NULL);
+    cassert_unref(ret == 0, ret);
+    sem->count = count;
+    _osbs_sem_alloc();
+    return cast(sem, Semaphore);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bsem_close(Semaphore **sem)
+{
+    i_Sem *isem = NULL;
+    int ret;
+    cassert_no_null(sem);
+    cassert_no_null(*sem);
+    isem = *dcast(sem, i_Sem);
+    ret = pthread_cond_destroy(&isem->cond);
+    cassert_unref(ret == 0, ret);
+    ret = pthread_mutex_destroy(&isem->mutex);
+    cassert_unref(ret == 0, ret);
+    free(isem);
+    _osbs_sem_dealloc();
+    *sem = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bsem_wait(Semaphore *sem)
+{
+    i_Sem *isem = cast(sem, i_Sem);
+    int ret = 0;
+    cassert_no_null(isem);
+    ret = pthread_mutex_lock(&isem->mutex);
+    cassert_unref(ret == 0, ret);
+    while (isem->count == 0)
+    {
+        ret = pthread_cond_wait(&isem->cond, &isem->mutex);
+        cassert_unref(ret == 0, ret);
+    }
+
+    isem->count -= 1;
+    ret = pthread_mutex_unlock(&isem->mutex);
+    cassert_unref(ret == 0, ret);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bsem_post(Semaphore *sem)
+{
+    i_Sem *isem = cast(sem, i_Sem);
+    int ret = 0;
+    cassert_no_null(isem);
+    ret = pthread_mutex_lock(&isem->mutex);
+    cassert_unref(ret == 0, ret);
+    isem->count += 1;
+    ret = pthread_cond_signal(&isem->cond);
+    cassert_unref(ret == 0, ret);
+    ret = pthread_mutex_unlock(&isem->mutex);
+    cassert_unref(ret == 0, ret);
+}
@@ -536,6 +536,101 @@ bool_t bsocket_write(Socket *lsocket, const byte_t *data, const uint32_t size, u
 
 /*---------------------------------------------------------------------------*/
 
+void bsocket_nonblocking(Socket *lsocket, const bool_t nonblocking)
+{
+    int flags = 0;
+    int ret = 0;
+    cassert_no_null(lsocket);
+    flags = fcntl((SOCKET_ID)(intptr_t)lsocket, F_GETFL, 0);
+    cassert(flags >= 0);
+    if (nonblocking == TRUE)
+        flags |= O_NONBLOCK;
+    else
+        flags &= ~O_NONBLOCK;
+    ret = fcntl((SOCKET_ID)(intptr_t)lsocket, F_SETFL, flags);
+    cassert_unref(ret == 0, ret);
+
+#if defined(SO_NOSIGPIPE)
+    {
+        int nosigpipe = 1;
+        ret = setsockopt((SOCKET_ID)(intptr_t)lsocket, SOL_SOCKET, SO_NOSIGPIPE, cast_const(&nosigpipe, char), sizeof(nosigpipe));
+        cassert_unref(ret == 0, ret);
+    }
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static serror_t i_nonblock_error(void)
+{
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return ekSWOULDBLOCK;
+    else if (errno == ETIMEDOUT)
+        return ekSTIMEOUT;
+    else
+        return ekSSTREAM;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t bsocket_recv(Socket *lsocket, byte_t *data, const uint32_t size, uint32_t *rsize, serror_t *error)
+{
+    SSIZE_T num_rbytes = 0;
+    cassert_no_null(lsocket);
+    cassert_no_null(data);
+    cassert(size > 0);
+
+    do
+    {
+        num_rbytes = recv((SOCKET_ID)(intptr_t)lsocket, (char *)data, (SIZE_T)size, 0);
+    } while (num_rbytes == SOCKET_FAIL && errno == EINTR);
+
+    if (num_rbytes >= 0)
+    {
+        /* 0 bytes: the peer has closed the connection */
+        ptr_assign(rsize, (uint32_t)num_rbytes);
+        ptr_assign(error, ekSOK);
+        return TRUE;
+    }
+
+    ptr_assign(rsize, 0);
+    ptr_assign(error, i_nonblock_error());
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t bsocket_send(Socket *lsocket, const byte_t *data, const uint32_t size, uint32_t *wsize, serror_t *error)
+{
+    SSIZE_T num_wbytes = 0;
+    int flags = 0;
+    cassert_no_null(lsocket);
+    cassert_no_null(data);
+    cassert(size > 0);
+
+#if defined(MSG_NOSIGNAL)
+    flags = MSG_NOSIGNAL;
+#endif
+
+    do
+    {
+        num_wbytes = send((SOCKET_ID)(intptr_t)lsocket, cast_const(data, char), (SIZE_T)size, flags);
+    } while (num_wbytes == SOCKET_FAIL && errno == EINTR);
+
+    if (num_wbytes >= 0)
+    {
+        ptr_assign(wsize, (uint32_t)num_wbytes);
+        ptr_assign(error, ekSOK);
+        return TRUE;
+    }
+
+    ptr_assign(wsize, 0);
+    ptr_assign(error, i_nonblock_error());
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
 uint32_t bsocket_url_ip(const char_t *url, serror_t *error)
 {
     struct hostent *host = NULL;
@@ -17,6 +17,8 @@
 #error This file is for Unix/Unix-like system
 #endif
 
+#include <unistd.h>
+
 static endian_t i_ENDIANNESS = ENUM_MAX(endian_t);
 union i_check_endianness
 {
@@ -65,3 +67,11 @@ endian_t osbs_endian(void)
 
     return i_ENDIANNESS;
 }
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t osbs_ncpus(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (uint32_t)n : 1;
+}
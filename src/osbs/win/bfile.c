@@ -695,6 +695,91 @@ uint64_t bfile_pos(const File *file)
 
 /*---------------------------------------------------------------------------*/
 
+static const byte_t i_EMPTY_MAP[1] = {0};
+
+/*---------------------------------------------------------------------------*/
+
+const byte_t *bfile_mmap(const char_t *pathname, uint64_t *size, ferror_t *error)
+{
+    WCHAR pathnamew[MAX_PATH + 1];
+    uint32_t num_bytes = unicode_convers(pathname, cast(pathnamew, char_t), ekUTF8, ekUTF16, sizeof(pathnamew));
+    cassert_no_null(size);
+    *size = 0;
+    if (num_bytes < sizeof(pathnamew))
+    {
+        HANDLE file = CreateFile(pathnamew, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file != INVALID_HANDLE_VALUE)
+        {
+            const byte_t *data = NULL;
+            LARGE_INTEGER fsize;
+            if (GetFileSizeEx(file, &fsize) == 0)
+            {
+                i_file_error(error);
+            }
+            else if (fsize.QuadPart == 0)
+            {
+                data = i_EMPTY_MAP;
+            }
+            else
+            {
+                /* The view remains valid after closing the file and mapping handles */
+                HANDLE map = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+                if (map != NULL)
+                {
+                    data = cast(MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0), byte_t);
+                    CloseHandle(map);
+                }
+
+                if (data != NULL)
+                    *size = (uint64_t)fsize.QuadPart;
+                else
+                    ptr_assign(error, ekFBIG);
+            }
+
+            CloseHandle(file);
+            if (data != NULL)
+            {
+                _osbs_file_alloc();
+                ptr_assign(error, ekFOK);
+            }
+
+            return data;
+        }
+        else
+        {
+            i_file_error(error);
+            return NULL;
+        }
+    }
+    else
+    {
+        ptr_assign(error, ekFBIGNAME);
+        return NULL;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bfile_munmap(const byte_t **data, const uint64_t size)
+{
+    cassert_no_null(data);
+    cassert_no_null(*data);
+    if (size > 0)
+    {
+        BOOL ok = UnmapViewOfFile(cast_const(*data, void));
+        cassert_unref(ok != 0, ok);
+    }
+    else
+    {
+        cassert(*data == i_EMPTY_MAP);
+    }
+
+    _osbs_file_dealloc();
+    *data = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
 bool_t bfile_delete(const char_t *pathname, ferror_t *error)
 {
     WCHAR pathnamew[MAX_PATH + 1];
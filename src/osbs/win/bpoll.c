@@ -0,0 +1,353 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bpoll.c
+ *
+ */
+
+/* Socket readiness multiplexer (select) */
+
+#include "../bpoll.inl"
+#include <sewer/bmem.h>
+#include <sewer/cassert.h>
+
+#if !defined(__WINDOWS__)
+#error This file is for Windows system
+#endif
+
+#include <sewer/nowarn.hxx>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <sewer/warn.hxx>
+
+/*
+ * WSAPoll() is not available in XP toolsets. Winsock fd_set is a counted
+ * array of handles, so the sets are allocated with the real number of
+ * sockets and FD_SETSIZE does not limit the poll. There is no edge-triggered
+ * mode: ekPOLL_EDGE works as level-triggered, so keep ekPOLL_WRITE only
+ * while there is pending output. The peer close is reported as ekPOLL_READ
+ * and detected by a zero bytes bsocket_recv().
+ */
+
+typedef struct _fdset_t i_FdSet;
+
+struct _fdset_t
+{
+    u_int fd_count;
+    SOCKET fd_array[1];
+};
+
+struct _pollimp_t
+{
+    SOCKET wake;
+    SOCKET *sockets;
+    uint32_t *events;
+    void **entries;
+    uint32_t *revents;
+    uint32_t *ready;
+    uint32_t nsockets;
+    uint32_t maxsockets;
+    i_FdSet *rset;
+    i_FdSet *wset;
+    i_FdSet *eset;
+};
+
+/*---------------------------------------------------------------------------*/
+
+static ___INLINE uint32_t i_set_size(const uint32_t n)
+{
+    return (uint32_t)sizeof(i_FdSet) + n * (uint32_t)sizeof(SOCKET);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Loopback UDP socket connected to itself */
+static SOCKET i_wake_socket(void)
+{
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    struct sockaddr_in addr;
+    int len = sizeof(addr);
+    u_long nonblock = 1;
+
+    if (sock == INVALID_SOCKET)
+        return INVALID_SOCKET;
+
+    bmem_zero(&addr, struct sockaddr_in);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(sock, cast(&addr, struct sockaddr), sizeof(addr)) == SOCKET_ERROR
+        || getsockname(sock, cast(&addr, struct sockaddr), &len) == SOCKET_ERROR
+        || connect(sock, cast(&addr, struct sockaddr), sizeof(addr)) == SOCKET_ERROR
+        || ioctlsocket(sock, (long)FIONBIO, &nonblock) == SOCKET_ERROR)
+    {
+        closesocket(sock);
+        return INVALID_SOCKET;
+    }
+
+    return sock;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_alloc(PollImp *imp, const uint32_t maxsockets)
+{
+    uint32_t max = maxsockets + 1;
+    imp->sockets = cast(bmem_malloc(maxsockets * sizeof32(SOCKET)), SOCKET);
+    imp->events = cast(bmem_malloc(maxsockets * sizeof32(uint32_t)), uint32_t);
+    imp->entries = cast(bmem_malloc(maxsockets * sizeofptr), void *);
+    imp->revents = cast(bmem_malloc(maxsockets * sizeof32(uint32_t)), uint32_t);
+    imp->ready = cast(bmem_malloc(maxsockets * sizeof32(uint32_t)), uint32_t);
+    imp->rset = cast(bmem_malloc(i_set_size(max)), i_FdSet);
+    imp->wset = cast(bmem_malloc(i_set_size(max)), i_FdSet);
+    imp->eset = cast(bmem_malloc(i_set_size(max)), i_FdSet);
+    bmem_set_zero(cast(imp->revents, byte_t), maxsockets * sizeof32(uint32_t));
+    imp->maxsockets = maxsockets;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_dealloc(PollImp *imp)
+{
+    bmem_free(cast(imp->sockets, byte_t));
+    bmem_free(cast(imp->events, byte_t));
+    bmem_free(cast(imp->entries, byte_t));
+    bmem_free(cast(imp->revents, byte_t));
+    bmem_free(cast(imp->ready, byte_t));
+    bmem_free(cast(imp->rset, byte_t));
+    bmem_free(cast(imp->wset, byte_t));
+    bmem_free(cast(imp->eset, byte_t));
+}
+
+/*---------------------------------------------------------------------------*/
+
+PollImp *_bpoll_imp_create(void)
+{
+    SOCKET wake = i_wake_socket();
+    PollImp *imp = NULL;
+
+    if (wake == INVALID_SOCKET)
+        return NULL;
+
+    imp = cast(bmem_malloc(sizeof(PollImp)), PollImp);
+    bmem_zero(imp, PollImp);
+    imp->wake = wake;
+    i_alloc(imp, 16);
+    return imp;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_destroy(PollImp **imp)
+{
+    cassert_no_null(imp);
+    cassert_no_null(*imp);
+    closesocket((*imp)->wake);
+    i_dealloc(*imp);
+    bmem_free(*dcast(imp, byte_t));
+    *imp = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static bool_t i_search(const PollImp *imp, const SOCKET sock, uint32_t *pos)
+{
+    uint32_t lo = 0, hi = imp->nsockets;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (imp->sockets[mid] == sock)
+        {
+            *pos = mid;
+            return TRUE;
+        }
+
+        if (imp->sockets[mid] < sock)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    *pos = lo;
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_grow(PollImp *imp)
+{
+    PollImp old = *imp;
+    uint32_t n = imp->nsockets;
+    i_alloc(imp, imp->maxsockets * 2);
+    bmem_copy(cast(imp->sockets, byte_t), cast(old.sockets, byte_t), n * sizeof32(SOCKET));
+    bmem_copy(cast(imp->events, byte_t), cast(old.events, byte_t), n * sizeof32(uint32_t));
+    bmem_copy(cast(imp->entries, byte_t), cast(old.entries, byte_t), n * sizeofptr);
+    i_dealloc(&old);
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _bpoll_imp_add(PollImp *imp, Socket *socket, const uint32_t events, void *entry)
+{
+    SOCKET sock = (SOCKET)(intptr_t)socket;
+    uint32_t pos = 0;
+    cassert_no_null(imp);
+    if (i_search(imp, sock, &pos) == TRUE)
+        return FALSE;
+
+    if (imp->nsockets == imp->maxsockets)
+        i_grow(imp);
+
+    if (pos < imp->nsockets)
+    {
+        uint32_t n = imp->nsockets - pos;
+        bmem_move(cast(imp->sockets + pos + 1, byte_t), cast(imp->sockets + pos, byte_t), n * sizeof32(SOCKET));
+        bmem_move(cast(imp->events + pos + 1, byte_t), cast(imp->events + pos, byte_t), n * sizeof32(uint32_t));
+        bmem_move(cast(imp->entries + pos + 1, byte_t), cast(imp->entries + pos, byte_t), n * sizeofptr);
+    }
+
+    imp->sockets[pos] = sock;
+    imp->events[pos] = events;
+    imp->entries[pos] = entry;
+    imp->nsockets += 1;
+    return TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t _bpoll_imp_modify(PollImp *imp, Socket *socket, const uint32_t events, void *entry)
+{
+    uint32_t pos = 0;
+    cassert_no_null(imp);
+    if (i_search(imp, (SOCKET)(intptr_t)socket, &pos) == TRUE)
+    {
+        imp->events[pos] = events;
+        imp->entries[pos] = entry;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_remove(PollImp *imp, Socket *socket)
+{
+    uint32_t pos = 0;
+    cassert_no_null(imp);
+    if (i_search(imp, (SOCKET)(intptr_t)socket, &pos) == TRUE)
+    {
+        uint32_t n = imp->nsockets - pos - 1;
+        if (n > 0)
+        {
+            bmem_move(cast(imp->sockets + pos, byte_t), cast(imp->sockets + pos + 1, byte_t), n * sizeof32(SOCKET));
+            bmem_move(cast(imp->events + pos, byte_t), cast(imp->events + pos + 1, byte_t), n * sizeof32(uint32_t));
+            bmem_move(cast(imp->entries + pos, byte_t), cast(imp->entries + pos + 1, byte_t), n * sizeofptr);
+        }
+
+        imp->nsockets -= 1;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_mark(PollImp *imp, const i_FdSet *set, const uint32_t flag, uint32_t *nready, bool_t *wake)
+{
+    u_int i;
+    for (i = 0; i < set->fd_count; ++i)
+    {
+        uint32_t pos = 0;
+        if (set->fd_array[i] == imp->wake)
+        {
+            *wake = TRUE;
+        }
+        else if (i_search(imp, set->fd_array[i], &pos) == TRUE)
+        {
+            if (imp->revents[pos] == 0)
+            {
+                imp->ready[*nready] = pos;
+                *nready += 1;
+            }
+
+            imp->revents[pos] |= flag;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+uint32_t _bpoll_imp_wait(PollImp *imp, const uint32_t timeout_ms, void **entries, uint32_t *events, const uint32_t max_events)
+{
+    struct timeval timeout;
+    uint32_t i, nready = 0, n = 0;
+    bool_t wake = FALSE;
+    int ret;
+    cassert_no_null(imp);
+    cassert_no_null(entries);
+    cassert_no_null(events);
+    cassert(max_events > 0);
+
+    imp->rset->fd_count = 1;
+    imp->rset->fd_array[0] = imp->wake;
+    imp->wset->fd_count = 0;
+    imp->eset->fd_count = 0;
+    for (i = 0; i < imp->nsockets; ++i)
+    {
+        if (imp->events[i] & ekPOLL_READ)
+            imp->rset->fd_array[imp->rset->fd_count++] = imp->sockets[i];
+        if (imp->events[i] & ekPOLL_WRITE)
+            imp->wset->fd_array[imp->wset->fd_count++] = imp->sockets[i];
+        /* Failed non-blocking connects */
+        imp->eset->fd_array[imp->eset->fd_count++] = imp->sockets[i];
+    }
+
+    timeout.tv_sec = (long)(timeout_ms / 1000);
+    timeout.tv_usec = (long)(timeout_ms % 1000) * 1000;
+    ret = select(0, cast(imp->rset, fd_set), cast(imp->wset, fd_set), cast(imp->eset, fd_set), timeout_ms == UINT32_MAX ? NULL : &timeout);
+    if (ret <= 0)
+        return 0;
+
+    i_mark(imp, imp->rset, ekPOLL_READ, &nready, &wake);
+    i_mark(imp, imp->wset, ekPOLL_WRITE, &nready, &wake);
+    i_mark(imp, imp->eset, ekPOLL_ERROR, &nready, &wake);
+
+    if (wake == TRUE)
+    {
+        char buffer[64];
+        while (recv(imp->wake, buffer, (int)sizeof(buffer), 0) > 0)
+        {
+        }
+
+        entries[n] = NULL;
+        events[n] = 0;
+        n += 1;
+    }
+
+    /* Sockets beyond max_events are still ready in the next call */
+    for (i = 0; i < nready; ++i)
+    {
+        uint32_t pos = imp->ready[i];
+        if (n < max_events)
+        {
+            entries[n] = imp->entries[pos];
+            events[n] = imp->revents[pos];
+            n += 1;
+        }
+
+        imp->revents[pos] = 0;
+    }
+
+    return n;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _bpoll_imp_wake(PollImp *imp)
+{
+    char byte = 0;
+    cassert_no_null(imp);
+    send(imp->wake, &byte, 1, 0);
+}
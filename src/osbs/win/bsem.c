@@ -0,0 +1,66 @@
+/*
+ * NAppGUI Cross-platform C SDK
+ * 2015-2026 Francisco Garcia Collado
+ * MIT Licence
+ * https://nappgui.com/en/legal/license.html
+ *
+ * File: bsem.c
+ *
+ */
+
+/* Counting semaphores */
+
+#include "../osbs.inl"
+#include "../bsem.h"
+#include <sewer/cassert.h>
+
+#if !defined(__WINDOWS__)
+#error This file is for Windows system
+#endif
+
+#include <sewer/nowarn.hxx>
+#include <Windows.h>
+#include <sewer/warn.hxx>
+
+/*---------------------------------------------------------------------------*/
+
+Semaphore *bsem_create(const uint32_t count)
+{
+    HANDLE sem = CreateSemaphore(NULL, (LONG)count, MAXLONG, NULL);
+    cassert_no_null(sem);
+    _osbs_sem_alloc();
+    return cast(sem, Semaphore);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bsem_close(Semaphore **sem)
+{
+    BOOL ok;
+    cassert_no_null(sem);
+    cassert_no_null(*sem);
+    ok = CloseHandle((HANDLE)*sem);
+    cassert_unref(ok != 0, ok);
+    _osbs_sem_dealloc();
+    *sem = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bsem_wait(Semaphore *sem)
+{
+    DWORD dwWaitResult = 0;
+    cassert_no_null(sem);
+    dwWaitResult = WaitForSingleObject((HANDLE)sem, INFINITE);
+    cassert_unref(dwWaitResult == WAIT_OBJECT_0, dwWaitResult);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void bsem_post(Semaphore *sem)
+{
+    BOOL ok = FALSE;
+    cassert_no_null(sem);
+    ok = ReleaseSemaphore((HANDLE)sem, 1, NULL);
+    cassert_unref(ok != 0, ok);
+}
@@ -532,6 +532,73 @@ bool_t bsocket_shutdown(Socket *lsocket, serror_t *error)
 
 /*---------------------------------------------------------------------------*/
 
+void bsocket_nonblocking(Socket *lsocket, const bool_t nonblocking)
+{
+    u_long mode = nonblocking == TRUE ? 1 : 0;
+    int ret = 0;
+    cassert_no_null(lsocket);
+    ret = ioctlsocket((SOCKET)(intptr_t)lsocket, FIONBIO, &mode);
+    cassert_unref(ret == 0, ret);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static serror_t i_nonblock_error(void)
+{
+    int sock_error = WSAGetLastError();
+    if (sock_error == WSAEWOULDBLOCK)
+        return ekSWOULDBLOCK;
+    else if (sock_error == WSAETIMEDOUT)
+        return ekSTIMEOUT;
+    else
+        return ekSSTREAM;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t bsocket_recv(Socket *lsocket, byte_t *data, const uint32_t size, uint32_t *rsize, serror_t *error)
+{
+    int num_rbytes = 0;
+    cassert_no_null(lsocket);
+    cassert_no_null(data);
+    cassert(size > 0);
+    num_rbytes = recv((SOCKET)(intptr_t)lsocket, cast(data, char), (int)size, 0);
+    if (num_rbytes != SOCKET_ERROR)
+    {
+        /* 0 bytes: the peer has closed the connection */
+        ptr_assign(rsize, (uint32_t)num_rbytes);
+        ptr_assign(error, ekSOK);
+        return TRUE;
+    }
+
+    ptr_assign(rsize, 0);
+    ptr_assign(error, i_nonblock_error());
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
+bool_t bsocket_send(Socket *lsocket, const byte_t *data, const uint32_t size, uint32_t *wsize, serror_t *error)
+{
+    int num_wbytes = 0;
+    cassert_no_null(lsocket);
+    cassert_no_null(data);
+    cassert(size > 0);
+    num_wbytes = send((SOCKET)(intptr_t)lsocket, cast_const(data, char), (int)size, 0);
+    if (num_wbytes != SOCKET_ERROR)
+    {
+        ptr_assign(wsize, (uint32_t)num_wbytes);
+        ptr_assign(error, ekSOK);
+        return TRUE;
+    }
+
+    ptr_assign(wsize, 0);
+    ptr_assign(error, i_nonblock_error());
+    return FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+
 uint32_t bsocket_url_ip(const char_t *url, serror_t *error)
 {
     struct hostent *host = NULL;
@@ -235,7 +235,7 @@ real64_t blib_strtod(const char_t *str, char_t **endptr, bool_t *err)
 void blib_qsort(byte_t *array, const uint32_t nelems, const uint32_t size, FPtr_compare func_compare)
 {
     cassert_no_nullf(func_compare);
-    qsort(cast(array, void), (size_t)nelems, (size_t)size, func_compare);
+    _qsort(cast_const(array, void), nelems, size, func_compare);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -248,6 +248,22 @@ void blib_qsort_ex(const byte_t *array, const uint32_t nelems, const uint32_t si
 
 /*---------------------------------------------------------------------------*/
 
+void blib_qsort_ptr(const void **array, const uint32_t nelems, FPtr_compare func_compare)
+{
+    cassert_no_nullf(func_compare);
+    _qsort_ptr_ex(array, nelems, func_compare, NULL, NULL);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void blib_qsort_ptr_ex(const void **array, const uint32_t nelems, FPtr_compare_ex func_compare, const byte_t *data)
+{
+    cassert_no_nullf(func_compare);
+    _qsort_ptr_ex(array, nelems, NULL, func_compare, cast_const(data, void));
+}
+
+/*---------------------------------------------------------------------------*/
+
 bool_t blib_bsearch(const byte_t *array, const byte_t *key, const uint32_t nelems, const uint32_t size, FPtr_compare func_compare, uint32_t *pos)
 {
     uint32_t st, ed;
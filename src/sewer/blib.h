@@ -43,6 +43,10 @@ _sewer_api void blib_qsort(byte_t *array, const uint32_t nelems, const uint32_t
 
 _sewer_api void blib_qsort_ex(const byte_t *array, const uint32_t nelems, const uint32_t size, FPtr_compare_ex func_compare, const byte_t *data);
 
+_sewer_api void blib_qsort_ptr(const void **array, const uint32_t nelems, FPtr_compare func_compare);
+
+_sewer_api void blib_qsort_ptr_ex(const void **array, const uint32_t nelems, FPtr_compare_ex func_compare, const byte_t *data);
+
 _sewer_api bool_t blib_bsearch(const byte_t *array, const byte_t *key, const uint32_t nelems, const uint32_t size, FPtr_compare func_compare, uint32_t *pos);
 
 _sewer_api bool_t blib_bsearch_ex(const byte_t *array, const byte_t *key, const uint32_t nelems, const uint32_t size, FPtr_compare_ex func_compare, const byte_t *data, uint32_t *pos);
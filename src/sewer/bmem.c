@@ -142,7 +142,7 @@ bool_t bmem_is_zero(const byte_t *mem, const uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
-void bmem_copy(byte_t *dest, const byte_t *src, const uint32_t size)
+void bmem_copy(byte_t *dest, const byte_t *src, const uint64_t size)
 {
     cassert_no_null(dest);
     cassert_no_null(src);
@@ -152,7 +152,7 @@ void bmem_copy(byte_t *dest, const byte_t *src, const uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
-void bmem_move(byte_t *dest, const byte_t *src, const uint32_t size)
+void bmem_move(byte_t *dest, const byte_t *src, const uint64_t size)
 {
     cassert_no_null(dest);
     cassert_no_null(src);
@@ -15,9 +15,9 @@
 
 __EXTERN_C
 
-_sewer_api byte_t *bmem_aligned_malloc(const uint32_t size, const uint32_t align);
+_sewer_api byte_t *bmem_aligned_malloc(const uint64_t size, const uint32_t align);
 
-_sewer_api byte_t *bmem_aligned_realloc(byte_t *mem, const uint32_t size, const uint32_t new_size, const uint32_t align);
+_sewer_api byte_t *bmem_aligned_realloc(byte_t *mem, const uint64_t size, const uint64_t new_size, const uint32_t align);
 
 _sewer_api void bmem_free(byte_t *mem);
 
@@ -33,11 +33,11 @@ _sewer_api int bmem_cmp(const byte_t *mem1, const byte_t *mem2, const uint32_t s
 
 _sewer_api bool_t bmem_is_zero(const byte_t *mem, const uint32_t size);
 
-_sewer_api void bmem_set_zero(byte_t *dest, const uint32_t size);
+_sewer_api void bmem_set_zero(byte_t *dest, const uint64_t size);
 
-_sewer_api void bmem_copy(byte_t *dest, const byte_t *src, const uint32_t size);
+_sewer_api void bmem_copy(byte_t *dest, const byte_t *src, const uint64_t size);
 
-_sewer_api void bmem_move(byte_t *dest, const byte_t *src, const uint32_t size);
+_sewer_api void bmem_move(byte_t *dest, const byte_t *src, const uint64_t size);
 
 _sewer_api bool_t bmem_overlaps(const byte_t *mem1, const byte_t *mem2, const uint32_t size1, const uint32_t size2);
 
@@ -100,6 +100,7 @@
     #define ___INLINE                        inline
     #define __DEPRECATED                    __attribute__((__deprecated__))
     #define __SENTINEL                      __attribute__((__sentinel__))
+    #define __THREAD_LOCAL                  __thread
 
 #if (__GNUC__ > 4 || defined(__clang__))
     #define __PRINTF(format_idx, arg_idx)   __attribute__((__format__ (__printf__, format_idx, arg_idx)))
@@ -130,6 +131,7 @@
     #define ___INLINE                        _inline
     #define __DEPRECATED                    _declspec(deprecated)
     #define __SENTINEL
+    #define __THREAD_LOCAL                  __declspec(thread)
     #define __PRINTF(format_idx, arg_idx)
     #define __SCANF(format_idx, arg_idx)
     #define __TYPECHECK                     _inline
@@ -8,9 +8,7 @@
  *
  */
 
-/* Quick sort with data (from glib) */
-
-/* https://github.com/frida/glib/blob/master/glib/gqsort.c */
+/* Introspective sort with data */
 
 #include "qsort.inl"
 #include "cassert.h"
@@ -18,6 +16,29 @@
 
 typedef void (*i_SWAP)(char *a, char *b, uint32_t size);
 
+typedef struct _sort_t i_Sort;
+
+struct _sort_t
+{
+    uint32_t size;
+    i_SWAP swap;
+    FPtr_compare func_compare;
+    FPtr_compare_ex func_compare_ex;
+    const void *user_data;
+};
+
+typedef struct _sortptr_t i_SortPtr;
+
+struct _sortptr_t
+{
+    FPtr_compare func_compare;
+    FPtr_compare_ex func_compare_ex;
+    const void *user_data;
+};
+
+/* Partitions below this size are finished with insertion sort */
+#define i_INSERTION_THRESH 16
+
 /*---------------------------------------------------------------------------*/
 
 static ___INLINE void i_SWAP_ALIGN(char *a, char *b, uint32_t size)
@@ -47,6 +68,16 @@ static ___INLINE void i_SWAP_PTR(char *a, char *b, uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
+static ___INLINE void i_SWAP_32(char *a, char *b, uint32_t size)
+{
+    uint32_t swap = *cast(a, uint32_t);
+    *cast(a, uint32_t) = *cast(b, uint32_t);
+    *cast(b, uint32_t) = swap;
+    unref(size);
+}
+
+/*---------------------------------------------------------------------------*/
+
 static ___INLINE void i_SWAP_GENERAL(char *a, char *b, uint32_t size)
 {
     uint32_t n1 = size / (uint32_t)sizeofptr;
@@ -75,255 +106,382 @@ static ___INLINE void i_SWAP_GENERAL(char *a, char *b, uint32_t size)
 
 /*---------------------------------------------------------------------------*/
 
-/*
-//#define SWAP(a, b, size)\
-//    do\
-//    {\
-//        uint32_t __size = (size);\
-//        char *__a = (a), *__b = (b);\
-//        do\
-//        {\
-//            char __tmp = *__a;\
-//            *__a++ = *__b;\
-//            *__b++ = __tmp;\
-//        } while (--__size > 0);\
-//    } while (i_FALSE)
-*/
-
-/* Discontinue quicksort algorithm when partition gets below this size.
-   This particular magic number was chosen to work best on a Sun 4/260. */
-#define MAX_THRESH 4
-
-/* Stack node declarations used to store unfulfilled partition obligations. */
-typedef struct
+static ___INLINE int i_cmp(const i_Sort *sort, const char *a, const char *b)
 {
-    char *lo;
-    char *hi;
-} stack_node;
-
-/* The next 4 #defines implement a very fast in-line stack abstraction. */
-/* The stack needs log (total_elements) entries (we could even subtract
-   log(MAX_THRESH)).  Since total_elements has type size_t, we get as
-   upper bound for log (total_elements):
-   bits per byte (CHAR_BIT) * sizeof(size_t).  */
-#define CHAR_BIT 8
-#define STACK_SIZE (CHAR_BIT * sizeof(uint32_t))
-#define PUSH(low, high) ((void)((top->lo = (low)), (top->hi = (high)), ++top))
-#define POP(low, high) ((void)(--top, (low = top->lo), (high = top->hi)))
-#define STACK_NOT_EMPTY (stack < top)
-
-/* Order size using quicksort.  This implementation incorporates
-   four optimizations discussed in Sedgewick:
-
-   1. Non-recursive, using an explicit stack of pointer that store the
-      next array partition to sort.  To save time, this maximum amount
-      of space required to store an array of SIZE_MAX is allocated on the
-      stack.  Assuming a 32-bit (64 bit) integer for size_t, this needs
-      only 32 * sizeof(stack_node) == 256 bytes (for 64 bit: 1024 bytes).
-      Pretty cheap, actually.
-
-   2. Chose the pivot element using a median-of-three decision tree.
-      This reduces the probability of selecting a bad pivot value and
-      eliminates certain extraneous comparisons.
-
-   3. Only quicksorts TOTAL_ELEMS / MAX_THRESH partitions, leaving
-      insertion sort to order the MAX_THRESH items within each partition.
-      This is a big win, since insertion sort is faster for small, mostly
-      sorted array segments.
-
-   4. The larger of the two sub-partitions is always pushed onto the
-      stack first, with the algorithm then concentrating on the
-      smaller partition.  This *guarantees* no more than log (total_elems)
-      stack size is needed (actually O(1) in this case)!  */
-
-/**
- * g_qsort_with_data:
- * @pbase: start of array to sort
- * @total_elems: elements in the array
- * @size: size of each element
- * @compare_func: function to compare elements
- * @user_data: data to pass to @compare_func
- *
- * This is just like the standard C qsort() function, but
- * the comparison routine accepts a user data argument.
- *
- **/
-void _qsort_ex(const void *data, const uint32_t total_elems, const uint32_t sizeof_elem, FPtr_compare_ex func_compare, const void *user_data)
+    if (sort->func_compare != NULL)
+        return sort->func_compare(cast_const(a, void), cast_const(b, void));
+    else
+        return sort->func_compare_ex(cast_const(a, void), cast_const(b, void), sort->user_data);
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Depth limit before switching to heapsort: 2 * log2(n) */
+static uint32_t i_depth(uint32_t n)
+{
+    uint32_t depth = 0;
+    while (n > 1)
+    {
+        n >>= 1;
+        depth += 2;
+    }
+
+    return depth;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_insertion(const i_Sort *sort, char *base, const uint32_t n)
+{
+    uint32_t size = sort->size;
+    char *end = base + (size_t)n * size;
+    char *run;
+
+    for (run = base + size; run < end; run += size)
+    {
+        char *pos = run;
+        while (pos > base && i_cmp(sort, pos, pos - size) < 0)
+        {
+            sort->swap(pos, pos - size, size);
+            pos -= size;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_heapsort(const i_Sort *sort, char *base, const uint32_t n)
 {
-    i_SWAP SWAP_FUNC;
-    char *base_ptr = (char *)data;
-    uint32_t max_thresh = MAX_THRESH * sizeof_elem;
+    uint32_t size = sort->size;
+    uint32_t i = n / 2;
+    uint32_t end = n;
+
+    for (;;)
+    {
+        uint32_t root, child;
+        if (i > 0)
+        {
+            /* Heapify */
+            i -= 1;
+        }
+        else
+        {
+            /* Extract the max */
+            end -= 1;
+            if (end == 0)
+                return;
+            sort->swap(base, base + (size_t)end * size, size);
+        }
+
+        root = i;
+        while ((child = 2 * root + 1) < end)
+        {
+            char *c = base + (size_t)child * size;
+            char *r = base + (size_t)root * size;
+            if (child + 1 < end && i_cmp(sort, c, c + size) < 0)
+            {
+                child += 1;
+                c += size;
+            }
+
+            if (i_cmp(sort, r, c) >= 0)
+                break;
+
+            sort->swap(r, c, size);
+            root = child;
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void i_introsort(const i_Sort *sort, char *lo, uint32_t n, uint32_t depth)
+{
+    uint32_t size = sort->size;
+    while (n > i_INSERTION_THRESH)
+    {
+        char *hi = lo + (size_t)(n - 1) * size;
+        char *mid = lo + (size_t)(n / 2) * size;
+        char *left, *right;
+        uint32_t nleft, nright;
+
+        if (depth == 0)
+        {
+            i_heapsort(sort, lo, n);
+            return;
+        }
+
+        depth -= 1;
+
+        /* Median of three as pivot (moved to 'lo'). 'hi' stops the left scan */
+        if (i_cmp(sort, mid, lo) < 0)
+            sort->swap(mid, lo, size);
+
+        if (i_cmp(sort, hi, mid) < 0)
+        {
+            sort->swap(hi, mid, size);
+            if (i_cmp(sort, mid, lo) < 0)
+                sort->swap(mid, lo, size);
+        }
+
+        sort->swap(lo, mid, size);
+
+        /* Hoare partition. Equal keys stop both scans, keeping the halves balanced */
+        left = lo + size;
+        right = hi;
+        for (;;)
+        {
+            while (i_cmp(sort, left, lo) < 0)
+                left += size;
+
+            while (i_cmp(sort, lo, right) < 0)
+                right -= size;
+
+            if (left >= right)
+                break;
+
+            sort->swap(left, right, size);
+            left += size;
+            right -= size;
+        }
+
+        if (right != lo)
+            sort->swap(lo, right, size);
+
+        /* Recurse into the smaller half, loop on the larger one */
+        nleft = (uint32_t)((size_t)(right - lo) / size);
+        nright = n - nleft - 1;
+        if (nleft < nright)
+        {
+            i_introsort(sort, lo, nleft, depth);
+            lo = right + size;
+            n = nright;
+        }
+        else
+        {
+            i_introsort(sort, right + size, nright, depth);
+            n = nleft;
+        }
+    }
+
+    i_insertion(sort, lo, n);
+}
+
+/*---------------------------------------------------------------------------*/
 
-    cassert_no_null(base_ptr);
+static void i_qsort(const void *data, const uint32_t total_elems, const uint32_t sizeof_elem, FPtr_compare func_compare, FPtr_compare_ex func_compare_ex, const void *user_data)
+{
+    i_Sort sort;
     cassert(sizeof_elem > 0);
-    cassert_no_nullf(func_compare);
 
-    /* Avoid lossage with unsigned arithmetic below.  */
-    if (total_elems == 0)
+    if (total_elems < 2)
         return;
 
+    cassert_no_null(data);
+    sort.size = sizeof_elem;
+    sort.func_compare = func_compare;
+    sort.func_compare_ex = func_compare_ex;
+    sort.user_data = user_data;
     if (sizeof_elem == sizeofptr)
-        SWAP_FUNC = i_SWAP_PTR;
+        sort.swap = i_SWAP_PTR;
+    else if (sizeof_elem == sizeof(uint32_t) && ((size_t)data % sizeof(uint32_t)) == 0)
+        sort.swap = i_SWAP_32;
     else if (sizeof_elem % (uint32_t)sizeofptr == 0)
-        SWAP_FUNC = i_SWAP_ALIGN;
+        sort.swap = i_SWAP_ALIGN;
     else
-        SWAP_FUNC = i_SWAP_GENERAL;
-
-    if (total_elems > MAX_THRESH)
-    {
-        char *lo = base_ptr;
-        char *hi = &lo[sizeof_elem * (total_elems - 1)];
-        stack_node stack[STACK_SIZE];
-        stack_node *top = stack;
-
-        PUSH(NULL, NULL);
+        sort.swap = i_SWAP_GENERAL;
 
-        while (STACK_NOT_EMPTY)
-        {
-            char *left_ptr;
-            char *right_ptr;
+    i_introsort(&sort, (char *)data, total_elems, i_depth(total_elems));
+}
 
-            /* Select median value from among LO, MID, and HI. Rearrange
-            LO and HI so the three values are sorted. This lowers the
-            probability of picking a pathological pivot value and
-            skips a comparison for both the LEFT_PTR and RIGHT_PTR in
-            the while loops. */
+/*---------------------------------------------------------------------------*/
 
-            char *mid = lo + sizeof_elem * ((uint32_t)(hi - lo) / sizeof_elem >> 1);
+void _qsort(const void *data, const uint32_t total_elems, const uint32_t sizeof_elem, FPtr_compare func_compare)
+{
+    cassert_no_nullf(func_compare);
+    i_qsort(data, total_elems, sizeof_elem, func_compare, NULL, NULL);
+}
 
-            if (func_compare(cast(mid, void), cast(lo, void), user_data) < 0)
-                SWAP_FUNC(mid, lo, sizeof_elem);
+/*---------------------------------------------------------------------------*/
 
-            if ((func_compare)(cast(hi, void), cast(mid, void), user_data) < 0)
-                SWAP_FUNC(mid, hi, sizeof_elem);
-            else
-                goto jump_over;
+void _qsort_ex(const void *data, const uint32_t total_elems, const uint32_t sizeof_elem, FPtr_compare_ex func_compare, const void *user_data)
+{
+    cassert_no_nullf(func_compare);
+    i_qsort(data, total_elems, sizeof_elem, NULL, func_compare, user_data);
+}
 
-            if (func_compare(cast(mid, void), cast(lo, void), user_data) < 0)
-                SWAP_FUNC(mid, lo, sizeof_elem);
+/*---------------------------------------------------------------------------*/
 
-        jump_over:;
+/*
+ * Pointer arrays: same algorithm, comparing the pointed objects
+ * directly and swapping pointers with no size dispatch.
+ */
+static ___INLINE int i_cmp_ptr(const i_SortPtr *sort, const void *a, const void *b)
+{
+    if (sort->func_compare != NULL)
+        return sort->func_compare(a, b);
+    else
+        return sort->func_compare_ex(a, b, sort->user_data);
+}
 
-            left_ptr = lo + sizeof_elem;
-            right_ptr = hi - sizeof_elem;
+/*---------------------------------------------------------------------------*/
 
-            /* Here's the famous ``collapse the walls'' section of quicksort.
-            Gotta like those tight inner loops!  They are the main reason
-            that this algorithm runs much faster than others. */
-            do
-            {
-                while (func_compare(cast(left_ptr, void), cast(mid, void), user_data) < 0)
-                    left_ptr += sizeof_elem;
-
-                while (func_compare(cast(mid, void), cast(right_ptr, void), user_data) < 0)
-                    right_ptr -= sizeof_elem;
-
-                if (left_ptr < right_ptr)
-                {
-                    SWAP_FUNC(left_ptr, right_ptr, sizeof_elem);
-
-                    if (mid == left_ptr)
-                        mid = right_ptr;
-                    else if (mid == right_ptr)
-                        mid = left_ptr;
-
-                    left_ptr += sizeof_elem;
-                    right_ptr -= sizeof_elem;
-                }
-                else if (left_ptr == right_ptr)
-                {
-                    left_ptr += sizeof_elem;
-                    right_ptr -= sizeof_elem;
-                    break;
-                }
-            } while (left_ptr <= right_ptr);
-
-            /* Set up pointers for next iteration.  First determine whether
-            left and right partitions are below the threshold size.  If so,
-            ignore one or both.  Otherwise, push the larger partition's
-            bounds on the stack and continue sorting the smaller one. */
-
-            if ((uint32_t)(right_ptr - lo) <= max_thresh)
-            {
-                /* Ignore both small partitions. */
-                if ((uint32_t)(hi - left_ptr) <= max_thresh)
-                    POP(lo, hi);
-                /* Ignore small left partition. */
-                else
-                    lo = left_ptr;
-            }
-            /* Ignore small right partition. */
-            else if ((uint32_t)(hi - left_ptr) <= max_thresh)
-                hi = right_ptr;
-            /* Push larger left partition indices. */
-            else if ((right_ptr - lo) > (hi - left_ptr))
-            {
-                PUSH(lo, right_ptr);
-                lo = left_ptr;
-            }
-            /* Push larger right partition indices. */
-            else
-            {
-                PUSH(left_ptr, hi);
-                hi = right_ptr;
-            }
+static void i_insertion_ptr(const i_SortPtr *sort, const void **base, const uint32_t n)
+{
+    uint32_t i;
+    for (i = 1; i < n; ++i)
+    {
+        const void *elem = base[i];
+        uint32_t j = i;
+        while (j > 0 && i_cmp_ptr(sort, elem, base[j - 1]) < 0)
+        {
+            base[j] = base[j - 1];
+            j -= 1;
         }
+
+        base[j] = elem;
     }
+}
 
-    /* Once the BASE_PTR array is partially sorted by quicksort the rest
-    is completely sorted using insertion sort, since this is efficient
-    for partitions below MAX_THRESH size. BASE_PTR points to the beginning
-    of the array to sort, and END_PTR points at the very last element in
-    the array (*not* one beyond it!). */
+/*---------------------------------------------------------------------------*/
 
-#define min(x, y) ((x) < (y) ? (x) : (y))
+static void i_heapsort_ptr(const i_SortPtr *sort, const void **base, const uint32_t n)
+{
+    uint32_t i = n / 2;
+    uint32_t end = n;
 
+    for (;;)
     {
-        char *const end_ptr = &base_ptr[sizeof_elem * (total_elems - 1)];
-        char *tmp_ptr = base_ptr;
-        char *thresh = min(end_ptr, base_ptr + max_thresh);
-        char *run_ptr;
+        uint32_t root, child;
+        const void *elem;
+        if (i > 0)
+        {
+            i -= 1;
+            elem = base[i];
+        }
+        else
+        {
+            end -= 1;
+            if (end == 0)
+                return;
+            elem = base[end];
+            base[end] = base[0];
+        }
+
+        /* Sift 'elem' down from the hole */
+        root = i;
+        while ((child = 2 * root + 1) < end)
+        {
+            if (child + 1 < end && i_cmp_ptr(sort, base[child], base[child + 1]) < 0)
+                child += 1;
+
+            if (i_cmp_ptr(sort, elem, base[child]) >= 0)
+                break;
 
-        /* Find smallest element in first threshold and place it at the
-        array's beginning.  This is the smallest array element,
-        and the operation speeds up insertion sort's inner loop. */
+            base[root] = base[child];
+            root = child;
+        }
 
-        for (run_ptr = tmp_ptr + sizeof_elem; run_ptr <= thresh; run_ptr += sizeof_elem)
-            if (func_compare(cast(run_ptr, void), cast(tmp_ptr, void), user_data) < 0)
-                tmp_ptr = run_ptr;
+        base[root] = elem;
+    }
+}
 
-        if (tmp_ptr != base_ptr)
-            SWAP_FUNC(tmp_ptr, base_ptr, sizeof_elem);
+/*---------------------------------------------------------------------------*/
 
-        /* Insertion sort, running from left-hand-side up to right-hand-side.  */
-        run_ptr = base_ptr + sizeof_elem;
+static void i_introsort_ptr(const i_SortPtr *sort, const void **lo, uint32_t n, uint32_t depth)
+{
+    while (n > i_INSERTION_THRESH)
+    {
+        uint32_t hi = n - 1;
+        uint32_t mid = n / 2;
+        uint32_t left, right;
+        const void *swap;
 
-        while ((run_ptr += sizeof_elem) <= end_ptr)
+        if (depth == 0)
         {
-            tmp_ptr = run_ptr - sizeof_elem;
+            i_heapsort_ptr(sort, lo, n);
+            return;
+        }
 
-            while (func_compare(cast(run_ptr, void), cast(tmp_ptr, void), user_data) < 0)
-                tmp_ptr -= sizeof_elem;
+        depth -= 1;
 
-            tmp_ptr += sizeof_elem;
+        if (i_cmp_ptr(sort, lo[mid], lo[0]) < 0)
+        {
+            swap = lo[mid];
+            lo[mid] = lo[0];
+            lo[0] = swap;
+        }
 
-            if (tmp_ptr != run_ptr)
+        if (i_cmp_ptr(sort, lo[hi], lo[mid]) < 0)
+        {
+            swap = lo[hi];
+            lo[hi] = lo[mid];
+            lo[mid] = swap;
+            if (i_cmp_ptr(sort, lo[mid], lo[0]) < 0)
             {
-                char *trav;
+                swap = lo[mid];
+                lo[mid] = lo[0];
+                lo[0] = swap;
+            }
+        }
 
-                trav = run_ptr + sizeof_elem;
+        swap = lo[mid];
+        lo[mid] = lo[0];
+        lo[0] = swap;
 
-                while (--trav >= run_ptr)
-                {
-                    char c = *trav;
-                    char *hi, *lo;
+        left = 1;
+        right = hi;
+        for (;;)
+        {
+            while (i_cmp_ptr(sort, lo[left], lo[0]) < 0)
+                left += 1;
 
-                    for (hi = lo = trav; (lo -= sizeof_elem) >= tmp_ptr; hi = lo)
-                        *hi = *lo;
+            while (i_cmp_ptr(sort, lo[0], lo[right]) < 0)
+                right -= 1;
 
-                    *hi = c;
-                }
-            }
+            if (left >= right)
+                break;
+
+            swap = lo[left];
+            lo[left] = lo[right];
+            lo[right] = swap;
+            left += 1;
+            right -= 1;
+        }
+
+        swap = lo[right];
+        lo[right] = lo[0];
+        lo[0] = swap;
+
+        if (right < n - right - 1)
+        {
+            i_introsort_ptr(sort, lo, right, depth);
+            lo += right + 1;
+            n -= right + 1;
+        }
+        else
+        {
+            i_introsort_ptr(sort, lo + right + 1, n - right - 1, depth);
+            n = right;
         }
     }
+
+    i_insertion_ptr(sort, lo, n);
+}
+
+/*---------------------------------------------------------------------------*/
+
+void _qsort_ptr_ex(const void **data, const uint32_t total_elems, FPtr_compare func_compare, FPtr_compare_ex func_compare_ex, const void *user_data)
+{
+    i_SortPtr sort;
+    cassert(func_compare != NULL || func_compare_ex != NULL);
+
+    if (total_elems < 2)
+        return;
+
+    cassert_no_null(data);
+    sort.func_compare = func_compare;
+    sort.func_compare_ex = func_compare_ex;
+    sort.user_data = user_data;
+    i_introsort_ptr(&sort, data, total_elems, i_depth(total_elems));
 }
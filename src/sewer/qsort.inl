@@ -8,12 +8,16 @@
  *
  */
 
-/* Quick sort with data */
+/* Introspective sort with data */
 
 #include "sewer.hxx"
 
 __EXTERN_C
 
+void _qsort(const void *data, const uint32_t num_elems, const uint32_t sizeof_elem, FPtr_compare func_compare);
+
 void _qsort_ex(const void *data, const uint32_t num_elems, const uint32_t sizeof_elem, FPtr_compare_ex func_compare, const void *user_data);
 
+void _qsort_ptr_ex(const void **data, const uint32_t num_elems, FPtr_compare func_compare, FPtr_compare_ex func_compare_ex, const void *user_data);
+
 __END_C
@@ -18,6 +18,7 @@
 #endif
 
 #include "../cassert.h"
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -52,7 +53,7 @@ void _bmem_atexit(void)
 
 /*---------------------------------------------------------------------------*/
 
-byte_t *bmem_aligned_malloc(const uint32_t size, const uint32_t align)
+byte_t *bmem_aligned_malloc(const uint64_t size, const uint32_t align)
 {
     byte_t *mem = NULL;
     /* Align must be power of 2 */
@@ -63,13 +64,16 @@ byte_t *bmem_aligned_malloc(const uint32_t size, const uint32_t align)
         int ret = 0;
         ret = posix_memalign(&mem1, (size_t)align, (size_t)size);
         mem = cast(mem1, byte_t);
-        cassert_unref(ret == 0, ret);
+        /* Out of memory returns NULL. The caller decides */
+        cassert_unref(ret == 0 || ret == ENOMEM, ret);
     }
 #else
     {
         /* Allocates a bigger buffer for alignment purpose, and stores the original allocated
            address just before the aligned buffer for a later call to free */
         void *alloc_mem = malloc((size_t)(size + (align - 1) + sizeofptr));
+        if (alloc_mem == NULL)
+            return NULL;
         mem = cast(alloc_mem, byte_t) + sizeofptr;
         mem += (align - ((size_t)mem & (align - 1)) & (align - 1));
         dcast(mem[-1], void) = alloc_mem;
@@ -81,7 +85,7 @@ byte_t *bmem_aligned_malloc(const uint32_t size, const uint32_t align)
 
 /*---------------------------------------------------------------------------*/
 
-byte_t *bmem_aligned_realloc(byte_t *mem, const uint32_t size, const uint32_t new_size, const uint32_t align)
+byte_t *bmem_aligned_realloc(byte_t *mem, const uint64_t size, const uint64_t new_size, const uint32_t align)
 {
     /* Align must be power of 2 */
     cassert_no_null(mem);
@@ -98,9 +102,9 @@ byte_t *bmem_aligned_realloc(byte_t *mem, const uint32_t size, const uint32_t ne
     /* realloc has not been successful. */
     {
         byte_t *new_mem = bmem_aligned_malloc(new_size, align);
-        size_t min_size = size;
-        if (new_size < min_size)
-            min_size = new_size;
+        size_t min_size = (size_t)size;
+        if (new_size < size)
+            min_size = (size_t)new_size;
         memcpy(cast(new_mem, void), cast_const(mem, void), min_size);
         bmem_free(mem);
         return new_mem;
@@ -133,7 +137,7 @@ void bmem_set1(byte_t *dest, const uint32_t size, const byte_t mask)
 
 /*---------------------------------------------------------------------------*/
 
-void bmem_set_zero(byte_t *dest, const uint32_t size)
+void bmem_set_zero(byte_t *dest, const uint64_t size)
 {
     cassert_no_null(dest);
     cassert(size > 0);
@@ -138,7 +138,7 @@ void _bmem_atexit(void)
 
 /*---------------------------------------------------------------------------*/
 
-byte_t *bmem_aligned_malloc(const uint32_t size, const uint32_t align)
+byte_t *bmem_aligned_malloc(const uint64_t size, const uint32_t align)
 {
     void *mem = NULL;
 
@@ -156,13 +156,14 @@ byte_t *bmem_aligned_malloc(const uint32_t size, const uint32_t align)
 #if defined(__MEMORY_SUBSYTEM_CHECKING__)
     i_mem_append(mem);
 #endif
-    cassert((mem != NULL) && ((intptr_t)mem % align) == 0);
+    /* Out of memory returns NULL. The caller decides */
+    cassert(mem == NULL || ((intptr_t)mem % align) == 0);
     return cast(mem, byte_t);
 }
 
 /*---------------------------------------------------------------------------*/
 
-byte_t *bmem_aligned_realloc(byte_t *mem, const uint32_t size, const uint32_t new_size, const uint32_t align)
+byte_t *bmem_aligned_realloc(byte_t *mem, const uint64_t size, const uint64_t new_size, const uint32_t align)
 {
     void *new_mem = NULL;
 
@@ -222,7 +223,7 @@ void bmem_set1(byte_t *dest, const uint32_t size, const byte_t mask)
 
 /*---------------------------------------------------------------------------*/
 
-void bmem_set_zero(byte_t *mem, const uint32_t size)
+void bmem_set_zero(byte_t *mem, const uint64_t size)
 {
     cassert_no_null(mem);
     cassert(size > 0);